@@ -1,6 +1,16 @@
 @echo off
 glslangValidator.exe -V ../Engine/Source/Shaders/simple_shader.vert -o ../Engine/Binaries/simple_shader.vert.spv
 glslangValidator.exe -V ../Engine/Source/Shaders/simple_shader.frag -o ../Engine/Binaries/simple_shader.frag.spv
+glslangValidator.exe -V ../Engine/Source/Shaders/mipmap_downsample.comp -o ../Engine/Binaries/mipmap_downsample.comp.spv
+glslangValidator.exe -V ../Engine/Source/Shaders/quantized_shader.vert -o ../Engine/Binaries/quantized_shader.vert.spv
+glslangValidator.exe -V ../Engine/Source/Shaders/quantized_shader.frag -o ../Engine/Binaries/quantized_shader.frag.spv
+glslangValidator.exe -V ../Engine/Source/Shaders/depth_only.vert -o ../Engine/Binaries/depth_only.vert.spv
+glslangValidator.exe -V ../Engine/Source/Shaders/depth_only.frag -o ../Engine/Binaries/depth_only.frag.spv
+glslangValidator.exe -V ../Engine/Source/Shaders/indirect_cull.comp -o ../Engine/Binaries/indirect_cull.comp.spv
+glslangValidator.exe -V ../Engine/Source/Shaders/indirect_shader.vert -o ../Engine/Binaries/indirect_shader.vert.spv
+glslangValidator.exe -V ../Engine/Source/Shaders/indirect_shader.frag -o ../Engine/Binaries/indirect_shader.frag.spv
+glslangValidator.exe -V ../Engine/Source/Shaders/instanced_shader.vert -o ../Engine/Binaries/instanced_shader.vert.spv
+glslangValidator.exe -V ../Engine/Source/Shaders/instanced_shader.frag -o ../Engine/Binaries/instanced_shader.frag.spv
 
 glslangValidator.exe -V ../Engine/Source/Shaders/draw_image_shader.frag -o ../Engine/Binaries/draw_image_shader.vert.spv
 glslangValidator.exe -V ../Engine/Source/Shaders/draw_image_shader.vert -o ../Engine/Binaries/draw_image_shader.frag.spv
@@ -37,6 +37,7 @@ enum VfluxDebugWatchValueType {
     VFLUX_DEBUGGER_WATCH_TYPE_FLOAT,
     VFLUX_DEBUGGER_WATCH_TYPE_DOUBLE,
     VFLUX_DEBUGGER_WATCH_TYPE_UINT32,
+    VFLUX_DEBUGGER_WATCH_TYPE_UINT64,
     VFLUX_DEBUGGER_WATCH_TYPE_FLOAT2,
     VFLUX_DEBUGGER_WATCH_TYPE_FLOAT3,
 };
@@ -33,6 +33,66 @@
 //
 #define ENABLE_VULKAN_VALIDATION_LAYER
 
+//
+// CPU 最多领先 GPU 的帧数 (frames in flight)
+//
+#define ENGINE_CONFIG_MAX_FRAMES_IN_FLIGHT 2
+
+//
+// 上传数据使用的持久映射暂存环形缓冲大小
+//
+#define ENGINE_CONFIG_STAGING_RING_SIZE (64 * 1024 * 1024)
+
+//
+// 管线缓存文件，启动时读取、退出时写回
+//
+#define ENGINE_CONFIG_PIPELINE_CACHE_FILE "pipeline.cache"
+
+//
+// 后台编译管线的工作线程数量
+//
+#define ENGINE_CONFIG_PIPELINE_COMPILE_THREADS 2
+
+//
+// bindless 纹理表容量
+//
+#define ENGINE_CONFIG_BINDLESS_TEXTURE_CAPACITY 4096
+
+//
+// 后台加载纹理的工作线程数量
+//
+#define ENGINE_CONFIG_TEXTURE_LOAD_THREADS 4
+
+//
+// 每帧最多上传的异步纹理字节数
+//
+#define ENGINE_CONFIG_TEXTURE_UPLOAD_BUDGET (16 * 1024 * 1024)
+
+//
+// 流送纹理始终常驻的最大 mip 尺寸
+//
+#define ENGINE_CONFIG_TEXTURE_STREAMING_TAIL_SIZE 128
+
+//
+// 流送纹理的显存预算上限，有 VK_EXT_memory_budget 时按驱动报告的预算再收紧
+//
+#define ENGINE_CONFIG_TEXTURE_STREAMING_BUDGET (512ull * 1024 * 1024)
+
+//
+// 同时在加载中的流送请求数量
+//
+#define ENGINE_CONFIG_TEXTURE_STREAMING_REQUESTS 4
+
+//
+// 网格二进制缓存目录，OBJ 第一次加载后写到这里
+//
+#define ENGINE_CONFIG_MESH_CACHE_FOLDER "MeshCache"
+
+//
+// 引擎内置着色器 (.spv) 所在目录
+//
+#define ENGINE_CONFIG_SHADER_FOLDER "../Engine/Binaries"
+
 //
 // 开启引擎调试
 //
@@ -24,8 +24,12 @@
  ===============================
 */
 #include "GedUI.h"
+#include <System.h>
 
 static VkApplicationContext *s_DriverApplicationContext = null;
+static VulkanContext *s_DriverContext = null;
+/* 本帧 ImGui 会采样的 render graph 资源 */
+static Vector<VkRenderGraphResource> s_SampledResources;
 GedUI *_GECTX = null;
 
 #define CASE_DEBUG_WATCH_TABLE_COLUMN(fmt, ...) \
@@ -90,6 +94,7 @@ void GedUI::InitGameEditorContext(const Window *window, VulkanContext *context)
     // Setup Platform/Renderer backends
     ImGui_ImplGlfw_InitForVulkan(window->GetWindowPointer(), true);
 
+    s_DriverContext = context;
     context->GetApplicationContext(&s_DriverApplicationContext);
     ImGui_ImplVulkan_InitInfo init_info = {};
     init_info.Instance = s_DriverApplicationContext->Instance;
@@ -97,7 +102,7 @@ void GedUI::InitGameEditorContext(const Window *window, VulkanContext *context)
     init_info.Device = s_DriverApplicationContext->Device;
     init_info.QueueFamily = s_DriverApplicationContext->GraphicsQueueFamily;
     init_info.Queue = s_DriverApplicationContext->GraphicsQueue;
-    init_info.PipelineCache = VK_NULL_HANDLE;
+    init_info.PipelineCache = s_DriverApplicationContext->PipelineCache;
     init_info.DescriptorPool = s_DriverApplicationContext->DescriptorPool;
     init_info.Subpass = 0;
     init_info.MinImageCount = s_DriverApplicationContext->MinImageCount;
@@ -105,7 +110,10 @@ void GedUI::InitGameEditorContext(const Window *window, VulkanContext *context)
     init_info.MSAASamples = VK_SAMPLE_COUNT_1_BIT;
     init_info.Allocator = VK_NULL_HANDLE;
     init_info.CheckVkResultFn = VK_NULL_HANDLE;
+    /* ImGui 的管线也计入启动时的管线创建耗时 */
+    timestamp64_t pipelineCreateStart = System::GetTimeNanos();
     ImGui_ImplVulkan_Init(&init_info, s_DriverApplicationContext->RenderPass);
+    context->GetPipelineCacheStats().createMicros += (System::GetTimeNanos() - pipelineCreateStart) / 1000;
 }
 
 void GedUI::BeginGameEditorFrame() {
@@ -113,6 +121,7 @@ void GedUI::BeginGameEditorFrame() {
     ImGui_ImplVulkan_NewFrame();
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
+    s_SampledResources.clear();
 
     // docking
     ImGui::DockSpaceOverViewport(NULL, ImGuiDockNodeFlags_PassthruCentralNode);
@@ -121,10 +130,16 @@ void GedUI::BeginGameEditorFrame() {
 void GedUI::EndGameEditorFrame() {
     ImGuiIO& io = ImGui::GetIO(); (void)io;
 
-    // Rendering
+    // Rendering, recorded when the render graph executes the pass
     ImGui::Render();
     ImDrawData* main_draw_data = ImGui::GetDrawData();
-    ImGui_ImplVulkan_RenderDrawData(main_draw_data, s_DriverApplicationContext->FrameContext->commandBuffer);
+    VulkanRenderGraphPassBuilder builder = s_DriverContext->GetRenderGraph()->AddPass("GedUI", [main_draw_data](const VkRenderGraphPassContext &passContext) {
+        ImGui_ImplVulkan_RenderDrawData(main_draw_data, passContext.commandBuffer);
+    });
+    VkClearColorValue clearColor = {{0.0f, 0.0f, 0.0f, 1.0f}};
+    builder.WriteColor(s_DriverApplicationContext->FrameContext->backbuffer, &clearColor);
+    for (VkRenderGraphResource resource : s_SampledResources)
+        builder.Read(resource, VULKAN_RENDER_GRAPH_ACCESS_SAMPLED_FRAGMENT);
 
     // Update and Render additional Platform Windows
     if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
@@ -170,6 +185,7 @@ void GedUI::_ShowDebugWatchWindow() {
                     case VFLUX_DEBUGGER_WATCH_TYPE_STRING: CASE_DEBUG_WATCH_TABLE_COLUMN("%s", (char *) watch.value);
                     case VFLUX_DEBUGGER_WATCH_TYPE_INT: CASE_DEBUG_WATCH_TABLE_COLUMN("%d", *((int *) watch.value));
                     case VFLUX_DEBUGGER_WATCH_TYPE_UINT32: CASE_DEBUG_WATCH_TABLE_COLUMN("%u", *((uint32_t *) watch.value));
+                    case VFLUX_DEBUGGER_WATCH_TYPE_UINT64: CASE_DEBUG_WATCH_TABLE_COLUMN("%llu", (unsigned long long) *((uint64_t *) watch.value));
                     case VFLUX_DEBUGGER_WATCH_TYPE_FLOAT: CASE_DEBUG_WATCH_TABLE_COLUMN("%.2f", *((float *) watch.value));
                     case VFLUX_DEBUGGER_WATCH_TYPE_DOUBLE: CASE_DEBUG_WATCH_TABLE_COLUMN("%.2lf", *((double *) watch.value));
                     case VFLUX_DEBUGGER_WATCH_TYPE_FLOAT2: CASE_DEBUG_WATCH_TABLE_COLUMN("(%.2f, %.2f)", ((float *) watch.value)[0], ((float *) watch.value)[1]);
@@ -303,7 +319,7 @@ void GedUI::EndNewFrame() {
 }
 
 ImTextureID GedUI::AddTexture2D(VkTexture2D &texture) {
-    return (ImTextureID) ImGui_ImplVulkan_AddTexture(texture.sampler, texture.imageView, texture.layout);
+    return (ImTextureID) ImGui_ImplVulkan_AddTexture(texture.sampler, texture.imageView, texture.mipLayouts[0]);
 }
 
 void GedUI::RemoveTexture2D(const ImTextureID &texture) {
@@ -322,6 +338,11 @@ void GedUI::Image(const ImTextureID &texture, const ImVec2 &size) {
     ImGui::Image(texture, size);
 }
 
+void GedUI::Image(const ImTextureID &texture, VkRenderGraphResource resource, const ImVec2 &size) {
+    s_SampledResources.push_back(resource);
+    ImGui::Image(texture, size);
+}
+
 void GedUI::BeginViewport(const char *name) {
     ImGui::PushStyleVar(ImGuiStyleVar_WindowPadding, ImVec2(0, 0));
     ImGui::Begin(name);
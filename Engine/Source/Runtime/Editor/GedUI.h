@@ -49,6 +49,8 @@ public:
     static ImVec2 GetWindowSize();
     static void Image(const ImTextureID &texture);
     static void Image(const ImTextureID &texture, const ImVec2 &size);
+    /* texture produced by a render graph pass this frame (RTT viewport) */
+    static void Image(const ImTextureID &texture, VkRenderGraphResource resource, const ImVec2 &size);
     static void BeginViewport(const char *name);
     static void EndViewport();
 
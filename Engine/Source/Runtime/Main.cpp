@@ -25,12 +25,764 @@
 */
 #include "Window/Window.h"
 #include "Render/Drivers/Vulkan/VulkanContext.h"
+#include "Render/Drivers/Vulkan/VulkanInstanceBatcher.h"
+#include "Render/Culling/FrustumCulling.h"
+#include "Render/Model/GameModel.h"
+#include "Render/Model/TransformHierarchy.h"
+#include "Utils/ThreadPool.h"
 #include <System.h>
 #include "Editor/GedUI.h"
+#include "Utils/ModelLoader.h"
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <random>
+
+/* 生成一个网格 OBJ，每个格子约 230 字节（v/vt/vn 与两个三角形） */
+static void GenerateBenchmarkObj(const String &path, size_t targetBytes) {
+    std::ofstream file(path, std::ios::binary);
+    String buffer;
+    char number[32];
+
+    auto flush = [&](bool force) {
+        if (force || std::size(buffer) > (1 << 20)) {
+            file.write(std::data(buffer), std::size(buffer));
+            buffer.clear();
+        }
+    };
+
+    auto put_float = [&](float value) {
+        auto result = std::to_chars(number, number + sizeof(number), value, std::chars_format::fixed, 6);
+        buffer.push_back(' ');
+        buffer.append(number, result.ptr);
+    };
+
+    auto put_index = [&](uint32_t value) {
+        auto result = std::to_chars(number, number + sizeof(number), value);
+        buffer.push_back(' ');
+        buffer.append(number, result.ptr);
+        for (int i = 0; i < 2; i++) {
+            buffer.push_back('/');
+            buffer.append(number, result.ptr);
+        }
+    };
+
+    uint32_t side = static_cast<uint32_t>(std::sqrt(targetBytes / 230.0)) + 2;
+    buffer += "o Grid\n";
+
+    for (uint32_t y = 0; y < side; y++) {
+        for (uint32_t x = 0; x < side; x++) {
+            float fx = x * 0.01f, fy = y * 0.01f;
+            buffer += "v";
+            put_float(fx); put_float(std::sin(fx + fy)); put_float(fy);
+            buffer += "\nvt";
+            put_float(x / (float) side); put_float(y / (float) side);
+            buffer += "\nvn";
+            put_float(0.0f); put_float(1.0f); put_float(0.0f);
+            buffer += "\n";
+            flush(false);
+        }
+    }
+
+    for (uint32_t y = 0; y + 1 < side; y++) {
+        for (uint32_t x = 0; x + 1 < side; x++) {
+            uint32_t a = y * side + x + 1, b = a + 1, c = a + side, d = c + 1;
+            buffer += "f"; put_index(a); put_index(b); put_index(d); buffer += "\n";
+            buffer += "f"; put_index(a); put_index(d); put_index(c); buffer += "\n";
+            flush(false);
+        }
+    }
+
+    flush(true);
+}
+
+/* --benchmark-obj [sizeMB]：测试 OBJ 加载吞吐量 */
+static int RunObjLoaderBenchmark(size_t megabytes) {
+    const String path = "vectraflux-benchmark.obj";
+    GenerateBenchmarkObj(path, megabytes << 20);
+
+    for (int i = 0; i < 3; i++) {
+        ObjModel model;
+        ObjLoadStats stats;
+        Loader::LoadObj(path, &model, &stats);
+        System::ConsoleWrite("benchmark.obj: {:.1f} MB in {:.1f} ms ({:.1f} MB/s), parse {:.1f} ms, index {:.1f} ms, {} chunks, {} vertices, {} indices",
+                             stats.fileBytes / (1024.0 * 1024.0), stats.totalMicros / 1000.0,
+                             (stats.fileBytes / (1024.0 * 1024.0)) / (stats.totalMicros / 1000000.0),
+                             stats.parseMicros / 1000.0, stats.indexMicros / 1000.0, stats.chunkCount,
+                             std::size(model.vertices), std::size(model.indices));
+    }
+
+    /* 按文件顺序的网格 vs 优化后的顺序 */
+    {
+        ObjModel model;
+        Loader::LoadObj(path, &model);
+        MeshOptimizeStats optimizeStats;
+        MeshOptimizer::Optimize(&model, &optimizeStats);
+        System::ConsoleWrite("benchmark.obj optimize: {:.1f} ms, ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}, {} -> {} vertices, {} indices",
+                             optimizeStats.micros / 1000.0, optimizeStats.before.acmr, optimizeStats.after.acmr,
+                             optimizeStats.before.atvr, optimizeStats.after.atvr, optimizeStats.vertexCountBefore,
+                             optimizeStats.vertexCountAfter, optimizeStats.indices16 ? "16-bit" : "32-bit");
+    }
+
+    std::remove(path.c_str());
+
+    ObjModel model;
+    ObjLoadStats stats;
+    Loader::LoadObj("../Engine/Assets/Models/nanosuit/nanosuit.obj", &model, &stats);
+    System::ConsoleWrite("nanosuit.obj: {:.2f} ms, {} vertices, {} indices, {} submeshes, {} materials",
+                         stats.totalMicros / 1000.0, std::size(model.vertices), std::size(model.indices),
+                         std::size(model.submeshes), std::size(model.materials));
+
+    /* 冷启动：删掉缓存后加载（OBJ + 写缓存），热启动：直接映射缓存 */
+    const String nanosuit = "../Engine/Assets/Models/nanosuit/nanosuit.obj";
+    std::filesystem::remove(Loader::GetMeshCachePath(nanosuit));
+    for (int i = 0; i < 4; i++) {
+        MeshCache mesh;
+        MeshCacheStats cacheStats;
+        Loader::LoadMesh(nanosuit, &mesh, &cacheStats);
+        System::ConsoleWrite("nanosuit {}: {:.3f} ms (lookup {:.3f} ms, obj {:.3f} ms, write {:.3f} ms), {} vertices ({} bytes each, {} in the position stream), {} indices",
+                             cacheStats.hit ? "warm" : "cold", cacheStats.totalMicros / 1000.0, cacheStats.lookupMicros / 1000.0,
+                             cacheStats.objMicros / 1000.0, cacheStats.writeMicros / 1000.0, mesh.GetVertexCount(),
+                             mesh.GetVertexLayout().GetVertexSize(), mesh.GetVertexLayout().strides[VERTEX_STREAM_POSITION], mesh.GetIndexCount());
+        if (!cacheStats.hit) {
+            System::ConsoleWrite("nanosuit optimize: {:.3f} ms, ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}, {}-bit indices",
+                                 cacheStats.optimizeMicros / 1000.0, cacheStats.optimize.before.acmr, cacheStats.optimize.after.acmr,
+                                 cacheStats.optimize.before.atvr, cacheStats.optimize.after.atvr, mesh.GetIndexSize() * 8);
+        }
+    }
+
+    return 0;
+}
+
+/* GPU benchmark 共用的窗口和设备 */
+struct BenchmarkContext {
+    Window window { "VectrafluxEngine", 1280, 720 };
+    std::unique_ptr<VulkanContext> p_vctx;
+    VkApplicationContext *appContext = null;
+
+    BenchmarkContext() : p_vctx(std::make_unique<VulkanContext>(&window)) {
+        window.SetWindowHintVisible(true);
+        p_vctx->GetApplicationContext(&appContext);
+    }
+};
+
+/* frameCount 是实际测量的帧数，窗口提前关闭时少于请求的帧数 */
+struct BenchmarkFrameStats {
+    uint32_t frameCount = 0;
+    timestamp64_t frameNanos = 0;
+
+    /* 累计的纳秒数换算成每帧毫秒 */
+    double GetMillis(timestamp64_t nanos) const { return frameCount != 0 ? nanos / 1000000.0 / frameCount : 0.0; }
+};
+
+/* 先跑 10 帧预热再测 measureFrames 帧，record(frameContext, measured) 往 render graph 里加 pass。
+ * pass 在 EndGraphicsRender 里才执行，pass 回调要按值捕获 measured */
+template<typename Fn>
+static BenchmarkFrameStats RunBenchmarkFrames(BenchmarkContext &context, uint32_t measureFrames, Fn &&record) {
+    const uint32_t warmupFrames = 10;
+    BenchmarkFrameStats stats;
+    for (uint32_t frame = 0; frame < warmupFrames + measureFrames && !context.window.is_close(); frame++) {
+        bool measured = frame >= warmupFrames;
+        timestamp64_t frameStart = System::GetTimeNanos();
+
+        VkGraphicsFrameContext *frameContext;
+        context.p_vctx->BeginGraphicsRender(&frameContext);
+        record(frameContext, measured);
+        context.p_vctx->EndGraphicsRender();
+        Window::PollEvents();
+
+        if (measured) {
+            stats.frameNanos += System::GetTimeNanos() - frameStart;
+            stats.frameCount++;
+        }
+    }
+    return stats;
+}
+
+/* benchmark 场景共用的单位立方体 */
+static const Vertex s_CubeVertices[8] = {
+    {{-0.5f, -0.5f, -0.5f}, {0.9f, 0.2f, 0.2f}, {0.0f, 0.0f}}, {{0.5f, -0.5f, -0.5f}, {0.2f, 0.9f, 0.2f}, {1.0f, 0.0f}},
+    {{0.5f,  0.5f, -0.5f}, {0.2f, 0.2f, 0.9f}, {1.0f, 1.0f}}, {{-0.5f,  0.5f, -0.5f}, {0.9f, 0.9f, 0.2f}, {0.0f, 1.0f}},
+    {{-0.5f, -0.5f,  0.5f}, {0.9f, 0.2f, 0.9f}, {0.0f, 0.0f}}, {{0.5f, -0.5f,  0.5f}, {0.2f, 0.9f, 0.9f}, {1.0f, 0.0f}},
+    {{0.5f,  0.5f,  0.5f}, {0.9f, 0.9f, 0.9f}, {1.0f, 1.0f}}, {{-0.5f,  0.5f,  0.5f}, {0.4f, 0.4f, 0.4f}, {0.0f, 1.0f}},
+};
+static const uint16_t s_CubeIndices[36] = {
+    0, 2, 1, 0, 3, 2, 4, 5, 6, 4, 6, 7, 0, 1, 5, 0, 5, 4,
+    3, 6, 2, 3, 7, 6, 0, 4, 7, 0, 7, 3, 1, 2, 6, 1, 6, 5,
+};
+
+/* --benchmark-indirect [objects]：逐物体 DrawIndexed 与 GPU 剔除 + indirect 绘制的 CPU 提交耗时对比 */
+static int RunIndirectDrawBenchmark(uint32_t objectCount) {
+    BenchmarkContext context;
+    VulkanContext *p_vctx = context.p_vctx.get();
+    VkApplicationContext *appContext = context.appContext;
+
+    //
+    // 场景：同一个立方体铺成网格，每个物体一个矩阵
+    //
+    VertexLayout layout = VertexLayout::CreateFloat();
+    const void *streams[] = { s_CubeVertices };
+    VkVertexStreamBuffer vertexBuffer;
+    VkDeviceBuffer indexBuffer;
+    p_vctx->AllocateVertexBuffer(layout, 8, streams, &vertexBuffer);
+    p_vctx->AllocateIndexBuffer(sizeof(s_CubeIndices), s_CubeIndices, &indexBuffer);
+
+    uint32_t side = std::max(1u, (uint32_t) std::ceil(std::sqrt((double) objectCount)));
+    float extent = side * 3.0f;
+    Vector<glm::mat4> transforms(objectCount);
+    Vector<VkIndirectDrawObject> objects(objectCount);
+    for (uint32_t i = 0; i < objectCount; i++) {
+        glm::vec3 position((i % side) * 3.0f - extent * 0.5f, 0.0f, (i / side) * 3.0f - extent * 0.5f);
+        transforms[i] = glm::translate(glm::mat4(1.0f), position);
+        /* 单位立方体的外接球 */
+        objects[i] = { glm::vec4(position, 0.8661f), 36, 0, 0, i };
+    }
+
+    VkDeviceBuffer transformBuffer;
+    p_vctx->AllocateBuffer(std::max<VkDeviceSize>(objectCount, 1) * sizeof(glm::mat4), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &transformBuffer);
+    if (objectCount != 0)
+        p_vctx->UploadBuffer(transformBuffer, 0, objectCount * sizeof(glm::mat4), std::data(transforms));
+
+    bool indirectSupported = p_vctx->IsIndirectDrawSupported();
+    VkIndirectDrawList drawList = {};
+    if (indirectSupported)
+        p_vctx->CreateIndirectDrawList(objectCount, std::data(objects), &drawList);
+    p_vctx->FlushUploads();
+
+    //
+    // 管线：set 0 是矩阵数组，push constant 是 viewProjection
+    //
+    Vector<VkDescriptorSetLayoutBinding> bindings(1);
+    bindings[0] = { 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, null };
+    VkDescriptorSetLayout setLayout;
+    p_vctx->CreateDescriptorSetLayout(bindings, 0, &setLayout);
+    Vector<VkDescriptorSetLayout> setLayouts = { setLayout };
+    VkDescriptorSet descriptorSet;
+    p_vctx->AllocateDescriptorSet(setLayouts, &descriptorSet);
+
+    VkDescriptorBufferInfo bufferInfo = { transformBuffer.buffer, 0, VK_WHOLE_SIZE };
+    VkWriteDescriptorSet write = {};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = descriptorSet;
+    write.dstBinding = 0;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    write.pBufferInfo = &bufferInfo;
+    vkUpdateDescriptorSets(appContext->Device, 1, &write, 0, null);
+
+    VkPipelineDesc pipelineDesc;
+    p_vctx->CreatePipelineDesc(ENGINE_CONFIG_SHADER_FOLDER, "indirect_shader", appContext->RenderPass, setLayout, layout, &pipelineDesc);
+    pipelineDesc.pushConstantSize = sizeof(glm::mat4);
+    pipelineDesc.blendEnable = VK_FALSE;
+    VkRenderPipeline pipeline;
+    p_vctx->CreateRenderPipeline(pipelineDesc, &pipeline);
+
+    /* 从网格一角斜看过去，大约一半的物体在视锥外 */
+    glm::mat4 view = glm::lookAt(glm::vec3(-extent * 0.5f, extent * 0.15f, -extent * 0.5f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 1280.0f / 720.0f, 0.1f, extent * 2.0f);
+    projection[1][1] *= -1.0f;
+    glm::mat4 viewProjection = projection * view;
+
+    const uint32_t measureFrames = 200;
+    const char *modeNames[] = { "per-draw DrawIndexed", indirectSupported && drawList.compact ? "gpu cull + DrawIndexedIndirectCount"
+                                                                                              : "gpu cull + DrawIndexedIndirect" };
+    for (int mode = 0; mode < (indirectSupported ? 2 : 1); mode++) {
+        bool indirect = mode == 1;
+        timestamp64_t recordNanos = 0;
+
+        BenchmarkFrameStats frameStats = RunBenchmarkFrames(context, measureFrames, [&](VkGraphicsFrameContext *frameContext, bool measured) {
+            VulkanRenderGraph *graph = p_vctx->GetRenderGraph();
+            if (indirect) {
+                graph->AddPass("IndirectCull", [&, measured](const VkRenderGraphPassContext &passContext) {
+                    timestamp64_t start = System::GetTimeNanos();
+                    p_vctx->CullIndirectDrawList(passContext.commandBuffer, drawList, viewProjection);
+                    recordNanos += measured ? System::GetTimeNanos() - start : 0;
+                }).SetSideEffect();
+            }
+
+            VkClearColorValue clearColor = {{ 0.05f, 0.05f, 0.08f, 1.0f }};
+            graph->AddPass("IndirectScene", [&, measured](const VkRenderGraphPassContext &passContext) {
+                timestamp64_t start = System::GetTimeNanos();
+                VkCommandBuffer commandBuffer = passContext.commandBuffer;
+                p_vctx->BindRenderPipeline(commandBuffer, passContext.width, passContext.height, pipeline);
+                p_vctx->BindDescriptorSets(commandBuffer, pipeline, 1, &descriptorSet);
+                vkCmdPushConstants(commandBuffer, pipeline.pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                                   0, sizeof(glm::mat4), &viewProjection);
+                p_vctx->BindVertexBuffer(commandBuffer, vertexBuffer);
+                p_vctx->BindIndexBuffer(commandBuffer, indexBuffer, VK_INDEX_TYPE_UINT16);
+                if (indirect) {
+                    p_vctx->DrawIndexedIndirect(commandBuffer, drawList);
+                } else {
+                    /* 现有路径：CPU 不剔除，每个物体一次 draw call */
+                    for (uint32_t i = 0; i < objectCount; i++)
+                        p_vctx->DrawIndexed(commandBuffer, 36, 0, 0, i);
+                }
+                recordNanos += measured ? System::GetTimeNanos() - start : 0;
+            }).WriteColor(frameContext->backbuffer, &clearColor);
+        });
+
+        System::ConsoleWrite("{}: {} objects, {} frames, record {:.3f} ms/frame, frame {:.3f} ms", modeNames[mode], objectCount,
+                             frameStats.frameCount, frameStats.GetMillis(recordNanos), frameStats.GetMillis(frameStats.frameNanos));
+    }
+
+    if (!indirectSupported)
+        System::ConsoleWrite("indirect draw unsupported (drawIndirectFirstInstance), only the per-draw path was measured");
+
+    p_vctx->DeviceWaitIdle();
+    if (indirectSupported)
+        p_vctx->DestroyIndirectDrawList(drawList);
+    p_vctx->DestroyDescriptorSetLayout(setLayout);
+    p_vctx->FreeBuffer(transformBuffer);
+    p_vctx->FreeBuffer(indexBuffer);
+    p_vctx->FreeBuffer(vertexBuffer.buffer);
+    return 0;
+}
+
+/* --benchmark-instancing [instances]：每帧重新提交所有实例，按 mesh + 材质合批 vs 每个实例一次 draw call */
+static int RunInstancingBenchmark(uint32_t instanceCount) {
+    BenchmarkContext context;
+    VulkanContext *p_vctx = context.p_vctx.get();
+    VkApplicationContext *appContext = context.appContext;
+
+    if (!p_vctx->IsBindlessSupported()) {
+        System::ConsoleWrite("instanced_shader needs bindless textures, not supported by this device");
+        return 1;
+    }
+
+    VertexLayout layout = VertexLayout::CreateFloat();
+    const void *streams[] = { s_CubeVertices };
+    VkVertexStreamBuffer vertexBuffer;
+    VkDeviceBuffer indexBuffer;
+    p_vctx->AllocateVertexBuffer(layout, 8, streams, &vertexBuffer);
+    p_vctx->AllocateIndexBuffer(sizeof(s_CubeIndices), s_CubeIndices, &indexBuffer);
+    p_vctx->FlushUploads();
+
+    /* 一半实例采样 bindless 表里的真实纹理，另一半只用颜色 */
+    VkTexture2D texture;
+    p_vctx->CreateTexture2D("../Engine/Assets/Models/nanosuit/body_dif.png", &texture);
+
+    /* 两个 mesh 共用同一组 buffer：整个立方体和只有前两个面的面片 */
+    std::unique_ptr<VulkanInstanceBatcher> batcher = std::make_unique<VulkanInstanceBatcher>(p_vctx);
+    VkMeshHandle meshes[2];
+    meshes[0] = batcher->AddMesh({ vertexBuffer, indexBuffer, VK_INDEX_TYPE_UINT16, 36, 0, 0 });
+    meshes[1] = batcher->AddMesh({ vertexBuffer, indexBuffer, VK_INDEX_TYPE_UINT16, 12, 0, 0 });
+
+    uint32_t side = std::max(1u, (uint32_t) std::ceil(std::sqrt((double) instanceCount)));
+    float extent = side * 1.5f;
+    Vector<glm::mat4> transforms(instanceCount);
+    Vector<glm::vec4> colors(instanceCount);
+    for (uint32_t i = 0; i < instanceCount; i++) {
+        glm::vec3 position((i % side) * 1.5f - extent * 0.5f, 0.0f, (i / side) * 1.5f - extent * 0.5f);
+        transforms[i] = glm::translate(glm::mat4(1.0f), position);
+        colors[i] = glm::vec4((i % 7) / 7.0f, (i % 11) / 11.0f, 1.0f, 1.0f);
+    }
+
+    VkPipelineDesc pipelineDesc;
+    p_vctx->CreatePipelineDesc(ENGINE_CONFIG_SHADER_FOLDER, "instanced_shader", appContext->RenderPass, batcher->GetSetLayout(), layout, &pipelineDesc);
+    pipelineDesc.bindlessSetLayout = p_vctx->GetBindlessDescriptorSetLayout();
+    pipelineDesc.pushConstantSize = sizeof(glm::mat4);
+    pipelineDesc.blendEnable = VK_FALSE;
+    VkRenderPipeline pipeline;
+    p_vctx->CreateRenderPipeline(pipelineDesc, &pipeline);
+
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, extent * 0.6f, -extent * 0.6f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), 1280.0f / 720.0f, 0.1f, extent * 2.0f);
+    projection[1][1] *= -1.0f;
+    glm::mat4 viewProjection = projection * view;
+
+    const uint32_t measureFrames = 100;
+    for (int mode = 0; mode < 2; mode++) {
+        bool instanced = mode == 1;
+        timestamp64_t submitNanos = 0, buildNanos = 0, recordNanos = 0;
+
+        BenchmarkFrameStats frameStats = RunBenchmarkFrames(context, measureFrames, [&](VkGraphicsFrameContext *frameContext, bool measured) {
+            /* mesh 和材质交替提交，由 batcher 合成四个批次 */
+            timestamp64_t start = System::GetTimeNanos();
+            for (uint32_t i = 0; i < instanceCount; i++)
+                batcher->Submit(meshes[i & 1], (i & 2) ? texture.bindlessIndex : VULKAN_BINDLESS_INVALID_INDEX, transforms[i], colors[i]);
+            timestamp64_t submitted = System::GetTimeNanos();
+            batcher->Build();
+            if (measured) {
+                submitNanos += submitted - start;
+                buildNanos += System::GetTimeNanos() - submitted;
+            }
+
+            VkClearColorValue clearColor = {{ 0.05f, 0.05f, 0.08f, 1.0f }};
+            p_vctx->GetRenderGraph()->AddPass("InstancedScene", [&, measured](const VkRenderGraphPassContext &passContext) {
+                timestamp64_t start = System::GetTimeNanos();
+                VkCommandBuffer commandBuffer = passContext.commandBuffer;
+                p_vctx->BindRenderPipeline(commandBuffer, passContext.width, passContext.height, pipeline);
+                p_vctx->BindBindlessDescriptorSet(commandBuffer, pipeline);
+                vkCmdPushConstants(commandBuffer, pipeline.pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                                   0, sizeof(glm::mat4), &viewProjection);
+                batcher->Draw(commandBuffer, pipeline, instanced);
+                recordNanos += measured ? System::GetTimeNanos() - start : 0;
+            }).WriteColor(frameContext->backbuffer, &clearColor);
+        });
+
+        const VkInstanceBatchStats &stats = batcher->GetStats();
+        System::ConsoleWrite("{}: {} instances in {} batches, {} frames, submit {:.3f} ms, build {:.3f} ms ({:.1f} MB), record {:.3f} ms, frame {:.3f} ms",
+                             instanced ? "instanced" : "per-instance draws", stats.instanceCount, stats.batchCount, frameStats.frameCount,
+                             frameStats.GetMillis(submitNanos), frameStats.GetMillis(buildNanos), stats.instanceBytes / (1024.0 * 1024.0),
+                             frameStats.GetMillis(recordNanos), frameStats.GetMillis(frameStats.frameNanos));
+    }
+
+    p_vctx->DeviceWaitIdle();
+    batcher.reset();
+    p_vctx->DestroyTexture2D(texture);
+    p_vctx->FreeBuffer(indexBuffer);
+    p_vctx->FreeBuffer(vertexBuffer.buffer);
+    return 0;
+}
+
+/* quantized_shader / depth_only 的 UBO，normal 在 CPU 上算好，着色器里不再逐顶点求逆 */
+struct MeshUniformBuffer {
+    glm::mat4 m; /* model * VertexQuantization::GetMatrix() */
+    glm::mat4 v;
+    glm::mat4 p;
+    glm::mat4 normal; /* transpose(inverse(model))，不含量化矩阵 */
+};
+
+/* --benchmark-mesh [frames]：从网格缓存加载 nanosuit，直接上传量化后的顶点流，用 quantized_shader 绘制，
+ * 再对比先用 depth_only 只读位置流画一遍预深度的耗时 */
+static int RunMeshCacheDrawBenchmark(uint32_t measureFrames) {
+    BenchmarkContext context;
+    VulkanContext *p_vctx = context.p_vctx.get();
+    VkApplicationContext *appContext = context.appContext;
+
+    MeshCache mesh;
+    Loader::LoadMesh("../Engine/Assets/Models/nanosuit/nanosuit.obj", &mesh);
+    const VertexLayout &layout = mesh.GetVertexLayout();
+    if (!layout.Has(VERTEX_ATTRIBUTE_NORMAL)) {
+        System::ConsoleWrite("quantized_shader needs normals, nanosuit.obj has none");
+        return 1;
+    }
+
+    VkVertexStreamBuffer vertexBuffer;
+    VkDeviceBuffer indexBuffer;
+    p_vctx->AllocateVertexBuffer(layout, mesh.GetVertexCount(), mesh.GetVertexStreams(), &vertexBuffer);
+    VkIndexType indexType = mesh.GetIndexSize() == sizeof(uint16_t) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+    if (indexType == VK_INDEX_TYPE_UINT16)
+        p_vctx->AllocateIndexBuffer(mesh.GetIndexCount() * sizeof(uint16_t), static_cast<const uint16_t *>(mesh.GetIndices()), &indexBuffer);
+    else
+        p_vctx->AllocateIndexBuffer(mesh.GetIndexCount() * sizeof(uint32_t), static_cast<const uint32_t *>(mesh.GetIndices()), &indexBuffer);
+
+    /* 相机正对包围盒中心，整个模型都在画面内 */
+    glm::vec3 center = (mesh.GetBoundsMin() + mesh.GetBoundsMax()) * 0.5f;
+    float radius = glm::length(mesh.GetBoundsMax() - mesh.GetBoundsMin()) * 0.5f;
+    glm::mat4 model(1.0f);
+    MeshUniformBuffer uniforms;
+    uniforms.m = model * mesh.GetQuantization().GetMatrix();
+    uniforms.v = glm::lookAt(center + glm::vec3(0.0f, 0.0f, radius * 2.0f), center, glm::vec3(0.0f, 1.0f, 0.0f));
+    uniforms.p = glm::perspective(glm::radians(45.0f), 1280.0f / 720.0f, radius * 0.1f, radius * 4.0f);
+    uniforms.p[1][1] *= -1.0f;
+    uniforms.normal = glm::transpose(glm::inverse(model));
+
+    VkDeviceBuffer uniformBuffer;
+    p_vctx->AllocateBuffer(sizeof(MeshUniformBuffer), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                           VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &uniformBuffer);
+    p_vctx->UploadBuffer(uniformBuffer, 0, sizeof(MeshUniformBuffer), &uniforms);
+    p_vctx->FlushUploads();
+
+    Vector<VkDescriptorSetLayoutBinding> bindings(1);
+    bindings[0] = { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, null };
+    VkDescriptorSetLayout setLayout;
+    p_vctx->CreateDescriptorSetLayout(bindings, 0, &setLayout);
+    Vector<VkDescriptorSetLayout> setLayouts = { setLayout };
+    VkDescriptorSet descriptorSet;
+    p_vctx->AllocateDescriptorSet(setLayouts, &descriptorSet);
+
+    VkDescriptorBufferInfo bufferInfo = { uniformBuffer.buffer, 0, sizeof(MeshUniformBuffer) };
+    VkWriteDescriptorSet write = {};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = descriptorSet;
+    write.dstBinding = 0;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    write.pBufferInfo = &bufferInfo;
+    vkUpdateDescriptorSets(appContext->Device, 1, &write, 0, null);
+
+    /* 场景 pass 带深度附件，render pass 由 render graph 创建，管线在第一次执行 pass 时再建 */
+    VkPipelineDesc sceneDesc;
+    p_vctx->CreatePipelineDesc(ENGINE_CONFIG_SHADER_FOLDER, "quantized_shader", VK_NULL_HANDLE, setLayout, layout, &sceneDesc);
+    sceneDesc.blendEnable = VK_FALSE;
+    sceneDesc.depthTestEnable = VK_TRUE;
+    sceneDesc.depthWriteEnable = VK_TRUE;
+    /* 投影 y 翻转之后 OBJ 的逆时针三角形在屏幕上是顺时针 */
+    sceneDesc.frontFace = VK_FRONT_FACE_CLOCKWISE;
+
+    /* 预深度之后场景 pass 只着色最前面的片元，两个着色器的 gl_Position 都是 invariant */
+    VkPipelineDesc sceneEqualDesc = sceneDesc;
+    sceneEqualDesc.depthWriteEnable = VK_FALSE;
+    sceneEqualDesc.depthCompareOp = VK_COMPARE_OP_EQUAL;
+
+    /* 预深度只绑定位置流 (流 0)，没有颜色附件 */
+    VkPipelineDesc prepassDesc;
+    p_vctx->CreatePipelineDesc(ENGINE_CONFIG_SHADER_FOLDER, "depth_only", VK_NULL_HANDLE, setLayout, layout.GetPositionOnly(), &prepassDesc);
+    prepassDesc.colorAttachmentCount = 0;
+    prepassDesc.depthTestEnable = VK_TRUE;
+    prepassDesc.depthWriteEnable = VK_TRUE;
+    prepassDesc.frontFace = VK_FRONT_FACE_CLOCKWISE;
+
+    VkRenderPipeline scenePipeline = {}, sceneEqualPipeline = {}, prepassPipeline = {};
+    auto AcquirePipeline = [&](VkPipelineDesc &desc, VkRenderPipeline &pipeline, VkRenderPass renderPass) {
+        if (pipeline.pipeline == VK_NULL_HANDLE) {
+            desc.renderPass = renderPass;
+            p_vctx->CreateRenderPipeline(desc, &pipeline);
+        }
+        return pipeline;
+    };
+
+    for (int mode = 0; mode < 2; mode++) {
+        bool prepass = mode == 1;
+        timestamp64_t recordNanos = 0;
+
+        BenchmarkFrameStats frameStats = RunBenchmarkFrames(context, measureFrames, [&](VkGraphicsFrameContext *frameContext, bool measured) {
+            VulkanRenderGraph *graph = p_vctx->GetRenderGraph();
+            VkRenderGraphResource depth = graph->CreateTexture("SceneDepth", { frameContext->width, frameContext->height, VK_FORMAT_D32_SFLOAT });
+
+            VkClearColorValue clearColor = {{ 0.05f, 0.05f, 0.08f, 1.0f }};
+            VkClearDepthStencilValue clearDepth = { 1.0f, 0 };
+            if (prepass) {
+                graph->AddPass("DepthPrepass", [&, measured](const VkRenderGraphPassContext &passContext) {
+                    timestamp64_t start = System::GetTimeNanos();
+                    VkCommandBuffer commandBuffer = passContext.commandBuffer;
+                    VkRenderPipeline pipeline = AcquirePipeline(prepassDesc, prepassPipeline, passContext.renderPass);
+                    p_vctx->BindRenderPipeline(commandBuffer, passContext.width, passContext.height, pipeline);
+                    p_vctx->BindDescriptorSets(commandBuffer, pipeline, 1, &descriptorSet);
+                    p_vctx->BindVertexBuffer(commandBuffer, vertexBuffer, 1);
+                    p_vctx->BindIndexBuffer(commandBuffer, indexBuffer, indexType);
+                    p_vctx->DrawIndexed(commandBuffer, mesh.GetIndexCount());
+                    recordNanos += measured ? System::GetTimeNanos() - start : 0;
+                }).WriteDepth(depth, &clearDepth);
+            }
+
+            graph->AddPass("MeshScene", [&, measured](const VkRenderGraphPassContext &passContext) {
+                timestamp64_t start = System::GetTimeNanos();
+                VkCommandBuffer commandBuffer = passContext.commandBuffer;
+                VkRenderPipeline pipeline = prepass ? AcquirePipeline(sceneEqualDesc, sceneEqualPipeline, passContext.renderPass)
+                                                    : AcquirePipeline(sceneDesc, scenePipeline, passContext.renderPass);
+                p_vctx->BindRenderPipeline(commandBuffer, passContext.width, passContext.height, pipeline);
+                p_vctx->BindDescriptorSets(commandBuffer, pipeline, 1, &descriptorSet);
+                p_vctx->BindVertexBuffer(commandBuffer, vertexBuffer);
+                p_vctx->BindIndexBuffer(commandBuffer, indexBuffer, indexType);
+                p_vctx->DrawIndexed(commandBuffer, mesh.GetIndexCount());
+                recordNanos += measured ? System::GetTimeNanos() - start : 0;
+            }).WriteColor(frameContext->backbuffer, &clearColor).WriteDepth(depth, prepass ? null : &clearDepth);
+        });
+
+        System::ConsoleWrite("nanosuit quantized{}: {} vertices ({} bytes each, {} in the position stream), {} indices, {} frames, record {:.3f} ms/frame, frame {:.3f} ms",
+                             prepass ? " + depth prepass" : "", mesh.GetVertexCount(), layout.GetVertexSize(), layout.strides[VERTEX_STREAM_POSITION],
+                             mesh.GetIndexCount(), frameStats.frameCount, frameStats.GetMillis(recordNanos), frameStats.GetMillis(frameStats.frameNanos));
+    }
+
+    p_vctx->DeviceWaitIdle();
+    p_vctx->FreeDescriptorSets(1, &descriptorSet);
+    p_vctx->DestroyDescriptorSetLayout(setLayout);
+    p_vctx->FreeBuffer(uniformBuffer);
+    p_vctx->FreeBuffer(indexBuffer);
+    p_vctx->FreeBuffer(vertexBuffer.buffer);
+    return 0;
+}
+
+/* --benchmark-culling [objects]：随机分布的包围球 / AABB 在各条 SIMD 路径上的剔除吞吐量，结果和标量路径逐个比对。
+ * 目标（AVX2 单线程）：包围球 >= 500000 objects/ms，AABB >= 250000 objects/ms */
+static int RunFrustumCullingBenchmark(uint32_t objectCount) {
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> position(-500.0f, 500.0f);
+    std::uniform_real_distribution<float> radius(0.5f, 5.0f);
+
+    BoundingSphereSoA spheres;
+    BoundingBoxSoA boxes;
+    for (uint32_t i = 0; i < objectCount; i++) {
+        glm::vec3 center(position(random), position(random), position(random));
+        float r = radius(random);
+        spheres.Add(center, r);
+        boxes.Add(center - glm::vec3(r), center + glm::vec3(r));
+    }
+
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 400.0f);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(1.0f, 0.2f, 0.3f), glm::vec3(0.0f, 1.0f, 0.0f));
+    Frustum frustum = Frustum::FromMatrix(projection * view);
+
+    FrustumCullingPath bestPath = FrustumCulling::GetPath();
+    Vector<uint32_t> expected[2], visible(objectCount);
+    for (int kind = 0; kind < 2; kind++) {
+        FrustumCulling::SetPath(FRUSTUM_CULLING_PATH_SCALAR);
+        expected[kind].resize(objectCount);
+        uint32_t count = kind == 0 ? FrustumCulling::CullSpheres(frustum, spheres, std::data(expected[kind]))
+                                   : FrustumCulling::CullBoxes(frustum, boxes, std::data(expected[kind]));
+        expected[kind].resize(count);
+    }
+
+    const int iterations = 20;
+    int mismatchCount = 0;
+    for (int path = FRUSTUM_CULLING_PATH_SCALAR; path <= bestPath; path++) {
+        FrustumCulling::SetPath((FrustumCullingPath) path);
+        for (int kind = 0; kind < 2; kind++) {
+            uint32_t count = 0;
+            timestamp64_t start = System::GetTimeNanos();
+            for (int i = 0; i < iterations; i++) {
+                count = kind == 0 ? FrustumCulling::CullSpheres(frustum, spheres, std::data(visible))
+                                  : FrustumCulling::CullBoxes(frustum, boxes, std::data(visible));
+            }
+            double ms = (System::GetTimeNanos() - start) / 1000000.0 / iterations;
+            bool match = count == std::size(expected[kind]) && std::equal(std::begin(expected[kind]), std::end(expected[kind]), std::begin(visible));
+            mismatchCount += match ? 0 : 1;
+            System::ConsoleWrite("cull {:<7} {:<7}: {} objects, {} visible, {:.3f} ms ({:.0f} objects/ms){}", FrustumCulling::GetPathName((FrustumCullingPath) path),
+                                 kind == 0 ? "spheres" : "boxes", objectCount, count, ms, objectCount / ms, match ? "" : " MISMATCH");
+        }
+    }
+
+    FrustumCulling::SetPath(bestPath);
+    /* SIMD 路径和标量路径的结果不一致时以非零退出，CI 据此判定失败 */
+    return mismatchCount != 0 ? 1 : 0;
+}
+
+struct BenchmarkVelocityComponent {
+    glm::vec3 value;
+};
+
+/* --benchmark-ecs [entities]：GameModel 的创建 / 遍历 / 销毁吞吐量 */
+static int RunGameModelBenchmark(uint32_t entityCount) {
+    GameModel model;
+    Vector<GameEntity> entities(entityCount);
+    auto throughput = [](uint32_t count, timestamp64_t nanos) { return count / (nanos / 1000000.0); };
+
+    timestamp64_t start = System::GetTimeNanos();
+    for (uint32_t i = 0; i < entityCount; i++) {
+        entities[i] = model.CreateEntity(TranslationComponent { glm::vec3((float) i, 0.0f, 0.0f) }, RotationComponent(),
+                                         BenchmarkVelocityComponent { glm::vec3(1.0f, 2.0f, 3.0f) });
+    }
+    timestamp64_t nanos = System::GetTimeNanos() - start;
+    System::ConsoleWrite("ecs create: {} entities in {:.2f} ms ({:.0f} entities/ms)", entityCount, nanos / 1000000.0, throughput(entityCount, nanos));
+
+    const int iterations = 10;
+    start = System::GetTimeNanos();
+    for (int i = 0; i < iterations; i++) {
+        model.ForEach<TranslationComponent, const BenchmarkVelocityComponent>([](TranslationComponent &translation, const BenchmarkVelocityComponent &velocity) {
+            translation.value += velocity.value * 0.016f;
+        });
+    }
+    nanos = (System::GetTimeNanos() - start) / iterations;
+    System::ConsoleWrite("ecs for each: {:.3f} ms ({:.0f} entities/ms)", nanos / 1000000.0, throughput(entityCount, nanos));
+
+    start = System::GetTimeNanos();
+    for (int i = 0; i < iterations; i++) {
+        model.ForEachChunk<TranslationComponent, const BenchmarkVelocityComponent>([](uint32_t count, const GameEntity *, TranslationComponent *translations,
+                                                                                      const BenchmarkVelocityComponent *velocities) {
+            for (uint32_t j = 0; j < count; j++)
+                translations[j].value += velocities[j].value * 0.016f;
+        });
+    }
+    nanos = (System::GetTimeNanos() - start) / iterations;
+    System::ConsoleWrite("ecs for each chunk: {:.3f} ms ({:.0f} entities/ms)", nanos / 1000000.0, throughput(entityCount, nanos));
+
+    /* 遍历中记录销毁，同步点统一执行 */
+    start = System::GetTimeNanos();
+    uint32_t destroyCount = 0;
+    model.ForEachChunk<const TranslationComponent>([&](uint32_t count, const GameEntity *pEntities, const TranslationComponent *) {
+        for (uint32_t j = 0; j < count; j += 2, destroyCount++)
+            model.GetCommandBuffer().DestroyEntity(pEntities[j]);
+    });
+    model.Flush();
+    nanos = System::GetTimeNanos() - start;
+    System::ConsoleWrite("ecs deferred destroy: {} entities in {:.2f} ms ({:.0f} entities/ms)", destroyCount, nanos / 1000000.0, throughput(destroyCount, nanos));
+
+    /* 复用空出来的句柄和 chunk */
+    start = System::GetTimeNanos();
+    for (uint32_t i = 0; i < destroyCount; i++)
+        model.CreateEntity(TranslationComponent(), RotationComponent(), BenchmarkVelocityComponent { glm::vec3(1.0f) });
+    nanos = System::GetTimeNanos() - start;
+    System::ConsoleWrite("ecs recreate: {} entities in {:.2f} ms ({:.0f} entities/ms)", destroyCount, nanos / 1000000.0, throughput(destroyCount, nanos));
+
+    Vector<GameEntity> aliveEntities;
+    aliveEntities.reserve(model.GetEntityCount());
+    model.ForEachChunk<>([&](uint32_t count, const GameEntity *pEntities) {
+        aliveEntities.insert(std::end(aliveEntities), pEntities, pEntities + count);
+    });
+
+    start = System::GetTimeNanos();
+    for (GameEntity entity : aliveEntities)
+        model.DestroyEntity(entity);
+    nanos = System::GetTimeNanos() - start;
+    System::ConsoleWrite("ecs destroy: {} entities in {:.2f} ms ({:.0f} entities/ms), {} left", std::size(aliveEntities), nanos / 1000000.0,
+                         throughput((uint32_t) std::size(aliveEntities), nanos), model.GetEntityCount());
+
+    return 0;
+}
+
+/* --benchmark-hierarchy [nodes]：四叉的场景树，一半的根是静态的，对比单线程 / 线程池下全部重算与局部重算 */
+static int RunTransformHierarchyBenchmark(uint32_t nodeCount) {
+    TransformHierarchy hierarchy;
+    Vector<TransformNode> nodes(nodeCount);
+    Vector<uint32_t> roots(nodeCount);
+
+    const uint32_t rootCount = std::min(nodeCount, 64u);
+    for (uint32_t i = 0; i < nodeCount; i++) {
+        uint32_t parentIndex = i < rootCount ? UINT32_MAX : (i - rootCount) / 4;
+        TransformNode parent = i < rootCount ? TRANSFORM_NODE_INVALID : nodes[parentIndex];
+        roots[i] = i < rootCount ? i : roots[parentIndex];
+        /* 偶数根的整棵子树都是静态的 */
+        bool isStatic = roots[i] % 2 == 0;
+        glm::mat4 local = glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(1.0f, 0.5f, 0.0f)), 0.01f * (i % 97), glm::vec3(0.0f, 1.0f, 0.0f));
+        nodes[i] = hierarchy.AddNode(parent, local, isStatic);
+    }
+
+    hierarchy.Update();
+    const TransformHierarchyStats &stats = hierarchy.GetStats();
+    System::ConsoleWrite("hierarchy: {} nodes, {} levels, {} static, first update {:.2f} ms (sort {:.2f} ms)", stats.nodeCount, stats.levelCount,
+                         stats.staticCount, stats.updateMicros / 1000.0, stats.rebuildMicros / 1000.0);
+
+    ThreadPool threadPool;
+    ThreadPool *pools[] = { null, &threadPool };
+    for (ThreadPool *pThreadPool : pools) {
+        const char *name = pThreadPool != null ? "thread pool" : "single thread";
+
+        /* 所有动态的根都动了，整棵非静态树重算。改静态节点会触发重新排序，这里不碰 */
+        for (uint32_t i = 1; i < rootCount; i += 2)
+            hierarchy.SetLocalTransform(nodes[i], hierarchy.GetLocalTransform(nodes[i]));
+        hierarchy.Update(pThreadPool);
+        System::ConsoleWrite("hierarchy {} ({} threads) full: {} updated in {:.3f} ms", name, pThreadPool != null ? pThreadPool->GetThreadCount() + 1 : 1,
+                             stats.updatedCount, stats.updateMicros / 1000.0);
+
+        /* 1% 的节点动了，只重算它们的子树 */
+        for (uint32_t i = 1; i < nodeCount; i += 100) {
+            if (roots[i] % 2 != 0)
+                hierarchy.SetLocalTransform(nodes[i], hierarchy.GetLocalTransform(nodes[i]));
+        }
+        hierarchy.Update(pThreadPool);
+        System::ConsoleWrite("hierarchy {} partial: {} updated in {:.3f} ms", name, stats.updatedCount, stats.updateMicros / 1000.0);
+
+        hierarchy.Update(pThreadPool);
+        System::ConsoleWrite("hierarchy {} unchanged: {:.3f} ms", name, stats.updateMicros / 1000.0);
+    }
+
+    return 0;
+}
 
 int main(int argc, const char **argv) {
     system("chcp 65001");
 
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--benchmark-obj") == 0)
+            return RunObjLoaderBenchmark(i + 1 < argc ? strtoull(argv[i + 1], null, 10) : 300);
+        if (strcmp(argv[i], "--benchmark-indirect") == 0)
+            return RunIndirectDrawBenchmark(i + 1 < argc ? strtoul(argv[i + 1], null, 10) : 10000);
+        if (strcmp(argv[i], "--benchmark-instancing") == 0)
+            return RunInstancingBenchmark(i + 1 < argc ? strtoul(argv[i + 1], null, 10) : 100000);
+        if (strcmp(argv[i], "--benchmark-mesh") == 0)
+            return RunMeshCacheDrawBenchmark(i + 1 < argc ? strtoul(argv[i + 1], null, 10) : 500);
+        if (strcmp(argv[i], "--benchmark-culling") == 0)
+            return RunFrustumCullingBenchmark(i + 1 < argc ? strtoul(argv[i + 1], null, 10) : 1000000);
+        if (strcmp(argv[i], "--benchmark-ecs") == 0)
+            return RunGameModelBenchmark(i + 1 < argc ? strtoul(argv[i + 1], null, 10) : 1000000);
+        if (strcmp(argv[i], "--benchmark-hierarchy") == 0)
+            return RunTransformHierarchyBenchmark(i + 1 < argc ? strtoul(argv[i + 1], null, 10) : 1000000);
+    }
+
     //
     // 初始化
     //
@@ -72,5 +824,6 @@ int main(int argc, const char **argv) {
     //
     // 资源释放
     //
+    p_vctx->DeviceWaitIdle();
     GedUI::Destroy();
 }
@@ -29,6 +29,7 @@
 #include <Typedef.h>
 // glm
 #include <Math.h>
+#include "Frustum.h"
 
 class Camera {
 public:
@@ -36,12 +37,35 @@ public:
     const glm::mat4 &GetViewMatrix() const { return m_ViewMatrix; };
     const glm::mat4 &GetProjectionMatrix() const { return m_ProjectionMatrix; };
 
+    // 视锥和 VP 矩阵在矩阵变化后第一次访问时重新计算
+    const glm::mat4 &GetViewProjectionMatrix() const { _UpdateFrustum(); return m_ViewProjectionMatrix; }
+    const Frustum &GetFrustum() const { _UpdateFrustum(); return m_Frustum; }
+
     // 更新摄像机数据，由子类实现
     virtual void UpdateCamera() = 0;
 
+protected:
+    // 子类通过这两个函数修改矩阵，直接写成员不会刷新视锥
+    void SetViewMatrix(const glm::mat4 &view) { m_ViewMatrix = view; m_FrustumDirty = true; }
+    void SetProjectionMatrix(const glm::mat4 &projection) { m_ProjectionMatrix = projection; m_FrustumDirty = true; }
+
 protected:
     glm::mat4 m_ViewMatrix;
     glm::mat4 m_ProjectionMatrix;
+
+private:
+    void _UpdateFrustum() const {
+        if (!m_FrustumDirty)
+            return;
+        m_ViewProjectionMatrix = m_ProjectionMatrix * m_ViewMatrix;
+        m_Frustum = Frustum::FromMatrix(m_ViewProjectionMatrix);
+        m_FrustumDirty = false;
+    }
+
+private:
+    mutable glm::mat4 m_ViewProjectionMatrix;
+    mutable Frustum m_Frustum;
+    mutable bool m_FrustumDirty = true;
 };
 
 #endif /* _VECTRAFLUX_ENGINE_CAMERA_H_ */
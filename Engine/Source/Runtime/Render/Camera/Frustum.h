@@ -0,0 +1,83 @@
+/* ************************************************************************
+ *
+ * Copyright (C) 2022 Vincent Luo All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, e1ither express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ************************************************************************/
+
+/* Creates on 2026/10/17. */
+
+/*
+  ===================================
+    @author bit-fashion
+  ===================================
+*/
+#ifndef _VECTRAFLUX_ENGINE_FRUSTUM_H_
+#define _VECTRAFLUX_ENGINE_FRUSTUM_H_
+
+// glm
+#include <Math.h>
+
+enum FrustumPlane {
+    FRUSTUM_PLANE_LEFT = 0,
+    FRUSTUM_PLANE_RIGHT,
+    FRUSTUM_PLANE_BOTTOM,
+    FRUSTUM_PLANE_TOP,
+    FRUSTUM_PLANE_NEAR,
+    FRUSTUM_PLANE_FAR,
+    FRUSTUM_PLANE_MAX_ENUM
+};
+
+/**
+ * Six normalized planes (xyz normal pointing inside, w distance), a point p
+ * is inside when dot(plane.xyz, p) + plane.w >= 0 for every plane.
+ */
+struct Frustum {
+    glm::vec4 planes[FRUSTUM_PLANE_MAX_ENUM];
+
+    /* Gribb-Hartmann，近平面按 [-w, w] 取，深度 [0, 1] 的投影只会更保守 */
+    static Frustum FromMatrix(const glm::mat4 &viewProjection) {
+        glm::mat4 m = glm::transpose(viewProjection);
+        Frustum frustum;
+        frustum.planes[FRUSTUM_PLANE_LEFT] = m[3] + m[0];
+        frustum.planes[FRUSTUM_PLANE_RIGHT] = m[3] - m[0];
+        frustum.planes[FRUSTUM_PLANE_BOTTOM] = m[3] + m[1];
+        frustum.planes[FRUSTUM_PLANE_TOP] = m[3] - m[1];
+        frustum.planes[FRUSTUM_PLANE_NEAR] = m[3] + m[2];
+        frustum.planes[FRUSTUM_PLANE_FAR] = m[3] - m[2];
+        for (auto &plane : frustum.planes)
+            plane /= glm::length(glm::vec3(plane));
+        return frustum;
+    }
+
+    bool IsSphereVisible(const glm::vec3 &center, float radius) const {
+        for (const auto &plane : planes) {
+            if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+                return false;
+        }
+        return true;
+    }
+
+    /* 只测离平面最远的那个角（p-vertex） */
+    bool IsBoxVisible(const glm::vec3 &min, const glm::vec3 &max) const {
+        for (const auto &plane : planes) {
+            glm::vec3 p(plane.x > 0.0f ? max.x : min.x, plane.y > 0.0f ? max.y : min.y, plane.z > 0.0f ? max.z : min.z);
+            if (glm::dot(glm::vec3(plane), p) + plane.w < 0.0f)
+                return false;
+        }
+        return true;
+    }
+};
+
+#endif /* _VECTRAFLUX_ENGINE_FRUSTUM_H_ */
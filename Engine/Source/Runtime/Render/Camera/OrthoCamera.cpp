@@ -26,8 +26,8 @@
 #include "OrthoCamera.h"
 
 OrthoCamera::OrthoCamera(float left, float right, float bottom, float top) {
-    m_ViewMatrix = glm::mat4(1.0f);
-    m_ProjectionMatrix = glm::ortho(left, right, bottom, top, -1.0f, 1.0f);
+    SetViewMatrix(glm::mat4(1.0f));
+    SetProjectionMatrix(glm::ortho(left, right, bottom, top, -1.0f, 1.0f));
 }
 
 void OrthoCamera::UpdateCamera() {
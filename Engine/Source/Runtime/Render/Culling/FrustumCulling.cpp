@@ -0,0 +1,324 @@
+/* ************************************************************************
+ *
+ * Copyright (C) 2022 Vincent Luo All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, e1ither express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ************************************************************************/
+
+/* Creates on 2026/10/17. */
+
+/*
+  ===================================
+    @author bit-fashion
+  ===================================
+*/
+#include "FrustumCulling.h"
+#include <array>
+#include <bit>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#  define FRUSTUM_CULLING_X86
+#  include <immintrin.h>
+#  if defined(_MSC_VER) && !defined(__clang__)
+#    include <intrin.h>
+#    define FRUSTUM_CULLING_TARGET_AVX2
+#  else
+#    define FRUSTUM_CULLING_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#  endif
+#endif
+
+
+/* p-vertex 取哪一侧只和平面法线有关，所有物体相同，按平面预先选好分量数组 */
+static void _SelectBoxComponents(const Frustum &frustum, const float *const min[3], const float *const max[3],
+                                 const float *pComponents[FRUSTUM_PLANE_MAX_ENUM][3]) {
+    for (int p = 0; p < FRUSTUM_PLANE_MAX_ENUM; p++) {
+        for (int axis = 0; axis < 3; axis++)
+            pComponents[p][axis] = frustum.planes[p][axis] > 0.0f ? max[axis] : min[axis];
+    }
+}
+
+//
+// Scalar
+//
+
+static uint32_t _CullSpheresScalar(const Frustum &frustum, const float *x, const float *y, const float *z, const float *radius,
+                                   uint32_t count, uint32_t *pVisible, uint32_t base = 0) {
+    uint32_t visibleCount = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        /* 不提前退出也不分支，先写下标再决定是否前进 */
+        bool visible = true;
+        for (const auto &plane : frustum.planes)
+            visible &= plane.x * x[i] + plane.y * y[i] + plane.z * z[i] + plane.w >= -radius[i];
+        pVisible[visibleCount] = base + i;
+        visibleCount += visible;
+    }
+    return visibleCount;
+}
+
+static uint32_t _CullBoxesScalar(const Frustum &frustum, const float *pComponents[FRUSTUM_PLANE_MAX_ENUM][3], uint32_t begin,
+                                 uint32_t count, uint32_t *pVisible) {
+    uint32_t visibleCount = 0;
+    for (uint32_t i = begin; i < count; i++) {
+        bool visible = true;
+        for (int p = 0; p < FRUSTUM_PLANE_MAX_ENUM; p++) {
+            const glm::vec4 &plane = frustum.planes[p];
+            visible &= plane.x * pComponents[p][0][i] + plane.y * pComponents[p][1][i] + plane.z * pComponents[p][2][i] + plane.w >= 0.0f;
+        }
+        pVisible[visibleCount] = i;
+        visibleCount += visible;
+    }
+    return visibleCount;
+}
+
+static uint32_t _CullBoxesScalar(const Frustum &frustum, const float *const min[3], const float *const max[3], uint32_t count,
+                                 uint32_t *pVisible) {
+    const float *pComponents[FRUSTUM_PLANE_MAX_ENUM][3];
+    _SelectBoxComponents(frustum, min, max, pComponents);
+    return _CullBoxesScalar(frustum, pComponents, 0, count, pVisible);
+}
+
+#ifdef FRUSTUM_CULLING_X86
+
+//
+// SSE: 每次迭代两组 4 个物体，掩码拼成 8 位
+//
+
+static inline uint32_t _CompactMask(uint32_t mask, uint32_t base, uint32_t *pVisible) {
+    uint32_t n = 0;
+    while (mask != 0) {
+        pVisible[n++] = base + std::countr_zero(mask);
+        mask &= mask - 1;
+    }
+    return n;
+}
+
+static uint32_t _CullSpheresSSE(const Frustum &frustum, const float *x, const float *y, const float *z, const float *radius,
+                                uint32_t count, uint32_t *pVisible) {
+    __m128 planes[FRUSTUM_PLANE_MAX_ENUM][4];
+    for (int p = 0; p < FRUSTUM_PLANE_MAX_ENUM; p++) {
+        for (int c = 0; c < 4; c++)
+            planes[p][c] = _mm_set1_ps(frustum.planes[p][c]);
+    }
+
+    const __m128 zero = _mm_setzero_ps();
+    uint32_t visibleCount = 0, i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint32_t mask = 0;
+        for (uint32_t half = 0; half < 8; half += 4) {
+            __m128 cx = _mm_loadu_ps(x + i + half);
+            __m128 cy = _mm_loadu_ps(y + i + half);
+            __m128 cz = _mm_loadu_ps(z + i + half);
+            __m128 nr = _mm_sub_ps(zero, _mm_loadu_ps(radius + i + half));
+            __m128 visible = _mm_cmpeq_ps(zero, zero);
+            for (int p = 0; p < FRUSTUM_PLANE_MAX_ENUM; p++) {
+                __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planes[p][0], cx), _mm_mul_ps(planes[p][1], cy)),
+                                      _mm_add_ps(_mm_mul_ps(planes[p][2], cz), planes[p][3]));
+                visible = _mm_and_ps(visible, _mm_cmpge_ps(d, nr));
+            }
+            mask |= (uint32_t) _mm_movemask_ps(visible) << half;
+        }
+        visibleCount += _CompactMask(mask, i, pVisible + visibleCount);
+    }
+
+    return visibleCount + _CullSpheresScalar(frustum, x + i, y + i, z + i, radius + i, count - i, pVisible + visibleCount, i);
+}
+
+static uint32_t _CullBoxesSSE(const Frustum &frustum, const float *const min[3], const float *const max[3], uint32_t count,
+                              uint32_t *pVisible) {
+    const float *pComponents[FRUSTUM_PLANE_MAX_ENUM][3];
+    _SelectBoxComponents(frustum, min, max, pComponents);
+
+    __m128 planes[FRUSTUM_PLANE_MAX_ENUM][4];
+    for (int p = 0; p < FRUSTUM_PLANE_MAX_ENUM; p++) {
+        for (int c = 0; c < 4; c++)
+            planes[p][c] = _mm_set1_ps(frustum.planes[p][c]);
+    }
+
+    const __m128 zero = _mm_setzero_ps();
+    uint32_t visibleCount = 0, i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint32_t mask = 0;
+        for (uint32_t half = 0; half < 8; half += 4) {
+            __m128 visible = _mm_cmpeq_ps(zero, zero);
+            for (int p = 0; p < FRUSTUM_PLANE_MAX_ENUM; p++) {
+                uint32_t k = i + half;
+                __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planes[p][0], _mm_loadu_ps(pComponents[p][0] + k)),
+                                                 _mm_mul_ps(planes[p][1], _mm_loadu_ps(pComponents[p][1] + k))),
+                                      _mm_add_ps(_mm_mul_ps(planes[p][2], _mm_loadu_ps(pComponents[p][2] + k)), planes[p][3]));
+                visible = _mm_and_ps(visible, _mm_cmpge_ps(d, zero));
+            }
+            mask |= (uint32_t) _mm_movemask_ps(visible) << half;
+        }
+        visibleCount += _CompactMask(mask, i, pVisible + visibleCount);
+    }
+
+    return visibleCount + _CullBoxesScalar(frustum, pComponents, i, count, pVisible + visibleCount);
+}
+
+//
+// AVX2 + FMA: 8 个物体一组，用查表把可见 lane 的下标直接压紧写出
+//
+
+/* 8 位掩码 -> 可见 lane 下标，每个下标占一个字节 */
+static constexpr std::array<uint64_t, 256> _BuildCompactTable() {
+    std::array<uint64_t, 256> table = {};
+    for (uint32_t mask = 0; mask < 256; mask++) {
+        uint32_t n = 0;
+        for (uint32_t lane = 0; lane < 8; lane++) {
+            if (mask & (1u << lane))
+                table[mask] |= (uint64_t) lane << (8 * n++);
+        }
+    }
+    return table;
+}
+
+static constexpr std::array<uint64_t, 256> s_CompactTable = _BuildCompactTable();
+
+/* 总是写 8 个下标，只前进 popcount 个。i + 8 <= count 时 visibleCount + 8 <= count，不会越界 */
+FRUSTUM_CULLING_TARGET_AVX2
+static inline uint32_t _CompactMaskAVX2(uint32_t mask, uint32_t base, uint32_t *pVisible) {
+    __m256i lanes = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(&s_CompactTable[mask])));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(pVisible), _mm256_add_epi32(lanes, _mm256_set1_epi32((int) base)));
+    return std::popcount(mask);
+}
+
+FRUSTUM_CULLING_TARGET_AVX2
+static uint32_t _CullSpheresAVX2(const Frustum &frustum, const float *x, const float *y, const float *z, const float *radius,
+                                 uint32_t count, uint32_t *pVisible) {
+    __m256 planes[FRUSTUM_PLANE_MAX_ENUM][4];
+    for (int p = 0; p < FRUSTUM_PLANE_MAX_ENUM; p++) {
+        for (int c = 0; c < 4; c++)
+            planes[p][c] = _mm256_set1_ps(frustum.planes[p][c]);
+    }
+
+    const __m256 zero = _mm256_setzero_ps();
+    uint32_t visibleCount = 0, i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 cx = _mm256_loadu_ps(x + i);
+        __m256 cy = _mm256_loadu_ps(y + i);
+        __m256 cz = _mm256_loadu_ps(z + i);
+        __m256 nr = _mm256_sub_ps(zero, _mm256_loadu_ps(radius + i));
+        __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < FRUSTUM_PLANE_MAX_ENUM; p++) {
+            __m256 d = _mm256_fmadd_ps(planes[p][0], cx, _mm256_fmadd_ps(planes[p][1], cy, _mm256_fmadd_ps(planes[p][2], cz, planes[p][3])));
+            visible = _mm256_and_ps(visible, _mm256_cmp_ps(d, nr, _CMP_GE_OQ));
+        }
+        visibleCount += _CompactMaskAVX2(_mm256_movemask_ps(visible), i, pVisible + visibleCount);
+    }
+
+    return visibleCount + _CullSpheresScalar(frustum, x + i, y + i, z + i, radius + i, count - i, pVisible + visibleCount, i);
+}
+
+FRUSTUM_CULLING_TARGET_AVX2
+static uint32_t _CullBoxesAVX2(const Frustum &frustum, const float *const min[3], const float *const max[3], uint32_t count,
+                               uint32_t *pVisible) {
+    const float *pComponents[FRUSTUM_PLANE_MAX_ENUM][3];
+    _SelectBoxComponents(frustum, min, max, pComponents);
+
+    __m256 planes[FRUSTUM_PLANE_MAX_ENUM][4];
+    for (int p = 0; p < FRUSTUM_PLANE_MAX_ENUM; p++) {
+        for (int c = 0; c < 4; c++)
+            planes[p][c] = _mm256_set1_ps(frustum.planes[p][c]);
+    }
+
+    const __m256 zero = _mm256_setzero_ps();
+    uint32_t visibleCount = 0, i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < FRUSTUM_PLANE_MAX_ENUM; p++) {
+            __m256 d = _mm256_fmadd_ps(planes[p][0], _mm256_loadu_ps(pComponents[p][0] + i),
+                                       _mm256_fmadd_ps(planes[p][1], _mm256_loadu_ps(pComponents[p][1] + i),
+                                                       _mm256_fmadd_ps(planes[p][2], _mm256_loadu_ps(pComponents[p][2] + i), planes[p][3])));
+            visible = _mm256_and_ps(visible, _mm256_cmp_ps(d, zero, _CMP_GE_OQ));
+        }
+        visibleCount += _CompactMaskAVX2(_mm256_movemask_ps(visible), i, pVisible + visibleCount);
+    }
+
+    return visibleCount + _CullBoxesScalar(frustum, pComponents, i, count, pVisible + visibleCount);
+}
+
+static bool _IsAVX2Supported() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool fma = (info[2] & (1 << 12)) != 0;
+    if (!osxsave || !fma)
+        return false;
+    /* 系统要保存 YMM 寄存器 */
+    if ((_xgetbv(0) & 0x6) != 0x6)
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+}
+
+#endif /* FRUSTUM_CULLING_X86 */
+
+static FrustumCullingPath _GetBestPath() {
+#ifdef FRUSTUM_CULLING_X86
+    /* x86-64 一定有 SSE2 */
+    return _IsAVX2Supported() ? FRUSTUM_CULLING_PATH_AVX2 : FRUSTUM_CULLING_PATH_SSE;
+#else
+    return FRUSTUM_CULLING_PATH_SCALAR;
+#endif
+}
+
+static const FrustumCullingPath s_BestPath = _GetBestPath();
+static FrustumCullingPath s_Path = s_BestPath;
+
+namespace FrustumCulling {
+    FrustumCullingPath GetPath() {
+        return s_Path;
+    }
+
+    bool SetPath(FrustumCullingPath path) {
+        if (path >= FRUSTUM_CULLING_PATH_MAX_ENUM || path > s_BestPath)
+            return false;
+        s_Path = path;
+        return true;
+    }
+
+    const char *GetPathName(FrustumCullingPath path) {
+        switch (path) {
+            case FRUSTUM_CULLING_PATH_SCALAR: return "scalar";
+            case FRUSTUM_CULLING_PATH_SSE: return "sse";
+            case FRUSTUM_CULLING_PATH_AVX2: return "avx2";
+            default: return "unknown";
+        }
+    }
+
+    uint32_t CullSpheres(const Frustum &frustum, const float *x, const float *y, const float *z, const float *radius,
+                         uint32_t count, uint32_t *pVisible) {
+        switch (s_Path) {
+#ifdef FRUSTUM_CULLING_X86
+            case FRUSTUM_CULLING_PATH_AVX2: return _CullSpheresAVX2(frustum, x, y, z, radius, count, pVisible);
+            case FRUSTUM_CULLING_PATH_SSE: return _CullSpheresSSE(frustum, x, y, z, radius, count, pVisible);
+#endif
+            default: return _CullSpheresScalar(frustum, x, y, z, radius, count, pVisible);
+        }
+    }
+
+    uint32_t CullBoxes(const Frustum &frustum, const float *const min[3], const float *const max[3], uint32_t count, uint32_t *pVisible) {
+        switch (s_Path) {
+#ifdef FRUSTUM_CULLING_X86
+            case FRUSTUM_CULLING_PATH_AVX2: return _CullBoxesAVX2(frustum, min, max, count, pVisible);
+            case FRUSTUM_CULLING_PATH_SSE: return _CullBoxesSSE(frustum, min, max, count, pVisible);
+#endif
+            default: return _CullBoxesScalar(frustum, min, max, count, pVisible);
+        }
+    }
+}
@@ -0,0 +1,98 @@
+/* ************************************************************************
+ *
+ * Copyright (C) 2022 Vincent Luo All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, e1ither express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ************************************************************************/
+
+/* Creates on 2026/10/17. */
+
+/*
+  ===================================
+    @author bit-fashion
+  ===================================
+*/
+#ifndef _VECTRAFLUX_ENGINE_FRUSTUM_CULLING_H_
+#define _VECTRAFLUX_ENGINE_FRUSTUM_CULLING_H_
+
+#include <Typedef.h>
+#include "Render/Camera/Frustum.h"
+
+/* 包围球按分量分开存放，SIMD 一次读 8 个物体的同一个分量 */
+struct BoundingSphereSoA {
+    Vector<float> x;
+    Vector<float> y;
+    Vector<float> z;
+    Vector<float> radius;
+
+    void Add(const glm::vec3 &center, float r) {
+        x.push_back(center.x);
+        y.push_back(center.y);
+        z.push_back(center.z);
+        radius.push_back(r);
+    }
+
+    uint32_t Size() const { return std::size(x); }
+};
+
+struct BoundingBoxSoA {
+    Vector<float> min[3];
+    Vector<float> max[3];
+
+    void Add(const glm::vec3 &boxMin, const glm::vec3 &boxMax) {
+        for (int axis = 0; axis < 3; axis++) {
+            min[axis].push_back(boxMin[axis]);
+            max[axis].push_back(boxMax[axis]);
+        }
+    }
+
+    uint32_t Size() const { return std::size(min[0]); }
+};
+
+enum FrustumCullingPath {
+    FRUSTUM_CULLING_PATH_SCALAR = 0,
+    FRUSTUM_CULLING_PATH_SSE, /* two 4-wide halves per iteration */
+    FRUSTUM_CULLING_PATH_AVX2, /* AVX2 + FMA */
+    FRUSTUM_CULLING_PATH_MAX_ENUM
+};
+
+/**
+ * Frustum tests over SoA bounding volumes, 8 objects per iteration. The
+ * visible objects are written to pVisible as ascending indices, which must
+ * have room for count entries, and their number is returned. The kernel is
+ * picked once from the CPU features.
+ */
+namespace FrustumCulling {
+    FrustumCullingPath GetPath();
+    /* false when the CPU lacks the instructions, benchmarks use it to compare paths */
+    bool SetPath(FrustumCullingPath path);
+    const char *GetPathName(FrustumCullingPath path);
+
+    uint32_t CullSpheres(const Frustum &frustum, const float *x, const float *y, const float *z, const float *radius,
+                         uint32_t count, uint32_t *pVisible);
+    uint32_t CullBoxes(const Frustum &frustum, const float *const min[3], const float *const max[3], uint32_t count, uint32_t *pVisible);
+
+    inline uint32_t CullSpheres(const Frustum &frustum, const BoundingSphereSoA &spheres, uint32_t *pVisible) {
+        return CullSpheres(frustum, std::data(spheres.x), std::data(spheres.y), std::data(spheres.z), std::data(spheres.radius),
+                           spheres.Size(), pVisible);
+    }
+
+    inline uint32_t CullBoxes(const Frustum &frustum, const BoundingBoxSoA &boxes, uint32_t *pVisible) {
+        const float *min[3] = { std::data(boxes.min[0]), std::data(boxes.min[1]), std::data(boxes.min[2]) };
+        const float *max[3] = { std::data(boxes.max[0]), std::data(boxes.max[1]), std::data(boxes.max[2]) };
+        return CullBoxes(frustum, min, max, boxes.Size(), pVisible);
+    }
+}
+
+#endif /* _VECTRAFLUX_ENGINE_FRUSTUM_CULLING_H_ */
@@ -26,18 +26,70 @@
 #include "VulkanContext.h"
 #include "Window/Window.h"
 #include "VulkanUtils.h"
+#include "Utils/MipmapUtils.h"
+#include "Utils/Texture/KTX2.h"
+#include <filesystem>
+#include <System.h>
 
 VulkanContext::VulkanContext(Window *window) : m_Window(window) {
     InitVulkanDriverContext();
 }
 
 VulkanContext::~VulkanContext() {
+    m_TextureLoadPool.reset(); /* 等待还在解码的纹理 */
+    FlushImmediateCommands();
+    DeviceWaitIdle();
+    for (auto &asyncTexture : m_AsyncTextures) {
+        if (asyncTexture->residency == VULKAN_TEXTURE_RESIDENCY_UPLOADING ||
+            asyncTexture->residency == VULKAN_TEXTURE_RESIDENCY_RESIDENT)
+            _DestroyTexture2DImmediate(asyncTexture->texture);
+    }
+    /* 正在上传的流送 mip 链 */
+    for (VkTextureHandle handle : m_UploadingTextures) {
+        if (m_AsyncTextures[handle]->streamingMip != UINT32_MAX)
+            _DestroyTexture2DImmediate(m_AsyncTextures[handle]->streamingTexture);
+    }
+    m_AsyncTextures.clear();
+    for (auto &frameSyncContext : m_FrameSyncContexts) {
+        for (auto &texture : frameSyncContext.retiredTextures)
+            _DestroyTexture2DImmediate(texture);
+        frameSyncContext.retiredTextures.clear();
+        frameSyncContext.retiredDescriptorSets.clear(); /* 随 pool 一起销毁 */
+    }
+    _DestroyTexture2DImmediate(m_PlaceholderTexture);
+    for (auto &batch : m_UploadBatches) {
+        _RetireUploadBatch(batch, true);
+        vkFreeCommandBuffers(m_Device, m_TransferCommandPool, 1, &batch.commandBuffer);
+        FreeCommandBuffer(1, &batch.acquireCommandBuffer);
+        DestroyFence(batch.fence);
+        batch.descriptorAllocator.reset();
+    }
+    m_MipmapGenerator.reset();
+    m_IndirectCuller.reset();
+    FreeBuffer(m_StagingBuffer);
+    vkDestroySemaphore(m_Device, m_UploadTimelineSemaphore, VulkanUtils::Allocator);
     vkDestroyDescriptorPool(m_Device, m_DescriptorPool, VulkanUtils::Allocator);
-    FreeCommandBuffer(std::size(m_CommandBuffers), std::data(m_CommandBuffers));
+    m_DescriptorAllocator.reset();
+    if (m_BindlessSupported) {
+        vkDestroyDescriptorPool(m_Device, m_BindlessDescriptorPool, VulkanUtils::Allocator);
+        vkDestroyDescriptorSetLayout(m_Device, m_BindlessSetLayout, VulkanUtils::Allocator);
+    }
+    for (auto &frameSyncContext : m_FrameSyncContexts) {
+        frameSyncContext.descriptorAllocator.reset();
+        FreeCommandBuffer(1, &frameSyncContext.commandBuffer);
+        vkDestroySemaphore(m_Device, frameSyncContext.imageAvailableSemaphore, VulkanUtils::Allocator);
+        DestroyFence(frameSyncContext.inFlightFence);
+    }
+    m_RenderGraph.reset();
     vkDestroyCommandPool(m_Device, m_CommandPool, VulkanUtils::Allocator);
-    vkDestroySemaphore(m_Device, m_WindowContext.renderFinishedSemaphore, VulkanUtils::Allocator);
-    vkDestroySemaphore(m_Device, m_WindowContext.imageAvailableSemaphore, VulkanUtils::Allocator);
+    vkDestroyCommandPool(m_Device, m_TransferCommandPool, VulkanUtils::Allocator);
+    DestroyFence(m_ImmediateFence);
+    vkDestroyCommandPool(m_Device, m_ImmediateCommandPool, VulkanUtils::Allocator);
     DestroySwapchainContextKHR(&m_MainSwapchainContext);
+    m_PipelineLibrary.reset();
+    m_PipelineCache.reset(); /* 写回磁盘 */
+    m_SamplerCache.reset();
+    m_MemoryAllocator.reset();
     vkDestroyDevice(m_Device, VulkanUtils::Allocator);
     vkDestroySurfaceKHR(m_Instance, m_SurfaceKHR, VulkanUtils::Allocator);
     vkDestroyInstance(m_Instance, VulkanUtils::Allocator);
@@ -66,9 +118,8 @@ void VulkanContext::_CreateSwapcahinAboutComponents(VkSwapchainContextKHR *pSwap
     pSwapchainContext->images.resize(pSwapchainContext->minImageCount);
     vkGetSwapchainImagesKHR(m_Device, pSwapchainContext->swapchain, &pSwapchainContext->minImageCount, std::data(pSwapchainContext->images));
 
-    /* create swapcahin image view and framebuffer */
+    /* create swapcahin image view, framebuffers are created by the render graph */
     pSwapchainContext->imageViews.resize(pSwapchainContext->minImageCount);
-    pSwapchainContext->framebuffers.resize(pSwapchainContext->minImageCount);
     for (uint32_t i = 0; i < pSwapchainContext->minImageCount; i++) {
         /* view */
         VkImageViewCreateInfo imageViewCreateInfo = {};
@@ -86,11 +137,12 @@ void VulkanContext::_CreateSwapcahinAboutComponents(VkSwapchainContextKHR *pSwap
         imageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
         imageViewCreateInfo.subresourceRange.layerCount = 1;
         vkCreateImageView(m_Device, &imageViewCreateInfo, VulkanUtils::Allocator, &pSwapchainContext->imageViews[i]);
-
-        /* framebuffer */
-        CreateFramebuffer(m_WindowContext.renderpass, pSwapchainContext->imageViews[i], pSwapchainContext->width,
-                          pSwapchainContext->height, &pSwapchainContext->framebuffers[i]);
     }
+
+    /* present 等待的信号量按图像分配，图像数可能多于在途帧数 */
+    pSwapchainContext->renderFinishedSemaphores.resize(pSwapchainContext->minImageCount);
+    for (uint32_t i = 0; i < pSwapchainContext->minImageCount; i++)
+        CreateSemaphore(&pSwapchainContext->renderFinishedSemaphores[i]);
 }
 
 void VulkanContext::_ConfigurationSwapchainContext(VkSwapchainContextKHR *pSwapchainContext) {
@@ -108,57 +160,416 @@ void VulkanContext::DeviceWaitIdle() {
     vkDeviceWaitIdle(m_Device);
 }
 
+void VulkanContext::FlushImmediateCommands() {
+    _SubmitImmediateCommands();
+    if (m_ImmediateInFlight) {
+        WaitForFence(m_ImmediateFence);
+        m_ImmediateInFlight = false;
+    }
+}
+
 void VulkanContext::CopyBuffer(VkDeviceBuffer dest, VkDeviceBuffer src, VkDeviceSize size) {
-    VkCommandBuffer oneTimeCommandBuffer;
-    BeginOnceTimeCommandBufferSubmit(&oneTimeCommandBuffer);
-    {
-        /* copy buffer */
-        VkBufferCopy copyRegion = {};
-        copyRegion.srcOffset = 0;
-        copyRegion.dstOffset = 0;
-        copyRegion.size = size;
-        vkCmdCopyBuffer(oneTimeCommandBuffer, src.buffer, dest.buffer, 1, &copyRegion);
+    /* copy buffer */
+    VkBufferCopy copyRegion = {};
+    copyRegion.srcOffset = 0;
+    copyRegion.dstOffset = 0;
+    copyRegion.size = size;
+    vkCmdCopyBuffer(_GetImmediateCommandBuffer(), src.buffer, dest.buffer, 1, &copyRegion);
+}
+
+void VulkanContext::MapMemory(VkDeviceBuffer buffer, VkDeviceSize offset, VkDeviceSize size, [[maybe_unused]] VkMemoryMapFlags flags, void **ppData) {
+    /* host visible blocks are mapped once by the allocator */
+    if (buffer.allocation.pMapped == null)
+        throw std::runtime_error("map memory of buffer that is not host visible!");
+    /* 先比较 offset 再算剩余长度，避免 offset + size 溢出 */
+    if (offset > buffer.allocation.size || (size != VK_WHOLE_SIZE && size > buffer.allocation.size - offset))
+        throw std::runtime_error("map memory range is out of the buffer allocation!");
+    *ppData = static_cast<char *>(buffer.allocation.pMapped) + offset;
+}
+
+void VulkanContext::UnmapMemory([[maybe_unused]] VkDeviceBuffer buffer) {
+    /* persistently mapped, nothing to do */
+}
+
+void VulkanContext::UploadBuffer(VkDeviceBuffer &buffer, VkDeviceSize offset, VkDeviceSize size, const void *pData) {
+    VkBuffer stagingBuffer;
+    VkDeviceSize stagingOffset;
+    void *data = _ReserveStagingMemory(size, 16, &stagingBuffer, &stagingOffset);
+    memcpy(data, pData, static_cast<size_t>(size));
+
+    VkBufferCopy copyRegion = {};
+    copyRegion.srcOffset = stagingOffset;
+    copyRegion.dstOffset = offset;
+    copyRegion.size = size;
+    VkCommandBuffer commandBuffer = _GetUploadCommandBuffer();
+    vkCmdCopyBuffer(commandBuffer, stagingBuffer, buffer.buffer, 1, &copyRegion);
+    m_CurrentUploadBatch->frameRequired |= !m_BackgroundUploads;
+
+    if (m_TransferQueueFamily == m_GraphicsQueueFamily)
+        return;
+
+    /* release 到 graphics 队列族，acquire 在 graphics 队列上执行 */
+    VkBufferMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = 0;
+    barrier.srcQueueFamilyIndex = m_TransferQueueFamily;
+    barrier.dstQueueFamilyIndex = m_GraphicsQueueFamily;
+    barrier.buffer = buffer.buffer;
+    barrier.offset = offset;
+    barrier.size = size;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                         0, 0, null, 1, &barrier, 0, null);
+
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT |
+                            VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+    m_CurrentUploadBatch->bufferAcquireBarriers.push_back(barrier);
+}
+
+uint32_t VulkanContext::_GetCompressedBlockSize(VkFormat format) {
+    switch (format) {
+        case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        case VK_FORMAT_BC4_UNORM_BLOCK:
+        case VK_FORMAT_BC4_SNORM_BLOCK:
+            return 8;
+        case VK_FORMAT_BC2_UNORM_BLOCK:
+        case VK_FORMAT_BC2_SRGB_BLOCK:
+        case VK_FORMAT_BC3_UNORM_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+        case VK_FORMAT_BC5_UNORM_BLOCK:
+        case VK_FORMAT_BC5_SNORM_BLOCK:
+        case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+        case VK_FORMAT_BC6H_SFLOAT_BLOCK:
+        case VK_FORMAT_BC7_UNORM_BLOCK:
+        case VK_FORMAT_BC7_SRGB_BLOCK:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+void VulkanContext::UploadTexture2D(VkTexture2D *pTexture2D, uint32_t width, uint32_t height, VkDeviceSize size, const void *pPixels,
+                                    uint32_t levelCount) {
+    uint32_t mipLevels = pTexture2D->mipLevels;
+    bool generate = levelCount < mipLevels;
+    if (levelCount == 0 || levelCount > mipLevels)
+        throw std::runtime_error("invalid texture level count!");
+    if (generate && m_MipmapGenerator->GetMethod(pTexture2D->format) == VULKAN_MIPMAP_METHOD_CPU)
+        throw std::runtime_error("texture format can't generate mipmaps on the GPU, upload every level!");
+
+    /* 每个 level 紧密排列，压缩格式按 4x4 块计算，其余的 texel 大小由总大小反推 */
+    uint32_t blockSize = _GetCompressedBlockSize(pTexture2D->format);
+    uint32_t blockDimension = blockSize != 0 ? 4 : 1;
+    VkDeviceSize blockCount = 0;
+    for (uint32_t level = 0; level < levelCount; level++)
+        blockCount += (VkDeviceSize) ((std::max(1u, width >> level) + blockDimension - 1) / blockDimension) *
+                      ((std::max(1u, height >> level) + blockDimension - 1) / blockDimension);
+    if (blockSize != 0 ? size != blockCount * blockSize : size == 0 || size % blockCount != 0)
+        throw std::runtime_error("texture data size doesn't match its format and levels!");
+    VkDeviceSize texelSize = blockSize != 0 ? blockSize : size / blockCount;
+
+    VkBuffer stagingBuffer;
+    VkDeviceSize stagingOffset;
+    void *data = _ReserveStagingMemory(size, 16, &stagingBuffer, &stagingOffset);
+    memcpy(data, pPixels, static_cast<size_t>(size));
+
+    VkCommandBuffer commandBuffer = _GetUploadCommandBuffer();
+    m_CurrentUploadBatch->frameRequired |= !m_BackgroundUploads;
+
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = pTexture2D->image;
+    barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, mipLevels, 0, 1 };
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 0, null, 0, null, 1, &barrier);
+
+    Vector<VkBufferImageCopy> regions(levelCount);
+    VkDeviceSize offset = stagingOffset;
+    for (uint32_t level = 0; level < levelCount; level++) {
+        VkBufferImageCopy &region = regions[level];
+        region = {};
+        region.bufferOffset = offset;
+        region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1 };
+        region.imageExtent = { std::max(1u, width >> level), std::max(1u, height >> level), 1 };
+        offset += (VkDeviceSize) ((region.imageExtent.width + blockDimension - 1) / blockDimension) *
+                  ((region.imageExtent.height + blockDimension - 1) / blockDimension) * texelSize;
+    }
+    vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, pTexture2D->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                           levelCount, std::data(regions));
+
+    /* 缺少的 mip 在 graphics 队列上生成，生成前所有 level 保持 TRANSFER_DST */
+    if (generate) {
+        VkMipmapJob job = { pTexture2D->image, pTexture2D->format, width, height, mipLevels, levelCount - 1 };
+        m_CurrentUploadBatch->mipmapJobs.push_back(job);
+    }
+
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = generate ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    VkAccessFlags dstAccess = generate ? VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT : VK_ACCESS_SHADER_READ_BIT;
+
+    if (m_TransferQueueFamily == m_GraphicsQueueFamily) {
+        /* 生成 mip 时由 acquire 提交里的 barrier 负责 */
+        if (!generate) {
+            barrier.dstAccessMask = dstAccess;
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                 0, 0, null, 0, null, 1, &barrier);
+        }
+    } else {
+        /* release 和 acquire 必须使用相同的 layout 转换 */
+        barrier.dstAccessMask = 0;
+        barrier.srcQueueFamilyIndex = m_TransferQueueFamily;
+        barrier.dstQueueFamilyIndex = m_GraphicsQueueFamily;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                             0, 0, null, 0, null, 1, &barrier);
+
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = dstAccess;
+        m_CurrentUploadBatch->imageAcquireBarriers.push_back(barrier);
+    }
+
+    for (uint32_t level = 0; level < mipLevels; level++)
+        pTexture2D->mipLayouts[level] = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+}
+
+void VulkanContext::FlushUploads() {
+    if (m_CurrentUploadBatch == null)
+        return;
+
+    VkUploadBatch &batch = *m_CurrentUploadBatch;
+    EndCommandBuffer(batch.commandBuffer);
+
+    batch.timelineValue = ++m_UploadTimelineValue;
+
+    VkTimelineSemaphoreSubmitInfo timelineSubmitInfo = {};
+    timelineSubmitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineSubmitInfo.signalSemaphoreValueCount = 1;
+    timelineSubmitInfo.pSignalSemaphoreValues = &batch.timelineValue;
+
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = &timelineSubmitInfo;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &batch.commandBuffer;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &m_UploadTimelineSemaphore;
+
+    if (vkQueueSubmit(m_TransferQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+        throw std::runtime_error("failed to submit upload command buffer!");
+
+    /* graphics 队列上的 acquire：只针对写入的 buffer/image 拿回队列族所有权，
+     * 同一队列族时 timeline 等待本身就带内存依赖，不需要 barrier */
+    BeginCommandBuffer(batch.acquireCommandBuffer, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+    if (!batch.bufferAcquireBarriers.empty() || !batch.imageAcquireBarriers.empty()) {
+        vkCmdPipelineBarrier(batch.acquireCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VULKAN_UPLOAD_ACQUIRE_STAGES,
+                             0, 0, null,
+                             std::size(batch.bufferAcquireBarriers), std::data(batch.bufferAcquireBarriers),
+                             std::size(batch.imageAcquireBarriers), std::data(batch.imageAcquireBarriers));
+    }
+
+    /* 拿到所有权之后补全 mip 链 */
+    for (const auto &job : batch.mipmapJobs)
+        m_MipmapGenerator->Record(batch.acquireCommandBuffer, job, batch.descriptorAllocator.get(), batch.temporaryImageViews);
+    batch.mipmapJobs.clear();
+
+    EndCommandBuffer(batch.acquireCommandBuffer);
+
+    batch.stagingHead = m_StagingRing.GetHead();
+    batch.pending = true;
+    batch.acquired = false;
+    m_CurrentUploadBatch = null;
+    m_UploadBatchIndex = (m_UploadBatchIndex + 1) % VULKAN_UPLOAD_BATCH_COUNT;
+    batch.serial = ++m_UploadBatchSubmitCount;
+}
+
+void VulkanContext::_SubmitUploadAcquires(uint64_t requiredSerial) {
+    uint64_t completedValue = 0;
+    if (vkGetSemaphoreCounterValue(m_Device, m_UploadTimelineSemaphore, &completedValue) != VK_SUCCESS)
+        throw std::runtime_error("failed to query upload timeline semaphore!");
+
+    /* 还在传输中的后台批次留给之后的帧。acquire 保持提交顺序，所以要 acquire 的
+     * 最后一个批次之前的都一起 acquire，传输队列按顺序完成，不会多等 */
+    uint64_t lastSerial = 0;
+    for (const auto &batch : m_UploadBatches) {
+        if (!batch.pending || batch.acquired)
+            continue;
+        if (batch.timelineValue <= completedValue || batch.frameRequired || batch.serial <= requiredSerial)
+            lastSerial = std::max(lastSerial, batch.serial);
+    }
+
+    /* 按提交顺序从最早的批次开始 */
+    for (uint32_t i = 0; i < VULKAN_UPLOAD_BATCH_COUNT; i++) {
+        VkUploadBatch &batch = m_UploadBatches[(m_UploadBatchIndex + i) % VULKAN_UPLOAD_BATCH_COUNT];
+        if (!batch.pending || batch.acquired || batch.serial > lastSerial)
+            continue;
+
+        /* 已完成的批次等待会立即满足，仍然需要它建立设备上的内存依赖 */
+        VkTimelineSemaphoreSubmitInfo timelineSubmitInfo = {};
+        timelineSubmitInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        timelineSubmitInfo.waitSemaphoreValueCount = 1;
+        timelineSubmitInfo.pWaitSemaphoreValues = &batch.timelineValue;
+
+        VkPipelineStageFlags waitStage = VULKAN_UPLOAD_ACQUIRE_STAGES;
+        VkSubmitInfo submitInfo = {};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.pNext = &timelineSubmitInfo;
+        submitInfo.waitSemaphoreCount = 1;
+        submitInfo.pWaitSemaphores = &m_UploadTimelineSemaphore;
+        submitInfo.pWaitDstStageMask = &waitStage;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &batch.acquireCommandBuffer;
+
+        vkResetFences(m_Device, 1, &batch.fence);
+        if (vkQueueSubmit(m_GraphicsQueue, 1, &submitInfo, batch.fence) != VK_SUCCESS)
+            throw std::runtime_error("failed to submit upload acquire command buffer!");
+
+        batch.acquired = true;
     }
-    EndOnceTimeCommandBufferSubmit();
 }
 
-void VulkanContext::MapMemory(VkDeviceBuffer buffer, VkDeviceSize offset, VkDeviceSize size, VkMemoryMapFlags flags, void **ppData) {
-    vkMapMemory(m_Device, buffer.memory, offset, size, flags, ppData);
+VkCommandBuffer VulkanContext::_GetUploadCommandBuffer() {
+    if (m_CurrentUploadBatch == null) {
+        VkUploadBatch &batch = m_UploadBatches[m_UploadBatchIndex];
+        _RetireUploadBatch(batch, true);
+        BeginCommandBuffer(batch.commandBuffer, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+        batch.frameRequired = false;
+        m_CurrentUploadBatch = &batch;
+    }
+
+    return m_CurrentUploadBatch->commandBuffer;
 }
 
-void VulkanContext::UnmapMemory(VkDeviceBuffer buffer) {
-    vkUnmapMemory(m_Device, buffer.memory);
+void *VulkanContext::_ReserveStagingMemory(VkDeviceSize size, VkDeviceSize alignment, VkBuffer *pBuffer, VkDeviceSize *pOffset) {
+    for (auto &batch : m_UploadBatches)
+        _RetireUploadBatch(batch, false);
+
+    /* 超过环形缓冲一半的数据单独分配暂存 buffer，随批次释放 */
+    if (size > m_StagingRing.GetSize() / 2) {
+        VkDeviceBuffer temporaryBuffer;
+        AllocateBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &temporaryBuffer);
+        _GetUploadCommandBuffer();
+        m_CurrentUploadBatch->temporaryBuffers.push_back(temporaryBuffer);
+        *pBuffer = temporaryBuffer.buffer;
+        *pOffset = 0;
+        return temporaryBuffer.allocation.pMapped;
+    }
+
+    while (!m_StagingRing.Reserve(size, alignment, pOffset)) {
+        /* 环形缓冲已满：提交当前批次并等待最早的批次完成 */
+        FlushUploads();
+        for (uint32_t i = 0; i < VULKAN_UPLOAD_BATCH_COUNT; i++) {
+            VkUploadBatch &batch = m_UploadBatches[(m_UploadBatchIndex + i) % VULKAN_UPLOAD_BATCH_COUNT];
+            if (batch.pending) {
+                _RetireUploadBatch(batch, true);
+                break;
+            }
+        }
+    }
+
+    _GetUploadCommandBuffer();
+    *pBuffer = m_StagingBuffer.buffer;
+    return static_cast<char *>(m_StagingBuffer.allocation.pMapped) + *pOffset;
+}
+
+bool VulkanContext::_RetireUploadBatch(VkUploadBatch &batch, bool wait) {
+    if (!batch.pending)
+        return true;
+
+    if (!batch.acquired) {
+        if (!wait)
+            return false;
+        _SubmitUploadAcquires(batch.serial);
+    }
+
+    if (wait)
+        WaitForFence(batch.fence);
+    else if (vkGetFenceStatus(m_Device, batch.fence) != VK_SUCCESS)
+        return false;
+
+    m_StagingRing.Release(batch.stagingHead);
+    for (auto &temporaryBuffer : batch.temporaryBuffers)
+        FreeBuffer(temporaryBuffer);
+    batch.temporaryBuffers.clear();
+    for (auto &imageView : batch.temporaryImageViews)
+        vkDestroyImageView(m_Device, imageView, VulkanUtils::Allocator);
+    batch.temporaryImageViews.clear();
+    batch.descriptorAllocator->Reset();
+    batch.bufferAcquireBarriers.clear();
+    batch.imageAcquireBarriers.clear();
+    batch.pending = false;
+    m_CompletedUploadSerial = std::max(m_CompletedUploadSerial, batch.serial);
+    return true;
 }
 
 void VulkanContext::BeginGraphicsRender(VkGraphicsFrameContext **ppFrameContext) {
+    VkFrameSyncContext &frameSyncContext = m_FrameSyncContexts[m_FrameIndex];
+
+    /* 等待该帧上一次的提交完成，只有 CPU 领先 N 帧时才会阻塞 */
+    WaitForFence(frameSyncContext.inFlightFence);
+    m_InsideFrame = true;
+    frameSyncContext.descriptorAllocator->Reset();
+    m_DescriptorAllocator->Free(std::size(frameSyncContext.retiredDescriptorSets), std::data(frameSyncContext.retiredDescriptorSets));
+    frameSyncContext.retiredDescriptorSets.clear();
+    for (auto &texture : frameSyncContext.retiredTextures)
+        _DestroyTexture2DImmediate(texture);
+    frameSyncContext.retiredTextures.clear();
+    _ProcessTextureLoads();
+    _UpdateTextureStreaming();
+
     uint32_t index;
     vkAcquireNextImageKHR(m_Device, m_MainSwapchainContext.swapchain, std::numeric_limits<uint64_t>::max(),
-                          m_WindowContext.imageAvailableSemaphore, null, &index);
+                          frameSyncContext.imageAvailableSemaphore, null, &index);
+    vkResetFences(m_Device, 1, &frameSyncContext.inFlightFence);
+
     m_GFCTX.index = index;
-    m_GFCTX.framebuffer = m_MainSwapchainContext.framebuffers[m_GFCTX.index];
-    m_GFCTX.commandBuffer = m_CommandBuffers[m_GFCTX.index];
+    m_GFCTX.frameIndex = m_FrameIndex;
+    m_GFCTX.commandBuffer = frameSyncContext.commandBuffer;
     m_GFCTX.image = m_MainSwapchainContext.images[index];
     m_GFCTX.imageView = m_MainSwapchainContext.imageViews[index];
+    m_GFCTX.width = m_MainSwapchainContext.width;
+    m_GFCTX.height = m_MainSwapchainContext.height;
+
+    /* 交换链图像导入 render graph，等 imageAvailableSemaphore 的 stage 之后才能写 */
+    m_RenderGraph->Reset();
+    VkRenderGraphTextureDesc backbufferDesc = { m_GFCTX.width, m_GFCTX.height, m_MainSwapchainContext.format };
+    m_GFCTX.backbuffer = m_RenderGraph->ImportTexture("Backbuffer", backbufferDesc, m_GFCTX.image, m_GFCTX.imageView,
+                                                      VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                                      VULKAN_RENDER_GRAPH_ACCESS_PRESENT);
+    m_RenderGraph->MarkOutput(m_GFCTX.backbuffer);
 
     if (ppFrameContext != null)
         GetFrameContext(ppFrameContext);
 
     BeginRecordCommandBuffer(m_GFCTX.commandBuffer);
-    BeginRenderPass(m_GFCTX.commandBuffer, m_MainSwapchainContext.width, m_MainSwapchainContext.height, m_WindowContext.renderpass, m_GFCTX.framebuffer);
 }
 
 void VulkanContext::EndGraphicsRender() {
-    EndRenderPass(m_GFCTX.commandBuffer);
+    m_RenderGraph->Execute(m_GFCTX.commandBuffer);
     EndRecordCommandBuffer(m_GFCTX.commandBuffer);
+    /* 本帧可能用到的上传先提交 */
+    FlushUploads();
     /* final submit */
-    VkSemaphore waitSemaphores[] = { m_WindowContext.imageAvailableSemaphore };
+    VkFrameSyncContext &frameSyncContext = m_FrameSyncContexts[m_FrameIndex];
+    VkSemaphore waitSemaphores[] = { frameSyncContext.imageAvailableSemaphore };
     VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-    VkSemaphore signalSemaphores[] = { m_WindowContext.renderFinishedSemaphore };
+    VkSemaphore signalSemaphores[] = { m_MainSwapchainContext.renderFinishedSemaphores[m_GFCTX.index] };
 
-    SyncSubmitQueueWithSubmitInfo(1, &m_GFCTX.commandBuffer,
-                                  1, waitSemaphores,
-                                  1, signalSemaphores,
-                                  waitStages);
+    SubmitQueueWithSubmitInfo(1, &m_GFCTX.commandBuffer,
+                              1, waitSemaphores,
+                              1, signalSemaphores,
+                              waitStages, frameSyncContext.inFlightFence);
 
     VkPresentInfoKHR presentInfo = {};
     presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -172,27 +583,32 @@ void VulkanContext::EndGraphicsRender() {
     presentInfo.pResults = nullptr; // Optional
 
     vkQueuePresentKHR(m_PresentQueue, &presentInfo);
-    QueueWaitIdle(m_PresentQueue);
+
+    m_FrameIndex = (m_FrameIndex + 1) % std::size(m_FrameSyncContexts);
+    m_InsideFrame = false;
 }
 
-void VulkanContext::BeginRTTRender(VkRTTRenderContext &renderContext, uint32_t width, uint32_t height)
-{
+VkRenderGraphResource VulkanContext::AddRTTRenderPass(VkRTTRenderContext &renderContext, uint32_t width, uint32_t height,
+                                                      VkRenderGraphExecuteCallback execute) {
     if (width != renderContext.width || height != renderContext.height)
         RecreateRTTRenderContext(&renderContext, width, height);
 
-    BeginRecordCommandBuffer(renderContext.commandBuffer);
-    BeginRenderPass(renderContext.commandBuffer, renderContext.width, renderContext.height, renderContext.renderpass, renderContext.framebuffer);
-}
+    /* 纹理平时处于 SHADER_READ_ONLY，上一帧可能还在片元着色器里采样 */
+    VkRenderGraphTextureDesc desc = { renderContext.width, renderContext.height, renderContext.texture.format };
+    VkRenderGraphResource resource = m_RenderGraph->ImportTexture("RTT", desc, renderContext.texture.image, renderContext.texture.imageView,
+                                                                  VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                                                  VULKAN_RENDER_GRAPH_ACCESS_SAMPLED_FRAGMENT);
 
-void VulkanContext::EndRTTRender(VkRTTRenderContext &renderContext) {
-    EndRenderPass(renderContext.commandBuffer);
-    EndRecordCommandBuffer(renderContext.commandBuffer);
-    SyncSubmitQueueWithSubmitInfo(1, &renderContext.commandBuffer,
-                                  0, null, 0, null, null);
+    VkClearColorValue clearColor = {{0.0f, 0.0f, 0.0f, 1.0f}};
+    m_RenderGraph->AddPass("RTT", std::move(execute))
+            .WriteColor(resource, &clearColor);
+    return resource;
 }
 
 void VulkanContext::RecreateRTTRenderContext(VkRTTRenderContext *pRenderContext, uint32_t width, uint32_t height) {
     if (VulkanUtils::CheckInvalidSize(width, height)) {
+        /* 纹理可能仍被在途帧采样 */
+        DeviceWaitIdle();
         DestroyRTTRenderContext(*pRenderContext);
         CreateRTTRenderContext(width, height, pRenderContext);
     }
@@ -267,8 +683,85 @@ void VulkanContext::WriteDescriptorSet(VkDeviceBuffer *pBuffer, VkTexture2D *pTe
                            std::data(descriptorWrites), 0, nullptr);
 }
 
-void VulkanContext::DrawIndexed(VkCommandBuffer commandBuffer, uint32_t indexCount) {
-    vkCmdDrawIndexed(commandBuffer, indexCount, 1, 0, 0, 0);
+void VulkanContext::BindVertexBuffer(VkCommandBuffer commandBuffer, VkVertexStreamBuffer &vertexBuffer, uint32_t streamCount) {
+    VkBuffer buffers[VERTEX_STREAM_MAX_ENUM];
+    streamCount = std::min(streamCount, vertexBuffer.streamCount);
+    for (uint32_t i = 0; i < streamCount; i++)
+        buffers[i] = vertexBuffer.buffer.buffer;
+    vkCmdBindVertexBuffers(commandBuffer, 0, streamCount, buffers, vertexBuffer.offsets);
+}
+
+void VulkanContext::BindIndexBuffer(VkCommandBuffer commandBuffer, VkDeviceBuffer &buffer, VkIndexType indexType) {
+    vkCmdBindIndexBuffer(commandBuffer, buffer.buffer, 0, indexType);
+}
+
+void VulkanContext::DrawIndexed(VkCommandBuffer commandBuffer, uint32_t indexCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance) {
+    vkCmdDrawIndexed(commandBuffer, indexCount, 1, firstIndex, vertexOffset, firstInstance);
+}
+
+void VulkanContext::CreateIndirectDrawList(uint32_t objectCount, const VkIndirectDrawObject *pObjects, VkIndirectDrawList *pDrawList) {
+    if (!m_IndirectDrawSupported)
+        throw std::runtime_error("indirect draw requires the drawIndirectFirstInstance feature!");
+
+    pDrawList->objectCount = objectCount;
+    /* count buffer 里的数量也不能超过 maxDrawIndirectCount */
+    pDrawList->compact = m_DrawIndirectCountSupported && objectCount <= m_PhysicalDeviceProperties.limits.maxDrawIndirectCount;
+
+    VkDeviceSize objectSize = (VkDeviceSize) objectCount * sizeof(VkIndirectDrawObject);
+    VkDeviceSize commandSize = (VkDeviceSize) objectCount * sizeof(VkDrawIndexedIndirectCommand);
+    AllocateBuffer(std::max<VkDeviceSize>(objectSize, sizeof(VkIndirectDrawObject)),
+                   VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &pDrawList->objectBuffer);
+    AllocateBuffer(std::max<VkDeviceSize>(commandSize, sizeof(VkDrawIndexedIndirectCommand)),
+                   VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &pDrawList->commandBuffer);
+    AllocateBuffer(sizeof(uint32_t), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &pDrawList->countBuffer);
+    if (objectCount != 0)
+        UploadBuffer(pDrawList->objectBuffer, 0, objectSize, pObjects);
+
+    VkDescriptorSetLayout setLayout = m_IndirectCuller->GetSetLayout();
+    m_DescriptorAllocator->Allocate(1, &setLayout, &pDrawList->descriptorSet);
+
+    VkDeviceBuffer *buffers[3] = { &pDrawList->objectBuffer, &pDrawList->commandBuffer, &pDrawList->countBuffer };
+    VkDescriptorBufferInfo bufferInfos[3];
+    VkWriteDescriptorSet writes[3] = {};
+    for (uint32_t i = 0; i < 3; i++) {
+        bufferInfos[i] = { buffers[i]->buffer, 0, VK_WHOLE_SIZE };
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = pDrawList->descriptorSet;
+        writes[i].dstBinding = i;
+        writes[i].descriptorCount = 1;
+        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[i].pBufferInfo = &bufferInfos[i];
+    }
+    vkUpdateDescriptorSets(m_Device, 3, writes, 0, null);
+}
+
+void VulkanContext::CullIndirectDrawList(VkCommandBuffer commandBuffer, VkIndirectDrawList &drawList, const glm::mat4 &viewProjection) {
+    m_IndirectCuller->Record(commandBuffer, drawList.descriptorSet, drawList.commandBuffer.buffer, drawList.countBuffer.buffer,
+                             drawList.objectCount, drawList.compact, viewProjection);
+}
+
+void VulkanContext::DrawIndexedIndirect(VkCommandBuffer commandBuffer, VkIndirectDrawList &drawList) {
+    const uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+    if (drawList.compact) {
+        vkCmdDrawIndexedIndirectCount(commandBuffer, drawList.commandBuffer.buffer, 0, drawList.countBuffer.buffer, 0,
+                                      drawList.objectCount, stride);
+        return;
+    }
+
+    /* 没有 count 时每个物体一条命令，被剔除的 instanceCount 为 0 */
+    uint32_t maxDrawCount = m_PhysicalDeviceFeature.multiDrawIndirect ? m_PhysicalDeviceProperties.limits.maxDrawIndirectCount : 1;
+    for (uint32_t first = 0; first < drawList.objectCount; first += maxDrawCount) {
+        uint32_t drawCount = std::min(maxDrawCount, drawList.objectCount - first);
+        vkCmdDrawIndexedIndirect(commandBuffer, drawList.commandBuffer.buffer, (VkDeviceSize) first * stride, drawCount, stride);
+    }
+}
+
+void VulkanContext::BindBindlessDescriptorSet(VkCommandBuffer commandBuffer, VkRenderPipeline &pipeline) {
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.pipelineLayout,
+                            VULKAN_BINDLESS_SET_INDEX, 1, &m_BindlessDescriptorSet, 0, null);
 }
 
 void VulkanContext::CreateRTTRenderContext(uint32_t width, uint32_t height, VkRTTRenderContext *pRenderContext) {
@@ -277,102 +770,103 @@ void VulkanContext::CreateRTTRenderContext(uint32_t width, uint32_t height, VkRT
                     VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &pRenderContext->texture);
     TransitionTextureLayout(&pRenderContext->texture, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
-    CreateFramebuffer(pRenderContext->renderpass, pRenderContext->texture.imageView, width, height, &pRenderContext->framebuffer);
-    AllocateCommandBuffer(1, &pRenderContext->commandBuffer);
     pRenderContext->width = width;
     pRenderContext->height = height;
 }
 
 void VulkanContext::AllocateVertexBuffer(VkDeviceSize size, const Vertex *pVertices, VkDeviceBuffer *pVertexBuffer) {
-    VkDeviceBuffer stagingBuffer;
-    AllocateBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &stagingBuffer);
-    void *data;
-    MapMemory(stagingBuffer, 0, stagingBuffer.size, 0, &data);
-    memcpy(data, pVertices, static_cast<VkDeviceSize>(stagingBuffer.size));
-    UnmapMemory(stagingBuffer);
-    /* vertex buffer */
     AllocateBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-                   VK_MEMORY_HEAP_DEVICE_LOCAL_BIT, pVertexBuffer);
-    CopyBuffer(*pVertexBuffer, stagingBuffer, size);
-    FreeBuffer(stagingBuffer);
+                   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, pVertexBuffer);
+    UploadBuffer(*pVertexBuffer, 0, size, pVertices);
+}
+
+void VulkanContext::AllocateVertexBuffer(VkDeviceSize size, const void *pVertexData, VkDeviceBuffer *pVertexBuffer) {
+    AllocateBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, pVertexBuffer);
+    UploadBuffer(*pVertexBuffer, 0, size, pVertexData);
+}
+
+void VulkanContext::AllocateVertexBuffer(const VertexLayout &layout, uint32_t vertexCount, const void *const *ppStreams, VkVertexStreamBuffer *pVertexBuffer) {
+    /* 所有流放在同一个 buffer 里，每个流起始位置按 16 字节对齐 */
+    VkDeviceSize size = 0;
+    pVertexBuffer->streamCount = layout.streamCount;
+    for (uint32_t i = 0; i < layout.streamCount; i++) {
+        size = (size + 15) & ~VkDeviceSize(15);
+        pVertexBuffer->offsets[i] = size;
+        size += (VkDeviceSize) vertexCount * layout.strides[i];
+    }
+
+    AllocateBuffer(std::max<VkDeviceSize>(size, 16), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &pVertexBuffer->buffer);
+    for (uint32_t i = 0; i < layout.streamCount; i++) {
+        if (vertexCount != 0)
+            UploadBuffer(pVertexBuffer->buffer, pVertexBuffer->offsets[i], (VkDeviceSize) vertexCount * layout.strides[i], ppStreams[i]);
+    }
 }
 
 void VulkanContext::AllocateIndexBuffer(VkDeviceSize size, const uint32_t *pIndices, VkDeviceBuffer *pIndexBuffer) {
-    VkDeviceBuffer stagingBuffer;
-    AllocateBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &stagingBuffer);
-    void *data;
-    MapMemory(stagingBuffer, 0, stagingBuffer.size, 0, &data);
-    memcpy(data, pIndices, static_cast<VkDeviceSize>(stagingBuffer.size));
-    UnmapMemory(stagingBuffer);
-    /* vertex buffer */
     AllocateBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-                   VK_MEMORY_HEAP_DEVICE_LOCAL_BIT, pIndexBuffer);
-    CopyBuffer(*pIndexBuffer, stagingBuffer, size);
-    FreeBuffer(stagingBuffer);
+                   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, pIndexBuffer);
+    UploadBuffer(*pIndexBuffer, 0, size, pIndices);
 }
 
-void VulkanContext::TransitionTextureLayout(VkTexture2D *texture, VkImageLayout newLayout) {
-    VkCommandBuffer commandBuffer;
-    BeginOnceTimeCommandBufferSubmit(&commandBuffer);
-
-    VkImageMemoryBarrier barrier = {};
-    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-    barrier.oldLayout = texture->layout;
-    barrier.newLayout = newLayout;
-    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    barrier.image = texture->image;
-    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = 1;
-    barrier.subresourceRange.baseArrayLayer = 0;
-    barrier.subresourceRange.layerCount = 1;
-
-    VkPipelineStageFlags sourceStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
-    VkPipelineStageFlags destinationStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
-
-    if (texture->layout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
-        barrier.srcAccessMask = 0;
-        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        goto PipelineBarrierCreateEndTag;
-    }
-
-    if (texture->layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
-        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-        goto PipelineBarrierCreateEndTag;
-    }
+void VulkanContext::AllocateIndexBuffer(VkDeviceSize size, const uint16_t *pIndices, VkDeviceBuffer *pIndexBuffer) {
+    AllocateBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+                   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, pIndexBuffer);
+    UploadBuffer(*pIndexBuffer, 0, size, pIndices);
+}
 
-    if (texture->layout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
-        barrier.srcAccessMask = 0;
-        barrier.dstAccessMask = VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_HOST_READ_BIT;
-        goto PipelineBarrierCreateEndTag;
+void VulkanContext::TransitionTextureLayout(VkTexture2D *texture, VkImageLayout newLayout) {
+    /* 不知道前后具体由谁访问，按布局推导最小的 stage 和 access */
+    VkPipelineStageFlags sourceStage = 0, destinationStage;
+    VkAccessFlags destinationAccess;
+    VulkanRenderGraph::GetImageLayoutScope(newLayout, &destinationStage, &destinationAccess);
+
+    /* 布局相同的连续 mip 合并成一个 barrier */
+    Vector<VkImageMemoryBarrier> barriers;
+    for (uint32_t level = 0; level < texture->mipLevels; level++) {
+        VkImageLayout oldLayout = texture->mipLayouts[level];
+        if (!barriers.empty() && barriers.back().oldLayout == oldLayout) {
+            ++barriers.back().subresourceRange.levelCount;
+            continue;
+        }
+
+        VkPipelineStageFlags stages;
+        VkAccessFlags access;
+        VulkanRenderGraph::GetImageLayoutScope(oldLayout, &stages, &access);
+        sourceStage |= stages;
+
+        VkImageMemoryBarrier barrier = {};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout = oldLayout;
+        barrier.newLayout = newLayout;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = texture->image;
+        barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, level, 1, 0, 1 };
+        /* 只有写需要 flush */
+        barrier.srcAccessMask = access & (VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                                          VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT |
+                                          VK_ACCESS_MEMORY_WRITE_BIT);
+        barrier.dstAccessMask = destinationAccess;
+        barriers.push_back(barrier);
     }
 
-    throw std::invalid_argument("unsupported layout transition!");
-
-PipelineBarrierCreateEndTag:
     vkCmdPipelineBarrier(
-            commandBuffer,
+            _GetImmediateCommandBuffer(),
             sourceStage,
             destinationStage,
             0,
             0, nullptr,
             0, nullptr,
-            1, &barrier
+            std::size(barriers), std::data(barriers)
     );
 
-    EndOnceTimeCommandBufferSubmit();
-
-    texture->layout = newLayout;
+    for (uint32_t level = 0; level < texture->mipLevels; level++)
+        texture->mipLayouts[level] = newLayout;
 }
 
 void VulkanContext::CopyTextureBuffer(VkDeviceBuffer &buffer, VkTexture2D &texture, uint32_t width, uint32_t height) {
-    VkCommandBuffer commandBuffer;
-    BeginOnceTimeCommandBufferSubmit(&commandBuffer);
-
     VkBufferImageCopy region = {};
     region.bufferOffset = 0;
     region.bufferRowLength = 0;
@@ -391,57 +885,551 @@ void VulkanContext::CopyTextureBuffer(VkDeviceBuffer &buffer, VkTexture2D &textu
     };
 
     vkCmdCopyBufferToImage(
-            commandBuffer,
+            _GetImmediateCommandBuffer(),
             buffer.buffer,
             texture.image,
             VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
             1,
             &region
     );
-
-    EndOnceTimeCommandBufferSubmit();
 }
 
 void VulkanContext::CreateTexture2D(const String &path, VkTexture2D *pTexture2D) {
+    timestamp64_t start = System::GetTimeNanos();
+
+    VkTextureData data;
+    _DecodeTexture2D(path, &data);
+    _CreateTexture2DFromData(data, pTexture2D);
+
+    ++m_TextureLoadStats.textureCount;
+    m_TextureLoadStats.loadMicros += (System::GetTimeNanos() - start) / 1000;
+}
+
+void VulkanContext::_DecodeTexture2D(const String &path, VkTextureData *pData) {
+    /* 烘焙过的同名 .ktx2 优先，直接上传压缩块，省掉解码 */
+    String cooked = path.substr(0, path.find_last_of('.')) + ".ktx2";
+    if (path == cooked || (m_PhysicalDeviceFeature.textureCompressionBC && std::filesystem::exists(cooked))) {
+        size_t size;
+        char *buf = IOUtils::Read(cooked, &size);
+        KTX2Texture texture;
+        try {
+            KTX2::Parse(buf, size, &texture);
+        } catch (...) {
+            IOUtils::Free(buf);
+            throw;
+        }
+
+        /* 只接受 BC 格式，每个 level 的大小必须和格式、尺寸算出来的一致 */
+        VkFormat format = static_cast<VkFormat>(texture.vkFormat);
+        const char *error = null;
+        if (_GetCompressedBlockSize(format) == 0 || std::size(texture.levelData) > VULKAN_MAX_MIP_LEVELS) {
+            error = "KTX2 texture format is not supported!";
+        } else {
+            for (uint32_t i = 0; i < std::size(texture.levelData) && error == null; i++) {
+                if (texture.levelSizes[i] != _GetTextureMipChainSize(format, texture.width, texture.height, i, i + 1))
+                    error = "KTX2 level size doesn't match its format!";
+            }
+        }
+        VkFormatProperties formatProperties;
+        vkGetPhysicalDeviceFormatProperties(m_PhysicalDevice, format, &formatProperties);
+        if (error == null && !(formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT))
+            error = "KTX2 texture format is not supported by the device!";
+        if (error != null) {
+            IOUtils::Free(buf);
+            throw std::runtime_error(error);
+        }
+
+        /* 文件里从最小的 level 开始存放，上传需要 level 0 在前紧密排列 */
+        pData->format = format;
+        pData->width = texture.width;
+        pData->height = texture.height;
+        pData->mipLevels = std::size(texture.levelData);
+        pData->levelCount = pData->mipLevels;
+        pData->compressed = true;
+        pData->pixels.clear();
+        for (uint32_t i = 0; i < pData->levelCount; i++)
+            pData->pixels.insert(pData->pixels.end(), texture.levelData[i], texture.levelData[i] + texture.levelSizes[i]);
+        IOUtils::Free(buf);
+        return;
+    }
+
     /* load image. */
     int texWidth, texHeight, texChannels;
     stbi_uc* pixels = stbi_load(getchr(path), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-    VkDeviceSize imageSize = texWidth * texHeight * 4;
     if (!pixels)
         throw std::runtime_error("failed to load texture image!");
 
-    /* 创建图像 */
+    /* 带完整的 mip 链，GPU 不能生成时在 CPU 上 box filter */
+    pData->format = VK_FORMAT_R8G8B8A8_UNORM;
+    pData->width = texWidth;
+    pData->height = texHeight;
+    pData->mipLevels = MipmapUtils::GetMipLevelCount(texWidth, texHeight);
+    pData->compressed = false;
+    if (m_MipmapGenerator->GetMethod(VK_FORMAT_R8G8B8A8_UNORM) == VULKAN_MIPMAP_METHOD_CPU) {
+        MipmapUtils::GenerateMipChain(pixels, texWidth, texHeight, 4, pData->mipLevels, &pData->pixels);
+        pData->levelCount = pData->mipLevels;
+    } else {
+        pData->pixels.assign(pixels, pixels + (size_t) texWidth * texHeight * 4);
+        pData->levelCount = 1;
+    }
+    stbi_image_free(pixels);
+}
+
+void VulkanContext::_CreateTexture2DFromData(const VkTextureData &data, VkTexture2D *pTexture2D, VkImageUsageFlags usage) {
     CreateTexture2D(
-            texWidth,
-            texHeight,
-            VK_FORMAT_R8G8B8A8_UNORM,
+            data.width,
+            data.height,
+            data.format,
             VK_IMAGE_TILING_OPTIMAL,
-            VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+            VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | usage,
             VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-            pTexture2D);
+            pTexture2D,
+            data.mipLevels);
 
-    // write buffer to image
-    VkDeviceBuffer stagingBuffer;
-    AllocateBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &stagingBuffer);
+    /* copy pixels to image through the staging ring */
+    UploadTexture2D(pTexture2D, data.width, data.height, std::size(data.pixels), std::data(data.pixels), data.levelCount);
 
-    void *data;
-    MapMemory(stagingBuffer, 0, imageSize, 0, &data);
-    memcpy(data, pixels, static_cast<size_t>(imageSize));
-    UnmapMemory(stagingBuffer);
+    if (data.compressed)
+        ++m_TextureLoadStats.compressedCount;
+    m_TextureLoadStats.imageBytes += pTexture2D->allocation.size;
+}
 
-    stbi_image_free(pixels);
+VkDeviceSize VulkanContext::_GetTextureMipChainSize(VkFormat format, uint32_t width, uint32_t height, uint32_t baseMip, uint32_t mipLevels) {
+    /* 解码出来的未压缩纹理都是 RGBA8 */
+    uint32_t blockSize = _GetCompressedBlockSize(format);
+    uint32_t blockDimension = blockSize != 0 ? 4 : 1;
+    if (blockSize == 0)
+        blockSize = 4;
+
+    VkDeviceSize size = 0;
+    for (uint32_t level = baseMip; level < mipLevels; level++)
+        size += (VkDeviceSize) ((std::max(1u, width >> level) + blockDimension - 1) / blockDimension) *
+                ((std::max(1u, height >> level) + blockDimension - 1) / blockDimension) * blockSize;
+    return size;
+}
+
+void VulkanContext::_TrimTextureData(VkTextureData *pData, uint32_t baseMip) {
+    if (baseMip == 0)
+        return;
 
-    /* copy buffer to image */
-    TransitionTextureLayout(pTexture2D, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-    CopyTextureBuffer(stagingBuffer, *pTexture2D, texWidth, texHeight);
-    TransitionTextureLayout(pTexture2D, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    if (pData->levelCount == pData->mipLevels) {
+        /* 完整的 mip 链直接去掉前面的 level */
+        size_t offset = _GetTextureMipChainSize(pData->format, pData->width, pData->height, 0, baseMip);
+        pData->pixels.erase(pData->pixels.begin(), pData->pixels.begin() + offset);
+        pData->levelCount -= baseMip;
+    } else {
+        /* 只有 level 0，在 CPU 上缩小到 baseMip，剩下的仍然交给 GPU 生成 */
+        Vector<uint8_t> level;
+        for (uint32_t i = 0; i < baseMip; i++) {
+            uint32_t width = std::max(1u, pData->width >> i);
+            uint32_t height = std::max(1u, pData->height >> i);
+            level.resize((size_t) std::max(1u, width >> 1) * std::max(1u, height >> 1) * 4);
+            MipmapUtils::Downsample(std::data(pData->pixels), width, height, 4, std::data(level));
+            pData->pixels.swap(level);
+        }
+        pData->pixels.resize((size_t) std::max(1u, pData->width >> baseMip) * std::max(1u, pData->height >> baseMip) * 4);
+        pData->levelCount = 1;
+    }
+
+    pData->width = std::max(1u, pData->width >> baseMip);
+    pData->height = std::max(1u, pData->height >> baseMip);
+    pData->mipLevels -= baseMip;
+}
+
+VkTextureHandle VulkanContext::LoadTexture2DAsync(const String &path, bool streamed) {
+    VkTextureHandle handle;
+    if (!m_FreeTextureHandles.empty()) {
+        handle = m_FreeTextureHandles.back();
+        m_FreeTextureHandles.pop_back();
+    } else {
+        handle = std::size(m_AsyncTextures);
+        m_AsyncTextures.push_back(std::make_unique<VkAsyncTexture>());
+    }
+
+    VkAsyncTexture &asyncTexture = *m_AsyncTextures[handle];
+    asyncTexture.residency = VULKAN_TEXTURE_RESIDENCY_LOADING;
+    asyncTexture.uploadSerial = 0;
+    asyncTexture.requestTime = System::GetTimeNanos();
+    asyncTexture.released = false;
+    asyncTexture.streamed = streamed;
+    asyncTexture.path = path;
+    asyncTexture.streamingMip = UINT32_MAX;
+    asyncTexture.lastUsedFrame = m_TextureStreamingFrame;
+    ++m_TextureLoadStats.asyncRequestCount;
+
+    _SubmitTextureDecode(handle, path, streamed ? VULKAN_TEXTURE_MIP_TAIL : 0);
+    return handle;
+}
+
+void VulkanContext::_SubmitTextureDecode(VkTextureHandle handle, const String &path, uint32_t baseMip) {
+    /* 解码在工作线程上进行，结果交给主线程在帧开始时上传 */
+    m_TextureLoadPool->Submit([this, handle, path, baseMip]() {
+        VkDecodedTexture decoded;
+        decoded.handle = handle;
+        decoded.failed = false;
+        try {
+            _DecodeTexture2D(path, &decoded.data);
+            decoded.sourceWidth = decoded.data.width;
+            decoded.sourceHeight = decoded.data.height;
+            decoded.sourceMipLevels = decoded.data.mipLevels;
+
+            /* 常驻不超过 ENGINE_CONFIG_TEXTURE_STREAMING_TAIL_SIZE 的最大 mip */
+            decoded.baseMip = baseMip;
+            if (baseMip == VULKAN_TEXTURE_MIP_TAIL) {
+                decoded.baseMip = 0;
+                while ((std::max(decoded.sourceWidth, decoded.sourceHeight) >> decoded.baseMip) > ENGINE_CONFIG_TEXTURE_STREAMING_TAIL_SIZE)
+                    ++decoded.baseMip;
+            }
+            _TrimTextureData(&decoded.data, decoded.baseMip);
+        } catch (const std::exception &e) {
+            decoded.failed = true;
+            decoded.error = strfmt("{}: {}", path, e.what());
+        }
+
+        std::lock_guard<std::mutex> lock(m_DecodedTextureMutex);
+        m_DecodedTextures.push_back(std::move(decoded));
+    });
+}
+
+VkTexture2D *VulkanContext::GetTexture2D(VkTextureHandle handle) {
+    VkAsyncTexture &asyncTexture = *m_AsyncTextures[handle];
+    return asyncTexture.residency == VULKAN_TEXTURE_RESIDENCY_RESIDENT ? &asyncTexture.texture : &m_PlaceholderTexture;
+}
 
-    FreeBuffer(stagingBuffer);
+VulkanTextureResidency VulkanContext::GetTextureResidency(VkTextureHandle handle) {
+    return m_AsyncTextures[handle]->residency;
+}
+
+void VulkanContext::RequestTexture2DMip(VkTextureHandle handle, uint32_t mip) {
+    VkAsyncTexture &asyncTexture = *m_AsyncTextures[handle];
+    if (!asyncTexture.streamed || asyncTexture.residency != VULKAN_TEXTURE_RESIDENCY_RESIDENT)
+        return;
+
+    asyncTexture.requestedMip = std::min(asyncTexture.requestedMip, mip);
+    asyncTexture.lastUsedFrame = m_TextureStreamingFrame;
+}
+
+void VulkanContext::RequestTexture2DScreenSize(VkTextureHandle handle, float screenPixels) {
+    VkAsyncTexture &asyncTexture = *m_AsyncTextures[handle];
+    if (!asyncTexture.streamed || asyncTexture.residency != VULKAN_TEXTURE_RESIDENCY_RESIDENT)
+        return;
+
+    RequestTexture2DMip(handle, MipmapUtils::GetScreenSpaceMip(asyncTexture.width, asyncTexture.height, screenPixels));
+}
+
+void VulkanContext::DestroyTexture2D(VkTextureHandle handle) {
+    VkAsyncTexture &asyncTexture = *m_AsyncTextures[handle];
+    switch (asyncTexture.residency) {
+        case VULKAN_TEXTURE_RESIDENCY_LOADING:
+        case VULKAN_TEXTURE_RESIDENCY_UPLOADING:
+            /* 还在解码或拷贝，完成后再销毁 */
+            asyncTexture.released = true;
+            return;
+        case VULKAN_TEXTURE_RESIDENCY_RESIDENT:
+            if (asyncTexture.streamingMip != UINT32_MAX) {
+                asyncTexture.released = true;
+                return;
+            }
+            if (asyncTexture.streamed) {
+                m_TextureStreamingStats.residentBytes -= _GetTextureMipChainSize(asyncTexture.texture.format, asyncTexture.width, asyncTexture.height,
+                                                                                 asyncTexture.residentMip, asyncTexture.mipLevels);
+                --m_TextureStreamingStats.streamedCount;
+            }
+            /* 句柄马上回收，纹理本身等在途帧的 fence */
+            _RetireTexture2D(asyncTexture.texture);
+            break;
+        default:
+            break;
+    }
+    _FreeTextureHandle(handle);
+}
+
+void VulkanContext::_FreeTextureHandle(VkTextureHandle handle) {
+    /* 回收后的句柄读出来是 FAILED，不会再被当成驻留的纹理 */
+    *m_AsyncTextures[handle] = VkAsyncTexture();
+    m_AsyncTextures[handle]->residency = VULKAN_TEXTURE_RESIDENCY_FAILED;
+    m_FreeTextureHandles.push_back(handle);
+}
+
+void VulkanContext::_ProcessTextureLoads() {
+    /* 上传批次的 fence 已经 signal 的纹理换成真正的图像 */
+    for (auto &batch : m_UploadBatches)
+        _RetireUploadBatch(batch, false);
+
+    for (size_t i = 0; i < std::size(m_UploadingTextures);) {
+        VkTextureHandle handle = m_UploadingTextures[i];
+        VkAsyncTexture &asyncTexture = *m_AsyncTextures[handle];
+        if (asyncTexture.uploadSerial > m_CompletedUploadSerial) {
+            ++i;
+            continue;
+        }
+
+        if (asyncTexture.streamingMip != UINT32_MAX) {
+            /* 流送进来的 mip 链替换旧的图像，旧图像可能还在被在途的帧采样 */
+            m_TextureStreamingStats.residentBytes -= _GetTextureMipChainSize(asyncTexture.texture.format, asyncTexture.width, asyncTexture.height,
+                                                                             asyncTexture.residentMip, asyncTexture.mipLevels);
+            _RetireTexture2D(asyncTexture.texture);
+            asyncTexture.texture = asyncTexture.streamingTexture;
+            asyncTexture.residentMip = asyncTexture.streamingMip;
+            asyncTexture.streamingMip = UINT32_MAX;
+            ++m_TextureStreamingStats.streamInCount;
+        } else {
+            asyncTexture.residency = VULKAN_TEXTURE_RESIDENCY_RESIDENT;
+            m_TextureLoadStats.lastLatencyMicros = (System::GetTimeNanos() - asyncTexture.requestTime) / 1000;
+            m_TextureLoadStats.totalLatencyMicros += m_TextureLoadStats.lastLatencyMicros;
+            ++m_TextureLoadStats.asyncResidentCount;
+        }
+        if (asyncTexture.released)
+            DestroyTexture2D(handle);
+
+        m_UploadingTextures[i] = m_UploadingTextures.back();
+        m_UploadingTextures.pop_back();
+    }
+
+    /* 每帧最多上传 ENGINE_CONFIG_TEXTURE_UPLOAD_BUDGET 字节，至少一张 */
+    Vector<VkDecodedTexture> decodedTextures;
+    {
+        std::lock_guard<std::mutex> lock(m_DecodedTextureMutex);
+        VkDeviceSize budget = 0;
+        size_t count = 0;
+        while (count < std::size(m_DecodedTextures) && (count == 0 || budget < ENGINE_CONFIG_TEXTURE_UPLOAD_BUDGET))
+            budget += std::size(m_DecodedTextures[count++].data.pixels);
+        decodedTextures.assign(std::make_move_iterator(m_DecodedTextures.begin()),
+                               std::make_move_iterator(m_DecodedTextures.begin() + count));
+        m_DecodedTextures.erase(m_DecodedTextures.begin(), m_DecodedTextures.begin() + count);
+    }
+
+    for (auto &decoded : decodedTextures) {
+        VkAsyncTexture &asyncTexture = *m_AsyncTextures[decoded.handle];
+
+        /* 已驻留的流送纹理，这是更精细的 mip 链 */
+        if (asyncTexture.residency == VULKAN_TEXTURE_RESIDENCY_RESIDENT) {
+            if (decoded.failed || asyncTexture.released) {
+                if (decoded.failed)
+                    System::ConsoleWrite("failed to stream texture {}", decoded.error);
+                m_TextureStreamingStats.residentBytes -= _GetTextureMipChainSize(asyncTexture.texture.format, asyncTexture.width, asyncTexture.height,
+                                                                                 asyncTexture.streamingMip, asyncTexture.mipLevels);
+                asyncTexture.streamingMip = UINT32_MAX;
+                if (asyncTexture.released)
+                    DestroyTexture2D(decoded.handle);
+                continue;
+            }
+
+            m_BackgroundUploads = true;
+            _CreateTexture2DFromData(decoded.data, &asyncTexture.streamingTexture, VK_IMAGE_USAGE_TRANSFER_SRC_BIT);
+            m_BackgroundUploads = false;
+            asyncTexture.uploadSerial = m_UploadBatchSubmitCount + (m_CurrentUploadBatch != null ? 1 : 0);
+            m_UploadingTextures.push_back(decoded.handle);
+            continue;
+        }
+
+        if (decoded.failed) {
+            System::ConsoleWrite("failed to load texture {}", decoded.error);
+            asyncTexture.residency = VULKAN_TEXTURE_RESIDENCY_FAILED;
+            ++m_TextureLoadStats.asyncFailedCount;
+            if (asyncTexture.released)
+                _FreeTextureHandle(decoded.handle);
+            continue;
+        }
+
+        if (asyncTexture.released) {
+            asyncTexture.residency = VULKAN_TEXTURE_RESIDENCY_FAILED;
+            _FreeTextureHandle(decoded.handle);
+            continue;
+        }
+
+        /* 流送纹理只加载了常驻的低 mip，缩小时要从旧图像拷贝 */
+        VkImageUsageFlags usage = 0;
+        if (asyncTexture.streamed) {
+            asyncTexture.width = decoded.sourceWidth;
+            asyncTexture.height = decoded.sourceHeight;
+            asyncTexture.mipLevels = decoded.sourceMipLevels;
+            asyncTexture.tailMip = decoded.baseMip;
+            asyncTexture.residentMip = decoded.baseMip;
+            asyncTexture.requestedMip = decoded.baseMip;
+            asyncTexture.desiredMip = decoded.baseMip;
+            m_TextureStreamingStats.residentBytes += _GetTextureMipChainSize(decoded.data.format, asyncTexture.width, asyncTexture.height,
+                                                                             decoded.baseMip, asyncTexture.mipLevels);
+            ++m_TextureStreamingStats.streamedCount;
+            usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        }
+
+        m_BackgroundUploads = true;
+        _CreateTexture2DFromData(decoded.data, &asyncTexture.texture, usage);
+        m_BackgroundUploads = false;
+        ++m_TextureLoadStats.textureCount;
+        /* 拷贝记录在当前批次里，等它提交后的序号；环满时可能已经提交了 */
+        asyncTexture.uploadSerial = m_UploadBatchSubmitCount + (m_CurrentUploadBatch != null ? 1 : 0);
+        asyncTexture.residency = VULKAN_TEXTURE_RESIDENCY_UPLOADING;
+        m_UploadingTextures.push_back(decoded.handle);
+    }
+
+    m_TextureLoadStats.asyncPendingCount = m_TextureLoadStats.asyncRequestCount - m_TextureLoadStats.asyncResidentCount -
+                                           m_TextureLoadStats.asyncFailedCount;
+}
+
+VkDeviceSize VulkanContext::_QueryTextureStreamingBudget() {
+    VkDeviceSize budget = ENGINE_CONFIG_TEXTURE_STREAMING_BUDGET;
+    if (!m_MemoryBudgetSupported)
+        return budget;
+
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT memoryBudgetProperties = {};
+    memoryBudgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+    VkPhysicalDeviceMemoryProperties2 memoryProperties2 = {};
+    memoryProperties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+    memoryProperties2.pNext = &memoryBudgetProperties;
+    vkGetPhysicalDeviceMemoryProperties2(m_PhysicalDevice, &memoryProperties2);
+
+    VkDeviceSize heapBudget = 0, heapUsage = 0;
+    for (uint32_t i = 0; i < memoryProperties2.memoryProperties.memoryHeapCount; i++) {
+        if (memoryProperties2.memoryProperties.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+            heapBudget += memoryBudgetProperties.heapBudget[i];
+            heapUsage += memoryBudgetProperties.heapUsage[i];
+        }
+    }
+
+    /* 除去其他资源（以及其他进程）占用的部分，留 10% 余量 */
+    VkDeviceSize otherUsage = heapUsage > m_TextureStreamingStats.residentBytes ? heapUsage - m_TextureStreamingStats.residentBytes : 0;
+    VkDeviceSize available = heapBudget > otherUsage ? (heapBudget - otherUsage) / 10 * 9 : 0;
+    return std::min(budget, available);
+}
+
+void VulkanContext::_UpdateTextureStreaming() {
+    ++m_TextureStreamingFrame;
+    VkDeviceSize budget = _QueryTextureStreamingBudget();
+    m_TextureStreamingStats.budgetBytes = budget;
+
+    /* 取上一帧的请求，没有被请求的纹理只需要常驻的低 mip */
+    Vector<VkTextureHandle> candidates;
+    uint32_t streamingCount = 0;
+    for (VkTextureHandle handle = 0; handle < std::size(m_AsyncTextures); handle++) {
+        VkAsyncTexture &asyncTexture = *m_AsyncTextures[handle];
+        if (!asyncTexture.streamed || asyncTexture.residency != VULKAN_TEXTURE_RESIDENCY_RESIDENT || asyncTexture.released)
+            continue;
+
+        asyncTexture.desiredMip = asyncTexture.requestedMip;
+        asyncTexture.requestedMip = asyncTexture.tailMip;
+        if (asyncTexture.streamingMip != UINT32_MAX)
+            ++streamingCount;
+        else if (asyncTexture.desiredMip < asyncTexture.residentMip)
+            candidates.push_back(handle);
+    }
+
+    /* 最近用到的优先，其次是差得最多的 */
+    std::sort(candidates.begin(), candidates.end(), [this](VkTextureHandle a, VkTextureHandle b) {
+        const VkAsyncTexture &x = *m_AsyncTextures[a];
+        const VkAsyncTexture &y = *m_AsyncTextures[b];
+        if (x.lastUsedFrame != y.lastUsedFrame)
+            return x.lastUsedFrame > y.lastUsedFrame;
+        return x.residentMip - x.desiredMip > y.residentMip - y.desiredMip;
+    });
+
+    for (VkTextureHandle handle : candidates) {
+        if (streamingCount >= ENGINE_CONFIG_TEXTURE_STREAMING_REQUESTS)
+            break;
+
+        /* 预算放不下时退而求其次，选一个放得下的较粗的 mip */
+        VkAsyncTexture &asyncTexture = *m_AsyncTextures[handle];
+        for (uint32_t mip = asyncTexture.desiredMip; mip < asyncTexture.residentMip; mip++) {
+            VkDeviceSize size = _GetTextureMipChainSize(asyncTexture.texture.format, asyncTexture.width, asyncTexture.height,
+                                                        mip, asyncTexture.mipLevels);
+            if (!_EvictTextureMips(budget, size))
+                continue;
+
+            /* 新旧图像在替换前同时存在，按新 mip 链的大小预留 */
+            m_TextureStreamingStats.residentBytes += size;
+            asyncTexture.streamingMip = mip;
+            _SubmitTextureDecode(handle, asyncTexture.path, mip);
+            ++streamingCount;
+            break;
+        }
+    }
+
+    /* 预算变小（其他资源占用了显存）时也要回收 */
+    _EvictTextureMips(budget, 0);
+}
+
+bool VulkanContext::_EvictTextureMips(VkDeviceSize budget, VkDeviceSize required) {
+    while (m_TextureStreamingStats.residentBytes + required > budget) {
+        /* 最久没用到、并且持有比需要更精细的 mip 的纹理，只缩到它需要的 mip */
+        VkAsyncTexture *victim = null;
+        for (auto &asyncTexture : m_AsyncTextures) {
+            if (!asyncTexture->streamed || asyncTexture->residency != VULKAN_TEXTURE_RESIDENCY_RESIDENT ||
+                asyncTexture->streamingMip != UINT32_MAX || asyncTexture->residentMip >= asyncTexture->desiredMip)
+                continue;
+            if (victim == null || asyncTexture->lastUsedFrame < victim->lastUsedFrame)
+                victim = asyncTexture.get();
+        }
+
+        if (victim == null)
+            return false;
+        _ShrinkTexture2D(*victim, victim->desiredMip);
+    }
+    return true;
+}
+
+void VulkanContext::_ShrinkTexture2D(VkAsyncTexture &asyncTexture, uint32_t mip) {
+    VkTexture2D &source = asyncTexture.texture;
+    uint32_t skip = mip - asyncTexture.residentMip;
+
+    /* 低 mip 已经在显存里，直接在 GPU 上拷贝，不用重新读文件 */
+    VkTexture2D texture;
+    CreateTexture2D(std::max(1u, source.width >> skip),
+                    std::max(1u, source.height >> skip),
+                    source.format,
+                    VK_IMAGE_TILING_OPTIMAL,
+                    VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                    &texture,
+                    source.mipLevels - skip);
+
+    TransitionTextureLayout(&source, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+    TransitionTextureLayout(&texture, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+    Vector<VkImageCopy> regions(texture.mipLevels);
+    for (uint32_t level = 0; level < texture.mipLevels; level++) {
+        VkImageCopy &region = regions[level];
+        region = {};
+        region.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, skip + level, 0, 1 };
+        region.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1 };
+        region.extent = { std::max(1u, texture.width >> level), std::max(1u, texture.height >> level), 1 };
+    }
+    vkCmdCopyImage(_GetImmediateCommandBuffer(), source.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                   texture.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, std::size(regions), std::data(regions));
+
+    TransitionTextureLayout(&texture, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    m_TextureStreamingStats.residentBytes -= _GetTextureMipChainSize(source.format, asyncTexture.width, asyncTexture.height,
+                                                                     asyncTexture.residentMip, asyncTexture.mipLevels);
+    m_TextureStreamingStats.residentBytes += _GetTextureMipChainSize(source.format, asyncTexture.width, asyncTexture.height,
+                                                                     mip, asyncTexture.mipLevels);
+    _RetireTexture2D(source);
+    asyncTexture.texture = texture;
+    asyncTexture.residentMip = mip;
+    ++m_TextureStreamingStats.evictionCount;
+}
+
+void VulkanContext::_RetireTexture2D(const VkTexture2D &texture) {
+    /* 在途的帧可能还在采样，等当前帧 fence 之后再销毁 */
+    _GetRetireFrameSyncContext().retiredTextures.push_back(texture);
+}
+
+VkFrameSyncContext &VulkanContext::_GetRetireFrameSyncContext() {
+    /* 帧外释放时最后提交的是上一帧，要等它的 fence；帧内就是当前帧 */
+    uint32_t frameCount = std::size(m_FrameSyncContexts);
+    return m_FrameSyncContexts[m_InsideFrame ? m_FrameIndex : (m_FrameIndex + frameCount - 1) % frameCount];
 }
 
 void VulkanContext::CreateTexture2D(int texWidth, int texHeight, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage,
-                                    VkMemoryPropertyFlags properties, VkTexture2D *pTexture2D) {
+                                    VkMemoryPropertyFlags properties, VkTexture2D *pTexture2D, uint32_t mipLevels,
+                                    const VkSamplerDesc &samplerDesc) {
+    if (mipLevels > VULKAN_MAX_MIP_LEVELS)
+        throw std::runtime_error("texture has too many mip levels!");
+
+    /* 需要生成 mip 的纹理加上生成方式要求的 usage */
+    if (mipLevels > 1)
+        usage |= VulkanMipmapGenerator::GetRequiredUsage(m_MipmapGenerator->GetMethod(format));
+
     /* Create image */
     VkImageCreateInfo imageCreateInfo = {};
     imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -449,7 +1437,7 @@ void VulkanContext::CreateTexture2D(int texWidth, int texHeight, VkFormat format
     imageCreateInfo.extent.width = static_cast<uint32_t>(texWidth);
     imageCreateInfo.extent.height = static_cast<uint32_t>(texHeight);
     imageCreateInfo.extent.depth = 1;
-    imageCreateInfo.mipLevels = 1;
+    imageCreateInfo.mipLevels = mipLevels;
     imageCreateInfo.arrayLayers = 1;
     imageCreateInfo.format = format;
     imageCreateInfo.tiling = tiling;
@@ -460,39 +1448,38 @@ void VulkanContext::CreateTexture2D(int texWidth, int texHeight, VkFormat format
     imageCreateInfo.flags = 0; // Optional
 
     pTexture2D->format = imageCreateInfo.format;
-    pTexture2D->layout = imageCreateInfo.initialLayout;
+    pTexture2D->width = imageCreateInfo.extent.width;
+    pTexture2D->height = imageCreateInfo.extent.height;
+    pTexture2D->mipLevels = mipLevels;
+    for (uint32_t level = 0; level < mipLevels; level++)
+        pTexture2D->mipLayouts[level] = imageCreateInfo.initialLayout;
 
     vkCreateImage(m_Device, &imageCreateInfo, VulkanUtils::Allocator, &pTexture2D->image);
 
     /* bind memory */
-    VkMemoryRequirements requirements;
-    vkGetImageMemoryRequirements(m_Device, pTexture2D->image, &requirements);
-
-    VkMemoryAllocateInfo allocInfo = {};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = requirements.size;
-    allocInfo.memoryTypeIndex = VulkanUtils::FindMemoryType(requirements.memoryTypeBits, m_PhysicalDevice, properties);
-
-    vkAllocateMemory(m_Device, &allocInfo, VulkanUtils::Allocator, &pTexture2D->memory);
-
-    vkBindImageMemory(m_Device, pTexture2D->image, pTexture2D->memory, 0);
+    m_MemoryAllocator->AllocateImageMemory(pTexture2D->image, properties, &pTexture2D->allocation);
 
     /* create image view */
     VkImageViewCreateInfo viewInfo = {};
     viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
     viewInfo.image = pTexture2D->image;
     viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
-    viewInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+    viewInfo.format = format;
     viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     viewInfo.subresourceRange.baseMipLevel = 0;
-    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.levelCount = mipLevels;
     viewInfo.subresourceRange.baseArrayLayer = 0;
     viewInfo.subresourceRange.layerCount = 1;
 
     vkCreateImageView(m_Device, &viewInfo, nullptr, &pTexture2D->imageView);
 
-    /* create sampler */
-    CreateTextureSampler2D(&pTexture2D->sampler);
+    /* 相同状态的纹理共用一个 sampler */
+    AcquireSampler(samplerDesc, &pTexture2D->sampler);
+
+    /* 可采样的纹理在 bindless 表里分配一个固定下标 */
+    pTexture2D->bindlessIndex = VULKAN_BINDLESS_INVALID_INDEX;
+    if (usage & VK_IMAGE_USAGE_SAMPLED_BIT)
+        _RegisterBindlessTexture(pTexture2D);
 }
 
 void VulkanContext::CreateFramebuffer(VkRenderPass renderpass, VkImageView imageView, int width, int height,
@@ -510,27 +1497,12 @@ void VulkanContext::CreateFramebuffer(VkRenderPass renderpass, VkImageView image
     vkCreateFramebuffer(m_Device, &framebufferCreateInfo, VulkanUtils::Allocator, pFramebuffer);
 }
 
-void VulkanContext::CreateTextureSampler2D(VkSampler *pSampler) {
-    /* create texture sampler */
-    VkSamplerCreateInfo samplerInfo = {};
-    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
-    samplerInfo.magFilter = VK_FILTER_LINEAR;
-    samplerInfo.minFilter = VK_FILTER_LINEAR;
-    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
-    samplerInfo.anisotropyEnable = VK_FALSE;
-    samplerInfo.maxAnisotropy = 16;
-    samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
-    samplerInfo.unnormalizedCoordinates = VK_FALSE;
-    samplerInfo.compareEnable = VK_FALSE;
-    samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
-    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-    samplerInfo.mipLodBias = 0.0f;
-    samplerInfo.minLod = 0.0f;
-    samplerInfo.maxLod = 0.0f;
-
-    vkCreateSampler(m_Device, &samplerInfo, VK_NULL_HANDLE, pSampler);
+void VulkanContext::AcquireSampler(const VkSamplerDesc &desc, VkSampler *pSampler) {
+    *pSampler = m_SamplerCache->Acquire(desc);
+}
+
+void VulkanContext::ReleaseSampler(VkSampler sampler) {
+    m_SamplerCache->Release(sampler);
 }
 
 void VulkanContext::CreateSemaphore(VkSemaphore *pSemaphore) {
@@ -540,6 +1512,17 @@ void VulkanContext::CreateSemaphore(VkSemaphore *pSemaphore) {
     vkCreateSemaphore(m_Device, &semaphoreCreateInfo, VulkanUtils::Allocator, pSemaphore);
 }
 
+void VulkanContext::CreateFence(VkFenceCreateFlags flags, VkFence *pFence) {
+    VkFenceCreateInfo fenceCreateInfo = {};
+    fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fenceCreateInfo.flags = flags;
+    vkCreateFence(m_Device, &fenceCreateInfo, VulkanUtils::Allocator, pFence);
+}
+
+void VulkanContext::WaitForFence(VkFence fence) {
+    vkWaitForFences(m_Device, 1, &fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+}
+
 void VulkanContext::CreateDescriptorSetLayout(std::vector<VkDescriptorSetLayoutBinding> &bindings, VkDescriptorSetLayoutCreateFlags flags, VkDescriptorSetLayout *pDescriptorSetLayout) {
     VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {};
     descriptorSetLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
@@ -550,174 +1533,54 @@ void VulkanContext::CreateDescriptorSetLayout(std::vector<VkDescriptorSetLayoutB
 }
 
 void VulkanContext::AllocateDescriptorSet(Vector<VkDescriptorSetLayout> &layouts, VkDescriptorSet *pDescriptorSet) {
-    /** Allocate descriptor set */
-    VkDescriptorSetAllocateInfo descriptorAllocateInfo = {};
-    descriptorAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    descriptorAllocateInfo.descriptorPool = m_DescriptorPool;
-    descriptorAllocateInfo.descriptorSetCount = std::size(layouts);
-    descriptorAllocateInfo.pSetLayouts = std::data(layouts);
-    vkAllocateDescriptorSets(m_Device, &descriptorAllocateInfo, pDescriptorSet);
+    /** Allocate long-lived descriptor set */
+    m_DescriptorAllocator->Allocate(std::size(layouts), std::data(layouts), pDescriptorSet);
+}
+
+void VulkanContext::AllocateFrameDescriptorSet(VkDescriptorSetLayout layout, VkDescriptorSet *pDescriptorSet) {
+    /* 只在当前帧有效，该帧 fence signal 后整体 reset */
+    m_FrameSyncContexts[m_FrameIndex].descriptorAllocator->Allocate(1, &layout, pDescriptorSet);
+}
+
+void VulkanContext::CreatePipelineDesc(const String &shaderfolder, const String &shadername, VkRenderPass renderPass, VkDescriptorSetLayout descriptorSetLayout, VkPipelineDesc *pDesc) {
+    *pDesc = {};
+    pDesc->shaderfolder = shaderfolder;
+    pDesc->shadername = shadername;
+    pDesc->renderPass = renderPass;
+    pDesc->descriptorSetLayout = descriptorSetLayout;
+
+    /* 默认使用 Vertex 顶点格式 */
+    SetPipelineVertexLayout(VertexLayout::CreateFloat(), pDesc);
+}
+
+void VulkanContext::CreatePipelineDesc(const String &shaderfolder, const String &shadername, VkRenderPass renderPass, VkDescriptorSetLayout descriptorSetLayout,
+                                       const VertexLayout &vertexLayout, VkPipelineDesc *pDesc) {
+    CreatePipelineDesc(shaderfolder, shadername, renderPass, descriptorSetLayout, pDesc);
+    SetPipelineVertexLayout(vertexLayout, pDesc);
+}
+
+void VulkanContext::SetPipelineVertexLayout(const VertexLayout &vertexLayout, VkPipelineDesc *pDesc) {
+    VkVertexInputBindingDescription bindings[VERTEX_STREAM_MAX_ENUM];
+    pDesc->vertexBindingCount = VulkanUtils::GetVertexInputBindingDescriptions(vertexLayout, bindings);
+    pDesc->vertexStrides = {};
+    for (uint32_t i = 0; i < pDesc->vertexBindingCount; i++)
+        pDesc->vertexStrides[i] = bindings[i].stride;
+    pDesc->vertexAttributes = {};
+    pDesc->vertexAttributeCount = VulkanUtils::GetVertexInputAttributeDescriptions(vertexLayout, std::data(pDesc->vertexAttributes));
 }
 
 void VulkanContext::CreateRenderPipeline(const String &shaderfolder, const String &shadername, VkRenderPass renderPass, VkDescriptorSetLayout descriptorSetLayout, VkRenderPipeline *pDriverGraphicsPipeline) {
-    /** Create shader of vertex & fragment module. */
-    VkShaderModule vertexShaderModule =
-            VulkanUtils::LoadShaderModule(m_Device, shaderfolder, shadername, VK_SHADER_STAGE_VERTEX_BIT);
-    VkShaderModule fragmentShaderModule =
-            VulkanUtils::LoadShaderModule(m_Device, shaderfolder, shadername, VK_SHADER_STAGE_FRAGMENT_BIT);
-
-    /** Create pipeline phase of vertex and fragment shader */
-    VkPipelineShaderStageCreateInfo pipelineVertexShaderStageCreateInfo = {};
-    pipelineVertexShaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    pipelineVertexShaderStageCreateInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-    pipelineVertexShaderStageCreateInfo.module = vertexShaderModule;
-    pipelineVertexShaderStageCreateInfo.pName = "main";
-
-    VkPipelineShaderStageCreateInfo pipelineFragmentStageCreateInfo = {};
-    pipelineFragmentStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    pipelineFragmentStageCreateInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-    pipelineFragmentStageCreateInfo.module = fragmentShaderModule;
-    pipelineFragmentStageCreateInfo.pName = "main";
-
-    VkPipelineShaderStageCreateInfo pipelineShaderStageCreateInfos[] = { pipelineVertexShaderStageCreateInfo, pipelineFragmentStageCreateInfo };
-
-    /* pipeline features */
-    VkPipelineVertexInputStateCreateInfo pipelineVertexInputStateCreateInfo = {};
-    pipelineVertexInputStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-
-    VkVertexInputBindingDescription vertexInputBindingDescription = VulkanUtils::GetVertexInputBindingDescription();
-    pipelineVertexInputStateCreateInfo.vertexBindingDescriptionCount = 1;
-    pipelineVertexInputStateCreateInfo.pVertexBindingDescriptions = &vertexInputBindingDescription;
-
-    auto vertexInputAttributeDescriptions = VulkanUtils::GetVertexInputAttributeDescriptionArray();
-    pipelineVertexInputStateCreateInfo.vertexAttributeDescriptionCount = std::size(vertexInputAttributeDescriptions);
-    pipelineVertexInputStateCreateInfo.pVertexAttributeDescriptions = std::data(vertexInputAttributeDescriptions);
-
-    VkPipelineInputAssemblyStateCreateInfo pipelineInputAssembly = {};
-    pipelineInputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-    pipelineInputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-    pipelineInputAssembly.primitiveRestartEnable = VK_FALSE;
-
-    VkViewport viewport;
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width = (float) m_MainSwapchainContext.width;
-    viewport.height = (float) m_MainSwapchainContext.width;
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
+    VkPipelineDesc desc;
+    CreatePipelineDesc(shaderfolder, shadername, renderPass, descriptorSetLayout, &desc);
+    CreateRenderPipeline(desc, pDriverGraphicsPipeline);
+}
 
-    VkRect2D scissor;
-    scissor.offset = {0, 0};
-    scissor.extent = { m_MainSwapchainContext.width, m_MainSwapchainContext.width };
-
-    /* 视口裁剪 */
-    VkPipelineViewportStateCreateInfo pipelineViewportStateCrateInfo = {};
-    pipelineViewportStateCrateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-    pipelineViewportStateCrateInfo.viewportCount = 1;
-    pipelineViewportStateCrateInfo.pViewports = &viewport;
-    pipelineViewportStateCrateInfo.scissorCount = 1;
-    pipelineViewportStateCrateInfo.pScissors = &scissor;
-
-    /* 光栅化阶段 */
-    VkPipelineRasterizationStateCreateInfo pipelineRasterizationStateCreateInfo = {};
-    pipelineRasterizationStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-    pipelineRasterizationStateCreateInfo.depthClampEnable = VK_FALSE;
-    pipelineRasterizationStateCreateInfo.rasterizerDiscardEnable = VK_FALSE;
-    pipelineRasterizationStateCreateInfo.polygonMode = VK_POLYGON_MODE_FILL;
-    pipelineRasterizationStateCreateInfo.lineWidth = 1.0f;
-    pipelineRasterizationStateCreateInfo.cullMode = VK_CULL_MODE_BACK_BIT;
-    pipelineRasterizationStateCreateInfo.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-    pipelineRasterizationStateCreateInfo.depthBiasEnable = VK_FALSE;
-    pipelineRasterizationStateCreateInfo.depthBiasConstantFactor = 0.0f; // Optional
-    pipelineRasterizationStateCreateInfo.depthBiasClamp = 0.0f; // Optional
-    pipelineRasterizationStateCreateInfo.depthBiasSlopeFactor = 0.0f; // Optional
-
-    /* 多重采样 */
-    VkPipelineMultisampleStateCreateInfo pipelineMultisampleStateCreateInfo = {};
-    pipelineMultisampleStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-    pipelineMultisampleStateCreateInfo.sampleShadingEnable = VK_FALSE;
-    pipelineMultisampleStateCreateInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-    pipelineMultisampleStateCreateInfo.minSampleShading = 1.0f; // Optional
-    pipelineMultisampleStateCreateInfo.pSampleMask = nullptr; // Optional
-    pipelineMultisampleStateCreateInfo.alphaToCoverageEnable = VK_FALSE; // Optional
-    pipelineMultisampleStateCreateInfo.alphaToOneEnable = VK_FALSE; // Optional
-
-    /* 颜色混合 */
-    VkPipelineColorBlendAttachmentState pipelineColorBlendAttachmentState = {};
-    pipelineColorBlendAttachmentState.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-    pipelineColorBlendAttachmentState.blendEnable = VK_FALSE;
-    pipelineColorBlendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_ONE; // Optional
-    pipelineColorBlendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO; // Optional
-    pipelineColorBlendAttachmentState.colorBlendOp = VK_BLEND_OP_ADD; // Optional
-    pipelineColorBlendAttachmentState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE; // Optional
-    pipelineColorBlendAttachmentState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO; // Optional
-    pipelineColorBlendAttachmentState.alphaBlendOp = VK_BLEND_OP_ADD; // Optional
-    pipelineColorBlendAttachmentState.blendEnable = VK_TRUE;
-    pipelineColorBlendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
-    pipelineColorBlendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
-    pipelineColorBlendAttachmentState.colorBlendOp = VK_BLEND_OP_ADD;
-    pipelineColorBlendAttachmentState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-    pipelineColorBlendAttachmentState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-    pipelineColorBlendAttachmentState.alphaBlendOp = VK_BLEND_OP_ADD;
-
-    /* 帧缓冲 */
-    VkPipelineColorBlendStateCreateInfo pipelineColorBlendStateCreateInfo = {};
-    pipelineColorBlendStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-    pipelineColorBlendStateCreateInfo.logicOpEnable = VK_FALSE;
-    pipelineColorBlendStateCreateInfo.logicOp = VK_LOGIC_OP_COPY; // Optional
-    pipelineColorBlendStateCreateInfo.attachmentCount = 1;
-    pipelineColorBlendStateCreateInfo.pAttachments = &pipelineColorBlendAttachmentState;
-    pipelineColorBlendStateCreateInfo.blendConstants[0] = 0.0f; // Optional
-    pipelineColorBlendStateCreateInfo.blendConstants[1] = 0.0f; // Optional
-    pipelineColorBlendStateCreateInfo.blendConstants[2] = 0.0f; // Optional
-    pipelineColorBlendStateCreateInfo.blendConstants[3] = 0.0f; // Optional
-
-    /* 动态修改 */
-    Vector<VkDynamicState> dynamicStates = {
-            VK_DYNAMIC_STATE_VIEWPORT,
-            VK_DYNAMIC_STATE_SCISSOR,
-            VK_DYNAMIC_STATE_LINE_WIDTH,
-    };
+void VulkanContext::CreateRenderPipeline(const VkPipelineDesc &desc, VkRenderPipeline *pDriverGraphicsPipeline) {
+    m_PipelineLibrary->GetPipeline(desc, pDriverGraphicsPipeline);
+}
 
-    VkPipelineDynamicStateCreateInfo pipelineDynamicStateCreateInfo = {};
-    pipelineDynamicStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-    pipelineDynamicStateCreateInfo.dynamicStateCount = std::size(dynamicStates);
-    pipelineDynamicStateCreateInfo.pDynamicStates = std::data(dynamicStates);
-
-    /* 管道布局 */
-    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
-    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 1;
-    pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
-    pipelineLayoutInfo.pushConstantRangeCount = 0;
-
-    vkCreatePipelineLayout(m_Device, &pipelineLayoutInfo, VulkanUtils::Allocator, &pDriverGraphicsPipeline->pipelineLayout);
-
-    /** Create graphics pipeline in vulkan. */
-    VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo = {};
-    graphicsPipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    graphicsPipelineCreateInfo.stageCount = 2;
-    graphicsPipelineCreateInfo.pStages = pipelineShaderStageCreateInfos;
-    graphicsPipelineCreateInfo.pVertexInputState = &pipelineVertexInputStateCreateInfo;
-    graphicsPipelineCreateInfo.pInputAssemblyState = &pipelineInputAssembly;
-    graphicsPipelineCreateInfo.pViewportState = &pipelineViewportStateCrateInfo;
-    graphicsPipelineCreateInfo.pRasterizationState = &pipelineRasterizationStateCreateInfo;
-    graphicsPipelineCreateInfo.pMultisampleState = &pipelineMultisampleStateCreateInfo;
-    graphicsPipelineCreateInfo.pDepthStencilState = nullptr; // Optional
-    graphicsPipelineCreateInfo.pColorBlendState = &pipelineColorBlendStateCreateInfo;
-    graphicsPipelineCreateInfo.pDynamicState = &pipelineDynamicStateCreateInfo; // Optional
-    graphicsPipelineCreateInfo.layout = pDriverGraphicsPipeline->pipelineLayout;
-    graphicsPipelineCreateInfo.renderPass = renderPass;
-    graphicsPipelineCreateInfo.subpass = 0;
-    graphicsPipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE; // Optional
-    graphicsPipelineCreateInfo.basePipelineIndex = -1; // Optional
-
-    vkCreateGraphicsPipelines(m_Device, null, 1, &graphicsPipelineCreateInfo,
-                              VulkanUtils::Allocator, &pDriverGraphicsPipeline->pipeline);
-
-    /* 销毁着色器模块 */
-    vkDestroyShaderModule(m_Device, vertexShaderModule, VulkanUtils::Allocator);
-    vkDestroyShaderModule(m_Device, fragmentShaderModule, VulkanUtils::Allocator);
+bool VulkanContext::AcquireRenderPipeline(const VkPipelineDesc &desc, const VkPipelineDesc *pFallback, VkRenderPipeline *pDriverGraphicsPipeline) {
+    return m_PipelineLibrary->AcquirePipeline(desc, pFallback, pDriverGraphicsPipeline);
 }
 
 void VulkanContext::AllocateCommandBuffer(uint32_t count, VkCommandBuffer *pCommandBuffer) {
@@ -741,23 +1604,15 @@ void VulkanContext::AllocateBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
     bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
     vkCreateBuffer(m_Device, &bufferCreateInfo, VulkanUtils::Allocator, &buffer->buffer);
 
-    /** Query memory requirements. */
-    VkMemoryRequirements memoryRequirements;
-    vkGetBufferMemoryRequirements(m_Device, buffer->buffer, &memoryRequirements);
-
-    VkMemoryAllocateInfo memoryAllocInfo = {};
-    memoryAllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    memoryAllocInfo.allocationSize = memoryRequirements.size;
-    memoryAllocInfo.memoryTypeIndex = VulkanUtils::FindMemoryType(memoryRequirements.memoryTypeBits, m_PhysicalDevice, properties);
-
-    vkAllocateMemory(m_Device, &memoryAllocInfo, VulkanUtils::Allocator, &buffer->memory);
-    vkBindBufferMemory(m_Device, buffer->buffer, buffer->memory, 0);
+    /** Sub-allocate and bind memory. */
+    m_MemoryAllocator->AllocateBufferMemory(buffer->buffer, properties, &buffer->allocation);
 }
 
 void VulkanContext::RecreateSwapchainContextKHR(VkSwapchainContextKHR *pSwapchainContext, uint32_t width, uint32_t height) {
     if (width <= 0 || height <= 0)
         return;
     DeviceWaitIdle();
+    m_RenderGraph->PurgeFramebuffers();
     DestroySwapchainContextKHR(pSwapchainContext);
     CreateSwapchainContextKHR(pSwapchainContext);
 }
@@ -818,10 +1673,18 @@ void VulkanContext::InitVulkanDriverContext() {
     _InitVulkanContextDevice();
     _InitVulkanContextWindowContext();
     _InitVulkanContextQueue();
+    _InitVulkanContextMemoryAllocator();
+    _InitVulkanContextSamplerCache();
+    _InitVulkanContextPipelineCache();
     _InitVulkanContextCommandPool();
+    _InitVulkanContextImmediateContext();
+    _InitVulkanContextStagingRing();
     _InitVulkanContextMainSwapchain();
-    _InitVulkanContextCommandBuffers();
+    _InitVulkanContextFrameSyncContexts();
+    _InitVulkanContextRenderGraph();
     _InitVulkanContextDescriptorPool();
+    _InitVulkanContextBindless();
+    _InitVulkanContextTextureLoader();
 
     m_ApplicationContext.Instance = m_Instance;
     m_ApplicationContext.Surface = m_SurfaceKHR;
@@ -832,6 +1695,7 @@ void VulkanContext::InitVulkanDriverContext() {
     m_ApplicationContext.Swapchain = m_MainSwapchainContext.swapchain;
     m_ApplicationContext.RenderPass = m_WindowContext.renderpass;
     m_ApplicationContext.CommandPool = m_CommandPool;
+    m_ApplicationContext.PipelineCache = m_PipelineCache->GetHandle();
     m_ApplicationContext.DescriptorPool = m_DescriptorPool;
     m_ApplicationContext.MinImageCount = m_MainSwapchainContext.minImageCount;
     m_ApplicationContext.FrameContext = &m_GFCTX;
@@ -841,8 +1705,8 @@ void VulkanContext::_InitVulkanContextInstance() {
     /* Create vulkan instance. */
     struct VkApplicationInfo applicationInfo = {};
     applicationInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
-    applicationInfo.apiVersion = VK_VERSION_1_3;
-    applicationInfo.apiVersion = VK_MAKE_VERSION(1, 0, 0);
+    /* timeline semaphore 需要 1.2 */
+    applicationInfo.apiVersion = VK_API_VERSION_1_2;
     applicationInfo.pApplicationName = ENGINE_NAME;
     applicationInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
     applicationInfo.pEngineName = ENGINE_NAME;
@@ -897,14 +1761,60 @@ void VulkanContext::_InitVulkanContextDevice() {
 
     m_GraphicsQueueFamily = queueFamilyIndices.graphicsQueueFamily;
     m_PresentQueueFamily = queueFamilyIndices.presentQueueFamily;
+    m_TransferQueueFamily = queueFamilyIndices.transferQueueFamily;
+
+    /* drawIndirectCount 只在 Vulkan12Features 里，和单独的 1.2 特性结构体不能同时出现 */
+    VkPhysicalDeviceVulkan12Features vulkan12Features = {};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+    VkPhysicalDeviceFeatures2 physicalDeviceFeatures2 = {};
+    physicalDeviceFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    physicalDeviceFeatures2.pNext = &vulkan12Features;
+    vkGetPhysicalDeviceFeatures2(m_PhysicalDevice, &physicalDeviceFeatures2);
+    if (!vulkan12Features.timelineSemaphore)
+        throw std::runtime_error("physical device does not support timeline semaphore!");
+
+    /* bindless 需要的 descriptor indexing 特性，不支持时退回逐材质 descriptor set */
+    m_BindlessSupported = vulkan12Features.runtimeDescriptorArray &&
+                          vulkan12Features.descriptorBindingPartiallyBound &&
+                          vulkan12Features.descriptorBindingSampledImageUpdateAfterBind &&
+                          vulkan12Features.descriptorBindingUpdateUnusedWhilePending &&
+                          vulkan12Features.shaderSampledImageArrayNonUniformIndexing;
+
+    /* GPU 剔除写 indirect 命令，firstInstance 用来索引物体数据，不支持时退回逐物体 DrawIndexed */
+    m_IndirectDrawSupported = m_PhysicalDeviceFeature.drawIndirectFirstInstance;
+    m_DrawIndirectCountSupported = m_IndirectDrawSupported && vulkan12Features.drawIndirectCount;
+
+    /* 只开启用到的特性 */
+    VkPhysicalDeviceVulkan12Features enabledVulkan12Features = {};
+    enabledVulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    enabledVulkan12Features.timelineSemaphore = VK_TRUE;
+    enabledVulkan12Features.runtimeDescriptorArray = m_BindlessSupported;
+    enabledVulkan12Features.descriptorBindingPartiallyBound = m_BindlessSupported;
+    enabledVulkan12Features.descriptorBindingSampledImageUpdateAfterBind = m_BindlessSupported;
+    enabledVulkan12Features.descriptorBindingUpdateUnusedWhilePending = m_BindlessSupported;
+    enabledVulkan12Features.shaderSampledImageArrayNonUniformIndexing = m_BindlessSupported;
+    enabledVulkan12Features.drawIndirectCount = m_DrawIndirectCountSupported;
 
     VkDeviceCreateInfo deviceCreateInfo = {};
     deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    deviceCreateInfo.pNext = &enabledVulkan12Features;
     static VkPhysicalDeviceFeatures features = {};
+    features.samplerAnisotropy = m_PhysicalDeviceFeature.samplerAnisotropy;
+    /* 烘焙出的 BCn 贴图 */
+    features.textureCompressionBC = m_PhysicalDeviceFeature.textureCompressionBC;
+    /* mipmap compute 回退路径写 storage image 不声明格式 */
+    features.shaderStorageImageWriteWithoutFormat = m_PhysicalDeviceFeature.shaderStorageImageWriteWithoutFormat;
+    features.multiDrawIndirect = m_PhysicalDeviceFeature.multiDrawIndirect;
+    features.drawIndirectFirstInstance = m_PhysicalDeviceFeature.drawIndirectFirstInstance;
     deviceCreateInfo.pEnabledFeatures = &features;
 
     static Vector<const char *> requiredEnableExtensions;
     VulkanUtils::GetVulkanDeviceRequiredExtensions(requiredEnableExtensions);
+    /* 可选扩展，纹理流送用来查询显存预算 */
+    m_MemoryBudgetSupported = VulkanUtils::IsDeviceExtensionSupported(m_PhysicalDevice, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    if (m_MemoryBudgetSupported)
+        requiredEnableExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
     deviceCreateInfo.enabledExtensionCount = std::size(requiredEnableExtensions);
     deviceCreateInfo.ppEnabledExtensionNames = std::data(requiredEnableExtensions);
 
@@ -921,14 +1831,62 @@ void VulkanContext::_InitVulkanContextDevice() {
 
 void VulkanContext::_InitVulkanContextWindowContext() {
     VulkanUtils::ConfigurationVulkanWindowContextDetail(m_PhysicalDevice, m_Window, m_SurfaceKHR, &m_WindowContext);
-    CreateSemaphore(&m_WindowContext.imageAvailableSemaphore);
-    CreateSemaphore(&m_WindowContext.renderFinishedSemaphore);
 }
 
 void VulkanContext::_InitVulkanContextQueue() {
     /* get queue */
     vkGetDeviceQueue(m_Device, m_GraphicsQueueFamily, 0, &m_GraphicsQueue);
     vkGetDeviceQueue(m_Device, m_PresentQueueFamily, 0, &m_PresentQueue);
+    vkGetDeviceQueue(m_Device, m_TransferQueueFamily, 0, &m_TransferQueue);
+
+#ifdef ENGINE_CONFIG_ENABLE_DEBUG
+    static const char *transferQueueMode = m_TransferQueueFamily != m_GraphicsQueueFamily ? "独立队列" : "共用 graphics 队列";
+    Vectraflux::AddDebuggerWatch("传输队列", VFLUX_DEBUGGER_WATCH_TYPE_STRING, transferQueueMode);
+#endif
+}
+
+void VulkanContext::_InitVulkanContextMemoryAllocator() {
+    m_MemoryAllocator = std::make_unique<VulkanMemoryAllocator>(m_PhysicalDevice, m_Device);
+
+#ifdef ENGINE_CONFIG_ENABLE_DEBUG
+    const VkDeviceMemoryStats &stats = m_MemoryAllocator->GetStats();
+    Vectraflux::AddDebuggerWatch("显存块数量", VFLUX_DEBUGGER_WATCH_TYPE_UINT64, &stats.blockCount);
+    Vectraflux::AddDebuggerWatch("显存块大小 (bytes)", VFLUX_DEBUGGER_WATCH_TYPE_UINT64, &stats.blockBytes);
+    Vectraflux::AddDebuggerWatch("显存已使用 (bytes)", VFLUX_DEBUGGER_WATCH_TYPE_UINT64, &stats.usedBytes);
+    Vectraflux::AddDebuggerWatch("显存分配数量", VFLUX_DEBUGGER_WATCH_TYPE_UINT64, &stats.allocationCount);
+    Vectraflux::AddDebuggerWatch("独立分配数量", VFLUX_DEBUGGER_WATCH_TYPE_UINT64, &stats.dedicatedAllocationCount);
+#endif
+}
+
+void VulkanContext::_InitVulkanContextSamplerCache() {
+    /* 各向异性在创建设备时按支持情况开启 */
+    m_SamplerCache = std::make_unique<VulkanSamplerCache>(m_Device, m_PhysicalDeviceFeature.samplerAnisotropy,
+                                                          m_PhysicalDeviceProperties.limits.maxSamplerAnisotropy);
+
+#ifdef ENGINE_CONFIG_ENABLE_DEBUG
+    const VkSamplerCacheStats &stats = m_SamplerCache->GetStats();
+    Vectraflux::AddDebuggerWatch("Sampler 数量", VFLUX_DEBUGGER_WATCH_TYPE_UINT32, &stats.samplerCount);
+    Vectraflux::AddDebuggerWatch("Sampler 缓存命中", VFLUX_DEBUGGER_WATCH_TYPE_UINT64, &stats.hitCount);
+#endif
+}
+
+void VulkanContext::_InitVulkanContextPipelineCache() {
+    m_PipelineCache = std::make_unique<VulkanPipelineCache>(m_Device, m_PhysicalDeviceProperties, ENGINE_CONFIG_PIPELINE_CACHE_FILE);
+    m_PipelineLibrary = std::make_unique<VulkanPipelineLibrary>(m_Device, m_PipelineCache.get(), ENGINE_CONFIG_PIPELINE_COMPILE_THREADS);
+    m_IndirectCuller = std::make_unique<VulkanIndirectCuller>(m_Device, m_PipelineCache->GetHandle());
+
+#ifdef ENGINE_CONFIG_ENABLE_DEBUG
+    /* 对比冷/热启动的管线创建耗时 */
+    VkPipelineCacheStats &stats = m_PipelineCache->GetStats();
+    Vectraflux::AddDebuggerWatch("管线缓存命中 (warm)", VFLUX_DEBUGGER_WATCH_TYPE_UINT32, &stats.warm);
+    Vectraflux::AddDebuggerWatch("管线缓存大小 (bytes)", VFLUX_DEBUGGER_WATCH_TYPE_UINT64, &stats.loadedBytes);
+    Vectraflux::AddDebuggerWatch("管线创建数量", VFLUX_DEBUGGER_WATCH_TYPE_UINT64, &stats.pipelineCount);
+    Vectraflux::AddDebuggerWatch("管线创建耗时 (us)", VFLUX_DEBUGGER_WATCH_TYPE_UINT64, &stats.createMicros);
+    const VkPipelineLibraryStats &libraryStats = m_PipelineLibrary->GetStats();
+    Vectraflux::AddDebuggerWatch("管线库命中", VFLUX_DEBUGGER_WATCH_TYPE_UINT64, &libraryStats.hitCount);
+    Vectraflux::AddDebuggerWatch("管线库未命中", VFLUX_DEBUGGER_WATCH_TYPE_UINT64, &libraryStats.missCount);
+    Vectraflux::AddDebuggerWatch("管线 fallback 次数", VFLUX_DEBUGGER_WATCH_TYPE_UINT64, &libraryStats.fallbackCount);
+#endif
 }
 
 void VulkanContext::_InitVulkanContextCommandPool() {
@@ -939,6 +1897,76 @@ void VulkanContext::_InitVulkanContextCommandPool() {
     commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
 
     vkCreateCommandPool(m_Device, &commandPoolCreateInfo, VulkanUtils::Allocator, &m_CommandPool);
+
+    /* 上传命令在传输队列族上录制 */
+    commandPoolCreateInfo.queueFamilyIndex = m_TransferQueueFamily;
+    vkCreateCommandPool(m_Device, &commandPoolCreateInfo, VulkanUtils::Allocator, &m_TransferCommandPool);
+}
+
+void VulkanContext::_InitVulkanContextImmediateContext() {
+    /* 短生命周期命令，整个 pool 一起 reset 而不是逐个释放 */
+    VkCommandPoolCreateInfo commandPoolCreateInfo = {};
+    commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    commandPoolCreateInfo.queueFamilyIndex = m_GraphicsQueueFamily;
+    commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    vkCreateCommandPool(m_Device, &commandPoolCreateInfo, VulkanUtils::Allocator, &m_ImmediateCommandPool);
+
+    VkCommandBufferAllocateInfo commandBufferAllocateInfo = {};
+    commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    commandBufferAllocateInfo.commandPool = m_ImmediateCommandPool;
+    commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    commandBufferAllocateInfo.commandBufferCount = 1;
+    vkAllocateCommandBuffers(m_Device, &commandBufferAllocateInfo, &m_ImmediateCommandBuffer);
+
+    CreateFence(0, &m_ImmediateFence);
+}
+
+void VulkanContext::_InitVulkanContextStagingRing() {
+    AllocateBuffer(ENGINE_CONFIG_STAGING_RING_SIZE, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &m_StagingBuffer);
+    m_StagingRing.Init(ENGINE_CONFIG_STAGING_RING_SIZE);
+
+    VkSemaphoreTypeCreateInfo semaphoreTypeCreateInfo = {};
+    semaphoreTypeCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    semaphoreTypeCreateInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    semaphoreTypeCreateInfo.initialValue = 0;
+
+    VkSemaphoreCreateInfo semaphoreCreateInfo = {};
+    semaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreCreateInfo.pNext = &semaphoreTypeCreateInfo;
+    if (vkCreateSemaphore(m_Device, &semaphoreCreateInfo, VulkanUtils::Allocator, &m_UploadTimelineSemaphore) != VK_SUCCESS)
+        throw std::runtime_error("failed to create upload timeline semaphore!");
+
+    VkCommandBufferAllocateInfo commandBufferAllocateInfo = {};
+    commandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    commandBufferAllocateInfo.commandPool = m_TransferCommandPool;
+    commandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    commandBufferAllocateInfo.commandBufferCount = 1;
+
+    for (auto &batch : m_UploadBatches) {
+        vkAllocateCommandBuffers(m_Device, &commandBufferAllocateInfo, &batch.commandBuffer);
+        AllocateCommandBuffer(1, &batch.acquireCommandBuffer);
+        CreateFence(0, &batch.fence);
+        batch.stagingHead = 0;
+        batch.timelineValue = 0;
+        batch.serial = 0;
+        batch.pending = false;
+        batch.frameRequired = false;
+        batch.acquired = false;
+        batch.descriptorAllocator = std::make_unique<VulkanDescriptorAllocator>(m_Device, 16);
+    }
+
+    m_MipmapGenerator = std::make_unique<VulkanMipmapGenerator>(m_Device, m_PhysicalDevice, m_PipelineCache->GetHandle(),
+                                                                m_PhysicalDeviceFeature.shaderStorageImageWriteWithoutFormat);
+
+#ifdef ENGINE_CONFIG_ENABLE_DEBUG
+    Vectraflux::AddDebuggerWatch("上传批次提交数", VFLUX_DEBUGGER_WATCH_TYPE_UINT64, &m_UploadBatchSubmitCount);
+    /* 对比 PNG 和烘焙过的 KTX2 的加载耗时与显存 */
+    Vectraflux::AddDebuggerWatch("纹理数量", VFLUX_DEBUGGER_WATCH_TYPE_UINT64, &m_TextureLoadStats.textureCount);
+    Vectraflux::AddDebuggerWatch("压缩纹理数量", VFLUX_DEBUGGER_WATCH_TYPE_UINT64, &m_TextureLoadStats.compressedCount);
+    Vectraflux::AddDebuggerWatch("纹理加载耗时 (us)", VFLUX_DEBUGGER_WATCH_TYPE_UINT64, &m_TextureLoadStats.loadMicros);
+    Vectraflux::AddDebuggerWatch("纹理显存 (bytes)", VFLUX_DEBUGGER_WATCH_TYPE_UINT64, &m_TextureLoadStats.imageBytes);
+#endif
 }
 
 void VulkanContext::_InitVulkanContextMainSwapchain() {
@@ -946,14 +1974,39 @@ void VulkanContext::_InitVulkanContextMainSwapchain() {
     CreateSwapchainContextKHR(&m_MainSwapchainContext);
 }
 
-void VulkanContext::_InitVulkanContextCommandBuffers() {
-    /* allocate */
-    m_CommandBuffers.resize(m_MainSwapchainContext.minImageCount);
-    AllocateCommandBuffer(std::size(m_CommandBuffers), std::data(m_CommandBuffers));
+void VulkanContext::_InitVulkanContextFrameSyncContexts() {
+    /* fence 初始为 signaled，第一帧不会阻塞 */
+    m_FrameSyncContexts.resize(ENGINE_CONFIG_MAX_FRAMES_IN_FLIGHT);
+    for (auto &frameSyncContext : m_FrameSyncContexts) {
+        AllocateCommandBuffer(1, &frameSyncContext.commandBuffer);
+        CreateSemaphore(&frameSyncContext.imageAvailableSemaphore);
+        CreateFence(VK_FENCE_CREATE_SIGNALED_BIT, &frameSyncContext.inFlightFence);
+        frameSyncContext.descriptorAllocator = std::make_unique<VulkanDescriptorAllocator>(m_Device, 64);
+    }
+}
+
+void VulkanContext::_InitVulkanContextRenderGraph() {
+    m_RenderGraph = std::make_unique<VulkanRenderGraph>(m_Device, m_MemoryAllocator.get(), ENGINE_CONFIG_MAX_FRAMES_IN_FLIGHT);
+
+#ifdef ENGINE_CONFIG_ENABLE_DEBUG
+    const VkRenderGraphStats &stats = m_RenderGraph->GetStats();
+    Vectraflux::AddDebuggerWatch("render graph pass 数", VFLUX_DEBUGGER_WATCH_TYPE_UINT32, &stats.passCount);
+    Vectraflux::AddDebuggerWatch("render graph 剔除 pass 数", VFLUX_DEBUGGER_WATCH_TYPE_UINT32, &stats.culledPassCount);
+    Vectraflux::AddDebuggerWatch("render graph barrier 次数", VFLUX_DEBUGGER_WATCH_TYPE_UINT32, &stats.barrierBatchCount);
+    Vectraflux::AddDebuggerWatch("render graph transient 内存", VFLUX_DEBUGGER_WATCH_TYPE_UINT64, &stats.transientMemoryBytes);
+#endif
 }
 
 void VulkanContext::_InitVulkanContextDescriptorPool() {
-    /** Create descriptor set pool */
+    /* 长期存在的 set 可以单独释放 */
+    m_DescriptorAllocator = std::make_unique<VulkanDescriptorAllocator>(m_Device, 256, true);
+
+#ifdef ENGINE_CONFIG_ENABLE_DEBUG
+    Vectraflux::AddDebuggerWatch("描述符 pool 数量", VFLUX_DEBUGGER_WATCH_TYPE_UINT64, &m_DescriptorAllocator->GetStats().poolCount);
+    Vectraflux::AddDebuggerWatch("描述符 set 数量", VFLUX_DEBUGGER_WATCH_TYPE_UINT64, &m_DescriptorAllocator->GetStats().setCount);
+#endif
+
+    /** Create descriptor set pool for ImGui, it frees sets individually */
     std::vector<VkDescriptorPoolSize> poolSizes = {
             {VK_DESCRIPTOR_TYPE_SAMPLER,                64},
             {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 64},
@@ -978,25 +2031,166 @@ void VulkanContext::_InitVulkanContextDescriptorPool() {
     vkCreateDescriptorPool(m_Device, &descriptorPoolCrateInfo, VulkanUtils::Allocator, &m_DescriptorPool);
 }
 
+void VulkanContext::_InitVulkanContextBindless() {
+    if (!m_BindlessSupported)
+        return;
+
+    VkPhysicalDeviceDescriptorIndexingProperties descriptorIndexingProperties = {};
+    descriptorIndexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+    VkPhysicalDeviceProperties2 physicalDeviceProperties2 = {};
+    physicalDeviceProperties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    physicalDeviceProperties2.pNext = &descriptorIndexingProperties;
+    vkGetPhysicalDeviceProperties2(m_PhysicalDevice, &physicalDeviceProperties2);
+
+    m_BindlessCapacity = std::min<uint32_t>(ENGINE_CONFIG_BINDLESS_TEXTURE_CAPACITY,
+                                            std::min(descriptorIndexingProperties.maxDescriptorSetUpdateAfterBindSampledImages,
+                                                     descriptorIndexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages));
+
+    /* 部分绑定 + 绑定后更新，新纹理不需要重新录制命令 */
+    VkDescriptorSetLayoutBinding binding = {};
+    binding.binding = 0;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    binding.descriptorCount = m_BindlessCapacity;
+    binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+    VkDescriptorBindingFlags bindingFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+                                            VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+                                            VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+    VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsCreateInfo = {};
+    bindingFlagsCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+    bindingFlagsCreateInfo.bindingCount = 1;
+    bindingFlagsCreateInfo.pBindingFlags = &bindingFlags;
+
+    VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {};
+    descriptorSetLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    descriptorSetLayoutCreateInfo.pNext = &bindingFlagsCreateInfo;
+    descriptorSetLayoutCreateInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+    descriptorSetLayoutCreateInfo.bindingCount = 1;
+    descriptorSetLayoutCreateInfo.pBindings = &binding;
+    if (vkCreateDescriptorSetLayout(m_Device, &descriptorSetLayoutCreateInfo, VulkanUtils::Allocator, &m_BindlessSetLayout) != VK_SUCCESS)
+        throw std::runtime_error("failed to create bindless descriptor set layout!");
+
+    VkDescriptorPoolSize poolSize = { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, m_BindlessCapacity };
+    VkDescriptorPoolCreateInfo descriptorPoolCrateInfo = {};
+    descriptorPoolCrateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    descriptorPoolCrateInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+    descriptorPoolCrateInfo.maxSets = 1;
+    descriptorPoolCrateInfo.poolSizeCount = 1;
+    descriptorPoolCrateInfo.pPoolSizes = &poolSize;
+    if (vkCreateDescriptorPool(m_Device, &descriptorPoolCrateInfo, VulkanUtils::Allocator, &m_BindlessDescriptorPool) != VK_SUCCESS)
+        throw std::runtime_error("failed to create bindless descriptor pool!");
+
+    VkDescriptorSetAllocateInfo descriptorAllocateInfo = {};
+    descriptorAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    descriptorAllocateInfo.descriptorPool = m_BindlessDescriptorPool;
+    descriptorAllocateInfo.descriptorSetCount = 1;
+    descriptorAllocateInfo.pSetLayouts = &m_BindlessSetLayout;
+    if (vkAllocateDescriptorSets(m_Device, &descriptorAllocateInfo, &m_BindlessDescriptorSet) != VK_SUCCESS)
+        throw std::runtime_error("failed to allocate bindless descriptor set!");
+
+#ifdef ENGINE_CONFIG_ENABLE_DEBUG
+    Vectraflux::AddDebuggerWatch("bindless 纹理数量", VFLUX_DEBUGGER_WATCH_TYPE_UINT32, &m_BindlessCount);
+#endif
+}
+
+void VulkanContext::_InitVulkanContextTextureLoader() {
+    m_TextureLoadPool = std::make_unique<ThreadPool>(ENGINE_CONFIG_TEXTURE_LOAD_THREADS);
+
+    /* 加载完成之前所有异步纹理都指向这张 1x1 白色纹理 */
+    const uint8_t white[4] = { 0xFF, 0xFF, 0xFF, 0xFF };
+    CreateTexture2D(1, 1, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_TILING_OPTIMAL,
+                    VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &m_PlaceholderTexture);
+    UploadTexture2D(&m_PlaceholderTexture, 1, 1, sizeof(white), white);
+
+#ifdef ENGINE_CONFIG_ENABLE_DEBUG
+    Vectraflux::AddDebuggerWatch("异步纹理请求数", VFLUX_DEBUGGER_WATCH_TYPE_UINT64, &m_TextureLoadStats.asyncRequestCount);
+    Vectraflux::AddDebuggerWatch("异步纹理加载中", VFLUX_DEBUGGER_WATCH_TYPE_UINT64, &m_TextureLoadStats.asyncPendingCount);
+    Vectraflux::AddDebuggerWatch("异步纹理已驻留", VFLUX_DEBUGGER_WATCH_TYPE_UINT64, &m_TextureLoadStats.asyncResidentCount);
+    Vectraflux::AddDebuggerWatch("异步纹理失败数", VFLUX_DEBUGGER_WATCH_TYPE_UINT64, &m_TextureLoadStats.asyncFailedCount);
+    Vectraflux::AddDebuggerWatch("异步纹理延迟 (us)", VFLUX_DEBUGGER_WATCH_TYPE_UINT64, &m_TextureLoadStats.lastLatencyMicros);
+    Vectraflux::AddDebuggerWatch("异步纹理总延迟 (us)", VFLUX_DEBUGGER_WATCH_TYPE_UINT64, &m_TextureLoadStats.totalLatencyMicros);
+    Vectraflux::AddDebuggerWatch("流送纹理数量", VFLUX_DEBUGGER_WATCH_TYPE_UINT64, &m_TextureStreamingStats.streamedCount);
+    Vectraflux::AddDebuggerWatch("流送显存 (bytes)", VFLUX_DEBUGGER_WATCH_TYPE_UINT64, &m_TextureStreamingStats.residentBytes);
+    Vectraflux::AddDebuggerWatch("流送预算 (bytes)", VFLUX_DEBUGGER_WATCH_TYPE_UINT64, &m_TextureStreamingStats.budgetBytes);
+    Vectraflux::AddDebuggerWatch("流送加载次数", VFLUX_DEBUGGER_WATCH_TYPE_UINT64, &m_TextureStreamingStats.streamInCount);
+    Vectraflux::AddDebuggerWatch("流送回收次数", VFLUX_DEBUGGER_WATCH_TYPE_UINT64, &m_TextureStreamingStats.evictionCount);
+#endif
+}
+
+void VulkanContext::_RegisterBindlessTexture(VkTexture2D *pTexture2D) {
+    if (!m_BindlessSupported)
+        return;
+
+    uint32_t index;
+    if (!m_BindlessFreeIndices.empty()) {
+        index = m_BindlessFreeIndices.back();
+        m_BindlessFreeIndices.pop_back();
+    } else {
+        if (m_BindlessCount >= m_BindlessCapacity)
+            throw std::runtime_error("bindless texture table is full!");
+        index = m_BindlessCount++;
+    }
+
+    VkDescriptorImageInfo imageInfo = {};
+    imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    imageInfo.imageView = pTexture2D->imageView;
+    imageInfo.sampler = pTexture2D->sampler;
+
+    VkWriteDescriptorSet writeDescriptorSet = {};
+    writeDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    writeDescriptorSet.dstSet = m_BindlessDescriptorSet;
+    writeDescriptorSet.dstBinding = 0;
+    writeDescriptorSet.dstArrayElement = index;
+    writeDescriptorSet.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    writeDescriptorSet.descriptorCount = 1;
+    writeDescriptorSet.pImageInfo = &imageInfo;
+    vkUpdateDescriptorSets(m_Device, 1, &writeDescriptorSet, 0, null);
+
+    pTexture2D->bindlessIndex = index;
+}
+
+void VulkanContext::_ReleaseBindlessTexture(VkTexture2D &texture) {
+    if (texture.bindlessIndex == VULKAN_BINDLESS_INVALID_INDEX)
+        return;
+
+    m_BindlessFreeIndices.push_back(texture.bindlessIndex);
+    texture.bindlessIndex = VULKAN_BINDLESS_INVALID_INDEX;
+}
+
 void VulkanContext::DestroyFramebuffer(VkFramebuffer &framebuffer) {
     vkDestroyFramebuffer(m_Device, framebuffer, VulkanUtils::Allocator);
 }
 
 void VulkanContext::DestroyRTTRenderContext(VkRTTRenderContext &context) {
+    /* 在途帧可能还在写或采样这张纹理，缓存的 framebuffer 也引用了它 */
+    DeviceWaitIdle();
+    m_RenderGraph->PurgeFramebuffers();
     DestroyRenderPass(context.renderpass);
     DestroyTexture2D(context.texture);
-    DestroyFramebuffer(context.framebuffer);
 }
 
 void VulkanContext::DestroyTexture2D(VkTexture2D &texture) {
-    vkDestroySampler(m_Device, texture.sampler, VulkanUtils::Allocator);
+    /* 在途的帧可能还在采样，图像、内存和 bindless 下标都等 fence 之后再释放 */
+    _RetireTexture2D(texture);
+}
+
+void VulkanContext::_DestroyTexture2DImmediate(VkTexture2D &texture) {
+    _ReleaseBindlessTexture(texture);
+    ReleaseSampler(texture.sampler);
     vkDestroyImageView(m_Device, texture.imageView, VulkanUtils::Allocator);
     vkDestroyImage(m_Device, texture.image, VulkanUtils::Allocator);
-    vkFreeMemory(m_Device, texture.memory, VulkanUtils::Allocator);
+    m_MemoryAllocator->FreeMemory(texture.allocation);
 }
 
 void VulkanContext::FreeDescriptorSets(uint32_t count, VkDescriptorSet *pDescriptorSet) {
-    vkFreeDescriptorSets(m_Device, m_DescriptorPool, count, pDescriptorSet);
+    /* 在途的帧可能还绑定着这些 set，fence 之后再还给分配器 */
+    VkFrameSyncContext &frameSyncContext = _GetRetireFrameSyncContext();
+    for (uint32_t i = 0; i < count; i++) {
+        if (pDescriptorSet[i] != null)
+            frameSyncContext.retiredDescriptorSets.push_back(pDescriptorSet[i]);
+        pDescriptorSet[i] = null;
+    }
 }
 
 void VulkanContext::DestroyDescriptorSetLayout(VkDescriptorSetLayout &descriptorSetLayout) {
@@ -1004,8 +2198,8 @@ void VulkanContext::DestroyDescriptorSetLayout(VkDescriptorSetLayout &descriptor
 }
 
 void VulkanContext::DestroyRenderPipeline(VkRenderPipeline &pipeline) {
-    vkDestroyPipeline(m_Device, pipeline.pipeline, VulkanUtils::Allocator);
-    vkDestroyPipelineLayout(m_Device, pipeline.pipelineLayout, VulkanUtils::Allocator);
+    /* 管线由 pipeline library 持有并共享，随 context 一起销毁 */
+    pipeline = {};
 }
 
 void VulkanContext::FreeCommandBuffer(uint32_t count, VkCommandBuffer *pCommandBuffer) {
@@ -1013,15 +2207,22 @@ void VulkanContext::FreeCommandBuffer(uint32_t count, VkCommandBuffer *pCommandB
 }
 
 void VulkanContext::FreeBuffer(VkDeviceBuffer &buffer) {
-    vkFreeMemory(m_Device, buffer.memory, VulkanUtils::Allocator);
     vkDestroyBuffer(m_Device, buffer.buffer, VulkanUtils::Allocator);
+    m_MemoryAllocator->FreeMemory(buffer.allocation);
+}
+
+void VulkanContext::DestroyIndirectDrawList(VkIndirectDrawList &drawList) {
+    FreeDescriptorSets(1, &drawList.descriptorSet);
+    FreeBuffer(drawList.objectBuffer);
+    FreeBuffer(drawList.commandBuffer);
+    FreeBuffer(drawList.countBuffer);
 }
 
 void VulkanContext::DestroySwapchainContextKHR(VkSwapchainContextKHR *pSwapchainContext) {
     DestroyRenderPass(m_WindowContext.renderpass);
-    for (int i = 0; i < pSwapchainContext->minImageCount; i++) {
+    for (uint32_t i = 0; i < pSwapchainContext->minImageCount; i++) {
         vkDestroyImageView(m_Device, pSwapchainContext->imageViews[i], VulkanUtils::Allocator);
-        DestroyFramebuffer(pSwapchainContext->framebuffers[i]);
+        vkDestroySemaphore(m_Device, pSwapchainContext->renderFinishedSemaphores[i], VulkanUtils::Allocator);
     }
     vkDestroySwapchainKHR(m_Device, pSwapchainContext->swapchain, VulkanUtils::Allocator);
 }
@@ -1030,6 +2231,10 @@ void VulkanContext::DestroyRenderPass(VkRenderPass renderPass) {
     vkDestroyRenderPass(m_Device, renderPass, VulkanUtils::Allocator);
 }
 
+void VulkanContext::DestroyFence(VkFence fence) {
+    vkDestroyFence(m_Device, fence, VulkanUtils::Allocator);
+}
+
 void VulkanContext::BeginCommandBuffer(VkCommandBuffer commandBuffer, VkCommandBufferUsageFlags usageFlags) {
     /* start command buffers record. */
     vkResetCommandBuffer(commandBuffer, /*VkCommandBufferResetFlagBits*/ 0);
@@ -1046,10 +2251,14 @@ void VulkanContext::EndCommandBuffer(VkCommandBuffer commandBuffer) {
         throw std::runtime_error("failed to record command buffer!");
 }
 
-void VulkanContext::SyncSubmitQueueWithSubmitInfo(uint32_t commandBufferCount, VkCommandBuffer *pCommandBuffers,
-                                                  uint32_t waitSemaphoreCount, VkSemaphore *pWaitSemaphores,
-                                                  uint32_t signalSemaphoreCount, VkSemaphore *pSignalSemaphores,
-                                                  VkPipelineStageFlags *pWaitDstStageMask) {
+void VulkanContext::SubmitQueueWithSubmitInfo(uint32_t commandBufferCount, VkCommandBuffer *pCommandBuffers,
+                                              uint32_t waitSemaphoreCount, VkSemaphore *pWaitSemaphores,
+                                              uint32_t signalSemaphoreCount, VkSemaphore *pSignalSemaphores,
+                                              VkPipelineStageFlags *pWaitDstStageMask, VkFence fence) {
+    /* 先让 graphics 队列等待已提交的上传，再提交累积的 immediate 命令 */
+    _SubmitUploadAcquires();
+    _SubmitImmediateCommands();
+
     /* submit command buffer */
     VkSubmitInfo submitInfo = {};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
@@ -1063,24 +2272,38 @@ void VulkanContext::SyncSubmitQueueWithSubmitInfo(uint32_t commandBufferCount, V
     submitInfo.signalSemaphoreCount = signalSemaphoreCount;
     submitInfo.pSignalSemaphores = pSignalSemaphores;
 
-    if (vkQueueSubmit(m_GraphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+    if (vkQueueSubmit(m_GraphicsQueue, 1, &submitInfo, fence) != VK_SUCCESS)
         throw std::runtime_error("failed to submit draw command buffer!");
-
-    vkQueueWaitIdle(m_GraphicsQueue);
 }
 
-void VulkanContext::BeginOnceTimeCommandBufferSubmit(VkCommandBuffer *pCommandBuffer) {
-    AllocateCommandBuffer(1, &m_SingleTimeCommandBuffer);
-    *pCommandBuffer = m_SingleTimeCommandBuffer;
-    /* begin */
-    BeginCommandBuffer(m_SingleTimeCommandBuffer, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+VkCommandBuffer VulkanContext::_GetImmediateCommandBuffer() {
+    if (!m_ImmediateRecording) {
+        /* 上一次提交完成后才能 reset pool */
+        if (m_ImmediateInFlight) {
+            WaitForFence(m_ImmediateFence);
+            m_ImmediateInFlight = false;
+        }
+        vkResetCommandPool(m_Device, m_ImmediateCommandPool, 0);
+
+        VkCommandBufferBeginInfo commandBufferBeginInfo = {};
+        commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        commandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkBeginCommandBuffer(m_ImmediateCommandBuffer, &commandBufferBeginInfo);
+        m_ImmediateRecording = true;
+    }
+
+    return m_ImmediateCommandBuffer;
 }
 
-void VulkanContext::EndOnceTimeCommandBufferSubmit() {
-    EndCommandBuffer(m_SingleTimeCommandBuffer);
-    /* submit */
-    SyncSubmitQueueWithSubmitInfo(1, &m_SingleTimeCommandBuffer, 0, NULL, 0, NULL, NULL);
-    FreeCommandBuffer(1, &m_SingleTimeCommandBuffer);
+void VulkanContext::_SubmitImmediateCommands() {
+    if (!m_ImmediateRecording)
+        return;
+
+    m_ImmediateRecording = false;
+    EndCommandBuffer(m_ImmediateCommandBuffer);
+    vkResetFences(m_Device, 1, &m_ImmediateFence);
+    SubmitQueueWithSubmitInfo(1, &m_ImmediateCommandBuffer, 0, null, 0, null, null, m_ImmediateFence);
+    m_ImmediateInFlight = true;
 }
 
 void VulkanContext::BeginRecordCommandBuffer(VkCommandBuffer commandBuffer) {
@@ -1091,26 +2314,6 @@ void VulkanContext::EndRecordCommandBuffer(VkCommandBuffer commandBuffer) {
     EndCommandBuffer(commandBuffer);
 }
 
-void VulkanContext::BeginRenderPass(VkCommandBuffer commandBuffer, uint32_t w, uint32_t h, VkRenderPass renderPass, VkFramebuffer framebuffer) {
-    /* start render pass. */
-    VkRenderPassBeginInfo renderPassBeginInfo = {};
-    renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassBeginInfo.renderPass = renderPass;
-    renderPassBeginInfo.framebuffer = framebuffer;
-    renderPassBeginInfo.renderArea.offset = {0, 0};
-    renderPassBeginInfo.renderArea.extent = { w, h };
-
-    VkClearValue clearColor = {0.0f, 0.0f, 0.0f, 1.0f};
-    renderPassBeginInfo.clearValueCount = 1;
-    renderPassBeginInfo.pClearValues = &clearColor;
-    vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-}
-
-void VulkanContext::EndRenderPass(VkCommandBuffer commandBuffer) {
-    /* end render pass */
-    vkCmdEndRenderPass(commandBuffer);
-}
-
 void VulkanContext::QueueWaitIdle(VkQueue queue) {
     vkQueueWaitIdle(queue);
 }
\ No newline at end of file
@@ -31,6 +31,30 @@
 #include <Engine.h>
 #include <stdexcept>
 #include <Math.h>
+#include "Render/Model/Vertex.h"
+#include "Render/Model/VertexLayout.h"
+#include <System.h>
+#include <mutex>
+#include "Utils/ThreadPool.h"
+#include "VulkanMemoryAllocator.h"
+#include "VulkanStagingRing.h"
+#include "VulkanPipelineCache.h"
+#include "VulkanPipelineLibrary.h"
+#include "VulkanDescriptorAllocator.h"
+#include "VulkanRenderGraph.h"
+#include "VulkanMipmapGenerator.h"
+#include "VulkanSamplerCache.h"
+#include "VulkanIndirectCuller.h"
+
+/* bindless 纹理表固定使用 set 1 */
+#define VULKAN_BINDLESS_SET_INDEX 1
+#define VULKAN_BINDLESS_INVALID_INDEX UINT32_MAX
+
+/* 同时在途的上传批次数量 */
+#define VULKAN_UPLOAD_BATCH_COUNT 4
+/* 上传结果可能被读取的阶段，acquire 只在这些阶段之前等待 */
+#define VULKAN_UPLOAD_ACQUIRE_STAGES (VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | \
+                                      VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT)
 
 class Window;
 
@@ -40,15 +64,14 @@ struct VkWindowContext {
     const Window *win;
     /* only create once */
     VkRenderPass renderpass;
-    VkSemaphore imageAvailableSemaphore;
-    VkSemaphore renderFinishedSemaphore;
 };
 
 struct VkSwapchainContextKHR {
     VkSwapchainKHR swapchain;
     Vector<VkImage> images;
     Vector<VkImageView> imageViews;
-    Vector<VkFramebuffer> framebuffers;
+    /* one per image: a present may still wait on it after the frame slot is reused */
+    Vector<VkSemaphore> renderFinishedSemaphores;
     const VkWindowContext *winctx;
     uint32_t minImageCount;
     uint32_t width;
@@ -61,32 +84,175 @@ struct VkSwapchainContextKHR {
 
 struct VkDeviceBuffer {
     VkBuffer buffer;
-    VkDeviceMemory memory;
+    VkDeviceMemoryAllocation allocation;
     VkDeviceSize size;
 };
 
-struct VkGraphicsFrameContext {
-    uint32_t index;
-    VkCommandBuffer commandBuffer;
-    VkFramebuffer framebuffer;
+/* 一个 buffer 里按 VertexLayout 的流依次存放，流 i 绑定到 binding i */
+struct VkVertexStreamBuffer {
+    VkDeviceBuffer buffer;
+    uint32_t streamCount;
+    VkDeviceSize offsets[VERTEX_STREAM_MAX_ENUM];
+};
+
+/* Draw arguments and bounds of objects that share the bound vertex and index
+ * buffers, culled into commandBuffer every frame by CullIndirectDrawList(). */
+struct VkIndirectDrawList {
+    VkDeviceBuffer objectBuffer; /* VkIndirectDrawObject[objectCount] */
+    VkDeviceBuffer commandBuffer; /* VkDrawIndexedIndirectCommand[objectCount] */
+    VkDeviceBuffer countBuffer; /* visible command count when compact */
+    VkDescriptorSet descriptorSet;
+    uint32_t objectCount;
+    bool compact; /* drawn with vkCmdDrawIndexedIndirectCount */
+};
+
+struct VkTexture2D {
     VkImage image;
     VkImageView imageView;
+    VkSampler sampler; /* shared, owned by the sampler cache */
+    VkFormat format;
     uint32_t width;
     uint32_t height;
+    uint32_t mipLevels;
+    VkImageLayout mipLayouts[VULKAN_MAX_MIP_LEVELS]; /* 每个 mip 单独记录布局 */
+    VkDeviceMemoryAllocation allocation;
+    uint32_t bindlessIndex; /* slot in the bindless texture table */
 };
 
-struct VkRenderPipeline {
-    VkPipeline pipeline;
-    VkPipelineLayout pipelineLayout;
+/* Per frame-in-flight synchronization, the CPU only blocks on inFlightFence
+ * when it runs ENGINE_CONFIG_MAX_FRAMES_IN_FLIGHT frames ahead of the GPU. */
+struct VkFrameSyncContext {
+    VkCommandBuffer commandBuffer;
+    VkSemaphore imageAvailableSemaphore;
+    VkFence inFlightFence;
+    /* transient sets, reset in bulk once inFlightFence signals */
+    std::unique_ptr<VulkanDescriptorAllocator> descriptorAllocator;
+    /* textures destroyed or replaced during this frame, released (bindless slot included)
+     * after inFlightFence */
+    Vector<VkTexture2D> retiredTextures;
+    /* long-lived sets freed during this frame, returned to the allocator after inFlightFence */
+    Vector<VkDescriptorSet> retiredDescriptorSets;
 };
 
-struct VkTexture2D {
+struct VkGraphicsFrameContext {
+    uint32_t index; /* swapchain image index */
+    uint32_t frameIndex; /* frame in flight index */
+    VkCommandBuffer commandBuffer;
     VkImage image;
     VkImageView imageView;
-    VkSampler sampler;
+    VkRenderGraphResource backbuffer; /* swapchain image in this frame's render graph */
+    uint32_t width;
+    uint32_t height;
+};
+
+/* Copies recorded into one command buffer and submitted together on the
+ * transfer queue. The batch signals timelineValue on the upload timeline, the
+ * graphics queue waits for it in a small acquire submit that also takes queue
+ * family ownership of the written resources. Batches holding only background
+ * texture loads are acquired once the timeline reached them, so frames never
+ * wait for them; direct uploads are acquired before the next graphics submit
+ * because the caller may use them right away. The staging ring space up to
+ * stagingHead is released once that acquire submit's fence signals. Mip
+ * chains of the uploaded textures are generated in the acquire submit. */
+struct VkUploadBatch {
+    VkCommandBuffer commandBuffer; /* transfer queue */
+    VkCommandBuffer acquireCommandBuffer; /* graphics queue */
+    VkFence fence;
+    uint64_t stagingHead;
+    uint64_t timelineValue;
+    uint64_t serial; /* submit order, starts at 1 */
+    bool pending;
+    bool acquired;
+    bool frameRequired; /* has direct uploads, acquire before the next graphics submit */
+    Vector<VkBufferMemoryBarrier> bufferAcquireBarriers;
+    Vector<VkImageMemoryBarrier> imageAcquireBarriers;
+    Vector<VkDeviceBuffer> temporaryBuffers; /* uploads larger than the ring */
+    Vector<VkMipmapJob> mipmapJobs;
+    Vector<VkImageView> temporaryImageViews; /* per-mip views of the compute fallback */
+    std::unique_ptr<VulkanDescriptorAllocator> descriptorAllocator;
+};
+
+struct VkTextureLoadStats {
+    uint64_t textureCount = 0;
+    uint64_t compressedCount = 0; /* loaded from cooked KTX2 */
+    uint64_t loadMicros = 0; /* file read + decode + staging copy */
+    uint64_t imageBytes = 0; /* device memory of the loaded textures */
+    /* LoadTexture2DAsync */
+    uint64_t asyncRequestCount = 0;
+    uint64_t asyncResidentCount = 0;
+    uint64_t asyncFailedCount = 0;
+    uint64_t asyncPendingCount = 0;
+    uint64_t lastLatencyMicros = 0; /* request to upload fence signaled */
+    uint64_t totalLatencyMicros = 0;
+};
+
+struct VkTextureStreamingStats {
+    uint64_t streamedCount = 0;
+    uint64_t residentBytes = 0; /* estimated from the resident mips */
+    uint64_t budgetBytes = 0;
+    uint64_t streamInCount = 0;
+    uint64_t evictionCount = 0;
+};
+
+typedef uint32_t VkTextureHandle;
+
+/* 流送纹理的初始加载，只解码常驻的低 mip */
+#define VULKAN_TEXTURE_MIP_TAIL UINT32_MAX
+
+enum VulkanTextureResidency {
+    VULKAN_TEXTURE_RESIDENCY_LOADING = 0, /* decoding on a worker thread */
+    VULKAN_TEXTURE_RESIDENCY_UPLOADING,
+    VULKAN_TEXTURE_RESIDENCY_RESIDENT,
+    VULKAN_TEXTURE_RESIDENCY_FAILED,
+};
+
+/* CPU side texture, decoded on any thread. pixels holds levelCount tightly
+ * packed levels starting at level 0, the rest of the chain is generated on
+ * the GPU. */
+struct VkTextureData {
     VkFormat format;
-    VkImageLayout layout;
-    VkDeviceMemory memory;
+    uint32_t width;
+    uint32_t height;
+    uint32_t mipLevels;
+    uint32_t levelCount;
+    bool compressed;
+    Vector<uint8_t> pixels;
+};
+
+/* Streamed textures only keep mips [residentMip, mipLevels) of the source,
+ * texture's level 0 is the source's residentMip. The mips up to tailMip are
+ * always resident, finer ones are streamed in on request and evicted LRU
+ * first when the budget is exceeded. */
+struct VkAsyncTexture {
+    VkTexture2D texture;
+    VulkanTextureResidency residency;
+    uint64_t uploadSerial; /* upload batch that copies the pixels */
+    timestamp64_t requestTime;
+    bool released; /* destroyed before the load finished */
+    /* streaming */
+    bool streamed;
+    String path;
+    uint32_t width; /* source size */
+    uint32_t height;
+    uint32_t mipLevels;
+    uint32_t tailMip;
+    uint32_t residentMip;
+    uint32_t requestedMip; /* finest mip requested during the current frame */
+    uint32_t desiredMip; /* requests of the previous frame */
+    uint32_t streamingMip; /* UINT32_MAX when nothing is in flight */
+    VkTexture2D streamingTexture;
+    uint64_t lastUsedFrame;
+};
+
+struct VkDecodedTexture {
+    VkTextureHandle handle;
+    VkTextureData data;
+    uint32_t baseMip; /* source mip of data's level 0 */
+    uint32_t sourceWidth;
+    uint32_t sourceHeight;
+    uint32_t sourceMipLevels;
+    bool failed;
+    String error;
 };
 
 struct VkApplicationContext {
@@ -98,27 +264,22 @@ struct VkApplicationContext {
     uint32_t GraphicsQueueFamily;
     VkSwapchainKHR Swapchain;
     VkCommandPool CommandPool;
+    VkPipelineCache PipelineCache;
     VkDescriptorPool DescriptorPool;
     uint32_t MinImageCount;
     VkRenderPass RenderPass;
     struct VkGraphicsFrameContext *FrameContext;
 };
 
+/* Render target sampled by the editor, drawn by a render graph pass. The
+ * render pass is only kept for creating compatible pipelines. */
 struct VkRTTRenderContext {
     VkRenderPass renderpass;
     VkTexture2D texture;
-    VkFramebuffer framebuffer;
-    VkCommandBuffer commandBuffer;
     uint32_t width;
     uint32_t height;
 };
 
-struct Vertex {
-    glm::vec3 position;
-    glm::vec3 color;
-    glm::vec2 texCoord;
-};
-
 /**
  * Vulkan context class.
  */
@@ -129,8 +290,18 @@ public:
 
     void GetApplicationContext(VkApplicationContext **ppApplicationContext) { *ppApplicationContext = &m_ApplicationContext; }
     void GetFrameContext(VkGraphicsFrameContext **pContext) { *pContext = &m_GFCTX; }
+    const VkDeviceMemoryStats &GetDeviceMemoryStats() const { return m_MemoryAllocator->GetStats(); }
+    VkPipelineCacheStats &GetPipelineCacheStats() { return m_PipelineCache->GetStats(); }
+    VulkanRenderGraph *GetRenderGraph() { return m_RenderGraph.get(); }
     void DeviceWaitIdle();
 
+    //
+    // Immediate commands (copies, layout transitions) accumulate in one
+    // transient command buffer. They are submitted ahead of the next graphics
+    // submit, FlushImmediateCommands() submits and waits for them right away.
+    //
+    void FlushImmediateCommands();
+
     //
     // About vulkan device buffer.
     //
@@ -139,16 +310,29 @@ public:
     void UnmapMemory(VkDeviceBuffer buffer);
 
     //
-    // Render to swapchain
+    // Batched uploads through the staging ring, flushed once per frame
+    // or explicitly per batch. Copies run on the transfer queue when the
+    // device has a dedicated one, so the destination must not be in use
+    // by the graphics queue (freshly created buffers and textures).
+    //
+    void UploadBuffer(VkDeviceBuffer &buffer, VkDeviceSize offset, VkDeviceSize size, const void *pData);
+    /* pPixels holds levelCount tightly packed levels starting at mip 0, the remaining levels are generated */
+    void UploadTexture2D(VkTexture2D *pTexture2D, uint32_t width, uint32_t height, VkDeviceSize size, const void *pPixels, uint32_t levelCount = 1);
+    void FlushUploads();
+
+    //
+    // Render to swapchain. Between begin and end passes are added to the
+    // render graph, the swapchain image is imported as frameContext->backbuffer
+    // and the graph is recorded and submitted by EndGraphicsRender().
     //
     void BeginGraphicsRender(VkGraphicsFrameContext **ppFrameContext = null);
     void EndGraphicsRender();
 
     //
-    // Render to texture
+    // Render to texture, adds a graph pass that clears and draws the texture.
+    // The pass is culled unless a later pass reads the returned resource.
     //
-    void BeginRTTRender(VkRTTRenderContext &renderContext, uint32_t width, uint32_t height);
-    void EndRTTRender(VkRTTRenderContext &renderContext);
+    VkRenderGraphResource AddRTTRenderPass(VkRTTRenderContext &renderContext, uint32_t width, uint32_t height, VkRenderGraphExecuteCallback execute);
     void RecreateRTTRenderContext(VkRTTRenderContext *pRenderContext, uint32_t width, uint32_t height);
     void AcquireRTTRenderTexture2D(VkRTTRenderContext &renderContext, VkTexture2D **ppTexture2D);
 
@@ -158,24 +342,78 @@ public:
     void BindRenderPipeline(VkCommandBuffer commandBuffer, uint32_t width, uint32_t height, VkRenderPipeline &pipeline);
     void BindDescriptorSets(VkCommandBuffer commandBuffer, VkRenderPipeline &pipeline, uint32_t count, VkDescriptorSet *pDescriptorSets);
     void WriteDescriptorSet(VkDeviceBuffer *pBuffer, VkTexture2D *pTexture, VkDescriptorSet descriptorSet);
-    void DrawIndexed(VkCommandBuffer commandBuffer, uint32_t indexCount);
+    /* binds streams [0, streamCount), depth-only passes bind just the position stream */
+    void BindVertexBuffer(VkCommandBuffer commandBuffer, VkVertexStreamBuffer &vertexBuffer, uint32_t streamCount = UINT32_MAX);
+    /* VK_INDEX_TYPE_UINT16 for meshes whose vertex count fits in 16 bits */
+    void BindIndexBuffer(VkCommandBuffer commandBuffer, VkDeviceBuffer &buffer, VkIndexType indexType);
+    void DrawIndexed(VkCommandBuffer commandBuffer, uint32_t indexCount, uint32_t firstIndex = 0, int32_t vertexOffset = 0, uint32_t firstInstance = 0);
+
+    //
+    // GPU driven drawing: per-object bounds and draw arguments live in
+    // storage buffers, a compute pass frustum culls them and writes the
+    // indirect commands, one vkCmdDrawIndexedIndirect(Count) draws them all.
+    // When unsupported use DrawIndexed per object instead.
+    //
+    bool IsIndirectDrawSupported() const { return m_IndirectDrawSupported; }
+    bool IsIndirectDrawCountSupported() const { return m_DrawIndirectCountSupported; }
+    void CreateIndirectDrawList(uint32_t objectCount, const VkIndirectDrawObject *pObjects, VkIndirectDrawList *pDrawList);
+    /* must be recorded outside of a render pass, e.g. in a render graph pass without attachments */
+    void CullIndirectDrawList(VkCommandBuffer commandBuffer, VkIndirectDrawList &drawList, const glm::mat4 &viewProjection);
+    void DrawIndexedIndirect(VkCommandBuffer commandBuffer, VkIndirectDrawList &drawList);
+
+    //
+    // Bindless textures: one set per frame, shaders index the table with
+    // an index from their own data, e.g. the instance's materialIndex. When
+    // descriptor indexing is unavailable use WriteDescriptorSet per material.
+    //
+    bool IsBindlessSupported() const { return m_BindlessSupported; }
+    VkDescriptorSetLayout GetBindlessDescriptorSetLayout() const { return m_BindlessSetLayout; }
+    void BindBindlessDescriptorSet(VkCommandBuffer commandBuffer, VkRenderPipeline &pipeline);
 
     //
     // Allocate and create buffer etc...
     //
     void CreateRTTRenderContext(uint32_t width, uint32_t height, VkRTTRenderContext *pContext);
     void AllocateVertexBuffer(VkDeviceSize size, const Vertex *pVertices, VkDeviceBuffer *pVertexBuffer);
+    /* already packed with the mesh's VertexLayout */
+    void AllocateVertexBuffer(VkDeviceSize size, const void *pVertexData, VkDeviceBuffer *pVertexBuffer);
+    /* ppStreams[i] holds vertexCount * layout.strides[i] bytes */
+    void AllocateVertexBuffer(const VertexLayout &layout, uint32_t vertexCount, const void *const *ppStreams, VkVertexStreamBuffer *pVertexBuffer);
     void AllocateIndexBuffer(VkDeviceSize size, const uint32_t *pIndices, VkDeviceBuffer *pIndexBuffer);
+    void AllocateIndexBuffer(VkDeviceSize size, const uint16_t *pIndices, VkDeviceBuffer *pIndexBuffer);
     void TransitionTextureLayout(VkTexture2D *texture, VkImageLayout newLayout);
     void CopyTextureBuffer(VkDeviceBuffer &buffer, VkTexture2D &texture, uint32_t width, uint32_t height);
+    /* a cooked <name>.ktx2 next to the image is preferred when the device supports BCn */
     void CreateTexture2D(const String &path, VkTexture2D *pTexture2D);
-    void CreateTexture2D(int texWidth, int texHeight, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkTexture2D *pTexture2D);
+    /* 立即返回，加载完成之前 GetTexture2D() 返回 1x1 的占位纹理。
+     * streamed 纹理只常驻低 mip，高 mip 由 RequestTexture2D*() 按需流送 */
+    VkTextureHandle LoadTexture2DAsync(const String &path, bool streamed = false);
+    VkTexture2D *GetTexture2D(VkTextureHandle handle);
+    VulkanTextureResidency GetTextureResidency(VkTextureHandle handle);
+    /* 每帧调用，取本帧所有请求里最精细的 mip */
+    void RequestTexture2DMip(VkTextureHandle handle, uint32_t mip);
+    /* screenPixels 是纹理在屏幕上覆盖的像素边长，见 MipmapUtils::EstimateScreenSize() */
+    void RequestTexture2DScreenSize(VkTextureHandle handle, float screenPixels);
+    VkTextureStreamingStats &GetTextureStreamingStats() { return m_TextureStreamingStats; }
+    void CreateTexture2D(int texWidth, int texHeight, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkTexture2D *pTexture2D, uint32_t mipLevels = 1, const VkSamplerDesc &samplerDesc = VkSamplerDesc());
     void CreateFramebuffer(VkRenderPass renderpass, VkImageView imageView, int width, int height, VkFramebuffer *pFramebuffer);
-    void CreateTextureSampler2D(VkSampler *pSampler);
+    /* samplers are shared by state, every Acquire needs a Release */
+    void AcquireSampler(const VkSamplerDesc &desc, VkSampler *pSampler);
+    void ReleaseSampler(VkSampler sampler);
     void CreateSemaphore(VkSemaphore *semaphore);
+    void CreateFence(VkFenceCreateFlags flags, VkFence *pFence);
+    void WaitForFence(VkFence fence);
     void CreateDescriptorSetLayout(std::vector<VkDescriptorSetLayoutBinding> &bindings, VkDescriptorSetLayoutCreateFlags flags, VkDescriptorSetLayout *pDescriptorSetLayout);
     void AllocateDescriptorSet(Vector<VkDescriptorSetLayout> &layouts, VkDescriptorSet *pDescriptorSet);
+    void AllocateFrameDescriptorSet(VkDescriptorSetLayout layout, VkDescriptorSet *pDescriptorSet);
+    void CreatePipelineDesc(const String &shaderfolder, const String &shadername, VkRenderPass renderPass, VkDescriptorSetLayout descriptorSetLayout, VkPipelineDesc *pDesc);
+    void CreatePipelineDesc(const String &shaderfolder, const String &shadername, VkRenderPass renderPass, VkDescriptorSetLayout descriptorSetLayout,
+                            const VertexLayout &vertexLayout, VkPipelineDesc *pDesc);
+    /* vertex input state generated from the layout, binding 0 */
+    void SetPipelineVertexLayout(const VertexLayout &vertexLayout, VkPipelineDesc *pDesc);
     void CreateRenderPipeline(const String &shaderfolder, const String &shadername, VkRenderPass renderPass, VkDescriptorSetLayout descriptorSetLayout, VkRenderPipeline *pDriverGraphicsPipeline);
+    void CreateRenderPipeline(const VkPipelineDesc &desc, VkRenderPipeline *pDriverGraphicsPipeline);
+    bool AcquireRenderPipeline(const VkPipelineDesc &desc, const VkPipelineDesc *pFallback, VkRenderPipeline *pDriverGraphicsPipeline);
     void AllocateCommandBuffer(uint32_t count, VkCommandBuffer *pCommandBuffer);
     void AllocateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkDeviceBuffer *buffer);
     void RecreateSwapchainContextKHR(VkSwapchainContextKHR *pSwapchainContext, uint32_t width, uint32_t height);
@@ -188,13 +426,16 @@ public:
     void DestroyFramebuffer(VkFramebuffer &framebuffer);
     void DestroyRTTRenderContext(VkRTTRenderContext &context);
     void DestroyTexture2D(VkTexture2D &texture);
+    void DestroyTexture2D(VkTextureHandle handle);
     void FreeDescriptorSets(uint32_t count, VkDescriptorSet *pDescriptorSet);
     void DestroyDescriptorSetLayout(VkDescriptorSetLayout &descriptorSetLayout);
     void DestroyRenderPipeline(VkRenderPipeline &pipeline);
     void FreeCommandBuffer(uint32_t count, VkCommandBuffer *pCommandBuffer);
     void FreeBuffer(VkDeviceBuffer &buffer);
+    void DestroyIndirectDrawList(VkIndirectDrawList &drawList);
     void DestroySwapchainContextKHR(VkSwapchainContextKHR *pSwapchainContext);
     void DestroyRenderPass(VkRenderPass renderPass);
+    void DestroyFence(VkFence fence);
 
 private:
     //
@@ -202,17 +443,36 @@ private:
     //
     void BeginCommandBuffer(VkCommandBuffer commandBuffer, VkCommandBufferUsageFlags usageFlags);
     void EndCommandBuffer(VkCommandBuffer commandBuffer);
-    void SyncSubmitQueueWithSubmitInfo(uint32_t commandBufferCount, VkCommandBuffer *pCommandBuffers,
-                                       uint32_t waitSemaphoreCount, VkSemaphore *pWaitSemaphores,
-                                       uint32_t signalSemaphoreCount, VkSemaphore *pSignalSemaphores,
-                                       VkPipelineStageFlags *pWaitDstStageMask);
-    void BeginOnceTimeCommandBufferSubmit(VkCommandBuffer *pCommandBuffer);
-    void EndOnceTimeCommandBufferSubmit();
+    void SubmitQueueWithSubmitInfo(uint32_t commandBufferCount, VkCommandBuffer *pCommandBuffers,
+                                   uint32_t waitSemaphoreCount, VkSemaphore *pWaitSemaphores,
+                                   uint32_t signalSemaphoreCount, VkSemaphore *pSignalSemaphores,
+                                   VkPipelineStageFlags *pWaitDstStageMask, VkFence fence);
+    VkCommandBuffer _GetImmediateCommandBuffer();
+    void _SubmitImmediateCommands();
     void BeginRecordCommandBuffer(VkCommandBuffer commandBuffer);
     void EndRecordCommandBuffer(VkCommandBuffer commandBuffer);
-    void BeginRenderPass(VkCommandBuffer commandBuffer, uint32_t w, uint32_t h, VkRenderPass renderPass, VkFramebuffer framebuffer);
-    void EndRenderPass(VkCommandBuffer commandBuffer);
     void QueueWaitIdle(VkQueue queue);
+    VkCommandBuffer _GetUploadCommandBuffer();
+    void *_ReserveStagingMemory(VkDeviceSize size, VkDeviceSize alignment, VkBuffer *pBuffer, VkDeviceSize *pOffset);
+    bool _RetireUploadBatch(VkUploadBatch &batch, bool wait);
+    /* acquires the batches that are finished, needed by the frame or not newer than requiredSerial */
+    void _SubmitUploadAcquires(uint64_t requiredSerial = 0);
+    void _RetireTexture2D(const VkTexture2D &texture);
+    void _DestroyTexture2DImmediate(VkTexture2D &texture); /* GPU 必须已经不再使用 */
+    /* frame whose inFlightFence covers every submit that may still use a resource released now */
+    VkFrameSyncContext &_GetRetireFrameSyncContext();
+    static uint32_t _GetCompressedBlockSize(VkFormat format);
+    void _DecodeTexture2D(const String &path, VkTextureData *pData);
+    void _CreateTexture2DFromData(const VkTextureData &data, VkTexture2D *pTexture2D, VkImageUsageFlags usage = 0);
+    void _SubmitTextureDecode(VkTextureHandle handle, const String &path, uint32_t baseMip);
+    void _FreeTextureHandle(VkTextureHandle handle);
+    void _ProcessTextureLoads();
+    static VkDeviceSize _GetTextureMipChainSize(VkFormat format, uint32_t width, uint32_t height, uint32_t baseMip, uint32_t mipLevels);
+    static void _TrimTextureData(VkTextureData *pData, uint32_t baseMip);
+    void _UpdateTextureStreaming();
+    VkDeviceSize _QueryTextureStreamingBudget();
+    bool _EvictTextureMips(VkDeviceSize budget, VkDeviceSize required);
+    void _ShrinkTexture2D(VkAsyncTexture &asyncTexture, uint32_t mip);
 
 private:
     void InitVulkanDriverContext(); /* Init VulkanContext main */
@@ -221,10 +481,20 @@ private:
     void _InitVulkanContextWindowContext();
     void _InitVulkanContextDevice();
     void _InitVulkanContextQueue();
+    void _InitVulkanContextMemoryAllocator();
+    void _InitVulkanContextSamplerCache();
+    void _InitVulkanContextPipelineCache();
     void _InitVulkanContextCommandPool();
+    void _InitVulkanContextImmediateContext();
+    void _InitVulkanContextStagingRing();
     void _InitVulkanContextMainSwapchain();
-    void _InitVulkanContextCommandBuffers();
+    void _InitVulkanContextFrameSyncContexts();
+    void _InitVulkanContextRenderGraph();
     void _InitVulkanContextDescriptorPool();
+    void _InitVulkanContextBindless();
+    void _InitVulkanContextTextureLoader();
+    void _RegisterBindlessTexture(VkTexture2D *pTexture2D);
+    void _ReleaseBindlessTexture(VkTexture2D &texture);
 
 private:
     void _CreateSwapcahinAboutComponents(VkSwapchainContextKHR *pSwapchainContext);
@@ -235,8 +505,44 @@ private:
     VkInstance m_Instance;
     VkSurfaceKHR m_SurfaceKHR;
     VkDevice m_Device;
+    std::unique_ptr<VulkanMemoryAllocator> m_MemoryAllocator;
+    std::unique_ptr<VulkanPipelineCache> m_PipelineCache;
+    std::unique_ptr<VulkanPipelineLibrary> m_PipelineLibrary;
+    std::unique_ptr<VulkanMipmapGenerator> m_MipmapGenerator;
+    std::unique_ptr<VulkanSamplerCache> m_SamplerCache;
+    std::unique_ptr<VulkanIndirectCuller> m_IndirectCuller;
     VkCommandPool m_CommandPool;
-    Vector<VkCommandBuffer> m_CommandBuffers;
+    VkCommandPool m_TransferCommandPool;
+    VkCommandPool m_ImmediateCommandPool; /* transient, reset as a whole */
+    VkCommandBuffer m_ImmediateCommandBuffer;
+    VkFence m_ImmediateFence;
+    bool m_ImmediateRecording = false;
+    bool m_ImmediateInFlight = false;
+    VkSemaphore m_UploadTimelineSemaphore;
+    uint64_t m_UploadTimelineValue = 0;
+    Vector<VkFrameSyncContext> m_FrameSyncContexts;
+    std::unique_ptr<VulkanRenderGraph> m_RenderGraph;
+    uint32_t m_FrameIndex = 0;
+    bool m_InsideFrame = false; /* between BeginGraphicsRender() and EndGraphicsRender() */
+    VkDeviceBuffer m_StagingBuffer;
+    VulkanStagingRing m_StagingRing;
+    Array<VkUploadBatch, VULKAN_UPLOAD_BATCH_COUNT> m_UploadBatches;
+    uint32_t m_UploadBatchIndex = 0;
+    VkUploadBatch *m_CurrentUploadBatch = null;
+    uint64_t m_UploadBatchSubmitCount = 0;
+    uint64_t m_CompletedUploadSerial = 0;
+    bool m_BackgroundUploads = false; /* set while _ProcessTextureLoads() records */
+    VkTextureLoadStats m_TextureLoadStats;
+    std::unique_ptr<ThreadPool> m_TextureLoadPool;
+    Vector<std::unique_ptr<VkAsyncTexture>> m_AsyncTextures; /* indexed by VkTextureHandle */
+    Vector<VkTextureHandle> m_FreeTextureHandles;
+    Vector<VkTextureHandle> m_UploadingTextures;
+    std::mutex m_DecodedTextureMutex;
+    Vector<VkDecodedTexture> m_DecodedTextures;
+    VkTexture2D m_PlaceholderTexture;
+    VkTextureStreamingStats m_TextureStreamingStats;
+    uint64_t m_TextureStreamingFrame = 0;
+    bool m_MemoryBudgetSupported = false;
     VkSwapchainContextKHR m_MainSwapchainContext;
 
     Window *m_Window;
@@ -245,11 +551,22 @@ private:
     VkPhysicalDeviceFeatures m_PhysicalDeviceFeature;
     uint32_t m_GraphicsQueueFamily;
     uint32_t m_PresentQueueFamily;
+    uint32_t m_TransferQueueFamily;
     VkQueue m_GraphicsQueue;
     VkQueue m_PresentQueue;
-    VkCommandBuffer m_SingleTimeCommandBuffer;
+    VkQueue m_TransferQueue;
     VkGraphicsFrameContext m_GFCTX;
-    VkDescriptorPool m_DescriptorPool;
+    VkDescriptorPool m_DescriptorPool; /* ImGui only */
+    std::unique_ptr<VulkanDescriptorAllocator> m_DescriptorAllocator; /* long-lived sets */
+    bool m_BindlessSupported = false;
+    VkDescriptorSetLayout m_BindlessSetLayout = null;
+    VkDescriptorPool m_BindlessDescriptorPool = null;
+    VkDescriptorSet m_BindlessDescriptorSet = null;
+    uint32_t m_BindlessCapacity = 0;
+    uint32_t m_BindlessCount = 0; /* high water mark */
+    Vector<uint32_t> m_BindlessFreeIndices;
+    bool m_IndirectDrawSupported = false;
+    bool m_DrawIndirectCountSupported = false;
     VkApplicationContext m_ApplicationContext;
     VkWindowContext m_WindowContext;
     String m_ApiVersion;
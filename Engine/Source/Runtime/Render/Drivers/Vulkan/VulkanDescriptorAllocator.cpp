@@ -0,0 +1,168 @@
+/* ************************************************************************
+ *
+ * Copyright (C) 2022 Vincent Luo All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, e1ither express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ************************************************************************/
+
+/* Creates on 2026/10/17. */
+
+/*
+  ===================================
+    @author bit-fashion
+  ===================================
+*/
+#include "VulkanDescriptorAllocator.h"
+#include <stdexcept>
+
+/* 单个 pool 最多能容纳的 set 数量 */
+#define DESCRIPTOR_POOL_MAX_SETS 4096
+
+/* 每个 set 平均需要的各类描述符数量 */
+static const struct {
+    VkDescriptorType type;
+    float ratio;
+} s_DescriptorPoolRatios[] = {
+        {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4.0f},
+        {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,          2.0f},
+        {VK_DESCRIPTOR_TYPE_SAMPLER,                1.0f},
+        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,         2.0f},
+        {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.0f},
+        {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,         2.0f},
+        {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,          1.0f},
+};
+
+VulkanDescriptorAllocator::VulkanDescriptorAllocator(VkDevice device, uint32_t setsPerPool, bool freeable)
+    : m_Device(device), m_SetsPerPool(setsPerPool), m_Freeable(freeable) {
+}
+
+VulkanDescriptorAllocator::~VulkanDescriptorAllocator() {
+    if (m_CurrentPool != VK_NULL_HANDLE)
+        vkDestroyDescriptorPool(m_Device, m_CurrentPool, nullptr);
+    for (VkDescriptorPool pool : m_UsedPools)
+        vkDestroyDescriptorPool(m_Device, pool, nullptr);
+    for (VkDescriptorPool pool : m_FreePools)
+        vkDestroyDescriptorPool(m_Device, pool, nullptr);
+}
+
+void VulkanDescriptorAllocator::Allocate(uint32_t count, const VkDescriptorSetLayout *pLayouts, VkDescriptorSet *pDescriptorSets) {
+    if (m_CurrentPool == VK_NULL_HANDLE)
+        m_CurrentPool = AcquirePool();
+
+    VkDescriptorSetAllocateInfo descriptorAllocateInfo = {};
+    descriptorAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    descriptorAllocateInfo.descriptorPool = m_CurrentPool;
+    descriptorAllocateInfo.descriptorSetCount = count;
+    descriptorAllocateInfo.pSetLayouts = pLayouts;
+
+    VkResult result = vkAllocateDescriptorSets(m_Device, &descriptorAllocateInfo, pDescriptorSets);
+
+    /* 可以单独释放的 pool 里可能有空位，先试已经串上的 pool */
+    for (size_t i = 0; m_Freeable && i < std::size(m_UsedPools) && (result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL); i++) {
+        descriptorAllocateInfo.descriptorPool = m_UsedPools[i];
+        result = vkAllocateDescriptorSets(m_Device, &descriptorAllocateInfo, pDescriptorSets);
+        if (result == VK_SUCCESS)
+            std::swap(m_UsedPools[i], m_CurrentPool);
+    }
+
+    if (result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL) {
+        /* 当前 pool 用完，串上一个新的再试一次 */
+        m_UsedPools.push_back(m_CurrentPool);
+        m_CurrentPool = AcquirePool();
+        descriptorAllocateInfo.descriptorPool = m_CurrentPool;
+        result = vkAllocateDescriptorSets(m_Device, &descriptorAllocateInfo, pDescriptorSets);
+    }
+
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("failed to allocate descriptor set!");
+
+    if (m_Freeable) {
+        for (uint32_t i = 0; i < count; i++)
+            m_SetPools[pDescriptorSets[i]] = m_CurrentPool;
+        m_PoolSetCounts[m_CurrentPool] += count;
+    }
+
+    m_Stats.setCount += count;
+}
+
+void VulkanDescriptorAllocator::Free(uint32_t count, const VkDescriptorSet *pDescriptorSets) {
+    if (!m_Freeable)
+        throw std::runtime_error("descriptor allocator can't free single sets!");
+
+    for (uint32_t i = 0; i < count; i++) {
+        auto it = m_SetPools.find(pDescriptorSets[i]);
+        if (it == m_SetPools.end())
+            continue;
+
+        VkDescriptorPool pool = it->second;
+        m_SetPools.erase(it);
+        vkFreeDescriptorSets(m_Device, pool, 1, &pDescriptorSets[i]);
+        --m_Stats.setCount;
+
+        /* 空出来的 pool 直接回收，不再占着串联的位置 */
+        if (--m_PoolSetCounts[pool] == 0 && pool != m_CurrentPool) {
+            m_UsedPools.remove(std::find(m_UsedPools.begin(), m_UsedPools.end(), pool) - m_UsedPools.begin());
+            vkResetDescriptorPool(m_Device, pool, 0);
+            m_FreePools.push_back(pool);
+        }
+    }
+}
+
+void VulkanDescriptorAllocator::Reset() {
+    if (m_CurrentPool != VK_NULL_HANDLE)
+        m_UsedPools.push_back(m_CurrentPool);
+    m_CurrentPool = VK_NULL_HANDLE;
+
+    for (VkDescriptorPool pool : m_UsedPools) {
+        vkResetDescriptorPool(m_Device, pool, 0);
+        m_FreePools.push_back(pool);
+    }
+    m_UsedPools.clear();
+    m_SetPools.clear();
+    m_PoolSetCounts.clear();
+    m_Stats.setCount = 0;
+}
+
+VkDescriptorPool VulkanDescriptorAllocator::AcquirePool() {
+    if (!m_FreePools.empty()) {
+        VkDescriptorPool pool = m_FreePools.back();
+        m_FreePools.pop_back();
+        return pool;
+    }
+
+    VkDescriptorPool pool = CreatePool(m_SetsPerPool);
+    /* 下一个 pool 更大一些，减少串联的数量 */
+    m_SetsPerPool = std::min(m_SetsPerPool + m_SetsPerPool / 2, (uint32_t) DESCRIPTOR_POOL_MAX_SETS);
+    return pool;
+}
+
+VkDescriptorPool VulkanDescriptorAllocator::CreatePool(uint32_t setCount) {
+    Vector<VkDescriptorPoolSize> poolSizes;
+    for (const auto &ratio : s_DescriptorPoolRatios)
+        poolSizes.push_back({ ratio.type, static_cast<uint32_t>(ratio.ratio * setCount) });
+
+    VkDescriptorPoolCreateInfo descriptorPoolCrateInfo = {};
+    descriptorPoolCrateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    descriptorPoolCrateInfo.poolSizeCount = static_cast<uint32_t>(std::size(poolSizes));
+    descriptorPoolCrateInfo.pPoolSizes = std::data(poolSizes);
+    descriptorPoolCrateInfo.maxSets = setCount;
+    descriptorPoolCrateInfo.flags = m_Freeable ? VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT : 0;
+
+    VkDescriptorPool pool;
+    if (vkCreateDescriptorPool(m_Device, &descriptorPoolCrateInfo, nullptr, &pool) != VK_SUCCESS)
+        throw std::runtime_error("failed to create descriptor pool!");
+
+    ++m_Stats.poolCount;
+    return pool;
+}
@@ -0,0 +1,74 @@
+/* ************************************************************************
+ *
+ * Copyright (C) 2022 Vincent Luo All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, e1ither express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ************************************************************************/
+
+/* Creates on 2026/10/17. */
+
+/*
+  ===================================
+    @author bit-fashion
+  ===================================
+*/
+#ifndef _VECTRAFLUX_VULKAN_DESCRIPTOR_ALLOCATOR_H_
+#define _VECTRAFLUX_VULKAN_DESCRIPTOR_ALLOCATOR_H_
+
+#include <vulkan/vulkan.h>
+#include <Typedef.h>
+
+struct VkDescriptorAllocatorStats {
+    uint64_t poolCount = 0;
+    uint64_t setCount = 0; /* sets allocated since the last reset */
+};
+
+/**
+ * Growable descriptor allocator. Sets are carved from plain pools (no
+ * FREE_DESCRIPTOR_SET_BIT) and released all at once by Reset(). When the
+ * current pool runs out another one is chained, each new pool being larger
+ * than the previous one up to a cap.
+ *
+ * A freeable allocator creates its pools with FREE_DESCRIPTOR_SET_BIT for
+ * long-lived sets: Free() returns single sets, pools with free space are
+ * tried again before a new one is chained and empty pools are recycled.
+ */
+class VulkanDescriptorAllocator {
+public:
+    VulkanDescriptorAllocator(VkDevice device, uint32_t setsPerPool, bool freeable = false);
+   ~VulkanDescriptorAllocator();
+
+    void Allocate(uint32_t count, const VkDescriptorSetLayout *pLayouts, VkDescriptorSet *pDescriptorSets);
+    /* freeable allocators only, the sets must no longer be used by pending command buffers */
+    void Free(uint32_t count, const VkDescriptorSet *pDescriptorSets);
+    void Reset();
+    const VkDescriptorAllocatorStats &GetStats() const { return m_Stats; }
+
+private:
+    VkDescriptorPool AcquirePool();
+    VkDescriptorPool CreatePool(uint32_t setCount);
+
+private:
+    VkDevice m_Device;
+    uint32_t m_SetsPerPool;
+    bool m_Freeable;
+    HashMap<VkDescriptorSet, VkDescriptorPool> m_SetPools; /* freeable only */
+    HashMap<VkDescriptorPool, uint32_t> m_PoolSetCounts; /* live sets per pool, freeable only */
+    VkDescriptorPool m_CurrentPool = VK_NULL_HANDLE;
+    Vector<VkDescriptorPool> m_UsedPools;
+    Vector<VkDescriptorPool> m_FreePools;
+    VkDescriptorAllocatorStats m_Stats;
+};
+
+#endif /* _VECTRAFLUX_VULKAN_DESCRIPTOR_ALLOCATOR_H_ */
@@ -0,0 +1,155 @@
+/* ************************************************************************
+ *
+ * Copyright (C) 2022 Vincent Luo All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, e1ither express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ************************************************************************/
+
+/* Creates on 2026/10/17. */
+
+/*
+  ===================================
+    @author bit-fashion
+  ===================================
+*/
+#include "VulkanIndirectCuller.h"
+#include <Engine.h>
+#include <System.h>
+#include "Utils/IOUtils.h"
+#include "Render/Camera/Frustum.h"
+#include <stdexcept>
+
+/* workgroup 大小，和 indirect_cull.comp 保持一致 */
+#define INDIRECT_CULL_GROUP_SIZE 64
+
+struct IndirectCullPushConstants {
+    Frustum frustum;
+    uint32_t objectCount;
+    uint32_t compact;
+};
+
+VulkanIndirectCuller::VulkanIndirectCuller(VkDevice device, VkPipelineCache pipelineCache)
+  : m_Device(device), m_PipelineCache(pipelineCache) {
+}
+
+VulkanIndirectCuller::~VulkanIndirectCuller() {
+    if (m_Pipeline != VK_NULL_HANDLE)
+        vkDestroyPipeline(m_Device, m_Pipeline, nullptr);
+    if (m_PipelineLayout != VK_NULL_HANDLE)
+        vkDestroyPipelineLayout(m_Device, m_PipelineLayout, nullptr);
+    if (m_SetLayout != VK_NULL_HANDLE)
+        vkDestroyDescriptorSetLayout(m_Device, m_SetLayout, nullptr);
+}
+
+VkDescriptorSetLayout VulkanIndirectCuller::GetSetLayout() {
+    if (m_Pipeline == VK_NULL_HANDLE)
+        _InitComputePipeline();
+    return m_SetLayout;
+}
+
+static VkBufferMemoryBarrier _BufferBarrier(VkBuffer buffer, VkAccessFlags srcAccess, VkAccessFlags dstAccess) {
+    VkBufferMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstAccessMask = dstAccess;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer = buffer;
+    barrier.offset = 0;
+    barrier.size = VK_WHOLE_SIZE;
+    return barrier;
+}
+
+void VulkanIndirectCuller::Record(VkCommandBuffer commandBuffer, VkDescriptorSet descriptorSet, VkBuffer drawCommandBuffer, VkBuffer countBuffer,
+                                  uint32_t objectCount, bool compact, const glm::mat4 &viewProjection) {
+    if (m_Pipeline == VK_NULL_HANDLE)
+        _InitComputePipeline();
+
+    /* 上一帧的 indirect 读取结束之后才能覆盖，WAR 只需要执行依赖 */
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                         VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, null, 0, null, 0, null);
+
+    if (compact) {
+        vkCmdFillBuffer(commandBuffer, countBuffer, 0, sizeof(uint32_t), 0);
+        VkBufferMemoryBarrier barrier = _BufferBarrier(countBuffer, VK_ACCESS_TRANSFER_WRITE_BIT,
+                                                       VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             0, 0, null, 1, &barrier, 0, null);
+    }
+
+    IndirectCullPushConstants pushConstants = { Frustum::FromMatrix(viewProjection), objectCount, compact ? 1u : 0u };
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_Pipeline);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_PipelineLayout, 0, 1, &descriptorSet, 0, null);
+    vkCmdPushConstants(commandBuffer, m_PipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), &pushConstants);
+    vkCmdDispatch(commandBuffer, (objectCount + INDIRECT_CULL_GROUP_SIZE - 1) / INDIRECT_CULL_GROUP_SIZE, 1, 1);
+
+    VkBufferMemoryBarrier barriers[2];
+    barriers[0] = _BufferBarrier(drawCommandBuffer, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
+    barriers[1] = _BufferBarrier(countBuffer, VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_INDIRECT_COMMAND_READ_BIT);
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+                         0, 0, null, compact ? 2 : 1, barriers, 0, null);
+}
+
+void VulkanIndirectCuller::_InitComputePipeline() {
+    VkDescriptorSetLayoutBinding bindings[3] = {};
+    for (uint32_t i = 0; i < 3; i++) {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo setLayoutCreateInfo = {};
+    setLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    setLayoutCreateInfo.bindingCount = 3;
+    setLayoutCreateInfo.pBindings = bindings;
+    if (vkCreateDescriptorSetLayout(m_Device, &setLayoutCreateInfo, nullptr, &m_SetLayout) != VK_SUCCESS)
+        throw std::runtime_error("failed to create indirect cull descriptor set layout!");
+
+    VkPushConstantRange pushConstantRange = { VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(IndirectCullPushConstants) };
+    VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {};
+    pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutCreateInfo.setLayoutCount = 1;
+    pipelineLayoutCreateInfo.pSetLayouts = &m_SetLayout;
+    pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+    pipelineLayoutCreateInfo.pPushConstantRanges = &pushConstantRange;
+    if (vkCreatePipelineLayout(m_Device, &pipelineLayoutCreateInfo, nullptr, &m_PipelineLayout) != VK_SUCCESS)
+        throw std::runtime_error("failed to create indirect cull pipeline layout!");
+
+    size_t size;
+    char *buf = IOUtils::Read(strfmt("{}/{}", ENGINE_CONFIG_SHADER_FOLDER, "indirect_cull.comp.spv"), &size);
+
+    VkShaderModuleCreateInfo shaderModuleCreateInfo = {};
+    shaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    shaderModuleCreateInfo.codeSize = size;
+    shaderModuleCreateInfo.pCode = reinterpret_cast<const uint32_t *>(buf);
+
+    VkShaderModule shaderModule;
+    VkResult result = vkCreateShaderModule(m_Device, &shaderModuleCreateInfo, nullptr, &shaderModule);
+    IOUtils::Free(buf);
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("failed to create indirect cull shader module!");
+
+    VkComputePipelineCreateInfo pipelineCreateInfo = {};
+    pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineCreateInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineCreateInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineCreateInfo.stage.module = shaderModule;
+    pipelineCreateInfo.stage.pName = "main";
+    pipelineCreateInfo.layout = m_PipelineLayout;
+    result = vkCreateComputePipelines(m_Device, m_PipelineCache, 1, &pipelineCreateInfo, nullptr, &m_Pipeline);
+    vkDestroyShaderModule(m_Device, shaderModule, nullptr);
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("failed to create indirect cull compute pipeline!");
+}
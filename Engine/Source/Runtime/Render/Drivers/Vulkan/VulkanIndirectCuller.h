@@ -0,0 +1,73 @@
+/* ************************************************************************
+ *
+ * Copyright (C) 2022 Vincent Luo All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, e1ither express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ************************************************************************/
+
+/* Creates on 2026/10/17. */
+
+/*
+  ===================================
+    @author bit-fashion
+  ===================================
+*/
+#ifndef _VECTRAFLUX_VULKAN_INDIRECT_CULLER_H_
+#define _VECTRAFLUX_VULKAN_INDIRECT_CULLER_H_
+
+#include <vulkan/vulkan.h>
+#include <Typedef.h>
+#include <Math.h>
+
+/* std430 layout, 和 indirect_cull.comp 里的 DrawObject 保持一致 */
+struct VkIndirectDrawObject {
+    glm::vec4 boundingSphere; /* xyz world space center, w radius */
+    uint32_t indexCount;
+    uint32_t firstIndex;
+    int32_t vertexOffset;
+    uint32_t firstInstance; /* the vertex shader finds the object's data with gl_InstanceIndex */
+};
+
+/**
+ * Frustum culls draw objects on the GPU and writes their
+ * VkDrawIndexedIndirectCommand. With compact the visible commands are packed
+ * at the front and counted in the count buffer (vkCmdDrawIndexedIndirectCount),
+ * otherwise command i belongs to object i and culled ones get instanceCount 0.
+ * The pipeline is only created the first time it is needed.
+ */
+class VulkanIndirectCuller {
+public:
+    VulkanIndirectCuller(VkDevice device, VkPipelineCache pipelineCache);
+   ~VulkanIndirectCuller();
+
+    /* binding 0 objects, 1 commands, 2 count */
+    VkDescriptorSetLayout GetSetLayout();
+
+    /* records outside of a render pass, the commands are ready for the
+     * DRAW_INDIRECT stage afterwards. countBuffer is ignored unless compact */
+    void Record(VkCommandBuffer commandBuffer, VkDescriptorSet descriptorSet, VkBuffer drawCommandBuffer, VkBuffer countBuffer,
+                uint32_t objectCount, bool compact, const glm::mat4 &viewProjection);
+
+private:
+    void _InitComputePipeline();
+
+private:
+    VkDevice m_Device;
+    VkPipelineCache m_PipelineCache;
+    VkDescriptorSetLayout m_SetLayout = VK_NULL_HANDLE;
+    VkPipelineLayout m_PipelineLayout = VK_NULL_HANDLE;
+    VkPipeline m_Pipeline = VK_NULL_HANDLE;
+};
+
+#endif /* _VECTRAFLUX_VULKAN_INDIRECT_CULLER_H_ */
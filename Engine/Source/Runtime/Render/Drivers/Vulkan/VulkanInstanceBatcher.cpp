@@ -0,0 +1,184 @@
+/* ************************************************************************
+ *
+ * Copyright (C) 2022 Vincent Luo All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, e1ither express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ************************************************************************/
+
+/* Creates on 2026/10/17. */
+
+/*
+  ===================================
+    @author bit-fashion
+  ===================================
+*/
+#include "VulkanInstanceBatcher.h"
+#include <glm/gtc/packing.hpp>
+#include <algorithm>
+#include <cstring>
+
+/* instance buffer 最小 64 KB，不够时翻倍 */
+#define INSTANCE_BUFFER_MIN_SIZE (64 << 10)
+
+VulkanInstanceBatcher::VulkanInstanceBatcher(VulkanContext *pContext) : m_Context(pContext) {
+    Vector<VkDescriptorSetLayoutBinding> bindings(1);
+    bindings[0] = { 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, null };
+    m_Context->CreateDescriptorSetLayout(bindings, 0, &m_SetLayout);
+}
+
+VulkanInstanceBatcher::~VulkanInstanceBatcher() {
+    for (auto &frameBuffer : m_FrameBuffers) {
+        if (frameBuffer.capacity != 0)
+            m_Context->FreeBuffer(frameBuffer.buffer);
+    }
+    m_Context->DestroyDescriptorSetLayout(m_SetLayout);
+}
+
+VkMeshHandle VulkanInstanceBatcher::AddMesh(const VkInstancedMesh &mesh) {
+    m_Meshes.push_back(mesh);
+    return std::size(m_Meshes) - 1;
+}
+
+VkInstanceData VulkanInstanceBatcher::PackInstance(const glm::mat4 &transform, const glm::vec4 &color, uint32_t materialIndex) {
+    VkInstanceData instance = {};
+    /* glm 按列存储，着色器里每行和位置点乘 */
+    for (int row = 0; row < 3; row++)
+        instance.transform[row] = glm::vec4(transform[0][row], transform[1][row], transform[2][row], transform[3][row]);
+    instance.color = glm::packUnorm4x8(color);
+    instance.materialIndex = materialIndex;
+    return instance;
+}
+
+VulkanInstanceBatcher::Batch &VulkanInstanceBatcher::_AcquireBatch(VkMeshHandle mesh, uint32_t materialIndex) {
+    uint64_t key = ((uint64_t) mesh << 32) | materialIndex;
+    if (m_LastBatch != UINT32_MAX && m_Batches[m_LastBatch].key == key)
+        return m_Batches[m_LastBatch];
+
+    auto it = m_BatchIndices.find(key);
+    if (it != m_BatchIndices.end()) {
+        m_LastBatch = it->second;
+        return m_Batches[m_LastBatch];
+    }
+
+    m_LastBatch = std::size(m_Batches);
+    m_BatchIndices.emplace(key, m_LastBatch);
+    m_Batches.push_back({ key, mesh, {}, 0, 0 });
+    m_DrawOrderDirty = true;
+    return m_Batches.back();
+}
+
+void VulkanInstanceBatcher::Submit(VkMeshHandle mesh, uint32_t materialIndex, const glm::mat4 &transform, const glm::vec4 &color) {
+    _AcquireBatch(mesh, materialIndex).instances.push_back(PackInstance(transform, color, materialIndex));
+}
+
+void VulkanInstanceBatcher::Submit(VkMeshHandle mesh, uint32_t materialIndex, uint32_t count, const VkInstanceData *pInstances) {
+    Batch &batch = _AcquireBatch(mesh, materialIndex);
+    batch.instances.insert(batch.instances.end(), pInstances, pInstances + count);
+}
+
+void VulkanInstanceBatcher::Build() {
+    timestamp64_t start = System::GetTimeNanos();
+
+    VkGraphicsFrameContext *frameContext;
+    m_Context->GetFrameContext(&frameContext);
+    m_FrameIndex = frameContext->frameIndex;
+
+    /* 按 mesh 再按材质排序，相同 mesh 的批次连续，只绑定一次顶点和索引 */
+    if (m_DrawOrderDirty) {
+        m_DrawOrder.resize(std::size(m_Batches));
+        for (uint32_t i = 0; i < std::size(m_Batches); i++)
+            m_DrawOrder[i] = i;
+        std::sort(m_DrawOrder.begin(), m_DrawOrder.end(), [this](uint32_t a, uint32_t b) { return m_Batches[a].key < m_Batches[b].key; });
+        m_DrawOrderDirty = false;
+    }
+
+    uint32_t instanceCount = 0, batchCount = 0;
+    for (uint32_t index : m_DrawOrder) {
+        Batch &batch = m_Batches[index];
+        batch.instanceCount = std::size(batch.instances);
+        batch.firstInstance = instanceCount;
+        instanceCount += batch.instanceCount;
+        batchCount += batch.instanceCount != 0 ? 1 : 0;
+    }
+
+    /* 该帧的 fence 已经在 BeginGraphicsRender 里等过，旧 buffer 可以直接释放 */
+    FrameBuffer &frameBuffer = m_FrameBuffers[m_FrameIndex];
+    VkDeviceSize size = (VkDeviceSize) instanceCount * sizeof(VkInstanceData);
+    if (size > frameBuffer.capacity) {
+        if (frameBuffer.capacity != 0)
+            m_Context->FreeBuffer(frameBuffer.buffer);
+        frameBuffer.capacity = std::max<VkDeviceSize>({ size, frameBuffer.capacity * 2, INSTANCE_BUFFER_MIN_SIZE });
+        m_Context->AllocateBuffer(frameBuffer.capacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, &frameBuffer.buffer);
+    }
+
+    if (instanceCount != 0) {
+        char *pData;
+        m_Context->MapMemory(frameBuffer.buffer, 0, size, 0, reinterpret_cast<void **>(&pData));
+        for (auto &batch : m_Batches) {
+            if (batch.instanceCount != 0)
+                memcpy(pData + (VkDeviceSize) batch.firstInstance * sizeof(VkInstanceData), std::data(batch.instances),
+                       (size_t) batch.instanceCount * sizeof(VkInstanceData));
+            batch.instances.clear();
+        }
+        m_Context->UnmapMemory(frameBuffer.buffer);
+
+        VkApplicationContext *applicationContext;
+        m_Context->GetApplicationContext(&applicationContext);
+        m_Context->AllocateFrameDescriptorSet(m_SetLayout, &frameBuffer.descriptorSet);
+        VkDescriptorBufferInfo bufferInfo = { frameBuffer.buffer.buffer, 0, size };
+        VkWriteDescriptorSet write = {};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = frameBuffer.descriptorSet;
+        write.dstBinding = 0;
+        write.descriptorCount = 1;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        write.pBufferInfo = &bufferInfo;
+        vkUpdateDescriptorSets(applicationContext->Device, 1, &write, 0, null);
+    }
+
+    m_LastBatch = UINT32_MAX;
+    m_Stats.instanceCount = instanceCount;
+    m_Stats.batchCount = batchCount;
+    m_Stats.instanceBytes = size;
+    m_Stats.buildMicros = (System::GetTimeNanos() - start) / 1000;
+}
+
+void VulkanInstanceBatcher::Draw(VkCommandBuffer commandBuffer, VkRenderPipeline &pipeline, bool instanced) {
+    if (m_Stats.instanceCount == 0)
+        return;
+
+    m_Context->BindDescriptorSets(commandBuffer, pipeline, 1, &m_FrameBuffers[m_FrameIndex].descriptorSet);
+
+    VkMeshHandle boundMesh = UINT32_MAX;
+    for (uint32_t index : m_DrawOrder) {
+        const Batch &batch = m_Batches[index];
+        if (batch.instanceCount == 0)
+            continue;
+
+        VkInstancedMesh &mesh = m_Meshes[batch.mesh];
+        if (batch.mesh != boundMesh) {
+            m_Context->BindVertexBuffer(commandBuffer, mesh.vertexBuffer);
+            m_Context->BindIndexBuffer(commandBuffer, mesh.indexBuffer, mesh.indexType);
+            boundMesh = batch.mesh;
+        }
+
+        if (instanced) {
+            vkCmdDrawIndexed(commandBuffer, mesh.indexCount, batch.instanceCount, mesh.firstIndex, mesh.vertexOffset, batch.firstInstance);
+        } else {
+            for (uint32_t i = 0; i < batch.instanceCount; i++)
+                m_Context->DrawIndexed(commandBuffer, mesh.indexCount, mesh.firstIndex, mesh.vertexOffset, batch.firstInstance + i);
+        }
+    }
+}
@@ -0,0 +1,121 @@
+/* ************************************************************************
+ *
+ * Copyright (C) 2022 Vincent Luo All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, e1ither express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ************************************************************************/
+
+/* Creates on 2026/10/17. */
+
+/*
+  ===================================
+    @author bit-fashion
+  ===================================
+*/
+#ifndef _VECTRAFLUX_VULKAN_INSTANCE_BATCHER_H_
+#define _VECTRAFLUX_VULKAN_INSTANCE_BATCHER_H_
+
+#include "VulkanContext.h"
+
+/* std430, 和 instanced_shader.vert 里的 InstanceData 保持一致 */
+struct VkInstanceData {
+    glm::vec4 transform[3]; /* rows of the affine model matrix */
+    uint32_t color; /* RGBA8 unorm */
+    uint32_t materialIndex; /* bindless texture index, VULKAN_BINDLESS_INVALID_INDEX for color only */
+    uint32_t reserved[2];
+};
+
+/* a range of indices in buffers owned by the caller */
+struct VkInstancedMesh {
+    VkVertexStreamBuffer vertexBuffer;
+    VkDeviceBuffer indexBuffer;
+    VkIndexType indexType;
+    uint32_t indexCount;
+    uint32_t firstIndex;
+    int32_t vertexOffset;
+};
+
+typedef uint32_t VkMeshHandle;
+
+struct VkInstanceBatchStats {
+    uint32_t instanceCount = 0; /* submitted during the last frame */
+    uint32_t batchCount = 0; /* instanced draws */
+    uint64_t buildMicros = 0; /* copy into the instance buffer */
+    uint64_t instanceBytes = 0;
+};
+
+/**
+ * Groups the instances submitted during a frame by mesh and material and
+ * draws every group with one vkCmdDrawIndexed. Instance data is written to a
+ * host visible storage buffer per frame in flight, the vertex shader reads it
+ * with gl_InstanceIndex (firstInstance is the group's offset in the buffer).
+ * Groups are kept across frames so steady scenes don't allocate. Destroy
+ * the batcher only after the device is idle.
+ */
+class VulkanInstanceBatcher {
+public:
+    VulkanInstanceBatcher(VulkanContext *pContext);
+   ~VulkanInstanceBatcher();
+
+    /* set 0 of instanced pipelines, binding 0 is the instance buffer */
+    VkDescriptorSetLayout GetSetLayout() const { return m_SetLayout; }
+    VkMeshHandle AddMesh(const VkInstancedMesh &mesh);
+
+    //
+    // Per frame: Submit() after BeginGraphicsRender(), Build() once after the
+    // last submit, Draw() inside the pass.
+    //
+    void Submit(VkMeshHandle mesh, uint32_t materialIndex, const glm::mat4 &transform, const glm::vec4 &color = glm::vec4(1.0f));
+    /* bulk submit, the instances must already carry materialIndex (PackInstance) */
+    void Submit(VkMeshHandle mesh, uint32_t materialIndex, uint32_t count, const VkInstanceData *pInstances);
+    void Build();
+    /* pipeline's set 0 must use GetSetLayout(), instanced = false issues one draw per instance for comparison */
+    void Draw(VkCommandBuffer commandBuffer, VkRenderPipeline &pipeline, bool instanced = true);
+
+    const VkInstanceBatchStats &GetStats() const { return m_Stats; }
+
+    static VkInstanceData PackInstance(const glm::mat4 &transform, const glm::vec4 &color, uint32_t materialIndex);
+
+private:
+    struct Batch {
+        uint64_t key; /* mesh << 32 | material, draw order */
+        VkMeshHandle mesh;
+        Vector<VkInstanceData> instances; /* cleared by Build() */
+        uint32_t instanceCount;
+        uint32_t firstInstance;
+    };
+
+    struct FrameBuffer {
+        VkDeviceBuffer buffer = {};
+        VkDeviceSize capacity = 0;
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+    };
+
+    Batch &_AcquireBatch(VkMeshHandle mesh, uint32_t materialIndex);
+
+private:
+    VulkanContext *m_Context;
+    VkDescriptorSetLayout m_SetLayout;
+    Vector<VkInstancedMesh> m_Meshes;
+    Vector<Batch> m_Batches;
+    HashMap<uint64_t, uint32_t> m_BatchIndices;
+    Vector<uint32_t> m_DrawOrder; /* batch indices sorted by key */
+    bool m_DrawOrderDirty = false;
+    uint32_t m_LastBatch = UINT32_MAX; /* consecutive submits usually hit the same batch */
+    Array<FrameBuffer, ENGINE_CONFIG_MAX_FRAMES_IN_FLIGHT> m_FrameBuffers;
+    uint32_t m_FrameIndex = 0;
+    VkInstanceBatchStats m_Stats;
+};
+
+#endif /* _VECTRAFLUX_VULKAN_INSTANCE_BATCHER_H_ */
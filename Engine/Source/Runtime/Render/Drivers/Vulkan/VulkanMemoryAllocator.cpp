@@ -0,0 +1,337 @@
+/* ************************************************************************
+ *
+ * Copyright (C) 2022 Vincent Luo All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, e1ither express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ************************************************************************/
+
+/* Creates on 2026/10/17. */
+
+/*
+  ===================================
+    @author bit-fashion
+  ===================================
+*/
+#include "VulkanMemoryAllocator.h"
+#include <bit>
+#include <stdexcept>
+
+/* 默认内存块大小，小显存堆会按比例缩小 */
+#define MEMORY_BLOCK_SIZE ((VkDeviceSize) 64 * 1024 * 1024)
+#define MEMORY_MIN_BLOCK_SIZE ((VkDeviceSize) 1 * 1024 * 1024)
+/* buddy 分配的最小节点 */
+#define MEMORY_MIN_NODE_SIZE ((VkDeviceSize) 256)
+/* 小 buffer 线性分页 */
+#define MEMORY_LINEAR_PAGE_SIZE ((VkDeviceSize) 256 * 1024)
+#define MEMORY_SMALL_ALLOCATION_SIZE ((VkDeviceSize) 32 * 1024)
+
+struct VkDeviceMemoryBlock {
+    VkDeviceMemory memory;
+    VkDeviceSize size;
+    void *pMapped;
+    uint32_t memoryTypeIndex;
+    uint32_t kind;
+    uint32_t maxOrder; /* log2(size) */
+    Vector<Set<VkDeviceSize>> freeLists; /* offsets of free nodes, indexed by order */
+    HashMap<VkDeviceSize, uint32_t> allocatedOrders;
+    VkDeviceSize usedBytes;
+};
+
+struct VkDeviceMemoryPage {
+    VkDeviceMemoryBlock *block;
+    VkDeviceSize offset; /* page offset inside the block */
+    VkDeviceSize head;
+    uint32_t liveCount;
+    uint32_t kind;
+};
+
+static uint32_t _Log2Ceil(VkDeviceSize size) {
+    return std::bit_width(std::bit_ceil(size)) - 1;
+}
+
+static bool _BuddyAllocate(VkDeviceMemoryBlock *block, VkDeviceSize size, VkDeviceSize *pOffset) {
+    uint32_t order = _Log2Ceil(std::max(size, MEMORY_MIN_NODE_SIZE));
+    if (order > block->maxOrder)
+        return false;
+
+    uint32_t k = order;
+    while (k <= block->maxOrder && block->freeLists[k].empty())
+        ++k;
+    if (k > block->maxOrder)
+        return false;
+
+    VkDeviceSize offset = *block->freeLists[k].begin();
+    block->freeLists[k].erase(block->freeLists[k].begin());
+
+    /* split until the node fits */
+    while (k > order) {
+        --k;
+        block->freeLists[k].insert(offset + ((VkDeviceSize) 1 << k));
+    }
+
+    block->allocatedOrders[offset] = order;
+    block->usedBytes += (VkDeviceSize) 1 << order;
+    *pOffset = offset;
+    return true;
+}
+
+static void _BuddyFree(VkDeviceMemoryBlock *block, VkDeviceSize offset) {
+    auto iter = block->allocatedOrders.find(offset);
+    if (iter == block->allocatedOrders.end())
+        throw std::runtime_error("free device memory range not allocated!");
+
+    uint32_t order = iter->second;
+    block->allocatedOrders.erase(iter);
+    block->usedBytes -= (VkDeviceSize) 1 << order;
+
+    /* merge with buddy */
+    while (order < block->maxOrder) {
+        VkDeviceSize buddy = offset ^ ((VkDeviceSize) 1 << order);
+        auto buddyIter = block->freeLists[order].find(buddy);
+        if (buddyIter == block->freeLists[order].end())
+            break;
+        block->freeLists[order].erase(buddyIter);
+        offset = std::min(offset, buddy);
+        ++order;
+    }
+
+    block->freeLists[order].insert(offset);
+}
+
+VulkanMemoryAllocator::VulkanMemoryAllocator(VkPhysicalDevice physicalDevice, VkDevice device) : m_Device(device) {
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &m_MemoryProperties);
+    for (uint32_t kind = 0; kind < POOL_KIND_MAX_ENUM; kind++) {
+        m_Pools[kind].resize(m_MemoryProperties.memoryTypeCount);
+        for (auto &pool : m_Pools[kind])
+            pool.kind = kind;
+    }
+}
+
+VulkanMemoryAllocator::~VulkanMemoryAllocator() {
+    for (auto &pools : m_Pools) {
+        for (auto &pool : pools) {
+            delete pool.currentPage;
+            for (auto block : pool.blocks) {
+                vkFreeMemory(m_Device, block->memory, VK_NULL_HANDLE);
+                delete block;
+            }
+        }
+    }
+}
+
+uint32_t VulkanMemoryAllocator::FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const {
+    for (uint32_t i = 0; i < m_MemoryProperties.memoryTypeCount; i++) {
+        if ((typeFilter & (1 << i)) && (m_MemoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+            return i;
+        }
+    }
+    throw std::runtime_error("failed to find suitable memory type!");
+}
+
+VkDeviceSize VulkanMemoryAllocator::GetBlockSize(uint32_t memoryTypeIndex) const {
+    VkDeviceSize heapSize = m_MemoryProperties.memoryHeaps[m_MemoryProperties.memoryTypes[memoryTypeIndex].heapIndex].size;
+    VkDeviceSize blockSize = std::bit_floor(std::max(heapSize / 8, MEMORY_MIN_BLOCK_SIZE));
+    return std::min(blockSize, MEMORY_BLOCK_SIZE);
+}
+
+void VulkanMemoryAllocator::AllocateBufferMemory(VkBuffer buffer, VkMemoryPropertyFlags properties,
+                                                 VkDeviceMemoryAllocation *pAllocation) {
+    VkMemoryRequirements requirements;
+    vkGetBufferMemoryRequirements(m_Device, buffer, &requirements);
+    Allocate(requirements, properties, POOL_KIND_LINEAR, pAllocation);
+    vkBindBufferMemory(m_Device, buffer, pAllocation->memory, pAllocation->offset);
+}
+
+void VulkanMemoryAllocator::AllocateImageMemory(VkImage image, VkMemoryPropertyFlags properties,
+                                                VkDeviceMemoryAllocation *pAllocation) {
+    VkMemoryRequirements requirements;
+    vkGetImageMemoryRequirements(m_Device, image, &requirements);
+    Allocate(requirements, properties, POOL_KIND_OPTIMAL, pAllocation);
+    vkBindImageMemory(m_Device, image, pAllocation->memory, pAllocation->offset);
+}
+
+void VulkanMemoryAllocator::Allocate(const VkMemoryRequirements &requirements, VkMemoryPropertyFlags properties,
+                                     PoolKind kind, VkDeviceMemoryAllocation *pAllocation) {
+    uint32_t memoryTypeIndex = FindMemoryType(requirements.memoryTypeBits, properties);
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    Pool &pool = m_Pools[kind][memoryTypeIndex];
+
+    *pAllocation = {};
+    pAllocation->memoryTypeIndex = memoryTypeIndex;
+    pAllocation->size = requirements.size;
+
+    if (kind == POOL_KIND_LINEAR && requirements.size <= MEMORY_SMALL_ALLOCATION_SIZE &&
+        requirements.alignment <= MEMORY_LINEAR_PAGE_SIZE) {
+        AllocateFromPage(pool, requirements, memoryTypeIndex, pAllocation);
+    } else if (requirements.size > GetBlockSize(memoryTypeIndex) / 2) {
+        AllocateDedicated(requirements, memoryTypeIndex, pAllocation);
+    } else {
+        VkDeviceMemoryBlock *block;
+        VkDeviceSize offset;
+        AllocateFromBlocks(pool, requirements.size, requirements.alignment, memoryTypeIndex, &block, &offset);
+        pAllocation->block = block;
+        pAllocation->memory = block->memory;
+        pAllocation->offset = offset;
+        if (block->pMapped != nullptr)
+            pAllocation->pMapped = static_cast<char *>(block->pMapped) + offset;
+    }
+
+    ++m_Stats.allocationCount;
+    m_Stats.usedBytes += requirements.size;
+}
+
+void VulkanMemoryAllocator::AllocateDedicated(const VkMemoryRequirements &requirements, uint32_t memoryTypeIndex,
+                                              VkDeviceMemoryAllocation *pAllocation) {
+    VkMemoryAllocateInfo memoryAllocateInfo = {};
+    memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    memoryAllocateInfo.allocationSize = requirements.size;
+    memoryAllocateInfo.memoryTypeIndex = memoryTypeIndex;
+    if (vkAllocateMemory(m_Device, &memoryAllocateInfo, VK_NULL_HANDLE, &pAllocation->memory) != VK_SUCCESS)
+        throw std::runtime_error("failed to allocate dedicated device memory!");
+
+    if (m_MemoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+        vkMapMemory(m_Device, pAllocation->memory, 0, VK_WHOLE_SIZE, 0, &pAllocation->pMapped);
+
+    ++m_Stats.vkAllocateMemoryCount;
+    ++m_Stats.dedicatedAllocationCount;
+    m_Stats.dedicatedBytes += requirements.size;
+}
+
+bool VulkanMemoryAllocator::AllocateFromPage(Pool &pool, const VkMemoryRequirements &requirements, uint32_t memoryTypeIndex,
+                                             VkDeviceMemoryAllocation *pAllocation) {
+    VkDeviceMemoryPage *page = pool.currentPage;
+    VkDeviceSize offset = 0;
+    if (page != nullptr)
+        offset = (page->head + requirements.alignment - 1) & ~(requirements.alignment - 1);
+
+    if (page == nullptr || offset + requirements.size > MEMORY_LINEAR_PAGE_SIZE) {
+        /* retire the full page, it goes back to its block with its last allocation */
+        if (page != nullptr && page->liveCount == 0) {
+            FreeBlockRange(pool, page->block, page->offset);
+            delete page;
+        }
+
+        page = new VkDeviceMemoryPage();
+        AllocateFromBlocks(pool, MEMORY_LINEAR_PAGE_SIZE, MEMORY_LINEAR_PAGE_SIZE, memoryTypeIndex, &page->block, &page->offset);
+        page->kind = pool.kind;
+        pool.currentPage = page;
+        offset = 0;
+    }
+
+    page->head = offset + requirements.size;
+    ++page->liveCount;
+
+    pAllocation->block = page->block;
+    pAllocation->page = page;
+    pAllocation->memory = page->block->memory;
+    pAllocation->offset = page->offset + offset;
+    if (page->block->pMapped != nullptr)
+        pAllocation->pMapped = static_cast<char *>(page->block->pMapped) + pAllocation->offset;
+    return true;
+}
+
+bool VulkanMemoryAllocator::AllocateFromBlocks(Pool &pool, VkDeviceSize size, VkDeviceSize alignment, uint32_t memoryTypeIndex,
+                                               VkDeviceMemoryBlock **ppBlock, VkDeviceSize *pOffset) {
+    /* buddy nodes are aligned to their own size, so rounding up to the alignment is enough */
+    VkDeviceSize nodeSize = std::max(size, alignment);
+
+    for (auto block : pool.blocks) {
+        if (_BuddyAllocate(block, nodeSize, pOffset)) {
+            *ppBlock = block;
+            return true;
+        }
+    }
+
+    VkDeviceMemoryBlock *block = CreateBlock(pool, memoryTypeIndex);
+    if (!_BuddyAllocate(block, nodeSize, pOffset))
+        throw std::runtime_error("device memory request larger than block size!");
+    *ppBlock = block;
+    return true;
+}
+
+VkDeviceMemoryBlock *VulkanMemoryAllocator::CreateBlock(Pool &pool, uint32_t memoryTypeIndex) {
+    VkDeviceMemoryBlock *block = new VkDeviceMemoryBlock();
+    block->size = GetBlockSize(memoryTypeIndex);
+    block->memoryTypeIndex = memoryTypeIndex;
+    block->kind = pool.kind;
+    block->maxOrder = _Log2Ceil(block->size);
+    block->freeLists.resize(block->maxOrder + 1);
+    block->freeLists[block->maxOrder].insert(0);
+    block->usedBytes = 0;
+    block->pMapped = nullptr;
+
+    VkMemoryAllocateInfo memoryAllocateInfo = {};
+    memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    memoryAllocateInfo.allocationSize = block->size;
+    memoryAllocateInfo.memoryTypeIndex = memoryTypeIndex;
+    if (vkAllocateMemory(m_Device, &memoryAllocateInfo, VK_NULL_HANDLE, &block->memory) != VK_SUCCESS) {
+        delete block;
+        throw std::runtime_error("failed to allocate device memory block!");
+    }
+
+    /* 整块持久映射，避免同一块 memory 被重复 map */
+    if (m_MemoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+        vkMapMemory(m_Device, block->memory, 0, VK_WHOLE_SIZE, 0, &block->pMapped);
+
+    pool.blocks.push_back(block);
+    ++m_Stats.vkAllocateMemoryCount;
+    ++m_Stats.blockCount;
+    m_Stats.blockBytes += block->size;
+    return block;
+}
+
+void VulkanMemoryAllocator::FreeBlockRange(Pool &pool, VkDeviceMemoryBlock *block, VkDeviceSize offset) {
+    _BuddyFree(block, offset);
+
+    /* keep one empty block around per pool to avoid allocation churn */
+    if (block->usedBytes == 0 && std::size(pool.blocks) > 1) {
+        vkFreeMemory(m_Device, block->memory, VK_NULL_HANDLE);
+        pool.blocks.erase(std::find(pool.blocks.begin(), pool.blocks.end(), block));
+        --m_Stats.blockCount;
+        m_Stats.blockBytes -= block->size;
+        delete block;
+    }
+}
+
+void VulkanMemoryAllocator::FreeMemory(VkDeviceMemoryAllocation &allocation) {
+    if (allocation.memory == VK_NULL_HANDLE)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    if (allocation.block == nullptr) {
+        vkFreeMemory(m_Device, allocation.memory, VK_NULL_HANDLE);
+        --m_Stats.dedicatedAllocationCount;
+        m_Stats.dedicatedBytes -= allocation.size;
+    } else if (allocation.page != nullptr) {
+        VkDeviceMemoryPage *page = allocation.page;
+        Pool &pool = m_Pools[page->kind][allocation.memoryTypeIndex];
+        if (--page->liveCount == 0) {
+            if (pool.currentPage == page) {
+                page->head = 0;
+            } else {
+                FreeBlockRange(pool, page->block, page->offset);
+                delete page;
+            }
+        }
+    } else {
+        Pool &pool = m_Pools[allocation.block->kind][allocation.memoryTypeIndex];
+        FreeBlockRange(pool, allocation.block, allocation.offset);
+    }
+
+    --m_Stats.allocationCount;
+    m_Stats.usedBytes -= allocation.size;
+    allocation = {};
+}
@@ -0,0 +1,112 @@
+/* ************************************************************************
+ *
+ * Copyright (C) 2022 Vincent Luo All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, e1ither express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ************************************************************************/
+
+/* Creates on 2026/10/17. */
+
+/*
+  ===================================
+    @author bit-fashion
+  ===================================
+*/
+#ifndef _VECTRAFLUX_VULKAN_MEMORY_ALLOCATOR_H_
+#define _VECTRAFLUX_VULKAN_MEMORY_ALLOCATOR_H_
+
+#include <vulkan/vulkan.h>
+#include <Typedef.h>
+#include <mutex>
+
+struct VkDeviceMemoryBlock;
+struct VkDeviceMemoryPage;
+
+/**
+ * A sub-allocated range of device memory. Host visible memory is mapped once
+ * per block, pMapped already points at this allocation's offset.
+ */
+struct VkDeviceMemoryAllocation {
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;
+    void *pMapped = nullptr;
+    uint32_t memoryTypeIndex = 0;
+    VkDeviceMemoryBlock *block = nullptr; /* null when dedicated */
+    VkDeviceMemoryPage *page = nullptr; /* non-null when taken from a linear page */
+};
+
+struct VkDeviceMemoryStats {
+    uint64_t blockCount = 0;
+    uint64_t blockBytes = 0;
+    uint64_t dedicatedAllocationCount = 0;
+    uint64_t dedicatedBytes = 0;
+    uint64_t allocationCount = 0;
+    uint64_t usedBytes = 0;
+    uint64_t vkAllocateMemoryCount = 0; /* total device allocations ever made */
+};
+
+/**
+ * Block based device memory allocator.
+ *
+ * Every memory type owns two pools, one for linear resources (buffers) and
+ * one for optimal tiled images, so bufferImageGranularity never applies
+ * between neighbours. Each pool carves large blocks with a buddy allocator,
+ * small buffers are bump allocated from linear pages that are handed back to
+ * the buddy allocator once their last allocation is freed.
+ */
+class VulkanMemoryAllocator {
+public:
+    VulkanMemoryAllocator(VkPhysicalDevice physicalDevice, VkDevice device);
+   ~VulkanMemoryAllocator();
+
+    void AllocateBufferMemory(VkBuffer buffer, VkMemoryPropertyFlags properties, VkDeviceMemoryAllocation *pAllocation);
+    void AllocateImageMemory(VkImage image, VkMemoryPropertyFlags properties, VkDeviceMemoryAllocation *pAllocation);
+    void FreeMemory(VkDeviceMemoryAllocation &allocation);
+    uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+    const VkDeviceMemoryStats &GetStats() const { return m_Stats; }
+    const VkPhysicalDeviceMemoryProperties &GetMemoryProperties() const { return m_MemoryProperties; }
+
+private:
+    enum PoolKind {
+        POOL_KIND_LINEAR = 0,
+        POOL_KIND_OPTIMAL = 1,
+        POOL_KIND_MAX_ENUM
+    };
+
+    struct Pool {
+        uint32_t kind;
+        Vector<VkDeviceMemoryBlock *> blocks;
+        VkDeviceMemoryPage *currentPage = nullptr;
+    };
+
+    void Allocate(const VkMemoryRequirements &requirements, VkMemoryPropertyFlags properties, PoolKind kind,
+                  VkDeviceMemoryAllocation *pAllocation);
+    void AllocateDedicated(const VkMemoryRequirements &requirements, uint32_t memoryTypeIndex, VkDeviceMemoryAllocation *pAllocation);
+    bool AllocateFromPage(Pool &pool, const VkMemoryRequirements &requirements, uint32_t memoryTypeIndex, VkDeviceMemoryAllocation *pAllocation);
+    bool AllocateFromBlocks(Pool &pool, VkDeviceSize size, VkDeviceSize alignment, uint32_t memoryTypeIndex,
+                            VkDeviceMemoryBlock **ppBlock, VkDeviceSize *pOffset);
+    VkDeviceMemoryBlock *CreateBlock(Pool &pool, uint32_t memoryTypeIndex);
+    void FreeBlockRange(Pool &pool, VkDeviceMemoryBlock *block, VkDeviceSize offset);
+    VkDeviceSize GetBlockSize(uint32_t memoryTypeIndex) const;
+
+private:
+    VkDevice m_Device;
+    VkPhysicalDeviceMemoryProperties m_MemoryProperties;
+    Array<Vector<Pool>, POOL_KIND_MAX_ENUM> m_Pools; /* [kind][memoryTypeIndex] */
+    VkDeviceMemoryStats m_Stats;
+    std::mutex m_Mutex;
+};
+
+#endif /* _VECTRAFLUX_VULKAN_MEMORY_ALLOCATOR_H_ */
@@ -0,0 +1,301 @@
+/* ************************************************************************
+ *
+ * Copyright (C) 2022 Vincent Luo All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, e1ither express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ************************************************************************/
+
+/* Creates on 2026/10/17. */
+
+/*
+  ===================================
+    @author bit-fashion
+  ===================================
+*/
+#include "VulkanMipmapGenerator.h"
+#include <Engine.h>
+#include <System.h>
+#include "Utils/IOUtils.h"
+#include <stdexcept>
+
+/* compute 生成 mip 的 workgroup 大小，和 mipmap_downsample.comp 保持一致 */
+#define MIPMAP_GROUP_SIZE 8
+
+VulkanMipmapGenerator::VulkanMipmapGenerator(VkDevice device, VkPhysicalDevice physicalDevice, VkPipelineCache pipelineCache,
+                                             bool storageWriteWithoutFormat)
+  : m_Device(device), m_PhysicalDevice(physicalDevice), m_PipelineCache(pipelineCache),
+    m_StorageWriteWithoutFormat(storageWriteWithoutFormat) {
+}
+
+VulkanMipmapGenerator::~VulkanMipmapGenerator() {
+    if (m_Pipeline != VK_NULL_HANDLE)
+        vkDestroyPipeline(m_Device, m_Pipeline, nullptr);
+    if (m_PipelineLayout != VK_NULL_HANDLE)
+        vkDestroyPipelineLayout(m_Device, m_PipelineLayout, nullptr);
+    if (m_SetLayout != VK_NULL_HANDLE)
+        vkDestroyDescriptorSetLayout(m_Device, m_SetLayout, nullptr);
+    if (m_Sampler != VK_NULL_HANDLE)
+        vkDestroySampler(m_Device, m_Sampler, nullptr);
+}
+
+VulkanMipmapMethod VulkanMipmapGenerator::GetMethod(VkFormat format) {
+    VkFormatProperties properties;
+    vkGetPhysicalDeviceFormatProperties(m_PhysicalDevice, format, &properties);
+    VkFormatFeatureFlags features = properties.optimalTilingFeatures;
+
+    VkFormatFeatureFlags blitFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT |
+                                        VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    if ((features & blitFeatures) == blitFeatures)
+        return VULKAN_MIPMAP_METHOD_BLIT;
+
+    /* 着色器里用 texelFetch 自己做 box filter，不依赖线性过滤 */
+    VkFormatFeatureFlags computeFeatures = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT;
+    if (m_StorageWriteWithoutFormat && (features & computeFeatures) == computeFeatures)
+        return VULKAN_MIPMAP_METHOD_COMPUTE;
+
+    return VULKAN_MIPMAP_METHOD_CPU;
+}
+
+VkImageUsageFlags VulkanMipmapGenerator::GetRequiredUsage(VulkanMipmapMethod method) {
+    switch (method) {
+        case VULKAN_MIPMAP_METHOD_BLIT:
+            return VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        case VULKAN_MIPMAP_METHOD_COMPUTE:
+            return VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        default:
+            return VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    }
+}
+
+void VulkanMipmapGenerator::Record(VkCommandBuffer commandBuffer, const VkMipmapJob &job, VulkanDescriptorAllocator *pDescriptorAllocator,
+                                   Vector<VkImageView> &temporaryImageViews) {
+    switch (GetMethod(job.format)) {
+        case VULKAN_MIPMAP_METHOD_BLIT:
+            _RecordBlit(commandBuffer, job);
+            break;
+        case VULKAN_MIPMAP_METHOD_COMPUTE:
+            _RecordCompute(commandBuffer, job, pDescriptorAllocator, temporaryImageViews);
+            break;
+        default:
+            throw std::runtime_error("format supports neither blit nor compute mipmap generation, upload every level!");
+    }
+}
+
+static VkImageMemoryBarrier _LevelBarrier(VkImage image, uint32_t baseLevel, uint32_t levelCount, VkImageLayout oldLayout, VkImageLayout newLayout,
+                                          VkAccessFlags srcAccess, VkAccessFlags dstAccess) {
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = oldLayout;
+    barrier.newLayout = newLayout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, baseLevel, levelCount, 0, 1 };
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstAccessMask = dstAccess;
+    return barrier;
+}
+
+void VulkanMipmapGenerator::_RecordBlit(VkCommandBuffer commandBuffer, const VkMipmapJob &job) {
+    int32_t width = std::max(1u, job.width >> job.baseLevel);
+    int32_t height = std::max(1u, job.height >> job.baseLevel);
+
+    /* 每一级从上一级 blit，上一级先转成 TRANSFER_SRC */
+    for (uint32_t level = job.baseLevel + 1; level < job.mipLevels; level++) {
+        VkImageMemoryBarrier barrier = _LevelBarrier(job.image, level - 1, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                                     VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT,
+                                                     VK_ACCESS_TRANSFER_READ_BIT);
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0, 0, null, 0, null, 1, &barrier);
+
+        int32_t levelWidth = std::max(1, width / 2);
+        int32_t levelHeight = std::max(1, height / 2);
+
+        VkImageBlit blit = {};
+        blit.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 0, 1 };
+        blit.srcOffsets[1] = { width, height, 1 };
+        blit.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1 };
+        blit.dstOffsets[1] = { levelWidth, levelHeight, 1 };
+        vkCmdBlitImage(commandBuffer, job.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, job.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                       1, &blit, VK_FILTER_LINEAR);
+
+        width = levelWidth;
+        height = levelHeight;
+    }
+
+    /* 最后一次转换合并成一个 barrier：上传的 level 和最后一级还是 TRANSFER_DST，中间的是 TRANSFER_SRC */
+    uint32_t lastLevel = job.mipLevels - 1;
+    Vector<VkImageMemoryBarrier> barriers;
+    if (job.baseLevel > 0)
+        barriers.push_back(_LevelBarrier(job.image, 0, job.baseLevel, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT));
+    if (lastLevel > job.baseLevel)
+        barriers.push_back(_LevelBarrier(job.image, job.baseLevel, lastLevel - job.baseLevel, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 0, VK_ACCESS_SHADER_READ_BIT));
+    barriers.push_back(_LevelBarrier(job.image, lastLevel, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT));
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                         0, 0, null, 0, null, std::size(barriers), std::data(barriers));
+}
+
+void VulkanMipmapGenerator::_RecordCompute(VkCommandBuffer commandBuffer, const VkMipmapJob &job, VulkanDescriptorAllocator *pDescriptorAllocator,
+                                           Vector<VkImageView> &temporaryImageViews) {
+    if (m_Pipeline == VK_NULL_HANDLE)
+        _InitComputePipeline();
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_Pipeline);
+
+    uint32_t width = std::max(1u, job.width >> job.baseLevel);
+    uint32_t height = std::max(1u, job.height >> job.baseLevel);
+
+    for (uint32_t level = job.baseLevel + 1; level < job.mipLevels; level++) {
+        /* 上一级变成只读，当前级丢弃旧内容后作为 storage image 写入 */
+        bool uploaded = level - 1 == job.baseLevel;
+        VkImageMemoryBarrier barriers[2];
+        barriers[0] = _LevelBarrier(job.image, level - 1, 1,
+                                    uploaded ? VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL,
+                                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                    uploaded ? VK_ACCESS_TRANSFER_WRITE_BIT : VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT);
+        barriers[1] = _LevelBarrier(job.image, level, 1, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+                                    0, VK_ACCESS_SHADER_WRITE_BIT);
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, null, 0, null, 2, barriers);
+
+        VkImageView srcView = _CreateLevelView(job, level - 1);
+        VkImageView dstView = _CreateLevelView(job, level);
+        temporaryImageViews.push_back(srcView);
+        temporaryImageViews.push_back(dstView);
+
+        VkDescriptorSet descriptorSet;
+        pDescriptorAllocator->Allocate(1, &m_SetLayout, &descriptorSet);
+
+        VkDescriptorImageInfo srcInfo = { m_Sampler, srcView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+        VkDescriptorImageInfo dstInfo = { VK_NULL_HANDLE, dstView, VK_IMAGE_LAYOUT_GENERAL };
+        VkWriteDescriptorSet writes[2] = {};
+        writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[0].dstSet = descriptorSet;
+        writes[0].dstBinding = 0;
+        writes[0].descriptorCount = 1;
+        writes[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writes[0].pImageInfo = &srcInfo;
+        writes[1] = writes[0];
+        writes[1].dstBinding = 1;
+        writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+        writes[1].pImageInfo = &dstInfo;
+        vkUpdateDescriptorSets(m_Device, 2, writes, 0, null);
+
+        uint32_t levelSize[2] = { std::max(1u, width / 2), std::max(1u, height / 2) };
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_PipelineLayout, 0, 1, &descriptorSet, 0, null);
+        vkCmdPushConstants(commandBuffer, m_PipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(levelSize), levelSize);
+        vkCmdDispatch(commandBuffer, (levelSize[0] + MIPMAP_GROUP_SIZE - 1) / MIPMAP_GROUP_SIZE,
+                      (levelSize[1] + MIPMAP_GROUP_SIZE - 1) / MIPMAP_GROUP_SIZE, 1);
+
+        width = levelSize[0];
+        height = levelSize[1];
+    }
+
+    /* 生成过程中读过的 level 已经是 SHADER_READ_ONLY，只剩上传的 level 和最后一级 */
+    uint32_t lastLevel = job.mipLevels - 1;
+    bool generated = lastLevel > job.baseLevel;
+    Vector<VkImageMemoryBarrier> barriers;
+    if (job.baseLevel > 0)
+        barriers.push_back(_LevelBarrier(job.image, 0, job.baseLevel, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT));
+    barriers.push_back(_LevelBarrier(job.image, lastLevel, 1,
+                                     generated ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                     VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                     generated ? VK_ACCESS_SHADER_WRITE_BIT : VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT));
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, null, 0, null, std::size(barriers), std::data(barriers));
+}
+
+VkImageView VulkanMipmapGenerator::_CreateLevelView(const VkMipmapJob &job, uint32_t level) {
+    VkImageViewCreateInfo viewInfo = {};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = job.image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = job.format;
+    viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, level, 1, 0, 1 };
+
+    VkImageView imageView;
+    if (vkCreateImageView(m_Device, &viewInfo, nullptr, &imageView) != VK_SUCCESS)
+        throw std::runtime_error("failed to create mip level image view!");
+    return imageView;
+}
+
+void VulkanMipmapGenerator::_InitComputePipeline() {
+    VkDescriptorSetLayoutBinding bindings[2] = {};
+    bindings[0].binding = 0;
+    bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    bindings[0].descriptorCount = 1;
+    bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    bindings[1] = bindings[0];
+    bindings[1].binding = 1;
+    bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+
+    VkDescriptorSetLayoutCreateInfo setLayoutCreateInfo = {};
+    setLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    setLayoutCreateInfo.bindingCount = 2;
+    setLayoutCreateInfo.pBindings = bindings;
+    if (vkCreateDescriptorSetLayout(m_Device, &setLayoutCreateInfo, nullptr, &m_SetLayout) != VK_SUCCESS)
+        throw std::runtime_error("failed to create mipmap descriptor set layout!");
+
+    VkPushConstantRange pushConstantRange = { VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(uint32_t) * 2 };
+    VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {};
+    pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutCreateInfo.setLayoutCount = 1;
+    pipelineLayoutCreateInfo.pSetLayouts = &m_SetLayout;
+    pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+    pipelineLayoutCreateInfo.pPushConstantRanges = &pushConstantRange;
+    if (vkCreatePipelineLayout(m_Device, &pipelineLayoutCreateInfo, nullptr, &m_PipelineLayout) != VK_SUCCESS)
+        throw std::runtime_error("failed to create mipmap pipeline layout!");
+
+    /* texelFetch 不经过过滤，sampler 只是占位 */
+    VkSamplerCreateInfo samplerInfo = {};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_NEAREST;
+    samplerInfo.minFilter = VK_FILTER_NEAREST;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    if (vkCreateSampler(m_Device, &samplerInfo, nullptr, &m_Sampler) != VK_SUCCESS)
+        throw std::runtime_error("failed to create mipmap sampler!");
+
+    size_t size;
+    char *buf = IOUtils::Read(strfmt("{}/{}", ENGINE_CONFIG_SHADER_FOLDER, "mipmap_downsample.comp.spv"), &size);
+
+    VkShaderModuleCreateInfo shaderModuleCreateInfo = {};
+    shaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    shaderModuleCreateInfo.codeSize = size;
+    shaderModuleCreateInfo.pCode = reinterpret_cast<const uint32_t *>(buf);
+
+    VkShaderModule shaderModule;
+    VkResult result = vkCreateShaderModule(m_Device, &shaderModuleCreateInfo, nullptr, &shaderModule);
+    IOUtils::Free(buf);
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("failed to create mipmap shader module!");
+
+    VkComputePipelineCreateInfo pipelineCreateInfo = {};
+    pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineCreateInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineCreateInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineCreateInfo.stage.module = shaderModule;
+    pipelineCreateInfo.stage.pName = "main";
+    pipelineCreateInfo.layout = m_PipelineLayout;
+    result = vkCreateComputePipelines(m_Device, m_PipelineCache, 1, &pipelineCreateInfo, nullptr, &m_Pipeline);
+    vkDestroyShaderModule(m_Device, shaderModule, nullptr);
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("failed to create mipmap compute pipeline!");
+}
@@ -0,0 +1,89 @@
+/* ************************************************************************
+ *
+ * Copyright (C) 2022 Vincent Luo All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, e1ither express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ************************************************************************/
+
+/* Creates on 2026/10/17. */
+
+/*
+  ===================================
+    @author bit-fashion
+  ===================================
+*/
+#ifndef _VECTRAFLUX_VULKAN_MIPMAP_GENERATOR_H_
+#define _VECTRAFLUX_VULKAN_MIPMAP_GENERATOR_H_
+
+#include <vulkan/vulkan.h>
+#include <Typedef.h>
+#include "VulkanDescriptorAllocator.h"
+
+/* 单张纹理最多的 mip 数量，够 32768x32768 */
+#define VULKAN_MAX_MIP_LEVELS 16
+
+enum VulkanMipmapMethod {
+    VULKAN_MIPMAP_METHOD_BLIT = 0, /* vkCmdBlitImage, needs linear filtering blits */
+    VULKAN_MIPMAP_METHOD_COMPUTE, /* 2x2 box filter in a compute shader, needs storage images */
+    VULKAN_MIPMAP_METHOD_CPU, /* every level must be uploaded */
+};
+
+/* levels [0, baseLevel] hold data, the rest is generated from baseLevel */
+struct VkMipmapJob {
+    VkImage image;
+    VkFormat format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t mipLevels;
+    uint32_t baseLevel;
+};
+
+/**
+ * Fills the mip chain of uploaded textures on the graphics queue. Every level
+ * of the image is expected in TRANSFER_DST_OPTIMAL and is left in
+ * SHADER_READ_ONLY_OPTIMAL. The compute fallback pipeline is only created the
+ * first time a format needs it.
+ */
+class VulkanMipmapGenerator {
+public:
+    VulkanMipmapGenerator(VkDevice device, VkPhysicalDevice physicalDevice, VkPipelineCache pipelineCache, bool storageWriteWithoutFormat);
+   ~VulkanMipmapGenerator();
+
+    VulkanMipmapMethod GetMethod(VkFormat format);
+    /* image usage the method needs on top of SAMPLED */
+    static VkImageUsageFlags GetRequiredUsage(VulkanMipmapMethod method);
+
+    /* per-mip views and descriptor sets must live until the command buffer completes */
+    void Record(VkCommandBuffer commandBuffer, const VkMipmapJob &job, VulkanDescriptorAllocator *pDescriptorAllocator,
+                Vector<VkImageView> &temporaryImageViews);
+
+private:
+    void _RecordBlit(VkCommandBuffer commandBuffer, const VkMipmapJob &job);
+    void _RecordCompute(VkCommandBuffer commandBuffer, const VkMipmapJob &job, VulkanDescriptorAllocator *pDescriptorAllocator,
+                        Vector<VkImageView> &temporaryImageViews);
+    void _InitComputePipeline();
+    VkImageView _CreateLevelView(const VkMipmapJob &job, uint32_t level);
+
+private:
+    VkDevice m_Device;
+    VkPhysicalDevice m_PhysicalDevice;
+    VkPipelineCache m_PipelineCache;
+    bool m_StorageWriteWithoutFormat;
+    VkDescriptorSetLayout m_SetLayout = VK_NULL_HANDLE;
+    VkPipelineLayout m_PipelineLayout = VK_NULL_HANDLE;
+    VkPipeline m_Pipeline = VK_NULL_HANDLE;
+    VkSampler m_Sampler = VK_NULL_HANDLE;
+};
+
+#endif /* _VECTRAFLUX_VULKAN_MIPMAP_GENERATOR_H_ */
@@ -0,0 +1,105 @@
+/* ************************************************************************
+ *
+ * Copyright (C) 2022 Vincent Luo All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, e1ither express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ************************************************************************/
+
+/* Creates on 2026/10/17. */
+
+/*
+  ===================================
+    @author bit-fashion
+  ===================================
+*/
+#include "VulkanPipelineCache.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+VulkanPipelineCache::VulkanPipelineCache(VkDevice device, const VkPhysicalDeviceProperties &properties, const String &path)
+    : m_Device(device), m_Properties(properties), m_Path(path) {
+    Vector<char> data;
+    std::ifstream file(m_Path, std::ios::ate | std::ios::binary);
+    if (file.is_open()) {
+        data.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(std::data(data), std::size(data));
+        /* 驱动或显卡变化后旧缓存无效，直接丢弃 */
+        if (!file || !ValidateHeader(std::data(data), std::size(data)))
+            data.clear();
+    }
+
+    VkPipelineCacheCreateInfo pipelineCacheCreateInfo = {};
+    pipelineCacheCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    pipelineCacheCreateInfo.initialDataSize = std::size(data);
+    pipelineCacheCreateInfo.pInitialData = std::empty(data) ? nullptr : std::data(data);
+
+    if (vkCreatePipelineCache(m_Device, &pipelineCacheCreateInfo, nullptr, &m_PipelineCache) != VK_SUCCESS) {
+        /* 缓存数据被驱动拒绝时退回空缓存 */
+        pipelineCacheCreateInfo.initialDataSize = 0;
+        pipelineCacheCreateInfo.pInitialData = nullptr;
+        data.clear();
+        if (vkCreatePipelineCache(m_Device, &pipelineCacheCreateInfo, nullptr, &m_PipelineCache) != VK_SUCCESS)
+            throw std::runtime_error("failed to create pipeline cache!");
+    }
+
+    m_Stats.warm = !std::empty(data);
+    m_Stats.loadedBytes = std::size(data);
+}
+
+VulkanPipelineCache::~VulkanPipelineCache() {
+    Save();
+    vkDestroyPipelineCache(m_Device, m_PipelineCache, nullptr);
+}
+
+void VulkanPipelineCache::Save() {
+    size_t size = 0;
+    if (vkGetPipelineCacheData(m_Device, m_PipelineCache, &size, nullptr) != VK_SUCCESS || size == 0)
+        return;
+
+    Vector<char> data(size);
+    if (vkGetPipelineCacheData(m_Device, m_PipelineCache, &size, std::data(data)) != VK_SUCCESS)
+        return;
+
+    /* 先写临时文件再替换，中途退出不会留下半个缓存文件 */
+    String temporaryPath = m_Path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            return;
+        file.write(std::data(data), size);
+        if (!file)
+            return;
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, m_Path, error);
+    if (error)
+        std::filesystem::remove(temporaryPath, error);
+}
+
+bool VulkanPipelineCache::ValidateHeader(const char *data, size_t size) const {
+    VkPipelineCacheHeaderVersionOne header;
+    if (size < sizeof(header))
+        return false;
+
+    memcpy(&header, data, sizeof(header));
+    return header.headerSize >= sizeof(header) &&
+           header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+           header.vendorID == m_Properties.vendorID &&
+           header.deviceID == m_Properties.deviceID &&
+           memcmp(header.pipelineCacheUUID, m_Properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
@@ -0,0 +1,64 @@
+/* ************************************************************************
+ *
+ * Copyright (C) 2022 Vincent Luo All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, e1ither express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ************************************************************************/
+
+/* Creates on 2026/10/17. */
+
+/*
+  ===================================
+    @author bit-fashion
+  ===================================
+*/
+#ifndef _VECTRAFLUX_VULKAN_PIPELINE_CACHE_H_
+#define _VECTRAFLUX_VULKAN_PIPELINE_CACHE_H_
+
+#include <vulkan/vulkan.h>
+#include <Typedef.h>
+
+struct VkPipelineCacheStats {
+    uint32_t warm = 0; /* 1 when seeded from a valid cache file */
+    uint64_t loadedBytes = 0;
+    uint64_t pipelineCount = 0;
+    uint64_t createMicros = 0; /* total time spent in vkCreate*Pipelines */
+};
+
+/**
+ * One VkPipelineCache per device, seeded from disk when the file header
+ * matches this device (vendor, device and pipelineCacheUUID) and written
+ * back atomically when the cache is destroyed.
+ */
+class VulkanPipelineCache {
+public:
+    VulkanPipelineCache(VkDevice device, const VkPhysicalDeviceProperties &properties, const String &path);
+   ~VulkanPipelineCache();
+
+    void Save();
+    VkPipelineCache GetHandle() const { return m_PipelineCache; }
+    VkPipelineCacheStats &GetStats() { return m_Stats; }
+
+private:
+    bool ValidateHeader(const char *data, size_t size) const;
+
+private:
+    VkDevice m_Device;
+    VkPhysicalDeviceProperties m_Properties;
+    String m_Path;
+    VkPipelineCache m_PipelineCache = VK_NULL_HANDLE;
+    VkPipelineCacheStats m_Stats;
+};
+
+#endif /* _VECTRAFLUX_VULKAN_PIPELINE_CACHE_H_ */
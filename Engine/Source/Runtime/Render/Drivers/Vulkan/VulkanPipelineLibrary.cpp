@@ -0,0 +1,412 @@
+/* ************************************************************************
+ *
+ * Copyright (C) 2022 Vincent Luo All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, e1ither express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ************************************************************************/
+
+/* Creates on 2026/10/17. */
+
+/*
+  ===================================
+    @author bit-fashion
+  ===================================
+*/
+#include "VulkanPipelineLibrary.h"
+#include <System.h>
+#include "Utils/IOUtils.h"
+#include "Utils/HashUtils.h"
+#include <cstring>
+#include <stdexcept>
+
+bool VkPipelineDesc::operator==(const VkPipelineDesc &other) const {
+    if (shaderfolder != other.shaderfolder || shadername != other.shadername)
+        return false;
+
+    if (vertexBindingCount != other.vertexBindingCount || vertexAttributeCount != other.vertexAttributeCount)
+        return false;
+    for (uint32_t i = 0; i < vertexBindingCount; i++) {
+        if (vertexStrides[i] != other.vertexStrides[i])
+            return false;
+    }
+    for (uint32_t i = 0; i < vertexAttributeCount; i++) {
+        const VkVertexInputAttributeDescription &a = vertexAttributes[i], &b = other.vertexAttributes[i];
+        if (a.location != b.location || a.binding != b.binding || a.format != b.format || a.offset != b.offset)
+            return false;
+    }
+
+    if (specializationConstantCount != other.specializationConstantCount)
+        return false;
+    for (uint32_t i = 0; i < specializationConstantCount; i++) {
+        if (specializationConstants[i].constantID != other.specializationConstants[i].constantID ||
+            specializationConstants[i].value != other.specializationConstants[i].value)
+            return false;
+    }
+
+    return topology == other.topology && polygonMode == other.polygonMode &&
+           cullMode == other.cullMode && frontFace == other.frontFace &&
+           colorAttachmentCount == other.colorAttachmentCount && blendEnable == other.blendEnable &&
+           srcColorBlendFactor == other.srcColorBlendFactor && dstColorBlendFactor == other.dstColorBlendFactor &&
+           colorBlendOp == other.colorBlendOp &&
+           srcAlphaBlendFactor == other.srcAlphaBlendFactor && dstAlphaBlendFactor == other.dstAlphaBlendFactor &&
+           alphaBlendOp == other.alphaBlendOp && colorWriteMask == other.colorWriteMask &&
+           depthTestEnable == other.depthTestEnable && depthWriteEnable == other.depthWriteEnable &&
+           depthCompareOp == other.depthCompareOp &&
+           renderPass == other.renderPass && subpass == other.subpass &&
+           descriptorSetLayout == other.descriptorSetLayout &&
+           bindlessSetLayout == other.bindlessSetLayout && pushConstantSize == other.pushConstantSize;
+}
+
+size_t VkPipelineDesc::Hash() const {
+    size_t hash = HashUtils::FNV_OFFSET_BASIS;
+    HashUtils::HashBytes(&hash, std::data(shaderfolder), std::size(shaderfolder));
+    HashUtils::HashBytes(&hash, std::data(shadername), std::size(shadername));
+
+    for (uint32_t i = 0; i < vertexBindingCount; i++)
+        HashUtils::HashValue(&hash, vertexStrides[i]);
+    for (uint32_t i = 0; i < vertexAttributeCount; i++) {
+        HashUtils::HashValue(&hash, vertexAttributes[i].location);
+        HashUtils::HashValue(&hash, vertexAttributes[i].binding);
+        HashUtils::HashValue(&hash, vertexAttributes[i].format);
+        HashUtils::HashValue(&hash, vertexAttributes[i].offset);
+    }
+
+    for (uint32_t i = 0; i < specializationConstantCount; i++) {
+        HashUtils::HashValue(&hash, specializationConstants[i].constantID);
+        HashUtils::HashValue(&hash, specializationConstants[i].value);
+    }
+
+    HashUtils::HashValue(&hash, topology);
+    HashUtils::HashValue(&hash, polygonMode);
+    HashUtils::HashValue(&hash, cullMode);
+    HashUtils::HashValue(&hash, frontFace);
+    HashUtils::HashValue(&hash, colorAttachmentCount);
+    HashUtils::HashValue(&hash, blendEnable);
+    HashUtils::HashValue(&hash, srcColorBlendFactor);
+    HashUtils::HashValue(&hash, dstColorBlendFactor);
+    HashUtils::HashValue(&hash, colorBlendOp);
+    HashUtils::HashValue(&hash, srcAlphaBlendFactor);
+    HashUtils::HashValue(&hash, dstAlphaBlendFactor);
+    HashUtils::HashValue(&hash, alphaBlendOp);
+    HashUtils::HashValue(&hash, colorWriteMask);
+    HashUtils::HashValue(&hash, depthTestEnable);
+    HashUtils::HashValue(&hash, depthWriteEnable);
+    HashUtils::HashValue(&hash, depthCompareOp);
+    HashUtils::HashValue(&hash, renderPass);
+    HashUtils::HashValue(&hash, subpass);
+    HashUtils::HashValue(&hash, descriptorSetLayout);
+    HashUtils::HashValue(&hash, bindlessSetLayout);
+    HashUtils::HashValue(&hash, pushConstantSize);
+
+    return hash;
+}
+
+VulkanPipelineLibrary::VulkanPipelineLibrary(VkDevice device, VulkanPipelineCache *pPipelineCache, uint32_t threadCount)
+    : m_Device(device), m_PipelineCache(pPipelineCache) {
+    m_ThreadPool = std::make_unique<ThreadPool>(threadCount);
+
+    VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {};
+    descriptorSetLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    vkCreateDescriptorSetLayout(m_Device, &descriptorSetLayoutCreateInfo, nullptr, &m_EmptySetLayout);
+}
+
+VulkanPipelineLibrary::~VulkanPipelineLibrary() {
+    /* 先让在编译的任务结束 */
+    m_ThreadPool.reset();
+
+    for (auto &[desc, entry] : m_Entries) {
+        if (entry->state != ENTRY_STATE_READY)
+            continue;
+        vkDestroyPipeline(m_Device, entry->pipeline.pipeline, nullptr);
+        vkDestroyPipelineLayout(m_Device, entry->pipeline.pipelineLayout, nullptr);
+    }
+
+    vkDestroyDescriptorSetLayout(m_Device, m_EmptySetLayout, nullptr);
+}
+
+void VulkanPipelineLibrary::GetPipeline(const VkPipelineDesc &desc, VkRenderPipeline *pPipeline) {
+    bool inserted;
+    Entry *entry = FindOrInsert(desc, &inserted);
+
+    if (inserted) {
+        Compile(desc, entry);
+    } else {
+        /* 可能正在工作线程上编译，等它完成 */
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_CompileCondition.wait(lock, [entry] { return entry->state != ENTRY_STATE_PENDING; });
+    }
+
+    if (entry->state != ENTRY_STATE_READY)
+        throw std::runtime_error(strfmt("failed to create graphics pipeline {}/{}!", desc.shaderfolder, desc.shadername));
+
+    *pPipeline = entry->pipeline;
+}
+
+bool VulkanPipelineLibrary::AcquirePipeline(const VkPipelineDesc &desc, const VkPipelineDesc *pFallback, VkRenderPipeline *pPipeline) {
+    bool inserted;
+    Entry *entry = FindOrInsert(desc, &inserted);
+
+    if (inserted) {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            ++m_Stats.asyncCompileCount;
+        }
+        VkPipelineDesc copy = desc;
+        m_ThreadPool->Submit([this, copy, entry] { Compile(copy, entry); });
+    }
+
+    if (entry->state == ENTRY_STATE_READY) {
+        *pPipeline = entry->pipeline;
+        return true;
+    }
+
+    *pPipeline = {};
+    if (pFallback != null) {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            ++m_Stats.fallbackCount;
+        }
+        /* fallback 应该是启动时已经编译好的通用管线 */
+        GetPipeline(*pFallback, pPipeline);
+    }
+
+    return false;
+}
+
+VulkanPipelineLibrary::Entry *VulkanPipelineLibrary::FindOrInsert(const VkPipelineDesc &desc, bool *pInserted) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    auto it = m_Entries.find(desc);
+    if (it != m_Entries.end()) {
+        ++m_Stats.hitCount;
+        *pInserted = false;
+        return it->second.get();
+    }
+
+    ++m_Stats.missCount;
+    *pInserted = true;
+    return m_Entries.emplace(desc, std::make_unique<Entry>()).first->second.get();
+}
+
+VkShaderModule VulkanPipelineLibrary::LoadShaderModule(const VkPipelineDesc &desc, const char *ext) {
+    size_t size;
+    char *buf = IOUtils::Read(strfmt("{}/{}.{}", desc.shaderfolder, desc.shadername, ext), &size);
+
+    VkShaderModuleCreateInfo shaderModuleCreateInfo = {};
+    shaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    shaderModuleCreateInfo.codeSize = size;
+    shaderModuleCreateInfo.pCode = reinterpret_cast<const uint32_t *>(buf);
+
+    VkShaderModule shaderModule = VK_NULL_HANDLE;
+    VkResult result = vkCreateShaderModule(m_Device, &shaderModuleCreateInfo, nullptr, &shaderModule);
+    IOUtils::Free(buf);
+
+    if (result != VK_SUCCESS)
+        throw std::runtime_error("failed to create shader module!");
+
+    return shaderModule;
+}
+
+void VulkanPipelineLibrary::Compile(const VkPipelineDesc &desc, Entry *entry) {
+    VkShaderModule vertexShaderModule = VK_NULL_HANDLE;
+    VkShaderModule fragmentShaderModule = VK_NULL_HANDLE;
+    VkRenderPipeline pipeline = {};
+    bool success = false;
+    timestamp64_t pipelineCreateStart = System::GetTimeNanos();
+
+    try {
+        vertexShaderModule = LoadShaderModule(desc, "vert.spv");
+        fragmentShaderModule = LoadShaderModule(desc, "frag.spv");
+
+        /* 特化常量 */
+        Array<VkSpecializationMapEntry, VULKAN_PIPELINE_MAX_SPECIALIZATION_CONSTANTS> specializationMapEntries = {};
+        Array<uint32_t, VULKAN_PIPELINE_MAX_SPECIALIZATION_CONSTANTS> specializationData = {};
+        for (uint32_t i = 0; i < desc.specializationConstantCount; i++) {
+            specializationMapEntries[i].constantID = desc.specializationConstants[i].constantID;
+            specializationMapEntries[i].offset = i * sizeof(uint32_t);
+            specializationMapEntries[i].size = sizeof(uint32_t);
+            specializationData[i] = desc.specializationConstants[i].value;
+        }
+
+        VkSpecializationInfo specializationInfo = {};
+        specializationInfo.mapEntryCount = desc.specializationConstantCount;
+        specializationInfo.pMapEntries = std::data(specializationMapEntries);
+        specializationInfo.dataSize = desc.specializationConstantCount * sizeof(uint32_t);
+        specializationInfo.pData = std::data(specializationData);
+
+        VkPipelineShaderStageCreateInfo pipelineShaderStageCreateInfos[2] = {};
+        pipelineShaderStageCreateInfos[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineShaderStageCreateInfos[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+        pipelineShaderStageCreateInfos[0].module = vertexShaderModule;
+        pipelineShaderStageCreateInfos[0].pName = "main";
+        pipelineShaderStageCreateInfos[0].pSpecializationInfo = desc.specializationConstantCount > 0 ? &specializationInfo : nullptr;
+        pipelineShaderStageCreateInfos[1] = pipelineShaderStageCreateInfos[0];
+        pipelineShaderStageCreateInfos[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+        pipelineShaderStageCreateInfos[1].module = fragmentShaderModule;
+
+        /* 顶点输入 */
+        Array<VkVertexInputBindingDescription, VULKAN_PIPELINE_MAX_VERTEX_BINDINGS> vertexInputBindingDescriptions = {};
+        for (uint32_t i = 0; i < desc.vertexBindingCount; i++) {
+            vertexInputBindingDescriptions[i].binding = i;
+            vertexInputBindingDescriptions[i].stride = desc.vertexStrides[i];
+            vertexInputBindingDescriptions[i].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+        }
+
+        VkPipelineVertexInputStateCreateInfo pipelineVertexInputStateCreateInfo = {};
+        pipelineVertexInputStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+        pipelineVertexInputStateCreateInfo.vertexBindingDescriptionCount = desc.vertexBindingCount;
+        pipelineVertexInputStateCreateInfo.pVertexBindingDescriptions = std::data(vertexInputBindingDescriptions);
+        pipelineVertexInputStateCreateInfo.vertexAttributeDescriptionCount = desc.vertexAttributeCount;
+        pipelineVertexInputStateCreateInfo.pVertexAttributeDescriptions = std::data(desc.vertexAttributes);
+
+        VkPipelineInputAssemblyStateCreateInfo pipelineInputAssembly = {};
+        pipelineInputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+        pipelineInputAssembly.topology = desc.topology;
+        pipelineInputAssembly.primitiveRestartEnable = VK_FALSE;
+
+        /* 视口和裁剪是动态状态，绑定管线时设置 */
+        VkPipelineViewportStateCreateInfo pipelineViewportStateCrateInfo = {};
+        pipelineViewportStateCrateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+        pipelineViewportStateCrateInfo.viewportCount = 1;
+        pipelineViewportStateCrateInfo.scissorCount = 1;
+
+        /* 光栅化阶段 */
+        VkPipelineRasterizationStateCreateInfo pipelineRasterizationStateCreateInfo = {};
+        pipelineRasterizationStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+        pipelineRasterizationStateCreateInfo.depthClampEnable = VK_FALSE;
+        pipelineRasterizationStateCreateInfo.rasterizerDiscardEnable = VK_FALSE;
+        pipelineRasterizationStateCreateInfo.polygonMode = desc.polygonMode;
+        pipelineRasterizationStateCreateInfo.lineWidth = 1.0f;
+        pipelineRasterizationStateCreateInfo.cullMode = desc.cullMode;
+        pipelineRasterizationStateCreateInfo.frontFace = desc.frontFace;
+        pipelineRasterizationStateCreateInfo.depthBiasEnable = VK_FALSE;
+
+        /* 多重采样 */
+        VkPipelineMultisampleStateCreateInfo pipelineMultisampleStateCreateInfo = {};
+        pipelineMultisampleStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+        pipelineMultisampleStateCreateInfo.sampleShadingEnable = VK_FALSE;
+        pipelineMultisampleStateCreateInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+        pipelineMultisampleStateCreateInfo.minSampleShading = 1.0f;
+
+        /* 深度 */
+        VkPipelineDepthStencilStateCreateInfo pipelineDepthStencilStateCreateInfo = {};
+        pipelineDepthStencilStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+        pipelineDepthStencilStateCreateInfo.depthTestEnable = desc.depthTestEnable;
+        pipelineDepthStencilStateCreateInfo.depthWriteEnable = desc.depthWriteEnable;
+        pipelineDepthStencilStateCreateInfo.depthCompareOp = desc.depthCompareOp;
+        pipelineDepthStencilStateCreateInfo.maxDepthBounds = 1.0f;
+
+        /* 颜色混合，数量要和 subpass 的颜色附件一致，纯深度 pass 为 0 */
+        if (desc.colorAttachmentCount > VULKAN_PIPELINE_MAX_COLOR_ATTACHMENTS)
+            throw std::runtime_error("too many pipeline color attachments!");
+        Array<VkPipelineColorBlendAttachmentState, VULKAN_PIPELINE_MAX_COLOR_ATTACHMENTS> pipelineColorBlendAttachmentStates = {};
+        for (uint32_t i = 0; i < desc.colorAttachmentCount; i++) {
+            pipelineColorBlendAttachmentStates[i].colorWriteMask = desc.colorWriteMask;
+            pipelineColorBlendAttachmentStates[i].blendEnable = desc.blendEnable;
+            pipelineColorBlendAttachmentStates[i].srcColorBlendFactor = desc.srcColorBlendFactor;
+            pipelineColorBlendAttachmentStates[i].dstColorBlendFactor = desc.dstColorBlendFactor;
+            pipelineColorBlendAttachmentStates[i].colorBlendOp = desc.colorBlendOp;
+            pipelineColorBlendAttachmentStates[i].srcAlphaBlendFactor = desc.srcAlphaBlendFactor;
+            pipelineColorBlendAttachmentStates[i].dstAlphaBlendFactor = desc.dstAlphaBlendFactor;
+            pipelineColorBlendAttachmentStates[i].alphaBlendOp = desc.alphaBlendOp;
+        }
+
+        VkPipelineColorBlendStateCreateInfo pipelineColorBlendStateCreateInfo = {};
+        pipelineColorBlendStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+        pipelineColorBlendStateCreateInfo.logicOpEnable = VK_FALSE;
+        pipelineColorBlendStateCreateInfo.logicOp = VK_LOGIC_OP_COPY;
+        pipelineColorBlendStateCreateInfo.attachmentCount = desc.colorAttachmentCount;
+        pipelineColorBlendStateCreateInfo.pAttachments = std::data(pipelineColorBlendAttachmentStates);
+
+        /* 动态修改 */
+        VkDynamicState dynamicStates[] = {
+                VK_DYNAMIC_STATE_VIEWPORT,
+                VK_DYNAMIC_STATE_SCISSOR,
+                VK_DYNAMIC_STATE_LINE_WIDTH,
+        };
+
+        VkPipelineDynamicStateCreateInfo pipelineDynamicStateCreateInfo = {};
+        pipelineDynamicStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+        pipelineDynamicStateCreateInfo.dynamicStateCount = std::size(dynamicStates);
+        pipelineDynamicStateCreateInfo.pDynamicStates = dynamicStates;
+
+        /* 管道布局 */
+        Vector<VkDescriptorSetLayout> setLayouts;
+        if (desc.descriptorSetLayout != VK_NULL_HANDLE || desc.bindlessSetLayout != VK_NULL_HANDLE)
+            setLayouts.push_back(desc.descriptorSetLayout != VK_NULL_HANDLE ? desc.descriptorSetLayout : m_EmptySetLayout);
+        if (desc.bindlessSetLayout != VK_NULL_HANDLE)
+            setLayouts.push_back(desc.bindlessSetLayout);
+
+        VkPushConstantRange pushConstantRange = {};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = desc.pushConstantSize;
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = std::size(setLayouts);
+        pipelineLayoutInfo.pSetLayouts = std::data(setLayouts);
+        pipelineLayoutInfo.pushConstantRangeCount = desc.pushConstantSize > 0 ? 1 : 0;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+        if (vkCreatePipelineLayout(m_Device, &pipelineLayoutInfo, nullptr, &pipeline.pipelineLayout) != VK_SUCCESS)
+            throw std::runtime_error("failed to create pipeline layout!");
+
+        VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo = {};
+        graphicsPipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+        graphicsPipelineCreateInfo.stageCount = std::size(pipelineShaderStageCreateInfos);
+        graphicsPipelineCreateInfo.pStages = pipelineShaderStageCreateInfos;
+        graphicsPipelineCreateInfo.pVertexInputState = &pipelineVertexInputStateCreateInfo;
+        graphicsPipelineCreateInfo.pInputAssemblyState = &pipelineInputAssembly;
+        graphicsPipelineCreateInfo.pViewportState = &pipelineViewportStateCrateInfo;
+        graphicsPipelineCreateInfo.pRasterizationState = &pipelineRasterizationStateCreateInfo;
+        graphicsPipelineCreateInfo.pMultisampleState = &pipelineMultisampleStateCreateInfo;
+        graphicsPipelineCreateInfo.pDepthStencilState = &pipelineDepthStencilStateCreateInfo;
+        graphicsPipelineCreateInfo.pColorBlendState = &pipelineColorBlendStateCreateInfo;
+        graphicsPipelineCreateInfo.pDynamicState = &pipelineDynamicStateCreateInfo;
+        graphicsPipelineCreateInfo.layout = pipeline.pipelineLayout;
+        graphicsPipelineCreateInfo.renderPass = desc.renderPass;
+        graphicsPipelineCreateInfo.subpass = desc.subpass;
+        graphicsPipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
+        graphicsPipelineCreateInfo.basePipelineIndex = -1;
+
+        /* VkPipelineCache 自身是线程安全的 */
+        if (vkCreateGraphicsPipelines(m_Device, m_PipelineCache->GetHandle(), 1, &graphicsPipelineCreateInfo,
+                                      nullptr, &pipeline.pipeline) != VK_SUCCESS)
+            throw std::runtime_error("failed to create graphics pipeline!");
+
+        success = true;
+    } catch (const std::exception &) {
+        if (pipeline.pipelineLayout != VK_NULL_HANDLE)
+            vkDestroyPipelineLayout(m_Device, pipeline.pipelineLayout, nullptr);
+    }
+
+    /* 销毁着色器模块 */
+    if (vertexShaderModule != VK_NULL_HANDLE)
+        vkDestroyShaderModule(m_Device, vertexShaderModule, nullptr);
+    if (fragmentShaderModule != VK_NULL_HANDLE)
+        vkDestroyShaderModule(m_Device, fragmentShaderModule, nullptr);
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        VkPipelineCacheStats &pipelineCacheStats = m_PipelineCache->GetStats();
+        pipelineCacheStats.createMicros += (System::GetTimeNanos() - pipelineCreateStart) / 1000;
+        if (success) {
+            ++pipelineCacheStats.pipelineCount;
+            entry->pipeline = pipeline;
+        }
+        entry->state = success ? ENTRY_STATE_READY : ENTRY_STATE_FAILED;
+    }
+    m_CompileCondition.notify_all();
+}
@@ -0,0 +1,162 @@
+/* ************************************************************************
+ *
+ * Copyright (C) 2022 Vincent Luo All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, e1ither express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ************************************************************************/
+
+/* Creates on 2026/10/17. */
+
+/*
+  ===================================
+    @author bit-fashion
+  ===================================
+*/
+#ifndef _VECTRAFLUX_VULKAN_PIPELINE_LIBRARY_H_
+#define _VECTRAFLUX_VULKAN_PIPELINE_LIBRARY_H_
+
+#include <vulkan/vulkan.h>
+#include <Typedef.h>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include "Utils/ThreadPool.h"
+#include "VulkanPipelineCache.h"
+
+#define VULKAN_PIPELINE_MAX_VERTEX_ATTRIBUTES 8
+#define VULKAN_PIPELINE_MAX_VERTEX_BINDINGS 4
+#define VULKAN_PIPELINE_MAX_SPECIALIZATION_CONSTANTS 8
+#define VULKAN_PIPELINE_MAX_COLOR_ATTACHMENTS 8
+
+struct VkRenderPipeline {
+    VkPipeline pipeline;
+    VkPipelineLayout pipelineLayout;
+};
+
+struct VkSpecializationConstant {
+    uint32_t constantID;
+    uint32_t value;
+};
+
+/**
+ * Everything that goes into a graphics pipeline. Two equal descs always map
+ * to the same VkPipeline in the library. Viewport and scissor are dynamic.
+ */
+struct VkPipelineDesc {
+    /* shaders: {shaderfolder}/{shadername}.vert.spv & .frag.spv */
+    String shaderfolder;
+    String shadername;
+
+    /* vertex layout, binding i has stride vertexStrides[i] */
+    uint32_t vertexBindingCount = 0;
+    Array<uint32_t, VULKAN_PIPELINE_MAX_VERTEX_BINDINGS> vertexStrides = {};
+    uint32_t vertexAttributeCount = 0;
+    Array<VkVertexInputAttributeDescription, VULKAN_PIPELINE_MAX_VERTEX_ATTRIBUTES> vertexAttributes = {};
+
+    /* raster */
+    VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    VkPolygonMode polygonMode = VK_POLYGON_MODE_FILL;
+    VkCullModeFlags cullMode = VK_CULL_MODE_BACK_BIT;
+    VkFrontFace frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+
+    /* blend, the same state for every color attachment, depth only passes use 0 */
+    uint32_t colorAttachmentCount = 1;
+    VkBool32 blendEnable = VK_TRUE;
+    VkBlendFactor srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+    VkBlendFactor dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    VkBlendOp colorBlendOp = VK_BLEND_OP_ADD;
+    VkBlendFactor srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    VkBlendFactor dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+    VkBlendOp alphaBlendOp = VK_BLEND_OP_ADD;
+    VkColorComponentFlags colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                                           VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+    /* depth */
+    VkBool32 depthTestEnable = VK_FALSE;
+    VkBool32 depthWriteEnable = VK_FALSE;
+    VkCompareOp depthCompareOp = VK_COMPARE_OP_LESS;
+
+    /* render pass compatibility & layout, the bindless texture table (if
+     * any) is always set 1 and pushConstantSize bytes are visible to the
+     * vertex and fragment stages */
+    VkRenderPass renderPass = VK_NULL_HANDLE;
+    uint32_t subpass = 0;
+    VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+    VkDescriptorSetLayout bindlessSetLayout = VK_NULL_HANDLE;
+    uint32_t pushConstantSize = 0;
+
+    /* specialization constants, applied to every stage */
+    uint32_t specializationConstantCount = 0;
+    Array<VkSpecializationConstant, VULKAN_PIPELINE_MAX_SPECIALIZATION_CONSTANTS> specializationConstants = {};
+
+    bool operator==(const VkPipelineDesc &other) const;
+    size_t Hash() const;
+};
+
+template<>
+struct std::hash<VkPipelineDesc> {
+    size_t operator()(const VkPipelineDesc &desc) const { return desc.Hash(); }
+};
+
+struct VkPipelineLibraryStats {
+    uint64_t hitCount = 0;
+    uint64_t missCount = 0;
+    uint64_t asyncCompileCount = 0;
+    uint64_t fallbackCount = 0; /* AcquirePipeline calls answered with the fallback */
+};
+
+/**
+ * Deduplicates pipelines by VkPipelineDesc. Misses are compiled either on the
+ * calling thread (GetPipeline) or on the library's worker threads
+ * (AcquirePipeline), in which case a fallback pipeline is handed out until
+ * the real one is ready. The library owns every pipeline it returns.
+ */
+class VulkanPipelineLibrary {
+public:
+    VulkanPipelineLibrary(VkDevice device, VulkanPipelineCache *pPipelineCache, uint32_t threadCount);
+   ~VulkanPipelineLibrary();
+
+    void GetPipeline(const VkPipelineDesc &desc, VkRenderPipeline *pPipeline);
+    bool AcquirePipeline(const VkPipelineDesc &desc, const VkPipelineDesc *pFallback, VkRenderPipeline *pPipeline);
+    void WaitIdle() { m_ThreadPool->Wait(); }
+    const VkPipelineLibraryStats &GetStats() const { return m_Stats; }
+
+private:
+    enum EntryState {
+        ENTRY_STATE_PENDING,
+        ENTRY_STATE_READY,
+        ENTRY_STATE_FAILED,
+    };
+
+    struct Entry {
+        std::atomic<uint32_t> state = ENTRY_STATE_PENDING;
+        VkRenderPipeline pipeline = {};
+    };
+
+    Entry *FindOrInsert(const VkPipelineDesc &desc, bool *pInserted);
+    void Compile(const VkPipelineDesc &desc, Entry *entry);
+    VkShaderModule LoadShaderModule(const VkPipelineDesc &desc, const char *ext);
+
+private:
+    VkDevice m_Device;
+    VulkanPipelineCache *m_PipelineCache;
+    VkDescriptorSetLayout m_EmptySetLayout; /* set 0 placeholder for bindless only pipelines */
+    HashMap<VkPipelineDesc, std::unique_ptr<Entry>> m_Entries;
+    VkPipelineLibraryStats m_Stats;
+    std::mutex m_Mutex;
+    std::condition_variable m_CompileCondition;
+    std::unique_ptr<ThreadPool> m_ThreadPool;
+};
+
+#endif /* _VECTRAFLUX_VULKAN_PIPELINE_LIBRARY_H_ */
@@ -0,0 +1,814 @@
+/* ************************************************************************
+ *
+ * Copyright (C) 2022 Vincent Luo All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, e1ither express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ************************************************************************/
+
+/* Creates on 2026/10/17. */
+
+/*
+  ===================================
+    @author bit-fashion
+  ===================================
+*/
+#include "VulkanRenderGraph.h"
+#include <stdexcept>
+#include <cstring>
+
+/* 需要在 barrier 里 flush 的写访问 */
+#define VULKAN_WRITE_ACCESS_MASK (VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | \
+                                  VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT | \
+                                  VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_MEMORY_WRITE_BIT)
+
+static const struct {
+    VkImageLayout layout;
+    VkPipelineStageFlags stages;
+    VkAccessFlags access;
+    bool write;
+    VkImageUsageFlags usage;
+} s_AccessInfos[VULKAN_RENDER_GRAPH_ACCESS_MAX_ENUM] = {
+        /* COLOR_ATTACHMENT */
+        {VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+         VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, true, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT},
+        /* DEPTH_ATTACHMENT */
+        {VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+         VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, true, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT},
+        /* DEPTH_READ */
+        {VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+         VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT, false, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT},
+        /* SAMPLED_FRAGMENT */
+        {VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+         VK_ACCESS_SHADER_READ_BIT, false, VK_IMAGE_USAGE_SAMPLED_BIT},
+        /* SAMPLED_COMPUTE */
+        {VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+         VK_ACCESS_SHADER_READ_BIT, false, VK_IMAGE_USAGE_SAMPLED_BIT},
+        /* STORAGE_COMPUTE */
+        {VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+         VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT, true, VK_IMAGE_USAGE_STORAGE_BIT},
+        /* TRANSFER_SRC */
+        {VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT,
+         VK_ACCESS_TRANSFER_READ_BIT, false, VK_IMAGE_USAGE_TRANSFER_SRC_BIT},
+        /* TRANSFER_DST */
+        {VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT,
+         VK_ACCESS_TRANSFER_WRITE_BIT, true, VK_IMAGE_USAGE_TRANSFER_DST_BIT},
+        /* PRESENT */
+        {VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+         0, false, 0},
+};
+
+static VkImageAspectFlags _GetFormatAspect(VkFormat format) {
+    switch (format) {
+        case VK_FORMAT_D16_UNORM:
+        case VK_FORMAT_X8_D24_UNORM_PACK32:
+        case VK_FORMAT_D32_SFLOAT:
+            return VK_IMAGE_ASPECT_DEPTH_BIT;
+        case VK_FORMAT_D16_UNORM_S8_UINT:
+        case VK_FORMAT_D24_UNORM_S8_UINT:
+        case VK_FORMAT_D32_SFLOAT_S8_UINT:
+            return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+        case VK_FORMAT_S8_UINT:
+            return VK_IMAGE_ASPECT_STENCIL_BIT;
+        default:
+            return VK_IMAGE_ASPECT_COLOR_BIT;
+    }
+}
+
+static bool _IsAttachmentAccess(VulkanRenderGraphAccess access) {
+    return access == VULKAN_RENDER_GRAPH_ACCESS_COLOR_ATTACHMENT ||
+           access == VULKAN_RENDER_GRAPH_ACCESS_DEPTH_ATTACHMENT ||
+           access == VULKAN_RENDER_GRAPH_ACCESS_DEPTH_READ;
+}
+
+//
+// VulkanRenderGraphPassBuilder
+//
+VulkanRenderGraphPassBuilder &VulkanRenderGraphPassBuilder::WriteColor(VkRenderGraphResource resource, const VkClearColorValue *pClearValue) {
+    VkClearValue clearValue = {};
+    if (pClearValue != null)
+        clearValue.color = *pClearValue;
+    m_Graph->_AddAccess(m_Pass, resource, VULKAN_RENDER_GRAPH_ACCESS_COLOR_ATTACHMENT, pClearValue != null ? &clearValue : null);
+    return *this;
+}
+
+VulkanRenderGraphPassBuilder &VulkanRenderGraphPassBuilder::WriteDepth(VkRenderGraphResource resource, const VkClearDepthStencilValue *pClearValue) {
+    VkClearValue clearValue = {};
+    if (pClearValue != null)
+        clearValue.depthStencil = *pClearValue;
+    m_Graph->_AddAccess(m_Pass, resource, VULKAN_RENDER_GRAPH_ACCESS_DEPTH_ATTACHMENT, pClearValue != null ? &clearValue : null);
+    return *this;
+}
+
+VulkanRenderGraphPassBuilder &VulkanRenderGraphPassBuilder::Read(VkRenderGraphResource resource, VulkanRenderGraphAccess access) {
+    if (s_AccessInfos[access].write)
+        throw std::invalid_argument("render graph read with a write access!");
+    m_Graph->_AddAccess(m_Pass, resource, access, null);
+    return *this;
+}
+
+VulkanRenderGraphPassBuilder &VulkanRenderGraphPassBuilder::Write(VkRenderGraphResource resource, VulkanRenderGraphAccess access) {
+    if (!s_AccessInfos[access].write)
+        throw std::invalid_argument("render graph write with a read only access!");
+    m_Graph->_AddAccess(m_Pass, resource, access, null);
+    return *this;
+}
+
+VulkanRenderGraphPassBuilder &VulkanRenderGraphPassBuilder::SetSideEffect() {
+    m_Graph->m_Passes[m_Pass].sideEffect = true;
+    return *this;
+}
+
+//
+// VulkanRenderGraph
+//
+VulkanRenderGraph::VulkanRenderGraph(VkDevice device, VulkanMemoryAllocator *allocator, uint32_t framesInFlight)
+    : m_Device(device), m_Allocator(allocator), m_FramesInFlight(framesInFlight) {
+}
+
+VulkanRenderGraph::~VulkanRenderGraph() {
+    _DestroyTransientSet(m_TransientSet);
+    for (auto &retired : m_RetiredTransientSets)
+        _DestroyTransientSet(retired.set);
+    PurgeFramebuffers();
+    for (auto &renderPass : m_RenderPasses)
+        vkDestroyRenderPass(m_Device, renderPass.second, nullptr);
+}
+
+void VulkanRenderGraph::Reset() {
+    ++m_FrameCount;
+
+    /* 旧的 transient 内存和 framebuffer 等在途帧结束后再销毁 */
+    for (size_t i = 0; i < std::size(m_RetiredTransientSets);) {
+        if (m_FrameCount >= m_RetiredTransientSets[i].frame + m_FramesInFlight) {
+            _DestroyTransientSet(m_RetiredTransientSets[i].set);
+            m_RetiredTransientSets.remove(i);
+            continue;
+        }
+        ++i;
+    }
+
+    for (size_t i = 0; i < std::size(m_Framebuffers);) {
+        if (m_FrameCount > m_Framebuffers[i].lastUsedFrame + m_FramesInFlight) {
+            vkDestroyFramebuffer(m_Device, m_Framebuffers[i].framebuffer, nullptr);
+            m_Framebuffers.remove(i);
+            continue;
+        }
+        ++i;
+    }
+
+    m_Passes.clear();
+    m_Resources.clear();
+}
+
+VkRenderGraphResource VulkanRenderGraph::CreateTexture(const char *name, const VkRenderGraphTextureDesc &desc) {
+    ResourceNode node = {};
+    node.name = name;
+    node.desc = desc;
+    m_Resources.push_back(node);
+    return std::size(m_Resources) - 1;
+}
+
+VkRenderGraphResource VulkanRenderGraph::ImportTexture(const char *name, const VkRenderGraphTextureDesc &desc, VkImage image, VkImageView imageView,
+                                                       VkImageLayout initialLayout, VkPipelineStageFlags initialStages, VulkanRenderGraphAccess finalAccess) {
+    ResourceNode node = {};
+    node.name = name;
+    node.desc = desc;
+    node.image = image;
+    node.imageView = imageView;
+    node.imported = true;
+    node.initialLayout = initialLayout;
+    node.initialStages = initialStages;
+    node.finalAccess = finalAccess;
+    m_Resources.push_back(node);
+    return std::size(m_Resources) - 1;
+}
+
+void VulkanRenderGraph::MarkOutput(VkRenderGraphResource resource) {
+    m_Resources[resource].output = true;
+}
+
+VulkanRenderGraphPassBuilder VulkanRenderGraph::AddPass(const char *name, VkRenderGraphExecuteCallback execute) {
+    PassNode pass = {};
+    pass.name = name;
+    pass.execute = std::move(execute);
+    m_Passes.push_back(std::move(pass));
+    return VulkanRenderGraphPassBuilder(this, std::size(m_Passes) - 1);
+}
+
+void VulkanRenderGraph::_AddAccess(uint32_t pass, VkRenderGraphResource resource, VulkanRenderGraphAccess access, const VkClearValue *pClearValue) {
+    ResourceNode &node = m_Resources[resource];
+
+    /* 没有 clear 的写会加载之前的内容，相当于也读了一次 */
+    bool previousContents = (node.imported && node.initialLayout != VK_IMAGE_LAYOUT_UNDEFINED) || !node.writers.empty();
+    bool write = s_AccessInfos[access].write;
+
+    ResourceAccess resourceAccess = {};
+    resourceAccess.resource = resource;
+    resourceAccess.access = access;
+    resourceAccess.write = write;
+    resourceAccess.read = !write || (pClearValue == null && previousContents);
+    resourceAccess.clear = pClearValue != null;
+    if (pClearValue != null)
+        resourceAccess.clearValue = *pClearValue;
+    m_Passes[pass].accesses.push_back(resourceAccess);
+
+    /* 只用于判断之前是否有内容，剔除时重新统计 */
+    if (write)
+        node.writers.push_back(pass);
+}
+
+void VulkanRenderGraph::_CullPasses() {
+    for (auto &node : m_Resources) {
+        node.writers.clear();
+        node.refCount = node.output ? 1 : 0;
+    }
+
+    /* 加载后再写的资源不算作自己的读者，否则永远剔除不掉 */
+    for (uint32_t i = 0; i < std::size(m_Passes); i++) {
+        PassNode &pass = m_Passes[i];
+        pass.culled = false;
+        pass.refCount = pass.sideEffect ? 1 : 0;
+        for (const auto &access : pass.accesses) {
+            if (access.write) {
+                m_Resources[access.resource].writers.push_back(i);
+                ++pass.refCount;
+            } else if (access.read) {
+                ++m_Resources[access.resource].refCount;
+            }
+        }
+    }
+
+    Vector<VkRenderGraphResource> unreferenced;
+    auto cull = [&](PassNode &pass) {
+        pass.culled = true;
+        for (const auto &access : pass.accesses) {
+            if (!access.read || access.write)
+                continue;
+            ResourceNode &node = m_Resources[access.resource];
+            if (node.refCount > 0 && --node.refCount == 0)
+                unreferenced.push_back(access.resource);
+        }
+    };
+
+    for (uint32_t i = 0; i < std::size(m_Resources); i++)
+        if (m_Resources[i].refCount == 0)
+            unreferenced.push_back(i);
+
+    for (auto &pass : m_Passes)
+        if (pass.refCount == 0)
+            cull(pass);
+
+    while (!unreferenced.empty()) {
+        ResourceNode &node = m_Resources[unreferenced.back()];
+        unreferenced.pop_back();
+        for (uint32_t writer : node.writers) {
+            PassNode &pass = m_Passes[writer];
+            if (!pass.culled && pass.refCount > 0 && --pass.refCount == 0)
+                cull(pass);
+        }
+    }
+
+    m_Stats.passCount = std::size(m_Passes);
+    m_Stats.culledPassCount = 0;
+    for (const auto &pass : m_Passes)
+        m_Stats.culledPassCount += pass.culled ? 1 : 0;
+}
+
+void VulkanRenderGraph::_ComputeLifetimes() {
+    for (uint32_t i = 0; i < std::size(m_Passes); i++) {
+        if (m_Passes[i].culled)
+            continue;
+        for (const auto &access : m_Passes[i].accesses) {
+            ResourceNode &node = m_Resources[access.resource];
+            if (node.firstPass == UINT32_MAX)
+                node.firstPass = i;
+            if (node.lastPass != i) {
+                node.lastStages = 0;
+                node.lastAccess = 0;
+            }
+            node.lastPass = i;
+            node.lastStages |= s_AccessInfos[access.access].stages;
+            node.lastAccess |= s_AccessInfos[access.access].access;
+            node.usage |= s_AccessInfos[access.access].usage;
+        }
+    }
+}
+
+void VulkanRenderGraph::_PrepareTransients() {
+    /* 本帧用到的 transient 纹理 */
+    TransientSet required;
+    for (uint32_t i = 0; i < std::size(m_Resources); i++) {
+        ResourceNode &node = m_Resources[i];
+        if (node.imported || node.firstPass == UINT32_MAX)
+            continue;
+        TransientImage image = {};
+        image.desc = node.desc;
+        image.usage = node.usage;
+        image.firstPass = node.firstPass;
+        image.lastPass = node.lastPass;
+        node.transientIndex = std::size(required.images);
+        required.images.push_back(image);
+    }
+
+    /* 和上一帧一致就沿用之前的内存布局 */
+    bool same = std::size(required.images) == std::size(m_TransientSet.images);
+    for (size_t i = 0; same && i < std::size(required.images); i++) {
+        const TransientImage &a = required.images[i];
+        const TransientImage &b = m_TransientSet.images[i];
+        same = a.desc.width == b.desc.width && a.desc.height == b.desc.height && a.desc.format == b.desc.format &&
+               a.usage == b.usage && a.firstPass == b.firstPass && a.lastPass == b.lastPass;
+    }
+
+    if (!same) {
+        if (!m_TransientSet.images.empty())
+            m_RetiredTransientSets.push_back({std::move(m_TransientSet), m_FrameCount});
+        m_TransientSet = std::move(required);
+        _BuildTransientSet(&m_TransientSet);
+    }
+
+    for (auto &node : m_Resources) {
+        if (node.transientIndex == UINT32_MAX)
+            continue;
+        node.image = m_TransientSet.images[node.transientIndex].image;
+        node.imageView = m_TransientSet.images[node.transientIndex].imageView;
+    }
+}
+
+void VulkanRenderGraph::_BuildTransientSet(TransientSet *pSet) {
+    Vector<TransientImage> &images = pSet->images;
+    Vector<VkDeviceSize> alignments(std::size(images));
+
+    for (size_t i = 0; i < std::size(images); i++) {
+        TransientImage &image = images[i];
+
+        VkImageCreateInfo imageCreateInfo = {};
+        imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageCreateInfo.extent = { image.desc.width, image.desc.height, 1 };
+        imageCreateInfo.mipLevels = 1;
+        imageCreateInfo.arrayLayers = 1;
+        imageCreateInfo.format = image.desc.format;
+        imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageCreateInfo.usage = image.usage;
+        imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        if (vkCreateImage(m_Device, &imageCreateInfo, nullptr, &image.image) != VK_SUCCESS)
+            throw std::runtime_error("failed to create render graph transient image!");
+
+        VkMemoryRequirements requirements;
+        vkGetImageMemoryRequirements(m_Device, image.image, &requirements);
+        image.size = requirements.size;
+        alignments[i] = requirements.alignment;
+
+        /* 同一种内存类型的纹理放进同一个 heap */
+        uint32_t memoryTypeIndex = m_Allocator->FindMemoryType(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        image.heap = UINT32_MAX;
+        for (uint32_t h = 0; h < std::size(pSet->heaps); h++)
+            if (pSet->heaps[h].memoryTypeIndex == memoryTypeIndex)
+                image.heap = h;
+        if (image.heap == UINT32_MAX) {
+            pSet->heaps.push_back({memoryTypeIndex, 0, VK_NULL_HANDLE});
+            image.heap = std::size(pSet->heaps) - 1;
+        }
+    }
+
+    /* 从大到小 first-fit，生命周期不重叠的纹理可以占用同一段内存 */
+    Vector<uint32_t> order(std::size(images));
+    for (uint32_t i = 0; i < std::size(order); i++)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return images[a].size > images[b].size; });
+
+    Vector<uint32_t> placed;
+    for (uint32_t index : order) {
+        TransientImage &image = images[index];
+
+        Vector<uint32_t> overlapping;
+        for (uint32_t other : placed) {
+            const TransientImage &o = images[other];
+            if (o.heap == image.heap && o.firstPass <= image.lastPass && image.firstPass <= o.lastPass)
+                overlapping.push_back(other);
+        }
+        std::sort(overlapping.begin(), overlapping.end(), [&](uint32_t a, uint32_t b) { return images[a].offset < images[b].offset; });
+
+        VkDeviceSize alignment = alignments[index];
+        VkDeviceSize offset = 0;
+        for (uint32_t other : overlapping) {
+            const TransientImage &o = images[other];
+            if (offset + image.size <= o.offset)
+                break;
+            offset = std::max(offset, (o.offset + o.size + alignment - 1) & ~(alignment - 1));
+        }
+
+        image.offset = offset;
+        pSet->heaps[image.heap].size = std::max(pSet->heaps[image.heap].size, offset + image.size);
+        placed.push_back(index);
+    }
+
+    m_Stats.transientRequestedBytes = 0;
+    m_Stats.transientMemoryBytes = 0;
+    for (auto &heap : pSet->heaps) {
+        VkMemoryAllocateInfo memoryAllocateInfo = {};
+        memoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        memoryAllocateInfo.allocationSize = heap.size;
+        memoryAllocateInfo.memoryTypeIndex = heap.memoryTypeIndex;
+        if (vkAllocateMemory(m_Device, &memoryAllocateInfo, nullptr, &heap.memory) != VK_SUCCESS)
+            throw std::runtime_error("failed to allocate render graph transient memory!");
+        m_Stats.transientMemoryBytes += heap.size;
+    }
+
+    for (auto &image : images) {
+        vkBindImageMemory(m_Device, image.image, pSet->heaps[image.heap].memory, image.offset);
+
+        VkImageViewCreateInfo imageViewCreateInfo = {};
+        imageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        imageViewCreateInfo.image = image.image;
+        imageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        imageViewCreateInfo.format = image.desc.format;
+        imageViewCreateInfo.subresourceRange.aspectMask = _GetFormatAspect(image.desc.format);
+        imageViewCreateInfo.subresourceRange.baseMipLevel = 0;
+        imageViewCreateInfo.subresourceRange.levelCount = 1;
+        imageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
+        imageViewCreateInfo.subresourceRange.layerCount = 1;
+        if (vkCreateImageView(m_Device, &imageViewCreateInfo, nullptr, &image.imageView) != VK_SUCCESS)
+            throw std::runtime_error("failed to create render graph transient image view!");
+
+        m_Stats.transientRequestedBytes += image.size;
+    }
+}
+
+void VulkanRenderGraph::_DestroyTransientSet(TransientSet &set) {
+    for (auto &image : set.images) {
+        vkDestroyImageView(m_Device, image.imageView, nullptr);
+        vkDestroyImage(m_Device, image.image, nullptr);
+    }
+    for (auto &heap : set.heaps)
+        vkFreeMemory(m_Device, heap.memory, nullptr);
+    set.images.clear();
+    set.heaps.clear();
+}
+
+void VulkanRenderGraph::_InitResourceStates() {
+    for (auto &node : m_Resources) {
+        if (node.imported) {
+            node.layout = node.initialLayout;
+            node.writeStages = node.initialStages;
+            node.writeAccess = 0;
+            node.readStages = 0;
+            node.visibleStages = node.initialStages;
+            node.hasContents = node.initialLayout != VK_IMAGE_LAYOUT_UNDEFINED;
+            continue;
+        }
+
+        node.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        node.writeStages = 0;
+        node.writeAccess = 0;
+        node.readStages = 0;
+        node.visibleStages = 0;
+        node.hasContents = false;
+        if (node.transientIndex == UINT32_MAX)
+            continue;
+
+        /* 第一次使用前要等共享同一段内存的纹理 (包括上一帧的自己) 用完 */
+        const TransientImage &image = m_TransientSet.images[node.transientIndex];
+        for (const auto &other : m_Resources) {
+            if (other.transientIndex == UINT32_MAX)
+                continue;
+            const TransientImage &o = m_TransientSet.images[other.transientIndex];
+            if (o.heap == image.heap && o.offset < image.offset + image.size && image.offset < o.offset + o.size) {
+                node.writeStages |= other.lastStages;
+                node.writeAccess |= other.lastAccess & VULKAN_WRITE_ACCESS_MASK;
+            }
+        }
+    }
+}
+
+void VulkanRenderGraph::_Transition(ResourceNode &node, VulkanRenderGraphAccess access, bool discard,
+                                    Vector<VkImageMemoryBarrier> &barriers, VkPipelineStageFlags *pSrcStages, VkPipelineStageFlags *pDstStages) {
+    const auto &info = s_AccessInfos[access];
+    bool layoutChange = node.layout != info.layout;
+
+    /* 同一布局下的读，之前的写已经对这些 stage 可见 */
+    if (!layoutChange && !info.write && (node.visibleStages & info.stages) == info.stages) {
+        node.readStages |= info.stages;
+        return;
+    }
+
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = discard ? VK_IMAGE_LAYOUT_UNDEFINED : node.layout;
+    barrier.newLayout = info.layout;
+    barrier.srcAccessMask = node.writeAccess & VULKAN_WRITE_ACCESS_MASK;
+    barrier.dstAccessMask = info.access;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = node.image;
+    barrier.subresourceRange.aspectMask = _GetFormatAspect(node.desc.format);
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    barriers.push_back(barrier);
+
+    /* 写或者布局转换之前还要等之前的读 (WAR) */
+    *pSrcStages |= node.writeStages;
+    if (info.write || layoutChange)
+        *pSrcStages |= node.readStages;
+    *pDstStages |= info.stages;
+
+    if (info.write || layoutChange) {
+        node.writeStages = info.stages;
+        node.writeAccess = info.write ? info.access : node.writeAccess;
+        node.readStages = info.write ? 0 : info.stages;
+        node.visibleStages = info.stages;
+    } else {
+        node.readStages |= info.stages;
+        node.visibleStages |= info.stages;
+    }
+    node.layout = info.layout;
+}
+
+void VulkanRenderGraph::_FlushBarriers(VkCommandBuffer commandBuffer, Vector<VkImageMemoryBarrier> &barriers,
+                                       VkPipelineStageFlags srcStages, VkPipelineStageFlags dstStages) {
+    if (barriers.empty())
+        return;
+
+    if (srcStages == 0)
+        srcStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, srcStages, dstStages, 0,
+                         0, nullptr, 0, nullptr,
+                         std::size(barriers), std::data(barriers));
+
+    ++m_Stats.barrierBatchCount;
+    m_Stats.imageBarrierCount += std::size(barriers);
+    barriers.clear();
+}
+
+void VulkanRenderGraph::_ExecutePass(VkCommandBuffer commandBuffer, uint32_t passIndex) {
+    PassNode &pass = m_Passes[passIndex];
+
+    Vector<VkImageMemoryBarrier> barriers;
+    VkPipelineStageFlags srcStages = 0, dstStages = 0;
+
+    RenderPassKey renderPassKey;
+    FramebufferKey framebufferKey;
+    memset(&renderPassKey, 0, sizeof(renderPassKey));
+    memset(&framebufferKey, 0, sizeof(framebufferKey));
+    Array<VkClearValue, VULKAN_RENDER_GRAPH_MAX_COLOR_ATTACHMENTS + 1> clearValues = {};
+    const ResourceAccess *pDepthAccess = null;
+    uint32_t width = 0, height = 0;
+
+    for (const auto &access : pass.accesses) {
+        ResourceNode &node = m_Resources[access.resource];
+        bool discard = access.write && (access.clear || !node.hasContents);
+        bool hadContents = node.hasContents;
+        _Transition(node, access.access, discard, barriers, &srcStages, &dstStages);
+        if (access.write)
+            node.hasContents = true;
+
+        if (!_IsAttachmentAccess(access.access))
+            continue;
+
+        width = node.desc.width;
+        height = node.desc.height;
+
+        /* 后面没有 pass 用到的 transient 附件不用写回 */
+        VkAttachmentLoadOp loadOp = access.clear ? VK_ATTACHMENT_LOAD_OP_CLEAR :
+                                    (hadContents ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+        VkAttachmentStoreOp storeOp = (node.imported || node.lastPass > passIndex) ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+
+        uint32_t slot;
+        if (access.access == VULKAN_RENDER_GRAPH_ACCESS_COLOR_ATTACHMENT) {
+            if (renderPassKey.colorCount == VULKAN_RENDER_GRAPH_MAX_COLOR_ATTACHMENTS)
+                throw std::runtime_error("too many render graph color attachments!");
+            slot = renderPassKey.colorCount++;
+        } else {
+            slot = VULKAN_RENDER_GRAPH_MAX_COLOR_ATTACHMENTS;
+            pDepthAccess = &access;
+            renderPassKey.depthLayout = s_AccessInfos[access.access].layout;
+        }
+        renderPassKey.formats[slot] = node.desc.format;
+        renderPassKey.loadOps[slot] = loadOp;
+        renderPassKey.storeOps[slot] = storeOp;
+        framebufferKey.attachments[slot] = node.imageView;
+        clearValues[slot] = access.clearValue;
+    }
+
+    _FlushBarriers(commandBuffer, barriers, srcStages, dstStages);
+
+    VkRenderGraphPassContext passContext = {};
+    passContext.commandBuffer = commandBuffer;
+
+    if (renderPassKey.colorCount == 0 && pDepthAccess == null) {
+        if (pass.execute)
+            pass.execute(passContext);
+        return;
+    }
+
+    /* 深度附件紧跟在颜色附件后面 */
+    uint32_t attachmentCount = renderPassKey.colorCount;
+    if (pDepthAccess != null) {
+        const uint32_t depth = VULKAN_RENDER_GRAPH_MAX_COLOR_ATTACHMENTS;
+        renderPassKey.formats[attachmentCount] = renderPassKey.formats[depth];
+        renderPassKey.loadOps[attachmentCount] = renderPassKey.loadOps[depth];
+        renderPassKey.storeOps[attachmentCount] = renderPassKey.storeOps[depth];
+        framebufferKey.attachments[attachmentCount] = framebufferKey.attachments[depth];
+        clearValues[attachmentCount] = clearValues[depth];
+        if (attachmentCount != depth) {
+            /* 保持 key 里未使用的槽位为零，缓存按字节比较 */
+            renderPassKey.formats[depth] = VkFormat(0);
+            renderPassKey.loadOps[depth] = VkAttachmentLoadOp(0);
+            renderPassKey.storeOps[depth] = VkAttachmentStoreOp(0);
+            framebufferKey.attachments[depth] = VK_NULL_HANDLE;
+        }
+        ++attachmentCount;
+    }
+
+    VkRenderPass renderPass = _AcquireRenderPass(renderPassKey);
+    framebufferKey.renderPass = renderPass;
+    framebufferKey.attachmentCount = attachmentCount;
+    framebufferKey.width = width;
+    framebufferKey.height = height;
+    VkFramebuffer framebuffer = _AcquireFramebuffer(framebufferKey);
+
+    VkRenderPassBeginInfo renderPassBeginInfo = {};
+    renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    renderPassBeginInfo.renderPass = renderPass;
+    renderPassBeginInfo.framebuffer = framebuffer;
+    renderPassBeginInfo.renderArea.offset = {0, 0};
+    renderPassBeginInfo.renderArea.extent = { width, height };
+    renderPassBeginInfo.clearValueCount = attachmentCount;
+    renderPassBeginInfo.pClearValues = std::data(clearValues);
+    vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+    passContext.renderPass = renderPass;
+    passContext.width = width;
+    passContext.height = height;
+    if (pass.execute)
+        pass.execute(passContext);
+
+    vkCmdEndRenderPass(commandBuffer);
+}
+
+void VulkanRenderGraph::Execute(VkCommandBuffer commandBuffer) {
+    m_Stats.barrierBatchCount = 0;
+    m_Stats.imageBarrierCount = 0;
+
+    _CullPasses();
+    _ComputeLifetimes();
+    _PrepareTransients();
+    _InitResourceStates();
+
+    for (uint32_t i = 0; i < std::size(m_Passes); i++)
+        if (!m_Passes[i].culled)
+            _ExecutePass(commandBuffer, i);
+
+    /* 导入的资源转换到外部期望的状态，合并成一次 barrier */
+    Vector<VkImageMemoryBarrier> barriers;
+    VkPipelineStageFlags srcStages = 0, dstStages = 0;
+    for (auto &node : m_Resources) {
+        if (node.imported && node.finalAccess != VULKAN_RENDER_GRAPH_ACCESS_MAX_ENUM)
+            _Transition(node, node.finalAccess, !node.hasContents, barriers, &srcStages, &dstStages);
+    }
+    _FlushBarriers(commandBuffer, barriers, srcStages, dstStages);
+}
+
+void VulkanRenderGraph::PurgeFramebuffers() {
+    for (auto &cached : m_Framebuffers)
+        vkDestroyFramebuffer(m_Device, cached.framebuffer, nullptr);
+    m_Framebuffers.clear();
+}
+
+VkRenderPass VulkanRenderGraph::_AcquireRenderPass(const RenderPassKey &key) {
+    for (const auto &renderPass : m_RenderPasses)
+        if (memcmp(&renderPass.first, &key, sizeof(key)) == 0)
+            return renderPass.second;
+
+    /* 布局转换全部由 graph 的 barrier 完成，render pass 内不做转换 */
+    uint32_t attachmentCount = key.colorCount + (key.depthLayout != VK_IMAGE_LAYOUT_UNDEFINED ? 1 : 0);
+    Array<VkAttachmentDescription, VULKAN_RENDER_GRAPH_MAX_COLOR_ATTACHMENTS + 1> attachments = {};
+    Array<VkAttachmentReference, VULKAN_RENDER_GRAPH_MAX_COLOR_ATTACHMENTS> colorReferences = {};
+    VkAttachmentReference depthReference = {};
+
+    for (uint32_t i = 0; i < attachmentCount; i++) {
+        bool depth = i == key.colorCount;
+        VkImageLayout layout = depth ? key.depthLayout : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+        attachments[i].format = key.formats[i];
+        attachments[i].samples = VK_SAMPLE_COUNT_1_BIT;
+        attachments[i].loadOp = key.loadOps[i];
+        attachments[i].storeOp = key.storeOps[i];
+        attachments[i].stencilLoadOp = depth ? key.loadOps[i] : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        attachments[i].stencilStoreOp = depth ? key.storeOps[i] : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachments[i].initialLayout = layout;
+        attachments[i].finalLayout = layout;
+
+        if (depth) {
+            depthReference.attachment = i;
+            depthReference.layout = layout;
+        } else {
+            colorReferences[i].attachment = i;
+            colorReferences[i].layout = layout;
+        }
+    }
+
+    VkSubpassDescription subpassDescription = {};
+    subpassDescription.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpassDescription.colorAttachmentCount = key.colorCount;
+    subpassDescription.pColorAttachments = std::data(colorReferences);
+    subpassDescription.pDepthStencilAttachment = key.depthLayout != VK_IMAGE_LAYOUT_UNDEFINED ? &depthReference : nullptr;
+
+    VkRenderPassCreateInfo renderPassCreateInfo = {};
+    renderPassCreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    renderPassCreateInfo.attachmentCount = attachmentCount;
+    renderPassCreateInfo.pAttachments = std::data(attachments);
+    renderPassCreateInfo.subpassCount = 1;
+    renderPassCreateInfo.pSubpasses = &subpassDescription;
+
+    VkRenderPass renderPass;
+    if (vkCreateRenderPass(m_Device, &renderPassCreateInfo, nullptr, &renderPass) != VK_SUCCESS)
+        throw std::runtime_error("failed to create render graph render pass!");
+    m_RenderPasses.push_back({key, renderPass});
+    return renderPass;
+}
+
+VkFramebuffer VulkanRenderGraph::_AcquireFramebuffer(const FramebufferKey &key) {
+    for (auto &cached : m_Framebuffers) {
+        if (memcmp(&cached.key, &key, sizeof(key)) == 0) {
+            cached.lastUsedFrame = m_FrameCount;
+            return cached.framebuffer;
+        }
+    }
+
+    VkFramebufferCreateInfo framebufferCreateInfo = {};
+    framebufferCreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    framebufferCreateInfo.renderPass = key.renderPass;
+    framebufferCreateInfo.attachmentCount = key.attachmentCount;
+    framebufferCreateInfo.pAttachments = key.attachments;
+    framebufferCreateInfo.width = key.width;
+    framebufferCreateInfo.height = key.height;
+    framebufferCreateInfo.layers = 1;
+
+    CachedFramebuffer cached = {};
+    cached.key = key;
+    cached.lastUsedFrame = m_FrameCount;
+    if (vkCreateFramebuffer(m_Device, &framebufferCreateInfo, nullptr, &cached.framebuffer) != VK_SUCCESS)
+        throw std::runtime_error("failed to create render graph framebuffer!");
+    m_Framebuffers.push_back(cached);
+    return cached.framebuffer;
+}
+
+void VulkanRenderGraph::GetImageLayoutScope(VkImageLayout layout, VkPipelineStageFlags *pStages, VkAccessFlags *pAccess) {
+    switch (layout) {
+        case VK_IMAGE_LAYOUT_UNDEFINED:
+        case VK_IMAGE_LAYOUT_PREINITIALIZED:
+            *pStages = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+            *pAccess = 0;
+            return;
+        case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+            *pStages = VK_PIPELINE_STAGE_TRANSFER_BIT;
+            *pAccess = VK_ACCESS_TRANSFER_WRITE_BIT;
+            return;
+        case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+            *pStages = VK_PIPELINE_STAGE_TRANSFER_BIT;
+            *pAccess = VK_ACCESS_TRANSFER_READ_BIT;
+            return;
+        case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+            *pStages = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+            *pAccess = VK_ACCESS_SHADER_READ_BIT;
+            return;
+        case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+            *pStages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+            *pAccess = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+            return;
+        case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
+            *pStages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+            *pAccess = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+            return;
+        case VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL:
+            *pStages = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+            *pAccess = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+            return;
+        case VK_IMAGE_LAYOUT_GENERAL:
+            *pStages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+            *pAccess = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+            return;
+        case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:
+            *pStages = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+            *pAccess = 0;
+            return;
+        default:
+            throw std::invalid_argument("unsupported image layout!");
+    }
+}
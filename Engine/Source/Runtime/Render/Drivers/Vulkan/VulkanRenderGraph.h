@@ -0,0 +1,271 @@
+/* ************************************************************************
+ *
+ * Copyright (C) 2022 Vincent Luo All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, e1ither express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ************************************************************************/
+
+/* Creates on 2026/10/17. */
+
+/*
+  ===================================
+    @author bit-fashion
+  ===================================
+*/
+#ifndef _VECTRAFLUX_VULKAN_RENDER_GRAPH_H_
+#define _VECTRAFLUX_VULKAN_RENDER_GRAPH_H_
+
+#include <vulkan/vulkan.h>
+#include <Typedef.h>
+#include <functional>
+#include "VulkanMemoryAllocator.h"
+
+typedef uint32_t VkRenderGraphResource;
+#define VULKAN_RENDER_GRAPH_INVALID_RESOURCE UINT32_MAX
+
+/* 单个 pass 最多的颜色附件数量 */
+#define VULKAN_RENDER_GRAPH_MAX_COLOR_ATTACHMENTS 8
+
+/* How a pass touches a resource, each one maps to a layout, stages and access mask. */
+enum VulkanRenderGraphAccess {
+    VULKAN_RENDER_GRAPH_ACCESS_COLOR_ATTACHMENT = 0,
+    VULKAN_RENDER_GRAPH_ACCESS_DEPTH_ATTACHMENT,
+    VULKAN_RENDER_GRAPH_ACCESS_DEPTH_READ,
+    VULKAN_RENDER_GRAPH_ACCESS_SAMPLED_FRAGMENT,
+    VULKAN_RENDER_GRAPH_ACCESS_SAMPLED_COMPUTE,
+    VULKAN_RENDER_GRAPH_ACCESS_STORAGE_COMPUTE,
+    VULKAN_RENDER_GRAPH_ACCESS_TRANSFER_SRC,
+    VULKAN_RENDER_GRAPH_ACCESS_TRANSFER_DST,
+    VULKAN_RENDER_GRAPH_ACCESS_PRESENT,
+    VULKAN_RENDER_GRAPH_ACCESS_MAX_ENUM
+};
+
+struct VkRenderGraphTextureDesc {
+    uint32_t width;
+    uint32_t height;
+    VkFormat format;
+};
+
+struct VkRenderGraphPassContext {
+    VkCommandBuffer commandBuffer;
+    VkRenderPass renderPass; /* null for passes without attachments */
+    uint32_t width;
+    uint32_t height;
+};
+
+typedef std::function<void(const VkRenderGraphPassContext &)> VkRenderGraphExecuteCallback;
+
+struct VkRenderGraphStats {
+    uint32_t passCount = 0;
+    uint32_t culledPassCount = 0;
+    uint32_t barrierBatchCount = 0; /* vkCmdPipelineBarrier calls */
+    uint32_t imageBarrierCount = 0;
+    uint64_t transientRequestedBytes = 0; /* sum of all transient images */
+    uint64_t transientMemoryBytes = 0; /* after aliasing */
+};
+
+class VulkanRenderGraph;
+
+/**
+ * Declares what a pass reads and writes, returned by AddPass().
+ */
+class VulkanRenderGraphPassBuilder {
+public:
+    VulkanRenderGraphPassBuilder(VulkanRenderGraph *graph, uint32_t pass) : m_Graph(graph), m_Pass(pass) {}
+
+    /* attachments, without a clear value the previous contents are loaded */
+    VulkanRenderGraphPassBuilder &WriteColor(VkRenderGraphResource resource, const VkClearColorValue *pClearValue = null);
+    VulkanRenderGraphPassBuilder &WriteDepth(VkRenderGraphResource resource, const VkClearDepthStencilValue *pClearValue = null);
+    VulkanRenderGraphPassBuilder &Read(VkRenderGraphResource resource, VulkanRenderGraphAccess access);
+    VulkanRenderGraphPassBuilder &Write(VkRenderGraphResource resource, VulkanRenderGraphAccess access);
+    /* never culled even if nothing reads its outputs */
+    VulkanRenderGraphPassBuilder &SetSideEffect();
+
+private:
+    VulkanRenderGraph *m_Graph;
+    uint32_t m_Pass;
+};
+
+/**
+ * Frame graph rebuilt every frame. Passes declare the resources they touch and
+ * run in declaration order, the graph then
+ *
+ *  - culls passes whose outputs nobody reads (imported outputs and side
+ *    effect passes are the roots),
+ *  - records one merged vkCmdPipelineBarrier in front of each pass with the
+ *    exact stages, access masks and layouts of the previous and next use,
+ *  - places transient textures in shared device memory, textures whose
+ *    lifetimes don't overlap alias the same range.
+ *
+ * Render passes and framebuffers are cached across frames, the transient
+ * memory layout is kept as long as the set of transients doesn't change.
+ * Resources are not versioned, a write keeps every earlier writer alive.
+ */
+class VulkanRenderGraph {
+public:
+    VulkanRenderGraph(VkDevice device, VulkanMemoryAllocator *allocator, uint32_t framesInFlight);
+   ~VulkanRenderGraph();
+
+    /* start a new frame, the frame's fence must already have been waited */
+    void Reset();
+
+    VkRenderGraphResource CreateTexture(const char *name, const VkRenderGraphTextureDesc &desc);
+    VkRenderGraphResource ImportTexture(const char *name, const VkRenderGraphTextureDesc &desc, VkImage image, VkImageView imageView,
+                                        VkImageLayout initialLayout, VkPipelineStageFlags initialStages, VulkanRenderGraphAccess finalAccess);
+    /* imported resource that keeps its writers alive (swapchain image) */
+    void MarkOutput(VkRenderGraphResource resource);
+
+    VulkanRenderGraphPassBuilder AddPass(const char *name, VkRenderGraphExecuteCallback execute);
+
+    /* cull, allocate transients and record every pass */
+    void Execute(VkCommandBuffer commandBuffer);
+
+    /* drop cached framebuffers, call after waiting idle when image views are destroyed */
+    void PurgeFramebuffers();
+
+    const VkRenderGraphStats &GetStats() const { return m_Stats; }
+
+    /* stages and access mask of an image layout when the consumer is unknown */
+    static void GetImageLayoutScope(VkImageLayout layout, VkPipelineStageFlags *pStages, VkAccessFlags *pAccess);
+
+private:
+    friend class VulkanRenderGraphPassBuilder;
+
+    struct ResourceAccess {
+        VkRenderGraphResource resource;
+        VulkanRenderGraphAccess access;
+        bool read; /* reads or loads earlier contents */
+        bool write;
+        bool clear;
+        VkClearValue clearValue;
+    };
+
+    struct PassNode {
+        String name;
+        VkRenderGraphExecuteCallback execute;
+        Vector<ResourceAccess> accesses;
+        bool sideEffect = false;
+        bool culled = false;
+        uint32_t refCount = 0;
+    };
+
+    struct ResourceNode {
+        String name;
+        VkRenderGraphTextureDesc desc;
+        VkImage image = VK_NULL_HANDLE;
+        VkImageView imageView = VK_NULL_HANDLE;
+        bool imported = false;
+        bool output = false;
+        VkImageLayout initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags initialStages = 0;
+        VulkanRenderGraphAccess finalAccess = VULKAN_RENDER_GRAPH_ACCESS_MAX_ENUM;
+        /* compile */
+        Vector<uint32_t> writers;
+        uint32_t refCount = 0;
+        uint32_t firstPass = UINT32_MAX;
+        uint32_t lastPass = 0;
+        VkPipelineStageFlags lastStages = 0;
+        VkAccessFlags lastAccess = 0;
+        VkImageUsageFlags usage = 0;
+        uint32_t transientIndex = UINT32_MAX;
+        /* execute */
+        VkImageLayout layout;
+        VkPipelineStageFlags writeStages;
+        VkAccessFlags writeAccess;
+        VkPipelineStageFlags readStages;
+        VkPipelineStageFlags visibleStages;
+        bool hasContents;
+    };
+
+    /* a transient texture placed in one of the heaps */
+    struct TransientImage {
+        VkRenderGraphTextureDesc desc;
+        VkImageUsageFlags usage;
+        uint32_t firstPass;
+        uint32_t lastPass;
+        VkImage image;
+        VkImageView imageView;
+        uint32_t heap;
+        VkDeviceSize offset;
+        VkDeviceSize size;
+    };
+
+    struct TransientHeap {
+        uint32_t memoryTypeIndex;
+        VkDeviceSize size;
+        VkDeviceMemory memory;
+    };
+
+    struct TransientSet {
+        Vector<TransientImage> images;
+        Vector<TransientHeap> heaps;
+    };
+
+    struct RenderPassKey {
+        uint32_t colorCount;
+        VkFormat formats[VULKAN_RENDER_GRAPH_MAX_COLOR_ATTACHMENTS + 1];
+        VkAttachmentLoadOp loadOps[VULKAN_RENDER_GRAPH_MAX_COLOR_ATTACHMENTS + 1];
+        VkAttachmentStoreOp storeOps[VULKAN_RENDER_GRAPH_MAX_COLOR_ATTACHMENTS + 1];
+        VkImageLayout depthLayout; /* undefined when there is no depth attachment */
+    };
+
+    struct FramebufferKey {
+        VkRenderPass renderPass;
+        uint32_t attachmentCount;
+        VkImageView attachments[VULKAN_RENDER_GRAPH_MAX_COLOR_ATTACHMENTS + 1];
+        uint32_t width;
+        uint32_t height;
+    };
+
+    struct CachedFramebuffer {
+        FramebufferKey key;
+        VkFramebuffer framebuffer;
+        uint64_t lastUsedFrame;
+    };
+
+    struct RetiredTransientSet {
+        TransientSet set;
+        uint64_t frame;
+    };
+
+    void _AddAccess(uint32_t pass, VkRenderGraphResource resource, VulkanRenderGraphAccess access, const VkClearValue *pClearValue);
+    void _CullPasses();
+    void _ComputeLifetimes();
+    void _PrepareTransients();
+    void _InitResourceStates();
+    void _BuildTransientSet(TransientSet *pSet);
+    void _DestroyTransientSet(TransientSet &set);
+    void _Transition(ResourceNode &node, VulkanRenderGraphAccess access, bool discard,
+                     Vector<VkImageMemoryBarrier> &barriers, VkPipelineStageFlags *pSrcStages, VkPipelineStageFlags *pDstStages);
+    void _FlushBarriers(VkCommandBuffer commandBuffer, Vector<VkImageMemoryBarrier> &barriers,
+                        VkPipelineStageFlags srcStages, VkPipelineStageFlags dstStages);
+    void _ExecutePass(VkCommandBuffer commandBuffer, uint32_t passIndex);
+    VkRenderPass _AcquireRenderPass(const RenderPassKey &key);
+    VkFramebuffer _AcquireFramebuffer(const FramebufferKey &key);
+
+private:
+    VkDevice m_Device;
+    VulkanMemoryAllocator *m_Allocator;
+    uint32_t m_FramesInFlight;
+    uint64_t m_FrameCount = 0;
+    Vector<PassNode> m_Passes;
+    Vector<ResourceNode> m_Resources;
+    TransientSet m_TransientSet;
+    Vector<RetiredTransientSet> m_RetiredTransientSets;
+    Vector<std::pair<RenderPassKey, VkRenderPass>> m_RenderPasses;
+    Vector<CachedFramebuffer> m_Framebuffers;
+    VkRenderGraphStats m_Stats;
+};
+
+#endif /* _VECTRAFLUX_VULKAN_RENDER_GRAPH_H_ */
@@ -0,0 +1,147 @@
+/* ************************************************************************
+ *
+ * Copyright (C) 2022 Vincent Luo All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, e1ither express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ************************************************************************/
+
+/* Creates on 2026/10/17. */
+
+/*
+  ===================================
+    @author bit-fashion
+  ===================================
+*/
+#include "VulkanSamplerCache.h"
+#include "Utils/HashUtils.h"
+#include <stdexcept>
+
+bool VkSamplerDesc::operator==(const VkSamplerDesc &other) const {
+    return magFilter == other.magFilter && minFilter == other.minFilter && mipmapMode == other.mipmapMode &&
+           addressModeU == other.addressModeU && addressModeV == other.addressModeV && addressModeW == other.addressModeW &&
+           borderColor == other.borderColor &&
+           anisotropyEnable == other.anisotropyEnable && maxAnisotropy == other.maxAnisotropy &&
+           mipLodBias == other.mipLodBias && minLod == other.minLod && maxLod == other.maxLod &&
+           compareEnable == other.compareEnable && compareOp == other.compareOp;
+}
+
+size_t VkSamplerDesc::Hash() const {
+    size_t hash = HashUtils::FNV_OFFSET_BASIS;
+    HashUtils::HashValue(&hash, magFilter);
+    HashUtils::HashValue(&hash, minFilter);
+    HashUtils::HashValue(&hash, mipmapMode);
+    HashUtils::HashValue(&hash, addressModeU);
+    HashUtils::HashValue(&hash, addressModeV);
+    HashUtils::HashValue(&hash, addressModeW);
+    HashUtils::HashValue(&hash, borderColor);
+    HashUtils::HashValue(&hash, anisotropyEnable);
+    HashUtils::HashValue(&hash, maxAnisotropy);
+    HashUtils::HashValue(&hash, mipLodBias);
+    HashUtils::HashValue(&hash, minLod);
+    HashUtils::HashValue(&hash, maxLod);
+    HashUtils::HashValue(&hash, compareEnable);
+    HashUtils::HashValue(&hash, compareOp);
+    return hash;
+}
+
+VulkanSamplerCache::VulkanSamplerCache(VkDevice device, VkBool32 anisotropySupported, float maxAnisotropy)
+  : m_Device(device), m_AnisotropySupported(anisotropySupported), m_MaxAnisotropy(maxAnisotropy) {
+}
+
+VulkanSamplerCache::~VulkanSamplerCache() {
+    for (auto &[desc, entry] : m_Entries)
+        vkDestroySampler(m_Device, entry.sampler, nullptr);
+}
+
+VkSamplerDesc VulkanSamplerCache::_Normalize(const VkSamplerDesc &desc) const {
+    /* 对设备无效的状态统一掉，避免生成只是字段不同但实际相同的 sampler */
+    VkSamplerDesc normalized = desc;
+    if (!m_AnisotropySupported || !normalized.anisotropyEnable || normalized.maxAnisotropy <= 1.0f) {
+        normalized.anisotropyEnable = VK_FALSE;
+        normalized.maxAnisotropy = 1.0f;
+    } else {
+        normalized.maxAnisotropy = std::min(normalized.maxAnisotropy, m_MaxAnisotropy);
+    }
+    if (!normalized.compareEnable)
+        normalized.compareOp = VK_COMPARE_OP_ALWAYS;
+    return normalized;
+}
+
+VkSampler VulkanSamplerCache::Acquire(const VkSamplerDesc &desc) {
+    VkSamplerDesc normalized = _Normalize(desc);
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    auto it = m_Entries.find(normalized);
+    if (it != m_Entries.end()) {
+        ++it->second.refCount;
+        ++m_Stats.hitCount;
+        return it->second.sampler;
+    }
+
+    VkSamplerCreateInfo samplerInfo = {};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = normalized.magFilter;
+    samplerInfo.minFilter = normalized.minFilter;
+    samplerInfo.mipmapMode = normalized.mipmapMode;
+    samplerInfo.addressModeU = normalized.addressModeU;
+    samplerInfo.addressModeV = normalized.addressModeV;
+    samplerInfo.addressModeW = normalized.addressModeW;
+    samplerInfo.borderColor = normalized.borderColor;
+    samplerInfo.anisotropyEnable = normalized.anisotropyEnable;
+    samplerInfo.maxAnisotropy = normalized.maxAnisotropy;
+    samplerInfo.mipLodBias = normalized.mipLodBias;
+    samplerInfo.minLod = normalized.minLod;
+    samplerInfo.maxLod = normalized.maxLod;
+    samplerInfo.compareEnable = normalized.compareEnable;
+    samplerInfo.compareOp = normalized.compareOp;
+    samplerInfo.unnormalizedCoordinates = VK_FALSE;
+
+    VkSampler sampler;
+    if (vkCreateSampler(m_Device, &samplerInfo, nullptr, &sampler) != VK_SUCCESS)
+        throw std::runtime_error("failed to create sampler!");
+
+    m_Entries.emplace(normalized, Entry { sampler, 1 });
+    m_Descs.emplace(sampler, normalized);
+    ++m_Stats.missCount;
+    ++m_Stats.samplerCount;
+    return sampler;
+}
+
+void VulkanSamplerCache::Release(VkSampler sampler) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    auto it = m_Descs.find(sampler);
+    if (it == m_Descs.end())
+        throw std::runtime_error("release sampler that is not owned by the sampler cache!");
+
+    Entry &entry = m_Entries.at(it->second);
+    if (entry.refCount > 0)
+        --entry.refCount;
+}
+
+void VulkanSamplerCache::PurgeUnused() {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+
+    for (auto it = m_Entries.begin(); it != m_Entries.end();) {
+        if (it->second.refCount != 0) {
+            ++it;
+            continue;
+        }
+
+        vkDestroySampler(m_Device, it->second.sampler, nullptr);
+        m_Descs.erase(it->second.sampler);
+        it = m_Entries.erase(it);
+        --m_Stats.samplerCount;
+    }
+}
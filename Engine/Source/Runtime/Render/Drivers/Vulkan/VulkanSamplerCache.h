@@ -0,0 +1,109 @@
+/* ************************************************************************
+ *
+ * Copyright (C) 2022 Vincent Luo All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, e1ither express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ************************************************************************/
+
+/* Creates on 2026/10/17. */
+
+/*
+  ===================================
+    @author bit-fashion
+  ===================================
+*/
+#ifndef _VECTRAFLUX_VULKAN_SAMPLER_CACHE_H_
+#define _VECTRAFLUX_VULKAN_SAMPLER_CACHE_H_
+
+#include <vulkan/vulkan.h>
+#include <Typedef.h>
+#include <mutex>
+
+/**
+ * Sampler state, equal descs share one VkSampler. The default is the
+ * trilinear repeat sampler textures get when nothing else is asked for.
+ */
+struct VkSamplerDesc {
+    VkFilter magFilter = VK_FILTER_LINEAR;
+    VkFilter minFilter = VK_FILTER_LINEAR;
+    VkSamplerMipmapMode mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    VkSamplerAddressMode addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    VkSamplerAddressMode addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    VkSamplerAddressMode addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    VkBorderColor borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+
+    /* clamped to the device limit, ignored when the device has no anisotropy */
+    VkBool32 anisotropyEnable = VK_TRUE;
+    float maxAnisotropy = 16.0f;
+
+    /* lod */
+    float mipLodBias = 0.0f;
+    float minLod = 0.0f;
+    float maxLod = VK_LOD_CLAMP_NONE;
+
+    /* depth compare (shadow maps) */
+    VkBool32 compareEnable = VK_FALSE;
+    VkCompareOp compareOp = VK_COMPARE_OP_ALWAYS;
+
+    bool operator==(const VkSamplerDesc &other) const;
+    size_t Hash() const;
+};
+
+template<>
+struct std::hash<VkSamplerDesc> {
+    size_t operator()(const VkSamplerDesc &desc) const { return desc.Hash(); }
+};
+
+struct VkSamplerCacheStats {
+    uint32_t samplerCount = 0; /* live VkSampler objects */
+    uint64_t hitCount = 0;
+    uint64_t missCount = 0;
+};
+
+/**
+ * Shared, reference counted samplers keyed by VkSamplerDesc. A sampler whose
+ * last reference is released stays cached, frames in flight may still use it
+ * and it is likely requested again. PurgeUnused() destroys those once the
+ * device is idle.
+ */
+class VulkanSamplerCache {
+public:
+    VulkanSamplerCache(VkDevice device, VkBool32 anisotropySupported, float maxAnisotropy);
+   ~VulkanSamplerCache();
+
+    VkSampler Acquire(const VkSamplerDesc &desc);
+    void Release(VkSampler sampler);
+    /* call after waiting for the device */
+    void PurgeUnused();
+    const VkSamplerCacheStats &GetStats() const { return m_Stats; }
+
+private:
+    struct Entry {
+        VkSampler sampler;
+        uint32_t refCount;
+    };
+
+    VkSamplerDesc _Normalize(const VkSamplerDesc &desc) const;
+
+private:
+    VkDevice m_Device;
+    VkBool32 m_AnisotropySupported;
+    float m_MaxAnisotropy;
+    HashMap<VkSamplerDesc, Entry> m_Entries;
+    HashMap<VkSampler, VkSamplerDesc> m_Descs; /* Release() 反查 */
+    VkSamplerCacheStats m_Stats;
+    std::mutex m_Mutex;
+};
+
+#endif /* _VECTRAFLUX_VULKAN_SAMPLER_CACHE_H_ */
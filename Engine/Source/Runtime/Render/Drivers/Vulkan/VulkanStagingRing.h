@@ -0,0 +1,79 @@
+/* ************************************************************************
+ *
+ * Copyright (C) 2022 Vincent Luo All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, e1ither express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ************************************************************************/
+
+/* Creates on 2026/10/17. */
+
+/*
+  ===================================
+    @author bit-fashion
+  ===================================
+*/
+#ifndef _VECTRAFLUX_VULKAN_STAGING_RING_H_
+#define _VECTRAFLUX_VULKAN_STAGING_RING_H_
+
+#include <vulkan/vulkan.h>
+#include <Typedef.h>
+
+/**
+ * Bookkeeping of the persistently mapped staging ring buffer. Head and tail
+ * are absolute byte positions that only grow, the physical offset is the
+ * position modulo the ring size. Whoever submits the copies remembers the head
+ * and hands it back to Release() once the GPU is done reading.
+ */
+class VulkanStagingRing {
+public:
+    void Init(VkDeviceSize size) {
+        m_Size = size;
+        m_Head = 0;
+        m_Tail = 0;
+    }
+
+    bool Reserve(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize *pOffset) {
+        if (size > m_Size)
+            return false;
+
+        VkDeviceSize offset = m_Head % m_Size;
+        VkDeviceSize aligned = (offset + alignment - 1) & ~(alignment - 1);
+        uint64_t head = m_Head + (aligned - offset);
+
+        /* 尾部空间不足，跳到环的开头 */
+        if (aligned + size > m_Size) {
+            head = m_Head + (m_Size - offset);
+            aligned = 0;
+        }
+
+        if (head + size - m_Tail > m_Size)
+            return false;
+
+        m_Head = head + size;
+        *pOffset = aligned;
+        return true;
+    }
+
+    void Release(uint64_t head) { m_Tail = std::max(m_Tail, head); }
+    uint64_t GetHead() const { return m_Head; }
+    VkDeviceSize GetSize() const { return m_Size; }
+    VkDeviceSize GetUsedSize() const { return m_Head - m_Tail; }
+
+private:
+    VkDeviceSize m_Size = 0;
+    uint64_t m_Head = 0;
+    uint64_t m_Tail = 0;
+};
+
+#endif /* _VECTRAFLUX_VULKAN_STAGING_RING_H_ */
@@ -27,6 +27,7 @@
 #define _VECTRAFLUX_VULKAN_UTILS_H_
 
 #include "Utils/IOUtils.h"
+#include "Render/Model/VertexLayout.h"
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb/stb_image.h>
 
@@ -101,6 +102,7 @@ namespace VulkanUtils {
     struct QueueFamilyIndices {
         uint32_t graphicsQueueFamily = 0;
         uint32_t presentQueueFamily = 0;
+        uint32_t transferQueueFamily = 0; /* 没有独立传输队列时与 graphics 相同 */
     };
 
     static VkBool32 _CheckQueueFamilyIndicesComplete(QueueFamilyIndices &queueFamilyIndices) {
@@ -140,6 +142,19 @@ namespace VulkanUtils {
         required.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
     }
 
+    static bool IsDeviceExtensionSupported(VkPhysicalDevice device, const char *name) {
+        uint32_t count;
+        vkEnumerateDeviceExtensionProperties(device, VK_NULL_HANDLE, &count, VK_NULL_HANDLE);
+        Vector<VkExtensionProperties> properties(count);
+        vkEnumerateDeviceExtensionProperties(device, VK_NULL_HANDLE, &count, std::data(properties));
+
+        for (const auto &extension : properties) {
+            if (strcmp(extension.extensionName, name) == 0)
+                return true;
+        }
+        return false;
+    }
+
     inline void GetVulkanDeviceRequiredLayers(Vector<const char *> &required) {
         // DO NOTHING...
     }
@@ -167,6 +182,17 @@ namespace VulkanUtils {
 
             ++i;
         }
+
+        /* 优先选择只支持传输的队列族（通常是 DMA 引擎） */
+        pQueueFamilyIndices->transferQueueFamily = pQueueFamilyIndices->graphicsQueueFamily;
+        for (i = 0; i < queueCount; i++) {
+            VkQueueFlags flags = properties[i].queueFlags;
+            if (properties[i].queueCount > 0 && (flags & VK_QUEUE_TRANSFER_BIT) &&
+                !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))) {
+                pQueueFamilyIndices->transferQueueFamily = i;
+                break;
+            }
+        }
     }
 
 #ifdef _glfw3_h_
@@ -178,24 +204,28 @@ namespace VulkanUtils {
     static QueueFamilyIndices GetVulkanDeviceCreateRequiredQueueFamilyAndQueueCreateInfo(VkPhysicalDevice device, VkSurfaceKHR surface,
                                                                            Vector<VkDeviceQueueCreateInfo> &deviceQueueCreateInfos) {
         /** Create vulkan device. */
-        float queuePriority = 1.0f;
+        static const float queuePriority = 1.0f; /* 返回后 create info 仍然引用它 */
         VulkanUtils::QueueFamilyIndices queueFamilyIndices;
         FindVulkanDeviceQueueFamilyIndices(device, surface, &queueFamilyIndices);
 
-        VkDeviceQueueCreateInfo graphicsDeviceQueueCreateInfo = {};
-        graphicsDeviceQueueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-        graphicsDeviceQueueCreateInfo.queueCount = 1;
-        graphicsDeviceQueueCreateInfo.queueFamilyIndex = queueFamilyIndices.graphicsQueueFamily;
-        graphicsDeviceQueueCreateInfo.pQueuePriorities = &queuePriority;
-
-        VkDeviceQueueCreateInfo presentDeviceQueueCreateInfo = {};
-        presentDeviceQueueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-        presentDeviceQueueCreateInfo.queueCount = 1;
-        presentDeviceQueueCreateInfo.queueFamilyIndex = queueFamilyIndices.presentQueueFamily;
-        presentDeviceQueueCreateInfo.pQueuePriorities = &queuePriority;
-
-        deviceQueueCreateInfos.push_back(graphicsDeviceQueueCreateInfo);
-        deviceQueueCreateInfos.push_back(presentDeviceQueueCreateInfo);
+        /* 同一个队列族只能出现一次 */
+        uint32_t families[] = { queueFamilyIndices.graphicsQueueFamily,
+                                queueFamilyIndices.presentQueueFamily,
+                                queueFamilyIndices.transferQueueFamily };
+        for (uint32_t family : families) {
+            bool exists = false;
+            for (const auto &createInfo : deviceQueueCreateInfos)
+                exists |= createInfo.queueFamilyIndex == family;
+            if (exists)
+                continue;
+
+            VkDeviceQueueCreateInfo deviceQueueCreateInfo = {};
+            deviceQueueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+            deviceQueueCreateInfo.queueCount = 1;
+            deviceQueueCreateInfo.queueFamilyIndex = family;
+            deviceQueueCreateInfo.pQueuePriorities = &queuePriority;
+            deviceQueueCreateInfos.push_back(deviceQueueCreateInfo);
+        }
 
         return queueFamilyIndices;
     }
@@ -288,34 +318,42 @@ namespace VulkanUtils {
         throw std::runtime_error("failed to find suitable memory type!");
     }
 
-    static VkVertexInputBindingDescription GetVertexInputBindingDescription() {
-        VkVertexInputBindingDescription vertexInputBindingDescription = {};
-        vertexInputBindingDescription.binding = 0;
-        vertexInputBindingDescription.stride = sizeof(Vertex);
-        vertexInputBindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-        return vertexInputBindingDescription;
+    static VkFormat GetVertexAttributeFormat(VertexAttributeFormat format) {
+        switch (format) {
+            case VERTEX_ATTRIBUTE_FORMAT_FLOAT32x2: return VK_FORMAT_R32G32_SFLOAT;
+            case VERTEX_ATTRIBUTE_FORMAT_FLOAT32x3: return VK_FORMAT_R32G32B32_SFLOAT;
+            case VERTEX_ATTRIBUTE_FORMAT_FLOAT16x2: return VK_FORMAT_R16G16_SFLOAT;
+            case VERTEX_ATTRIBUTE_FORMAT_FLOAT16x4: return VK_FORMAT_R16G16B16A16_SFLOAT;
+            case VERTEX_ATTRIBUTE_FORMAT_UNORM16x4: return VK_FORMAT_R16G16B16A16_UNORM;
+            case VERTEX_ATTRIBUTE_FORMAT_UNORM8x4: return VK_FORMAT_R8G8B8A8_UNORM;
+            case VERTEX_ATTRIBUTE_FORMAT_SNORM16x2: return VK_FORMAT_R16G16_SNORM;
+            default: return VK_FORMAT_UNDEFINED;
+        }
+    }
+
+    /* binding 即 VertexStream，返回 binding 个数 */
+    static uint32_t GetVertexInputBindingDescriptions(const VertexLayout &layout, VkVertexInputBindingDescription *pDescriptions) {
+        for (uint32_t i = 0; i < layout.streamCount; i++) {
+            pDescriptions[i].binding = i;
+            pDescriptions[i].stride = layout.strides[i];
+            pDescriptions[i].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+        }
+        return layout.streamCount;
     }
 
-    static Array<VkVertexInputAttributeDescription, 3> GetVertexInputAttributeDescriptionArray() {
-        Array<VkVertexInputAttributeDescription, 3> array = {};
-        /* position attribute */
-        array[0].binding = 0;
-        array[0].location = 0;
-        array[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-        array[0].offset = offsetof(Vertex, position);
-
-        /* color attribute */
-        array[1].binding = 0;
-        array[1].location = 1;
-        array[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-        array[1].offset = offsetof(Vertex, color);
-
-        array[2].binding = 0;
-        array[2].location = 2;
-        array[2].format = VK_FORMAT_R32G32_SFLOAT;
-        array[2].offset = offsetof(Vertex, texCoord);
-
-        return array;
+    /* 顶点输入由 layout 生成，location 即 VertexAttribute，返回属性个数 */
+    static uint32_t GetVertexInputAttributeDescriptions(const VertexLayout &layout, VkVertexInputAttributeDescription *pDescriptions) {
+        uint32_t count = 0;
+        for (uint32_t i = 0; i < VERTEX_ATTRIBUTE_MAX_ENUM; i++) {
+            if (layout.attributes[i].format == VERTEX_ATTRIBUTE_FORMAT_NONE)
+                continue;
+            VkVertexInputAttributeDescription &description = pDescriptions[count++];
+            description.binding = layout.attributes[i].stream;
+            description.location = i;
+            description.format = GetVertexAttributeFormat(layout.attributes[i].format);
+            description.offset = layout.attributes[i].offset;
+        }
+        return count;
     }
 
     static VkShaderModule LoadShaderModule(VkDevice device, const String &path, const String &name, VkShaderStageFlagBits flag) {
@@ -0,0 +1,324 @@
+/* ************************************************************************
+ *
+ * Copyright (C) 2022 Vincent Luo All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, e1ither express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ************************************************************************/
+
+/* Creates on 2026/10/17. */
+
+/*
+  ===================================
+    @author bit-fashion
+  ===================================
+*/
+#include "GameModel.h"
+#include <mutex>
+
+#define GAME_MODEL_INVALID_ARCHETYPE UINT32_MAX
+/* chunk 内每个数组按缓存行对齐 */
+#define GAME_MODEL_ARRAY_ALIGNMENT 64
+
+struct GameComponentInfo {
+    uint32_t size;
+    uint32_t alignment;
+};
+
+/* 注册只在 GetComponentType<T>() 第一次调用时发生，之后只读 */
+static std::mutex s_ComponentMutex;
+static GameComponentInfo s_Components[GAME_MODEL_MAX_COMPONENT_TYPES];
+static uint32_t s_ComponentCount = 0;
+
+GameComponentType GameModel::_RegisterComponent(uint32_t size, uint32_t alignment) {
+    std::lock_guard<std::mutex> lock(s_ComponentMutex);
+    if (s_ComponentCount >= GAME_MODEL_MAX_COMPONENT_TYPES)
+        throw std::runtime_error("too many game component types!");
+    if (alignment > GAME_MODEL_ARRAY_ALIGNMENT)
+        throw std::runtime_error("game component alignment is larger than a cache line!");
+    s_Components[s_ComponentCount] = { size, alignment };
+    return s_ComponentCount++;
+}
+
+uint32_t GameModel::_GetComponentSize(GameComponentType type) {
+    return s_Components[type].size;
+}
+
+uint8_t *GameModel::Archetype::GetComponent(uint32_t row, GameComponentType type) const {
+    return chunks[row / chunkCapacity] + offsets[type] + (size_t) (row % chunkCapacity) * _GetComponentSize(type);
+}
+
+GameModel::GameModel() : m_CommandBuffer(this) {
+    /* archetype 0 没有组件 */
+    _GetArchetype(0);
+}
+
+GameModel::~GameModel() {
+    for (const auto &archetype : m_Archetypes) {
+        for (uint8_t *chunk : archetype->chunks)
+            ::operator delete(chunk, std::align_val_t(GAME_MODEL_ARRAY_ALIGNMENT));
+    }
+}
+
+void GameModel::_CheckStructuralChange() const {
+    if (m_IterationDepth != 0)
+        throw std::runtime_error("structural change while iterating game model, use GetCommandBuffer() instead!");
+}
+
+bool GameModel::IsAlive(GameEntity entity) const {
+    if (entity.index >= std::size(m_Records))
+        return false;
+    const EntityRecord &record = m_Records[entity.index];
+    return record.generation == entity.generation && record.archetype != GAME_MODEL_INVALID_ARCHETYPE;
+}
+
+uint32_t GameModel::_GetArchetype(GameComponentMask mask) {
+    /* 连续创建同一种实体时不查表 */
+    if (m_LastArchetype < std::size(m_Archetypes) && m_Archetypes[m_LastArchetype]->mask == mask)
+        return m_LastArchetype;
+
+    auto it = m_ArchetypeIndices.find(mask);
+    if (it != m_ArchetypeIndices.end())
+        return m_LastArchetype = it->second;
+
+    auto archetype = std::make_unique<Archetype>();
+    archetype->mask = mask;
+    archetype->entityCount = 0;
+
+    uint32_t stride = sizeof(GameEntity);
+    for (GameComponentType type = 0; type < GAME_MODEL_MAX_COMPONENT_TYPES; type++) {
+        if (mask & (GameComponentMask(1) << type)) {
+            archetype->types.push_back(type);
+            stride += _GetComponentSize(type);
+        }
+    }
+
+    /* 每个数组最多浪费一个缓存行的对齐 */
+    uint32_t padding = GAME_MODEL_ARRAY_ALIGNMENT * (uint32_t) std::size(archetype->types);
+    archetype->chunkCapacity = (GAME_MODEL_CHUNK_SIZE - padding) / stride;
+    if (archetype->chunkCapacity == 0)
+        throw std::runtime_error("game components are too large for a chunk!");
+
+    archetype->offsets.fill(0);
+    uint32_t offset = archetype->chunkCapacity * sizeof(GameEntity);
+    for (GameComponentType type : archetype->types) {
+        offset = (offset + GAME_MODEL_ARRAY_ALIGNMENT - 1) & ~(GAME_MODEL_ARRAY_ALIGNMENT - 1);
+        archetype->offsets[type] = offset;
+        offset += archetype->chunkCapacity * _GetComponentSize(type);
+    }
+
+    archetype->addEdges.fill(GAME_MODEL_INVALID_ARCHETYPE);
+    archetype->removeEdges.fill(GAME_MODEL_INVALID_ARCHETYPE);
+
+    uint32_t index = (uint32_t) std::size(m_Archetypes);
+    m_Archetypes.push_back(std::move(archetype));
+    m_ArchetypeIndices[mask] = index;
+    return m_LastArchetype = index;
+}
+
+uint32_t GameModel::_AllocateRow(uint32_t archetypeIndex) {
+    Archetype *archetype = m_Archetypes[archetypeIndex].get();
+    uint32_t row = archetype->entityCount++;
+    if (row / archetype->chunkCapacity >= std::size(archetype->chunks))
+        archetype->chunks.push_back(static_cast<uint8_t *>(::operator new(GAME_MODEL_CHUNK_SIZE, std::align_val_t(GAME_MODEL_ARRAY_ALIGNMENT))));
+    return row;
+}
+
+void GameModel::_FreeRow(uint32_t archetypeIndex, uint32_t row) {
+    Archetype *archetype = m_Archetypes[archetypeIndex].get();
+    uint32_t last = --archetype->entityCount;
+    if (row == last)
+        return;
+
+    for (GameComponentType type : archetype->types)
+        memcpy(archetype->GetComponent(row, type), archetype->GetComponent(last, type), _GetComponentSize(type));
+
+    GameEntity moved = archetype->GetEntities(archetype->chunks[last / archetype->chunkCapacity])[last % archetype->chunkCapacity];
+    archetype->GetEntities(archetype->chunks[row / archetype->chunkCapacity])[row % archetype->chunkCapacity] = moved;
+    m_Records[moved.index].row = row;
+}
+
+GameEntity GameModel::_ReserveEntity() {
+    uint32_t index;
+    if (!m_FreeIndices.empty()) {
+        index = m_FreeIndices.back();
+        m_FreeIndices.pop_back();
+    } else {
+        index = (uint32_t) std::size(m_Records);
+        m_Records.push_back({ 1, GAME_MODEL_INVALID_ARCHETYPE, 0 });
+    }
+    return { index, m_Records[index].generation };
+}
+
+GameEntity GameModel::_CreateEntity(GameEntity entity, GameComponentMask mask, const void *const *values) {
+    _CheckStructuralChange();
+
+    uint32_t archetypeIndex = _GetArchetype(mask);
+    uint32_t row = _AllocateRow(archetypeIndex);
+    Archetype *archetype = m_Archetypes[archetypeIndex].get();
+    uint8_t *chunk = archetype->chunks[row / archetype->chunkCapacity];
+    uint32_t column = row % archetype->chunkCapacity;
+    archetype->GetEntities(chunk)[column] = entity;
+    for (GameComponentType type : archetype->types) {
+        uint32_t size = _GetComponentSize(type);
+        memcpy(chunk + archetype->offsets[type] + (size_t) column * size, values[type], size);
+    }
+
+    m_Records[entity.index].archetype = archetypeIndex;
+    m_Records[entity.index].row = row;
+    m_EntityCount++;
+    return entity;
+}
+
+void GameModel::DestroyEntity(GameEntity entity) {
+    _CheckStructuralChange();
+    /* 已经销毁的句柄直接忽略，延迟命令里重复销毁很常见 */
+    if (!IsAlive(entity))
+        return;
+
+    EntityRecord &record = m_Records[entity.index];
+    _FreeRow(record.archetype, record.row);
+    record.archetype = GAME_MODEL_INVALID_ARCHETYPE;
+    if (++record.generation == 0)
+        record.generation = 1;
+    m_FreeIndices.push_back(entity.index);
+    m_EntityCount--;
+}
+
+void GameModel::_MoveEntity(GameEntity entity, uint32_t dstArchetypeIndex, GameComponentType type, const void *value) {
+    EntityRecord &record = m_Records[entity.index];
+    uint32_t srcArchetypeIndex = record.archetype;
+    uint32_t row = _AllocateRow(dstArchetypeIndex);
+
+    Archetype *src = m_Archetypes[srcArchetypeIndex].get();
+    Archetype *dst = m_Archetypes[dstArchetypeIndex].get();
+    dst->GetEntities(dst->chunks[row / dst->chunkCapacity])[row % dst->chunkCapacity] = entity;
+    for (GameComponentType dstType : dst->types) {
+        const void *data = dstType == type && value != null ? value : src->GetComponent(record.row, dstType);
+        memcpy(dst->GetComponent(row, dstType), data, _GetComponentSize(dstType));
+    }
+
+    _FreeRow(srcArchetypeIndex, record.row);
+    record.archetype = dstArchetypeIndex;
+    record.row = row;
+}
+
+void GameModel::_AddComponent(GameEntity entity, GameComponentType type, const void *value) {
+    _CheckStructuralChange();
+    if (!IsAlive(entity))
+        throw std::runtime_error("add component to a destroyed entity!");
+
+    const EntityRecord &record = m_Records[entity.index];
+    Archetype *archetype = m_Archetypes[record.archetype].get();
+    if (archetype->mask & (GameComponentMask(1) << type)) {
+        memcpy(archetype->GetComponent(record.row, type), value, _GetComponentSize(type));
+        return;
+    }
+
+    uint32_t dstArchetypeIndex = archetype->addEdges[type];
+    if (dstArchetypeIndex == GAME_MODEL_INVALID_ARCHETYPE) {
+        dstArchetypeIndex = _GetArchetype(archetype->mask | (GameComponentMask(1) << type));
+        archetype->addEdges[type] = dstArchetypeIndex;
+    }
+
+    _MoveEntity(entity, dstArchetypeIndex, type, value);
+}
+
+void GameModel::_RemoveComponent(GameEntity entity, GameComponentType type) {
+    _CheckStructuralChange();
+    if (!IsAlive(entity))
+        throw std::runtime_error("remove component from a destroyed entity!");
+
+    const EntityRecord &record = m_Records[entity.index];
+    Archetype *archetype = m_Archetypes[record.archetype].get();
+    if (!(archetype->mask & (GameComponentMask(1) << type)))
+        return;
+
+    uint32_t dstArchetypeIndex = archetype->removeEdges[type];
+    if (dstArchetypeIndex == GAME_MODEL_INVALID_ARCHETYPE) {
+        dstArchetypeIndex = _GetArchetype(archetype->mask & ~(GameComponentMask(1) << type));
+        archetype->removeEdges[type] = dstArchetypeIndex;
+    }
+
+    _MoveEntity(entity, dstArchetypeIndex, type, null);
+}
+
+uint8_t *GameModel::_GetComponent(GameEntity entity, GameComponentType type) {
+    if (!IsAlive(entity))
+        return null;
+
+    const EntityRecord &record = m_Records[entity.index];
+    const Archetype *archetype = m_Archetypes[record.archetype].get();
+    if (!(archetype->mask & (GameComponentMask(1) << type)))
+        return null;
+    return archetype->GetComponent(record.row, type);
+}
+
+void GameModel::Flush() {
+    Flush(m_CommandBuffer);
+}
+
+void GameModel::Flush(GameCommandBuffer &commandBuffer) {
+    _CheckStructuralChange();
+
+    /* 换出来播放，保留容量 */
+    Vector<uint8_t> commands;
+    commands.swap(commandBuffer.m_Commands);
+
+    const uint8_t *cursor = std::data(commands);
+    const uint8_t *end = cursor + std::size(commands);
+    while (cursor < end) {
+        GameCommandBuffer::CommandHeader header;
+        memcpy(&header, cursor, sizeof(header));
+        cursor += sizeof(header);
+
+        GameComponentMask mask = 0;
+        const void *values[GAME_MODEL_MAX_COMPONENT_TYPES];
+        GameComponentType type = 0;
+        for (uint32_t i = 0; i < header.componentCount; i++) {
+            memcpy(&type, cursor, sizeof(type));
+            cursor += sizeof(type);
+            mask |= GameComponentMask(1) << type;
+            if (header.type == GameCommandBuffer::COMMAND_TYPE_REMOVE_COMPONENT)
+                continue;
+            values[type] = cursor;
+            cursor += _GetComponentSize(type);
+        }
+
+        switch (header.type) {
+            case GameCommandBuffer::COMMAND_TYPE_CREATE:
+                _CreateEntity(header.entity, mask, values);
+                break;
+            case GameCommandBuffer::COMMAND_TYPE_DESTROY:
+                DestroyEntity(header.entity);
+                break;
+            case GameCommandBuffer::COMMAND_TYPE_ADD_COMPONENT:
+                /* 前面的命令可能已经把它销毁了 */
+                if (IsAlive(header.entity))
+                    _AddComponent(header.entity, type, values[type]);
+                break;
+            case GameCommandBuffer::COMMAND_TYPE_REMOVE_COMPONENT:
+                if (IsAlive(header.entity))
+                    _RemoveComponent(header.entity, type);
+                break;
+        }
+    }
+
+    commands.clear();
+    commandBuffer.m_Commands.swap(commands);
+}
+
+void GameCommandBuffer::DestroyEntity(GameEntity entity) {
+    CommandHeader header = { COMMAND_TYPE_DESTROY, 0, entity };
+    _Write(&header, sizeof(header));
+}
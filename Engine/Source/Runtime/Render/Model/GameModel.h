@@ -26,4 +26,312 @@
 #ifndef VECTRAFLUXENGINE_GAMEMODEL_H
 #define VECTRAFLUXENGINE_GAMEMODEL_H
 
+#include <Typedef.h>
+#include <Math.h>
+#include <glm/gtc/quaternion.hpp>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#  include <xmmintrin.h>
+#  define GAME_MODEL_PREFETCH(p) _mm_prefetch(reinterpret_cast<const char *>(p), _MM_HINT_T0)
+#else
+#  define GAME_MODEL_PREFETCH(p) __builtin_prefetch(p)
+#endif
+
+/* 组件类型数量上限，archetype 用 64 位掩码表示 */
+#define GAME_MODEL_MAX_COMPONENT_TYPES 64
+/* 每个 chunk 的字节数，组件按 SoA 排列在 chunk 里 */
+#define GAME_MODEL_CHUNK_SIZE (16 * 1024)
+
+typedef uint32_t GameComponentType;
+typedef uint64_t GameComponentMask;
+
+/**
+ * Generational entity handle. The index is reused after the entity is
+ * destroyed, the generation tells stale handles apart. {0, 0} is never alive.
+ */
+struct GameEntity {
+    uint32_t index = 0;
+    uint32_t generation = 0;
+
+    bool operator==(const GameEntity &other) const = default;
+};
+
+//
+// 内置的变换组件，每个都是单独的 SoA 数组
+//
+struct TranslationComponent {
+    glm::vec3 value = glm::vec3(0.0f);
+};
+
+struct RotationComponent {
+    glm::quat value = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+};
+
+struct ScaleComponent {
+    glm::vec3 value = glm::vec3(1.0f);
+};
+
+struct LocalToWorldComponent {
+    glm::mat4 value = glm::mat4(1.0f);
+};
+
+class GameModel;
+
+/**
+ * Records structural changes (create, destroy, add and remove component) so
+ * they can be made while a query is iterating, GameModel::Flush() plays them
+ * back in order. Entities created here get their handle right away but are
+ * not alive until the flush. Not thread safe, use one buffer per thread.
+ */
+class GameCommandBuffer {
+public:
+    explicit GameCommandBuffer(GameModel *pModel) : m_Model(pModel) {}
+
+    template<typename... T>
+    GameEntity CreateEntity(const T &...components);
+    void DestroyEntity(GameEntity entity);
+    template<typename T>
+    void AddComponent(GameEntity entity, const T &component);
+    template<typename T>
+    void RemoveComponent(GameEntity entity);
+
+    bool IsEmpty() const { return m_Commands.empty(); }
+
+private:
+    friend class GameModel;
+
+    enum CommandType : uint32_t {
+        COMMAND_TYPE_CREATE = 0,
+        COMMAND_TYPE_DESTROY,
+        COMMAND_TYPE_ADD_COMPONENT,
+        COMMAND_TYPE_REMOVE_COMPONENT
+    };
+
+    /* 后面紧跟 componentCount 个 (type, data) */
+    struct CommandHeader {
+        CommandType type;
+        uint32_t componentCount;
+        GameEntity entity;
+    };
+
+    void _Write(const void *data, size_t size) {
+        size_t offset = std::size(m_Commands);
+        m_Commands.resize(offset + size);
+        memcpy(std::data(m_Commands) + offset, data, size);
+    }
+
+    template<typename T>
+    void _WriteComponent(const T &component);
+
+private:
+    GameModel *m_Model;
+    Vector<uint8_t> m_Commands;
+};
+
+/**
+ * Data oriented entity store. Entities with the same set of components share
+ * an archetype, whose entities are packed into 16KB chunks with one array per
+ * component, so queries walk contiguous memory chunk by chunk. Components
+ * must be trivially copyable, they are moved with memcpy. Archetypes stay
+ * dense (destroy moves the last entity into the hole) and chunks are kept
+ * for reuse.
+ *
+ * Structural changes made directly are applied immediately and are not
+ * allowed while a query is iterating, record them in GetCommandBuffer()
+ * and apply them at a sync point with Flush().
+ */
+class GameModel {
+public:
+    GameModel();
+   ~GameModel();
+
+    GameModel(const GameModel &) = delete;
+    GameModel &operator=(const GameModel &) = delete;
+
+    template<typename T>
+    static GameComponentType GetComponentType() {
+        static_assert(std::is_trivially_copyable_v<T>, "components are moved with memcpy");
+        static const GameComponentType type = _RegisterComponent(sizeof(T), alignof(T));
+        return type;
+    }
+
+    template<typename... T>
+    static GameComponentMask GetComponentMask() {
+        return (GameComponentMask(0) | ... | (GameComponentMask(1) << GetComponentType<std::remove_const_t<T>>()));
+    }
+
+    template<typename... T>
+    GameEntity CreateEntity(const T &...components) {
+        const void *values[GAME_MODEL_MAX_COMPONENT_TYPES];
+        ((values[GetComponentType<T>()] = &components), ...);
+        return _CreateEntity(_ReserveEntity(), GetComponentMask<T...>(), values);
+    }
+
+    void DestroyEntity(GameEntity entity);
+    bool IsAlive(GameEntity entity) const;
+    uint32_t GetEntityCount() const { return m_EntityCount; }
+
+    template<typename T>
+    void AddComponent(GameEntity entity, const T &component) {
+        _AddComponent(entity, GetComponentType<T>(), &component);
+    }
+
+    template<typename T>
+    void RemoveComponent(GameEntity entity) {
+        _RemoveComponent(entity, GetComponentType<T>());
+    }
+
+    template<typename T>
+    bool HasComponent(GameEntity entity) const {
+        return IsAlive(entity) && (m_Archetypes[m_Records[entity.index].archetype]->mask & GetComponentMask<T>()) != 0;
+    }
+
+    /* null if the entity is not alive or has no T, valid until the next structural change */
+    template<typename T>
+    T *GetComponent(GameEntity entity) {
+        return reinterpret_cast<T *>(_GetComponent(entity, GetComponentType<T>()));
+    }
+
+    GameCommandBuffer &GetCommandBuffer() { return m_CommandBuffer; }
+    /* sync point: plays back GetCommandBuffer() or the given buffer */
+    void Flush();
+    void Flush(GameCommandBuffer &commandBuffer);
+
+    /**
+     * Calls func(count, entities, T *...) for every chunk whose archetype has
+     * all of T and none of the excluded components. The arrays are
+     * contiguous, which is what SIMD loops want.
+     */
+    template<typename... T, typename Func>
+    void ForEachChunk(Func &&func, GameComponentMask excludeMask = 0);
+
+    /* func(T &...) per entity */
+    template<typename... T, typename Func>
+    void ForEach(Func &&func, GameComponentMask excludeMask = 0) {
+        ForEachChunk<T...>([&func](uint32_t count, const GameEntity *, T *...arrays) {
+            for (uint32_t i = 0; i < count; i++)
+                func(arrays[i]...);
+        }, excludeMask);
+    }
+
+private:
+    friend class GameCommandBuffer;
+
+    struct EntityRecord {
+        uint32_t generation;
+        uint32_t archetype; /* UINT32_MAX when free or reserved */
+        uint32_t row; /* chunk = row / chunkCapacity */
+    };
+
+    struct Archetype {
+        GameComponentMask mask;
+        uint32_t chunkCapacity;
+        uint32_t entityCount;
+        Vector<uint8_t *> chunks; /* may hold more chunks than entityCount needs */
+        Vector<GameComponentType> types; /* ascending */
+        Array<uint32_t, GAME_MODEL_MAX_COMPONENT_TYPES> offsets; /* array offset in a chunk by type, entities at 0 */
+        Array<uint32_t, GAME_MODEL_MAX_COMPONENT_TYPES> addEdges; /* archetype with one more type, lazily filled */
+        Array<uint32_t, GAME_MODEL_MAX_COMPONENT_TYPES> removeEdges;
+
+        GameEntity *GetEntities(uint8_t *chunk) const { return reinterpret_cast<GameEntity *>(chunk); }
+        uint8_t *GetComponent(uint32_t row, GameComponentType type) const;
+    };
+
+    /* 迭代期间禁止直接修改结构 */
+    struct IterationScope {
+        explicit IterationScope(GameModel *pModel) : model(pModel) { ++model->m_IterationDepth; }
+       ~IterationScope() { --model->m_IterationDepth; }
+        GameModel *model;
+    };
+
+    static GameComponentType _RegisterComponent(uint32_t size, uint32_t alignment);
+    static uint32_t _GetComponentSize(GameComponentType type);
+
+    GameEntity _ReserveEntity();
+    /* values are indexed by component type, only the ones in mask are read */
+    GameEntity _CreateEntity(GameEntity entity, GameComponentMask mask, const void *const *values);
+    void _AddComponent(GameEntity entity, GameComponentType type, const void *value);
+    void _RemoveComponent(GameEntity entity, GameComponentType type);
+    uint8_t *_GetComponent(GameEntity entity, GameComponentType type);
+
+    void _CheckStructuralChange() const;
+    uint32_t _GetArchetype(GameComponentMask mask);
+    uint32_t _AllocateRow(uint32_t archetypeIndex);
+    /* 用最后一个实体填洞 */
+    void _FreeRow(uint32_t archetypeIndex, uint32_t row);
+    void _MoveEntity(GameEntity entity, uint32_t dstArchetypeIndex, GameComponentType type, const void *value);
+
+private:
+    Vector<EntityRecord> m_Records;
+    Vector<uint32_t> m_FreeIndices;
+    Vector<std::unique_ptr<Archetype>> m_Archetypes;
+    HashMap<GameComponentMask, uint32_t> m_ArchetypeIndices;
+    uint32_t m_LastArchetype = 0;
+    uint32_t m_EntityCount = 0;
+    uint32_t m_IterationDepth = 0;
+    GameCommandBuffer m_CommandBuffer;
+};
+
+template<typename... T, typename Func>
+void GameModel::ForEachChunk(Func &&func, GameComponentMask excludeMask) {
+    const GameComponentMask mask = GetComponentMask<T...>();
+    const GameComponentType types[sizeof...(T) + 1] = { GetComponentType<std::remove_const_t<T>>()... };
+    IterationScope scope(this);
+
+    for (const auto &archetype : m_Archetypes) {
+        if ((archetype->mask & mask) != mask || (archetype->mask & excludeMask) != 0 || archetype->entityCount == 0)
+            continue;
+
+        uint32_t chunkCount = (archetype->entityCount + archetype->chunkCapacity - 1) / archetype->chunkCapacity;
+        for (uint32_t c = 0; c < chunkCount; c++) {
+            uint8_t *chunk = archetype->chunks[c];
+            /* 提前把下一个 chunk 各数组的开头拉进缓存，chunk 之间不连续，硬件预取跟不过去 */
+            if (c + 1 < chunkCount) {
+                for (size_t i = 0; i < sizeof...(T); i++)
+                    GAME_MODEL_PREFETCH(archetype->chunks[c + 1] + archetype->offsets[types[i]]);
+            }
+
+            uint32_t count = c + 1 < chunkCount ? archetype->chunkCapacity : archetype->entityCount - c * archetype->chunkCapacity;
+            [&]<size_t... I>(std::index_sequence<I...>) {
+                func(count, archetype->GetEntities(chunk), reinterpret_cast<T *>(chunk + archetype->offsets[types[I]])...);
+            }(std::index_sequence_for<T...>());
+        }
+    }
+}
+
+template<typename T>
+void GameCommandBuffer::_WriteComponent(const T &component) {
+    GameComponentType type = GameModel::GetComponentType<T>();
+    _Write(&type, sizeof(type));
+    _Write(&component, sizeof(T));
+}
+
+template<typename... T>
+GameEntity GameCommandBuffer::CreateEntity(const T &...components) {
+    GameEntity entity = m_Model->_ReserveEntity();
+    CommandHeader header = { COMMAND_TYPE_CREATE, sizeof...(T), entity };
+    _Write(&header, sizeof(header));
+    (_WriteComponent(components), ...);
+    return entity;
+}
+
+template<typename T>
+void GameCommandBuffer::AddComponent(GameEntity entity, const T &component) {
+    CommandHeader header = { COMMAND_TYPE_ADD_COMPONENT, 1, entity };
+    _Write(&header, sizeof(header));
+    _WriteComponent(component);
+}
+
+template<typename T>
+void GameCommandBuffer::RemoveComponent(GameEntity entity) {
+    GameComponentType type = GameModel::GetComponentType<T>();
+    CommandHeader header = { COMMAND_TYPE_REMOVE_COMPONENT, 1, entity };
+    _Write(&header, sizeof(header));
+    _Write(&type, sizeof(type));
+}
+
 #endif //VECTRAFLUXENGINE_GAMEMODEL_H
@@ -0,0 +1,310 @@
+/* ************************************************************************
+ *
+ * Copyright (C) 2022 Vincent Luo All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, e1ither express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ************************************************************************/
+
+/* Creates on 2026/10/17. */
+
+/*
+  ===================================
+    @author bit-fashion
+  ===================================
+*/
+#include "TransformHierarchy.h"
+#include "Utils/ThreadPool.h"
+#include <System.h>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#  define TRANSFORM_HIERARCHY_SSE
+#  include <immintrin.h>
+#endif
+
+/* 每个任务至少处理这么多节点，太小的层直接在调用线程上做 */
+#define TRANSFORM_HIERARCHY_BATCH_SIZE 2048
+
+/* out = parent * local，列主序：每一列都是 parent 四列的线性组合 */
+static inline void _MultiplyMatrix(const glm::mat4 &parent, const glm::mat4 &local, glm::mat4 &out) {
+#ifdef TRANSFORM_HIERARCHY_SSE
+    const __m128 p0 = _mm_loadu_ps(&parent[0][0]);
+    const __m128 p1 = _mm_loadu_ps(&parent[1][0]);
+    const __m128 p2 = _mm_loadu_ps(&parent[2][0]);
+    const __m128 p3 = _mm_loadu_ps(&parent[3][0]);
+    for (int c = 0; c < 4; c++) {
+        __m128 column = _mm_add_ps(_mm_add_ps(_mm_mul_ps(p0, _mm_set1_ps(local[c][0])), _mm_mul_ps(p1, _mm_set1_ps(local[c][1]))),
+                                   _mm_add_ps(_mm_mul_ps(p2, _mm_set1_ps(local[c][2])), _mm_mul_ps(p3, _mm_set1_ps(local[c][3]))));
+        _mm_storeu_ps(&out[c][0], column);
+    }
+#else
+    out = parent * local;
+#endif
+}
+
+void TransformHierarchy::_CheckNode(TransformNode node) const {
+    if (node >= std::size(m_Slots) || m_Slots[node] == UINT32_MAX)
+        throw std::runtime_error("invalid transform node!");
+}
+
+TransformNode TransformHierarchy::AddNode(TransformNode parent, const glm::mat4 &local, bool isStatic) {
+    uint32_t parentSlot = TRANSFORM_NODE_INVALID;
+    if (parent != TRANSFORM_NODE_INVALID) {
+        _CheckNode(parent);
+        parentSlot = m_Slots[parent];
+    }
+
+    TransformNode node;
+    if (!m_FreeNodes.empty()) {
+        node = m_FreeNodes.back();
+        m_FreeNodes.pop_back();
+    } else {
+        node = (TransformNode) std::size(m_Slots);
+        m_Slots.push_back(UINT32_MAX);
+    }
+
+    /* 先追加到末尾，下一次 Update() 重新按层排序 */
+    m_Slots[node] = (uint32_t) std::size(m_Ids);
+    m_Parents.push_back(parentSlot);
+    m_Locals.push_back(local);
+    m_Worlds.push_back(local);
+    m_Dirty.push_back(1);
+    m_Changed.push_back(0);
+    m_Static.push_back(isStatic);
+    m_Removed.push_back(0);
+    m_Ids.push_back(node);
+
+    m_OrderDirty = true;
+    return node;
+}
+
+void TransformHierarchy::RemoveNode(TransformNode node) {
+    _CheckNode(node);
+    /* 子节点在重新排序时一起删掉 */
+    m_Removed[m_Slots[node]] = 1;
+    m_OrderDirty = true;
+}
+
+void TransformHierarchy::SetParent(TransformNode node, TransformNode parent) {
+    _CheckNode(node);
+    uint32_t slot = m_Slots[node];
+    uint32_t parentSlot = TRANSFORM_NODE_INVALID;
+    if (parent != TRANSFORM_NODE_INVALID) {
+        _CheckNode(parent);
+        parentSlot = m_Slots[parent];
+        for (uint32_t ancestor = parentSlot; ancestor != TRANSFORM_NODE_INVALID; ancestor = m_Parents[ancestor]) {
+            if (ancestor == slot)
+                throw std::runtime_error("transform node can't be parented to its own descendant!");
+        }
+    }
+
+    m_Parents[slot] = parentSlot;
+    m_Dirty[slot] = 1;
+    m_AnyDirty = true;
+    m_OrderDirty = true;
+}
+
+void TransformHierarchy::SetLocalTransform(TransformNode node, const glm::mat4 &local) {
+    _CheckNode(node);
+    uint32_t slot = m_Slots[node];
+    m_Locals[slot] = local;
+    m_Dirty[slot] = 1;
+    m_AnyDirty = true;
+    /* 静态节点只在重新排序时计算 */
+    if (m_Static[slot])
+        m_OrderDirty = true;
+}
+
+void TransformHierarchy::SetStatic(TransformNode node, bool isStatic) {
+    _CheckNode(node);
+    uint32_t slot = m_Slots[node];
+    if (m_Static[slot] == isStatic)
+        return;
+    m_Static[slot] = isStatic;
+    m_OrderDirty = true;
+}
+
+TransformNode TransformHierarchy::GetParent(TransformNode node) const {
+    _CheckNode(node);
+    uint32_t parentSlot = m_Parents[m_Slots[node]];
+    return parentSlot == TRANSFORM_NODE_INVALID ? TRANSFORM_NODE_INVALID : m_Ids[parentSlot];
+}
+
+void TransformHierarchy::_Rebuild() {
+    const uint32_t count = (uint32_t) std::size(m_Ids);
+
+    //
+    // 求深度：沿父节点往上走到已知深度的祖先，再往回填
+    //
+    Vector<uint32_t> depths(count, UINT32_MAX);
+    Vector<uint32_t> stack;
+    uint32_t maxDepth = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t slot = i;
+        while (slot != TRANSFORM_NODE_INVALID && depths[slot] == UINT32_MAX) {
+            stack.push_back(slot);
+            slot = m_Parents[slot];
+        }
+        uint32_t depth = slot == TRANSFORM_NODE_INVALID ? 0 : depths[slot] + 1;
+        for (; !stack.empty(); stack.pop_back())
+            depths[stack.back()] = depth++;
+        maxDepth = std::max(maxDepth, depths[i]);
+    }
+
+    /* 按深度计数排序，同一层内保持原来的相对顺序 */
+    Vector<uint32_t> levelStarts(maxDepth + 2, 0);
+    for (uint32_t i = 0; i < count; i++)
+        levelStarts[depths[i] + 1]++;
+    for (uint32_t d = 1; d < std::size(levelStarts); d++)
+        levelStarts[d] += levelStarts[d - 1];
+    Vector<uint32_t> order(count);
+    for (uint32_t i = 0; i < count; i++)
+        order[levelStarts[depths[i]]++] = i;
+
+    Vector<uint32_t> parents, newSlots(count, UINT32_MAX);
+    Vector<glm::mat4> locals, worlds;
+    Vector<uint8_t> statics, effectiveStatics;
+    Vector<TransformNode> ids;
+    parents.reserve(count);
+    locals.reserve(count);
+    worlds.reserve(count);
+    statics.reserve(count);
+    effectiveStatics.reserve(count);
+    ids.reserve(count);
+
+    m_DynamicSlots.clear();
+    m_LevelOffsets.clear();
+    uint32_t staticCount = 0, depth = UINT32_MAX;
+    for (uint32_t oldSlot : order) {
+        uint32_t oldParent = m_Parents[oldSlot];
+        uint32_t parent = oldParent == TRANSFORM_NODE_INVALID ? TRANSFORM_NODE_INVALID : newSlots[oldParent];
+        /* 父节点被删掉了，子树跟着删 */
+        if (m_Removed[oldSlot] || (oldParent != TRANSFORM_NODE_INVALID && parent == UINT32_MAX)) {
+            m_Slots[m_Ids[oldSlot]] = UINT32_MAX;
+            m_FreeNodes.push_back(m_Ids[oldSlot]);
+            continue;
+        }
+
+        if (depths[oldSlot] != depth) {
+            depth = depths[oldSlot];
+            m_LevelOffsets.push_back((uint32_t) std::size(m_DynamicSlots));
+        }
+
+        uint32_t slot = (uint32_t) std::size(ids);
+        newSlots[oldSlot] = slot;
+        m_Slots[m_Ids[oldSlot]] = slot;
+        parents.push_back(parent);
+        locals.push_back(m_Locals[oldSlot]);
+        ids.push_back(m_Ids[oldSlot]);
+
+        /* 父节点不是静态的话，静态标记不生效 */
+        bool isStatic = m_Static[oldSlot] && (parent == TRANSFORM_NODE_INVALID || effectiveStatics[parent]);
+        statics.push_back(m_Static[oldSlot]);
+        effectiveStatics.push_back(isStatic);
+        if (isStatic) {
+            worlds.push_back(parent == TRANSFORM_NODE_INVALID ? locals.back() : glm::mat4());
+            if (parent != TRANSFORM_NODE_INVALID)
+                _MultiplyMatrix(worlds[parent], locals.back(), worlds.back());
+            staticCount++;
+        } else {
+            worlds.push_back(m_Worlds[oldSlot]);
+            m_DynamicSlots.push_back(slot);
+        }
+    }
+    m_LevelOffsets.push_back((uint32_t) std::size(m_DynamicSlots));
+
+    const uint32_t newCount = (uint32_t) std::size(ids);
+
+    m_Parents = std::move(parents);
+    m_Locals = std::move(locals);
+    m_Worlds = std::move(worlds);
+    m_Static = std::move(statics);
+    m_Ids = std::move(ids);
+    m_Dirty.assign(newCount, 1);
+    m_Changed.assign(newCount, 0);
+    m_Removed.assign(newCount, 0);
+
+    m_Stats.nodeCount = newCount;
+    m_Stats.levelCount = (uint32_t) std::size(m_LevelOffsets) - 1;
+    m_Stats.staticCount = staticCount;
+    m_OrderDirty = false;
+    m_AnyDirty = true;
+}
+
+void TransformHierarchy::_UpdateRange(const uint32_t *pSlots, uint32_t count, uint32_t *pUpdatedCount) {
+    uint32_t updatedCount = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t slot = pSlots[i];
+        uint32_t parent = m_Parents[slot];
+        /* 父节点这一帧重算过，子节点也要重算 */
+        bool dirty = m_Dirty[slot] || (parent != TRANSFORM_NODE_INVALID && m_Changed[parent]);
+        m_Changed[slot] = dirty;
+        if (!dirty)
+            continue;
+
+        m_Dirty[slot] = 0;
+        if (parent == TRANSFORM_NODE_INVALID)
+            m_Worlds[slot] = m_Locals[slot];
+        else
+            _MultiplyMatrix(m_Worlds[parent], m_Locals[slot], m_Worlds[slot]);
+        updatedCount++;
+    }
+    *pUpdatedCount = updatedCount;
+}
+
+void TransformHierarchy::Update(ThreadPool *pThreadPool) {
+    timestamp64_t start = System::GetTimeNanos();
+    m_Stats.rebuildMicros = 0;
+    m_Stats.updatedCount = 0;
+
+    if (m_OrderDirty) {
+        _Rebuild();
+        m_Stats.rebuildMicros = (System::GetTimeNanos() - start) / 1000;
+    }
+
+    if (m_AnyDirty) {
+        const uint32_t threadCount = pThreadPool != null ? pThreadPool->GetThreadCount() + 1 : 1;
+        Vector<uint32_t> updatedCounts(threadCount);
+
+        /* 一层一层往下，同一层的节点互不依赖 */
+        for (uint32_t level = 0; level < m_Stats.levelCount; level++) {
+            const uint32_t *pSlots = std::data(m_DynamicSlots) + m_LevelOffsets[level];
+            uint32_t count = m_LevelOffsets[level + 1] - m_LevelOffsets[level];
+            if (threadCount == 1 || count < 2 * TRANSFORM_HIERARCHY_BATCH_SIZE) {
+                _UpdateRange(pSlots, count, &updatedCounts[0]);
+                m_Stats.updatedCount += updatedCounts[0];
+                continue;
+            }
+
+            uint32_t batchSize = std::max<uint32_t>(TRANSFORM_HIERARCHY_BATCH_SIZE, (count + threadCount - 1) / threadCount);
+            uint32_t batchCount = (count + batchSize - 1) / batchSize;
+            for (uint32_t batch = 1; batch < batchCount; batch++) {
+                uint32_t first = batch * batchSize;
+                pThreadPool->Submit([this, pSlots, first, count, batchSize, batch, &updatedCounts] {
+                    _UpdateRange(pSlots + first, std::min(batchSize, count - first), &updatedCounts[batch]);
+                });
+            }
+            /* 调用线程处理第一批 */
+            _UpdateRange(pSlots, batchSize, &updatedCounts[0]);
+            pThreadPool->Wait();
+
+            for (uint32_t batch = 0; batch < batchCount; batch++)
+                m_Stats.updatedCount += updatedCounts[batch];
+        }
+
+        m_AnyDirty = false;
+    }
+
+    m_Stats.updateMicros = (System::GetTimeNanos() - start) / 1000;
+}
@@ -0,0 +1,113 @@
+/* ************************************************************************
+ *
+ * Copyright (C) 2022 Vincent Luo All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, e1ither express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ************************************************************************/
+
+/* Creates on 2026/10/17. */
+
+/*
+  ===================================
+    @author bit-fashion
+  ===================================
+*/
+#ifndef _VECTRAFLUX_ENGINE_TRANSFORM_HIERARCHY_H_
+#define _VECTRAFLUX_ENGINE_TRANSFORM_HIERARCHY_H_
+
+#include <Typedef.h>
+#include <Math.h>
+
+class ThreadPool;
+
+typedef uint32_t TransformNode;
+
+#define TRANSFORM_NODE_INVALID UINT32_MAX
+
+struct TransformHierarchyStats {
+    uint32_t nodeCount = 0;
+    uint32_t levelCount = 0;
+    uint32_t staticCount = 0; /* never visited by Update() */
+    uint32_t updatedCount = 0; /* world matrices recomputed by the last Update() */
+    uint64_t updateMicros = 0;
+    uint64_t rebuildMicros = 0; /* 0 unless the last Update() had to re-sort */
+};
+
+/**
+ * Parent / child transforms. Nodes are stored breadth first (sorted by
+ * depth) so every parent comes before its children and one depth level is a
+ * contiguous range. Update() walks the levels in order, a node is recomputed
+ * when its local transform changed or its parent was recomputed, and the
+ * nodes of a level are split across the thread pool.
+ *
+ * Static nodes under static parents (or roots) get their world matrix when
+ * the hierarchy is re-sorted and are never visited again. Adding, removing,
+ * reparenting nodes and changing a static node re-sort the hierarchy on the
+ * next Update(). Node handles stay valid until the node is removed.
+ */
+class TransformHierarchy {
+public:
+    TransformHierarchy() = default;
+   ~TransformHierarchy() = default;
+
+    /* parent TRANSFORM_NODE_INVALID for a root */
+    TransformNode AddNode(TransformNode parent, const glm::mat4 &local, bool isStatic = false);
+    /* removes the whole subtree */
+    void RemoveNode(TransformNode node);
+    void SetParent(TransformNode node, TransformNode parent);
+    void SetLocalTransform(TransformNode node, const glm::mat4 &local);
+    void SetStatic(TransformNode node, bool isStatic);
+
+    const glm::mat4 &GetLocalTransform(TransformNode node) const { return m_Locals[m_Slots[node]]; }
+    /* valid after Update() */
+    const glm::mat4 &GetWorldTransform(TransformNode node) const { return m_Worlds[m_Slots[node]]; }
+    TransformNode GetParent(TransformNode node) const;
+    uint32_t GetNodeCount() const { return (uint32_t) std::size(m_Ids); }
+
+    /* pThreadPool null updates on the calling thread */
+    void Update(ThreadPool *pThreadPool = null);
+
+    const TransformHierarchyStats &GetStats() const { return m_Stats; }
+
+private:
+    void _Rebuild();
+    void _UpdateRange(const uint32_t *pSlots, uint32_t count, uint32_t *pUpdatedCount);
+    void _CheckNode(TransformNode node) const;
+
+private:
+    //
+    // 按 slot（层序）存放的 SoA 数组
+    //
+    Vector<uint32_t> m_Parents; /* parent slot */
+    Vector<glm::mat4> m_Locals;
+    Vector<glm::mat4> m_Worlds;
+    Vector<uint8_t> m_Dirty; /* local transform changed */
+    Vector<uint8_t> m_Changed; /* world recomputed during this Update() */
+    Vector<uint8_t> m_Static;
+    Vector<uint8_t> m_Removed;
+    Vector<TransformNode> m_Ids; /* slot -> node */
+
+    Vector<uint32_t> m_Slots; /* node -> slot, UINT32_MAX when free */
+    Vector<TransformNode> m_FreeNodes;
+
+    /* 每层需要更新的非静态 slot，m_LevelOffsets[i]..m_LevelOffsets[i + 1] */
+    Vector<uint32_t> m_DynamicSlots;
+    Vector<uint32_t> m_LevelOffsets;
+
+    bool m_OrderDirty = false;
+    bool m_AnyDirty = false;
+    TransformHierarchyStats m_Stats;
+};
+
+#endif /* _VECTRAFLUX_ENGINE_TRANSFORM_HIERARCHY_H_ */
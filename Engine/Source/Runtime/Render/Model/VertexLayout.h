@@ -0,0 +1,315 @@
+/* ************************************************************************
+ *
+ * Copyright (C) 2022 Vincent Luo All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, e1ither express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ************************************************************************/
+
+/* Creates on 2026/10/17. */
+
+/*
+  ===================================
+    @author bit-fashion
+  ===================================
+*/
+#ifndef _VECTRAFLUX_ENGINE_VERTEX_LAYOUT_H_
+#define _VECTRAFLUX_ENGINE_VERTEX_LAYOUT_H_
+
+#include <Typedef.h>
+#include <Math.h>
+#include <cfloat>
+#include <cstring>
+#include "Vertex.h"
+
+/* 属性的值就是着色器里的 location */
+enum VertexAttribute {
+    VERTEX_ATTRIBUTE_POSITION = 0,
+    VERTEX_ATTRIBUTE_COLOR = 1,
+    VERTEX_ATTRIBUTE_TEXCOORD = 2,
+    VERTEX_ATTRIBUTE_NORMAL = 3,
+    VERTEX_ATTRIBUTE_MAX_ENUM
+};
+
+/* 每种格式的大小都是 4 的倍数，属性按顺序紧密排列 */
+enum VertexAttributeFormat {
+    VERTEX_ATTRIBUTE_FORMAT_NONE = 0,
+    VERTEX_ATTRIBUTE_FORMAT_FLOAT32x2,
+    VERTEX_ATTRIBUTE_FORMAT_FLOAT32x3,
+    VERTEX_ATTRIBUTE_FORMAT_FLOAT16x2,
+    VERTEX_ATTRIBUTE_FORMAT_FLOAT16x4, /* position, w unused */
+    VERTEX_ATTRIBUTE_FORMAT_UNORM16x4, /* position, w unused */
+    VERTEX_ATTRIBUTE_FORMAT_UNORM8x4, /* color, a = 1 */
+    VERTEX_ATTRIBUTE_FORMAT_SNORM16x2, /* octahedral normal */
+    VERTEX_ATTRIBUTE_FORMAT_MAX_ENUM
+};
+
+/* 流的编号就是 Vulkan 的 binding，位置单独成流时深度/阴影 pass 只绑定流 0 */
+enum VertexStream {
+    VERTEX_STREAM_POSITION = 0,
+    VERTEX_STREAM_ATTRIBUTES = 1,
+    VERTEX_STREAM_MAX_ENUM
+};
+
+enum VertexPositionFormat {
+    VERTEX_POSITION_FORMAT_FLOAT32 = 0, /* the plain Vertex layout, no quantization */
+    VERTEX_POSITION_FORMAT_FLOAT16,
+    VERTEX_POSITION_FORMAT_UNORM16,
+};
+
+/**
+ * Quantized positions are stored relative to the mesh bounds with one
+ * uniform scale, the shader sees position = offset + scale * stored. GetMatrix() folds that into the
+ * model matrix so vertex shaders don't need to know about it.
+ */
+struct VertexQuantization {
+    glm::vec3 offset = glm::vec3(0.0f);
+    glm::vec3 scale = glm::vec3(1.0f);
+
+    glm::mat4 GetMatrix() const {
+        return glm::scale(glm::translate(glm::mat4(1.0f), offset), scale);
+    }
+};
+
+struct VertexLayoutAttribute {
+    VertexAttributeFormat format = VERTEX_ATTRIBUTE_FORMAT_NONE;
+    uint32_t stream = 0;
+    uint32_t offset = 0; /* inside the stream */
+};
+
+/**
+ * 每个网格自己的顶点格式，属性按 VertexAttribute 的顺序排列。所有属性交错在
+ * 流 0 里，或者位置单独在流 0、其余属性交错在流 1 里（splitPosition）。
+ * 管线的顶点输入从这里生成（VulkanUtils::GetVertexInputBindingDescriptions /
+ * GetVertexInputAttributeDescriptions）。
+ */
+struct VertexLayout {
+    VertexPositionFormat positionFormat = VERTEX_POSITION_FORMAT_FLOAT32;
+    bool splitPosition = false;
+    uint32_t streamCount = 0;
+    uint32_t strides[VERTEX_STREAM_MAX_ENUM] = {};
+    VertexLayoutAttribute attributes[VERTEX_ATTRIBUTE_MAX_ENUM];
+
+    static uint32_t GetFormatSize(VertexAttributeFormat format) {
+        switch (format) {
+            case VERTEX_ATTRIBUTE_FORMAT_FLOAT32x2: return 8;
+            case VERTEX_ATTRIBUTE_FORMAT_FLOAT32x3: return 12;
+            case VERTEX_ATTRIBUTE_FORMAT_FLOAT16x2: return 4;
+            case VERTEX_ATTRIBUTE_FORMAT_FLOAT16x4: return 8;
+            case VERTEX_ATTRIBUTE_FORMAT_UNORM16x4: return 8;
+            case VERTEX_ATTRIBUTE_FORMAT_UNORM8x4: return 4;
+            case VERTEX_ATTRIBUTE_FORMAT_SNORM16x2: return 4;
+            default: return 0;
+        }
+    }
+
+    /* 偏移由格式顺序决定，所以只存格式和 splitPosition 就能还原整个布局 */
+    static VertexLayout Create(VertexPositionFormat positionFormat, const VertexAttributeFormat formats[VERTEX_ATTRIBUTE_MAX_ENUM],
+                               bool splitPosition = false) {
+        VertexLayout layout;
+        layout.positionFormat = positionFormat;
+        layout.splitPosition = splitPosition;
+        for (uint32_t i = 0; i < VERTEX_ATTRIBUTE_MAX_ENUM; i++) {
+            if (formats[i] == VERTEX_ATTRIBUTE_FORMAT_NONE)
+                continue;
+            uint32_t stream = splitPosition && i != VERTEX_ATTRIBUTE_POSITION ? VERTEX_STREAM_ATTRIBUTES : VERTEX_STREAM_POSITION;
+            layout.attributes[i].format = formats[i];
+            layout.attributes[i].stream = stream;
+            layout.attributes[i].offset = layout.strides[stream];
+            layout.strides[stream] += GetFormatSize(formats[i]);
+            layout.streamCount = std::max(layout.streamCount, stream + 1);
+        }
+        return layout;
+    }
+
+    /* 和 Vertex 结构体一致（32 字节），带法线时法线接在后面（44 字节） */
+    static VertexLayout CreateFloat(bool normals = false, bool splitPosition = false) {
+        const VertexAttributeFormat formats[VERTEX_ATTRIBUTE_MAX_ENUM] = {
+            VERTEX_ATTRIBUTE_FORMAT_FLOAT32x3, VERTEX_ATTRIBUTE_FORMAT_FLOAT32x3, VERTEX_ATTRIBUTE_FORMAT_FLOAT32x2,
+            normals ? VERTEX_ATTRIBUTE_FORMAT_FLOAT32x3 : VERTEX_ATTRIBUTE_FORMAT_NONE
+        };
+        return Create(VERTEX_POSITION_FORMAT_FLOAT32, formats, splitPosition);
+    }
+
+    /* 位置 8 字节 + 颜色 4 + UV 4 (+ 法线 4)，即 16/20 字节 */
+    static VertexLayout CreateQuantized(VertexPositionFormat positionFormat, bool normals = false, bool splitPosition = false) {
+        if (positionFormat == VERTEX_POSITION_FORMAT_FLOAT32)
+            return CreateFloat(normals, splitPosition);
+        const VertexAttributeFormat formats[VERTEX_ATTRIBUTE_MAX_ENUM] = {
+            positionFormat == VERTEX_POSITION_FORMAT_FLOAT16 ? VERTEX_ATTRIBUTE_FORMAT_FLOAT16x4 : VERTEX_ATTRIBUTE_FORMAT_UNORM16x4,
+            VERTEX_ATTRIBUTE_FORMAT_UNORM8x4, VERTEX_ATTRIBUTE_FORMAT_FLOAT16x2,
+            normals ? VERTEX_ATTRIBUTE_FORMAT_SNORM16x2 : VERTEX_ATTRIBUTE_FORMAT_NONE
+        };
+        return Create(positionFormat, formats, splitPosition);
+    }
+
+    /* 深度、阴影 pass 用：只保留位置。位置单独成流时只需要绑定流 0，
+     * 交错布局也能用，只是仍然按整个顶点的 stride 读取 */
+    VertexLayout GetPositionOnly() const {
+        VertexLayout layout;
+        layout.positionFormat = positionFormat;
+        layout.splitPosition = splitPosition;
+        layout.streamCount = 1;
+        layout.strides[VERTEX_STREAM_POSITION] = strides[VERTEX_STREAM_POSITION];
+        layout.attributes[VERTEX_ATTRIBUTE_POSITION] = attributes[VERTEX_ATTRIBUTE_POSITION];
+        return layout;
+    }
+
+    bool Has(VertexAttribute attribute) const {
+        return attributes[attribute].format != VERTEX_ATTRIBUTE_FORMAT_NONE;
+    }
+
+    /* 所有流加起来一个顶点的字节数 */
+    uint32_t GetVertexSize() const {
+        uint32_t size = 0;
+        for (uint32_t i = 0; i < streamCount; i++)
+            size += strides[i];
+        return size;
+    }
+
+    bool operator==(const VertexLayout &other) const {
+        if (positionFormat != other.positionFormat || splitPosition != other.splitPosition || streamCount != other.streamCount)
+            return false;
+        for (uint32_t i = 0; i < streamCount; i++) {
+            if (strides[i] != other.strides[i])
+                return false;
+        }
+        for (uint32_t i = 0; i < VERTEX_ATTRIBUTE_MAX_ENUM; i++) {
+            if (attributes[i].format != other.attributes[i].format || attributes[i].stream != other.attributes[i].stream ||
+                attributes[i].offset != other.attributes[i].offset)
+                return false;
+        }
+        return true;
+    }
+};
+
+/**
+ * Vertex (+ 法线) 到任意 VertexLayout 的打包。
+ */
+namespace VertexCodec {
+
+    /* 八面体映射，单位法线 -> [-1, 1]^2 */
+    static glm::vec2 EncodeOctahedral(glm::vec3 normal) {
+        float length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+        if (length == 0.0f)
+            return glm::vec2(0.0f);
+        normal /= length;
+        glm::vec2 result(normal.x, normal.y);
+        if (normal.z < 0.0f) {
+            result.x = (1.0f - std::abs(normal.y)) * (normal.x >= 0.0f ? 1.0f : -1.0f);
+            result.y = (1.0f - std::abs(normal.x)) * (normal.y >= 0.0f ? 1.0f : -1.0f);
+        }
+        return result;
+    }
+
+    static glm::vec3 DecodeOctahedral(glm::vec2 encoded) {
+        glm::vec3 normal(encoded.x, encoded.y, 1.0f - std::abs(encoded.x) - std::abs(encoded.y));
+        float t = std::max(-normal.z, 0.0f);
+        normal.x += normal.x >= 0.0f ? -t : t;
+        normal.y += normal.y >= 0.0f ? -t : t;
+        return glm::normalize(normal);
+    }
+
+    /* 位置量化到包围盒，float16 存 [-1, 1]，unorm16 存 [0, 1]。三个轴用同一个
+     * 缩放，量化矩阵只是均匀缩放 + 平移，法线不受影响 */
+    static VertexQuantization GetQuantization(VertexPositionFormat format, glm::vec3 boundsMin, glm::vec3 boundsMax) {
+        VertexQuantization quantization;
+        if (format == VERTEX_POSITION_FORMAT_FLOAT32 || boundsMin.x > boundsMax.x)
+            return quantization;
+        glm::vec3 size = boundsMax - boundsMin;
+        glm::vec3 extent(std::max(std::max(size.x, size.y), std::max(size.z, FLT_MIN)));
+        if (format == VERTEX_POSITION_FORMAT_FLOAT16) {
+            quantization.offset = (boundsMin + boundsMax) * 0.5f;
+            quantization.scale = extent * 0.5f;
+        } else {
+            quantization.offset = boundsMin;
+            quantization.scale = extent;
+        }
+        return quantization;
+    }
+
+    static void _EncodeAttribute(VertexAttributeFormat format, const float *pValue, uint8_t *pDst) {
+        uint32_t packed[2];
+        switch (format) {
+            case VERTEX_ATTRIBUTE_FORMAT_FLOAT32x2:
+                memcpy(pDst, pValue, 8);
+                break;
+            case VERTEX_ATTRIBUTE_FORMAT_FLOAT32x3:
+                memcpy(pDst, pValue, 12);
+                break;
+            case VERTEX_ATTRIBUTE_FORMAT_FLOAT16x2:
+                packed[0] = glm::packHalf2x16(glm::vec2(pValue[0], pValue[1]));
+                memcpy(pDst, packed, 4);
+                break;
+            case VERTEX_ATTRIBUTE_FORMAT_FLOAT16x4:
+                packed[0] = glm::packHalf2x16(glm::vec2(pValue[0], pValue[1]));
+                packed[1] = glm::packHalf2x16(glm::vec2(pValue[2], 1.0f));
+                memcpy(pDst, packed, 8);
+                break;
+            case VERTEX_ATTRIBUTE_FORMAT_UNORM16x4:
+                packed[0] = glm::packUnorm2x16(glm::vec2(pValue[0], pValue[1]));
+                packed[1] = glm::packUnorm2x16(glm::vec2(pValue[2], 1.0f));
+                memcpy(pDst, packed, 8);
+                break;
+            case VERTEX_ATTRIBUTE_FORMAT_UNORM8x4:
+                packed[0] = glm::packUnorm4x8(glm::vec4(pValue[0], pValue[1], pValue[2], 1.0f));
+                memcpy(pDst, packed, 4);
+                break;
+            case VERTEX_ATTRIBUTE_FORMAT_SNORM16x2:
+                packed[0] = glm::packSnorm2x16(glm::vec2(pValue[0], pValue[1]));
+                memcpy(pDst, packed, 4);
+                break;
+            default:
+                break;
+        }
+    }
+
+    /* pNormals 可以为 null，ppStreams[i] 至少 count * layout.strides[i] 字节 */
+    static void Encode(const VertexLayout &layout, const VertexQuantization &quantization, const Vertex *pVertices,
+                       const glm::vec3 *pNormals, size_t count, void *const *ppStreams) {
+        const VertexLayoutAttribute *attributes = layout.attributes;
+        glm::vec3 inverseScale = 1.0f / quantization.scale;
+        uint8_t *dst[VERTEX_ATTRIBUTE_MAX_ENUM] = {};
+        for (uint32_t i = 0; i < VERTEX_ATTRIBUTE_MAX_ENUM; i++) {
+            if (layout.Has(static_cast<VertexAttribute>(i)))
+                dst[i] = static_cast<uint8_t *>(ppStreams[attributes[i].stream]) + attributes[i].offset;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            const Vertex &vertex = pVertices[i];
+            glm::vec3 position = (vertex.position - quantization.offset) * inverseScale;
+            _EncodeAttribute(attributes[VERTEX_ATTRIBUTE_POSITION].format, &position.x, dst[VERTEX_ATTRIBUTE_POSITION]);
+            _EncodeAttribute(attributes[VERTEX_ATTRIBUTE_COLOR].format, &vertex.color.x, dst[VERTEX_ATTRIBUTE_COLOR]);
+            _EncodeAttribute(attributes[VERTEX_ATTRIBUTE_TEXCOORD].format, &vertex.texCoord.x, dst[VERTEX_ATTRIBUTE_TEXCOORD]);
+
+            if (layout.Has(VERTEX_ATTRIBUTE_NORMAL)) {
+                glm::vec3 normal = pNormals != null ? pNormals[i] : glm::vec3(0.0f, 0.0f, 1.0f);
+                glm::vec2 octahedral;
+                const float *value = &normal.x;
+                if (attributes[VERTEX_ATTRIBUTE_NORMAL].format == VERTEX_ATTRIBUTE_FORMAT_SNORM16x2) {
+                    octahedral = EncodeOctahedral(normal);
+                    value = &octahedral.x;
+                }
+                _EncodeAttribute(attributes[VERTEX_ATTRIBUTE_NORMAL].format, value, dst[VERTEX_ATTRIBUTE_NORMAL]);
+            }
+
+            for (uint32_t k = 0; k < VERTEX_ATTRIBUTE_MAX_ENUM; k++) {
+                if (layout.Has(static_cast<VertexAttribute>(k)))
+                    dst[k] += layout.strides[attributes[k].stream];
+            }
+        }
+    }
+
+}
+
+#endif /* _VECTRAFLUX_ENGINE_VERTEX_LAYOUT_H_ */
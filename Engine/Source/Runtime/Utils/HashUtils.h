@@ -0,0 +1,57 @@
+/* ************************************************************************
+ *
+ * Copyright (C) 2022 Vincent Luo All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, e1ither express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ************************************************************************/
+
+/* Creates on 2026/10/17. */
+
+/*
+  ===================================
+    @author bit-fashion
+  ===================================
+*/
+#ifndef _VECTRAFLUX_ENGINE_HASH_UTILS_H_
+#define _VECTRAFLUX_ENGINE_HASH_UTILS_H_
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * FNV-1a，用于缓存 key（sampler、pipeline 描述）。按字节哈希，结构体
+ * 成员要逐个传入，不能把带 padding 的整个结构体传进来。
+ */
+namespace HashUtils {
+
+    static constexpr size_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+
+    static void HashBytes(size_t *pHash, const void *data, size_t size) {
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+        uint64_t hash = *pHash;
+        for (size_t i = 0; i < size; i++) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+        *pHash = static_cast<size_t>(hash);
+    }
+
+    template<typename T>
+    static void HashValue(size_t *pHash, const T &value) {
+        HashBytes(pHash, &value, sizeof(value));
+    }
+
+}
+
+#endif /* _VECTRAFLUX_ENGINE_HASH_UTILS_H_ */
@@ -0,0 +1,141 @@
+/* ************************************************************************
+ *
+ * Copyright (C) 2022 Vincent Luo All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, e1ither express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ************************************************************************/
+
+/* Creates on 2026/10/17. */
+
+/*
+ ===============================
+   @author bit-fashion
+ ===============================
+*/
+#ifndef _VECTRAFLUX_ENGINE_MAPPED_FILE_H_
+#define _VECTRAFLUX_ENGINE_MAPPED_FILE_H_
+
+#include <Typedef.h>
+#include <stdexcept>
+
+#ifdef _WIN32
+#  ifndef WIN32_LEAN_AND_MEAN
+#    define WIN32_LEAN_AND_MEAN
+#  endif
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <unistd.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#endif
+
+/**
+ * 只读的内存映射文件，析构时解除映射。空文件映射后 GetData() 为 null。
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const String &path) { Map(path); }
+   ~MappedFile() { Unmap(); }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    void Map(const String &path) {
+        Unmap();
+#ifdef _WIN32
+        m_File = CreateFileA(getchr(path), GENERIC_READ, FILE_SHARE_READ, null, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, null);
+        if (m_File == INVALID_HANDLE_VALUE)
+            throw std::runtime_error("Error: open file failed!");
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(m_File, &size)) {
+            Unmap();
+            throw std::runtime_error("Error: stat file failed!");
+        }
+        m_Size = static_cast<size_t>(size.QuadPart);
+        if (m_Size == 0)
+            return;
+
+        m_Mapping = CreateFileMappingA(m_File, null, PAGE_READONLY, 0, 0, null);
+        if (m_Mapping != null)
+            m_Data = static_cast<const char *>(MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+        m_File = open(getchr(path), O_RDONLY);
+        if (m_File < 0)
+            throw std::runtime_error("Error: open file failed!");
+
+        struct stat st;
+        if (fstat(m_File, &st) != 0) {
+            Unmap();
+            throw std::runtime_error("Error: stat file failed!");
+        }
+        m_Size = static_cast<size_t>(st.st_size);
+        if (m_Size == 0)
+            return;
+
+        void *data = mmap(null, m_Size, PROT_READ, MAP_PRIVATE, m_File, 0);
+        if (data != MAP_FAILED) {
+            m_Data = static_cast<const char *>(data);
+            /* 按顺序读，让内核提前预读。advice 是枚举值不能按位或，分两次设置 */
+            madvise(data, m_Size, MADV_SEQUENTIAL);
+            madvise(data, m_Size, MADV_WILLNEED);
+        }
+#endif
+        if (m_Data == null) {
+            Unmap();
+            throw std::runtime_error("Error: map file failed!");
+        }
+    }
+
+    void Unmap() {
+#ifdef _WIN32
+        if (m_Data != null)
+            UnmapViewOfFile(m_Data);
+        if (m_Mapping != null)
+            CloseHandle(m_Mapping);
+        if (m_File != INVALID_HANDLE_VALUE)
+            CloseHandle(m_File);
+        m_Mapping = null;
+        m_File = INVALID_HANDLE_VALUE;
+#else
+        if (m_Data != null)
+            munmap(const_cast<char *>(m_Data), m_Size);
+        if (m_File >= 0)
+            close(m_File);
+        m_File = -1;
+#endif
+        m_Data = null;
+        m_Size = 0;
+    }
+
+    const char *GetData() const { return m_Data; }
+    size_t GetSize() const { return m_Size; }
+
+private:
+    const char *m_Data = null;
+    size_t m_Size = 0;
+#ifdef _WIN32
+    HANDLE m_File = INVALID_HANDLE_VALUE;
+    HANDLE m_Mapping = null;
+#else
+    int m_File = -1;
+#endif
+};
+
+#endif /* _VECTRAFLUX_ENGINE_MAPPED_FILE_H_ */
@@ -0,0 +1,102 @@
+/* ************************************************************************
+ *
+ * Copyright (C) 2022 Vincent Luo All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, e1ither express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ************************************************************************/
+/* Creates on 2026/10/17. */
+
+/*
+ ===============================
+   @author bit-fashion
+ ===============================
+*/
+#ifndef _VECTRAFLUX_ENGINE_MIPMAP_UTILS_H_
+#define _VECTRAFLUX_ENGINE_MIPMAP_UTILS_H_
+
+#include <Typedef.h>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+/**
+ * CPU 端的 mipmap 生成，2x2 box filter，8 位通道。用于离线烘焙和 GPU
+ * 无法生成 mip 的格式。所有 level 紧密排列在同一块内存里，level 0 在最前。
+ */
+namespace MipmapUtils {
+
+    static uint32_t GetMipLevelCount(uint32_t width, uint32_t height) {
+        uint32_t levels = 1;
+        for (uint32_t size = std::max(width, height); size > 1; size >>= 1)
+            ++levels;
+        return levels;
+    }
+
+    static size_t GetMipChainSize(uint32_t width, uint32_t height, uint32_t channels, uint32_t mipLevels) {
+        size_t size = 0;
+        for (uint32_t i = 0; i < mipLevels; i++)
+            size += (size_t) std::max(1u, width >> i) * std::max(1u, height >> i) * channels;
+        return size;
+    }
+
+    /* 奇数尺寸时最后一行/列被重复采样 */
+    static void Downsample(const uint8_t *pSrc, uint32_t srcWidth, uint32_t srcHeight, uint32_t channels, uint8_t *pDst) {
+        uint32_t dstWidth = std::max(1u, srcWidth >> 1);
+        uint32_t dstHeight = std::max(1u, srcHeight >> 1);
+        for (uint32_t y = 0; y < dstHeight; y++) {
+            const uint8_t *row0 = pSrc + (size_t) std::min(y * 2, srcHeight - 1) * srcWidth * channels;
+            const uint8_t *row1 = pSrc + (size_t) std::min(y * 2 + 1, srcHeight - 1) * srcWidth * channels;
+            for (uint32_t x = 0; x < dstWidth; x++) {
+                uint32_t x0 = std::min(x * 2, srcWidth - 1) * channels;
+                uint32_t x1 = std::min(x * 2 + 1, srcWidth - 1) * channels;
+                for (uint32_t c = 0; c < channels; c++)
+                    *pDst++ = (uint8_t) ((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) >> 2);
+            }
+        }
+    }
+
+    /* pPixels 是 level 0，pChain 得到完整的 mip 链（包括 level 0） */
+    static void GenerateMipChain(const uint8_t *pPixels, uint32_t width, uint32_t height, uint32_t channels,
+                                 uint32_t mipLevels, Vector<uint8_t> *pChain) {
+        pChain->resize(GetMipChainSize(width, height, channels, mipLevels));
+        uint8_t *level = std::data(*pChain);
+        memcpy(level, pPixels, (size_t) width * height * channels);
+
+        for (uint32_t i = 1; i < mipLevels; i++) {
+            uint32_t levelWidth = std::max(1u, width >> (i - 1));
+            uint32_t levelHeight = std::max(1u, height >> (i - 1));
+            uint8_t *next = level + (size_t) levelWidth * levelHeight * channels;
+            Downsample(level, levelWidth, levelHeight, channels, next);
+            level = next;
+        }
+    }
+
+    /* 半径为 radius 的包围球在屏幕上覆盖的像素边长 */
+    static float EstimateScreenSize(float radius, float distance, float fovY, uint32_t viewportHeight) {
+        distance = std::max(distance, radius);
+        return radius / (distance * std::tan(fovY * 0.5f)) * (float) viewportHeight;
+    }
+
+    /* 纹理铺满 screenPixels 个像素时采样到的 mip，1 texel 对 1 pixel */
+    static uint32_t GetScreenSpaceMip(uint32_t width, uint32_t height, float screenPixels) {
+        float texels = (float) std::max(width, height);
+        if (screenPixels >= texels)
+            return 0;
+        uint32_t mip = (uint32_t) std::floor(std::log2(texels / std::max(screenPixels, 1.0f)));
+        return std::min(mip, GetMipLevelCount(width, height) - 1);
+    }
+
+}
+
+#endif /* _VECTRAFLUX_ENGINE_MIPMAP_UTILS_H_ */
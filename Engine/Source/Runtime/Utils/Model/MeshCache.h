@@ -0,0 +1,621 @@
+/* ************************************************************************
+ *
+ * Copyright (C) 2022 Vincent Luo All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, e1ither express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ************************************************************************/
+
+/* Creates on 2026/10/17. */
+
+/*
+  ===================================
+    @author bit-fashion
+  ===================================
+*/
+#ifndef _VECTRAFLUX_ENGINE_MESH_CACHE_H_
+#define _VECTRAFLUX_ENGINE_MESH_CACHE_H_
+
+#include <Engine.h>
+#include <Typedef.h>
+#include <System.h>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include "Render/Model/VertexLayout.h"
+#include "Utils/MappedFile.h"
+#include "Utils/Model/ObjLoader.h"
+#include "Utils/Model/MeshOptimizer.h"
+
+static_assert(std::endian::native == std::endian::little, "mesh cache files are little-endian");
+
+#define MESH_CACHE_MAGIC 0x434D4656 /* "VFMC" */
+#define MESH_CACHE_VERSION 4
+#define MESH_CACHE_EXTENSION ".vfmesh"
+/* 每个数据流的起始位置对齐，映射后可以直接当数组用、整块拷到暂存缓冲 */
+#define MESH_CACHE_STREAM_ALIGNMENT 64
+
+/* 文件以这个头开始，所有偏移都相对文件开头 */
+struct MeshCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t fileSize;
+    /* 缓存的 key：源文件路径 + 修改时间 + 内容哈希 */
+    uint64_t sourceMtime;
+    uint64_t sourceSize;
+    uint64_t sourceHash;
+    uint32_t sourcePathOffset; /* string table */
+    uint32_t sourcePathLength;
+    /* 顶点按 VertexLayout 打包，位置单独一个流，offset 由格式推出 */
+    uint32_t vertexStreamCount;
+    uint32_t vertexStrides[VERTEX_STREAM_MAX_ENUM];
+    uint32_t vertexCount;
+    uint32_t positionFormat; /* VertexPositionFormat */
+    uint32_t vertexFormats[VERTEX_ATTRIBUTE_MAX_ENUM]; /* VertexAttributeFormat */
+    uint32_t indexCount;
+    uint32_t indexStride; /* 2 when every index fits in 16 bits, otherwise 4 */
+    uint32_t splitPosition;
+    uint32_t submeshCount;
+    uint32_t materialCount;
+    float boundsMin[3];
+    float boundsMax[3];
+    float quantizationOffset[3];
+    float quantizationScale[3];
+    uint64_t vertexOffsets[VERTEX_STREAM_MAX_ENUM];
+    uint64_t indexOffset;
+    uint64_t submeshOffset;
+    uint64_t materialOffset;
+    uint64_t stringOffset;
+    uint64_t stringSize;
+};
+
+/* 字符串都存在 string table 里，不以 0 结尾 */
+struct MeshCacheString {
+    uint32_t offset;
+    uint32_t length;
+};
+
+struct MeshCacheSubmesh {
+    MeshCacheString name;
+    uint32_t material;
+    uint32_t indexOffset;
+    uint32_t indexCount;
+};
+
+struct MeshCacheMaterial {
+    MeshCacheString name;
+    float ambient[3];
+    float diffuse[3];
+    float specular[3];
+    float emissive[3];
+    float shininess;
+    float opacity;
+    float ior;
+    uint32_t illum;
+    MeshCacheString diffuseMap;
+    MeshCacheString specularMap;
+    MeshCacheString normalMap;
+    MeshCacheString alphaMap;
+    MeshCacheString emissiveMap;
+};
+
+struct MeshCacheStats {
+    bool hit = false;
+    bool hashed = false; /* mtime changed, content hash decided */
+    uint64_t lookupMicros = 0; /* stat + map + validate */
+    uint64_t objMicros = 0; /* OBJ load on a miss */
+    uint64_t optimizeMicros = 0;
+    MeshOptimizeStats optimize; /* filled on a miss */
+    uint64_t writeMicros = 0;
+    uint64_t totalMicros = 0;
+};
+
+/**
+ * Mesh loaded from the binary cache, already run through MeshOptimizer.
+ * The vertex streams are packed with the mesh's VertexLayout, positions in
+ * a stream of their own so depth-only passes can bind just that one. Like
+ * the index stream they point straight into the mapped file, so uploading is a
+ * single memcpy into the staging ring (AllocateVertexBuffer /
+ * AllocateIndexBuffer) with no parsing. Quantized positions need
+ * GetQuantization().GetMatrix() in front of the model matrix.
+ * Submeshes and materials are small and copied out on open. When the cache
+ * can't be written the streams point into the OBJ result kept in here.
+ */
+class MeshCache {
+public:
+    MeshCache() = default;
+   ~MeshCache() = default;
+
+    MeshCache(const MeshCache &) = delete;
+    MeshCache &operator=(const MeshCache &) = delete;
+
+    /* 校验失败返回 false，不抛异常 */
+    bool Open(const String &cachePath) {
+        Close();
+        try {
+            m_File.Map(cachePath);
+        } catch (const std::exception &) {
+            return false;
+        }
+        if (!_Validate()) {
+            Close();
+            return false;
+        }
+
+        const MeshCacheHeader *header = GetHeader();
+        const char *data = m_File.GetData();
+        m_VertexLayout = _GetVertexLayout(header);
+        for (uint32_t i = 0; i < m_VertexLayout.streamCount; i++)
+            m_VertexStreams[i] = data + header->vertexOffsets[i];
+        m_Quantization.offset = glm::vec3(header->quantizationOffset[0], header->quantizationOffset[1], header->quantizationOffset[2]);
+        m_Quantization.scale = glm::vec3(header->quantizationScale[0], header->quantizationScale[1], header->quantizationScale[2]);
+        m_Indices = data + header->indexOffset;
+        m_IndexSize = header->indexStride;
+        m_VertexCount = header->vertexCount;
+        m_IndexCount = header->indexCount;
+        m_BoundsMin = glm::vec3(header->boundsMin[0], header->boundsMin[1], header->boundsMin[2]);
+        m_BoundsMax = glm::vec3(header->boundsMax[0], header->boundsMax[1], header->boundsMax[2]);
+
+        const MeshCacheSubmesh *submeshes = reinterpret_cast<const MeshCacheSubmesh *>(data + header->submeshOffset);
+        for (uint32_t i = 0; i < header->submeshCount; i++) {
+            const MeshCacheSubmesh &submesh = submeshes[i];
+            m_Submeshes.push_back({ _GetString(submesh.name), submesh.material, submesh.indexOffset, submesh.indexCount });
+        }
+
+        const MeshCacheMaterial *materials = reinterpret_cast<const MeshCacheMaterial *>(data + header->materialOffset);
+        for (uint32_t i = 0; i < header->materialCount; i++) {
+            const MeshCacheMaterial &src = materials[i];
+            ObjMaterial &material = m_Materials.emplace_back();
+            material.name = _GetString(src.name);
+            material.ambient = glm::vec3(src.ambient[0], src.ambient[1], src.ambient[2]);
+            material.diffuse = glm::vec3(src.diffuse[0], src.diffuse[1], src.diffuse[2]);
+            material.specular = glm::vec3(src.specular[0], src.specular[1], src.specular[2]);
+            material.emissive = glm::vec3(src.emissive[0], src.emissive[1], src.emissive[2]);
+            material.shininess = src.shininess;
+            material.opacity = src.opacity;
+            material.ior = src.ior;
+            material.illum = src.illum;
+            material.diffuseMap = _GetString(src.diffuseMap);
+            material.specularMap = _GetString(src.specularMap);
+            material.normalMap = _GetString(src.normalMap);
+            material.alphaMap = _GetString(src.alphaMap);
+            material.emissiveMap = _GetString(src.emissiveMap);
+        }
+
+        return true;
+    }
+
+    /* 不走缓存文件，直接持有 OBJ 的解析结果 */
+    void Assign(ObjModel &&model, VertexPositionFormat positionFormat) {
+        Close();
+        m_Model = std::move(model);
+        m_VertexLayout = VertexLayout::CreateQuantized(positionFormat, !m_Model.normals.empty(), true);
+        m_Quantization = VertexCodec::GetQuantization(positionFormat, m_Model.boundsMin, m_Model.boundsMax);
+        void *streams[VERTEX_STREAM_MAX_ENUM];
+        for (uint32_t i = 0; i < m_VertexLayout.streamCount; i++) {
+            m_PackedVertices[i].resize(std::size(m_Model.vertices) * m_VertexLayout.strides[i]);
+            streams[i] = std::data(m_PackedVertices[i]);
+            m_VertexStreams[i] = streams[i];
+        }
+        VertexCodec::Encode(m_VertexLayout, m_Quantization, std::data(m_Model.vertices),
+                            !m_Model.normals.empty() ? std::data(m_Model.normals) : null, std::size(m_Model.vertices), streams);
+        m_Indices = std::data(m_Model.indices);
+        m_IndexSize = sizeof(uint32_t);
+        if (MeshOptimizer::CanUse16BitIndices(std::size(m_Model.vertices))) {
+            m_Indices16.assign(std::begin(m_Model.indices), std::end(m_Model.indices));
+            m_Indices = std::data(m_Indices16);
+            m_IndexSize = sizeof(uint16_t);
+        }
+        m_VertexCount = static_cast<uint32_t>(std::size(m_Model.vertices));
+        m_IndexCount = static_cast<uint32_t>(std::size(m_Model.indices));
+        m_BoundsMin = m_Model.boundsMin;
+        m_BoundsMax = m_Model.boundsMax;
+        m_Submeshes = std::move(m_Model.submeshes);
+        m_Materials = std::move(m_Model.materials);
+    }
+
+    void Close() {
+        m_File.Unmap();
+        m_Model = ObjModel();
+        for (uint32_t i = 0; i < VERTEX_STREAM_MAX_ENUM; i++) {
+            m_VertexStreams[i] = null;
+            m_PackedVertices[i].clear();
+        }
+        m_VertexLayout = VertexLayout();
+        m_Quantization = VertexQuantization();
+        m_Indices = null;
+        m_Indices16.clear();
+        m_IndexSize = sizeof(uint32_t);
+        m_VertexCount = 0;
+        m_IndexCount = 0;
+        m_Submeshes.clear();
+        m_Materials.clear();
+    }
+
+    /* 文件映射时有效 */
+    const MeshCacheHeader *GetHeader() const {
+        return m_File.GetData() != null ? reinterpret_cast<const MeshCacheHeader *>(m_File.GetData()) : null;
+    }
+
+    bool IsMapped() const { return m_File.GetData() != null; }
+    /* 传给 AllocateVertexBuffer(layout, count, streams, ...) */
+    const void *const *GetVertexStreams() const { return m_VertexStreams; }
+    const VertexLayout &GetVertexLayout() const { return m_VertexLayout; }
+    const VertexQuantization &GetQuantization() const { return m_Quantization; }
+    const void *GetIndices() const { return m_Indices; }
+    uint32_t GetIndexSize() const { return m_IndexSize; } /* 2 or 4 bytes */
+    uint32_t GetVertexCount() const { return m_VertexCount; }
+    uint32_t GetIndexCount() const { return m_IndexCount; }
+    const Vector<ObjSubmesh> &GetSubmeshes() const { return m_Submeshes; }
+    const Vector<ObjMaterial> &GetMaterials() const { return m_Materials; }
+    glm::vec3 GetBoundsMin() const { return m_BoundsMin; }
+    glm::vec3 GetBoundsMax() const { return m_BoundsMax; }
+
+    String GetSourcePath() const {
+        const MeshCacheHeader *header = GetHeader();
+        return header != null ? _GetString({ header->sourcePathOffset, header->sourcePathLength }) : String();
+    }
+
+private:
+    static bool _IsStreamValid(uint64_t offset, uint64_t count, uint64_t stride, uint64_t fileSize) {
+        return offset % MESH_CACHE_STREAM_ALIGNMENT == 0 && offset <= fileSize && count * stride <= fileSize - offset;
+    }
+
+    bool _IsStringValid(const MeshCacheString &string) const {
+        const MeshCacheHeader *header = GetHeader();
+        return static_cast<uint64_t>(string.offset) + string.length <= header->stringSize;
+    }
+
+    String _GetString(const MeshCacheString &string) const {
+        return String(m_File.GetData() + GetHeader()->stringOffset + string.offset, string.length);
+    }
+
+    static VertexLayout _GetVertexLayout(const MeshCacheHeader *header) {
+        VertexAttributeFormat formats[VERTEX_ATTRIBUTE_MAX_ENUM];
+        for (uint32_t i = 0; i < VERTEX_ATTRIBUTE_MAX_ENUM; i++)
+            formats[i] = static_cast<VertexAttributeFormat>(header->vertexFormats[i]);
+        return VertexLayout::Create(static_cast<VertexPositionFormat>(header->positionFormat), formats, header->splitPosition != 0);
+    }
+
+    /* 文件可能被截断或者来自旧版本，任何一项不对都当作未命中 */
+    bool _Validate() const {
+        size_t size = m_File.GetSize();
+        if (size < sizeof(MeshCacheHeader))
+            return false;
+
+        const MeshCacheHeader *header = GetHeader();
+        if (header->magic != MESH_CACHE_MAGIC || header->version != MESH_CACHE_VERSION || header->fileSize != size ||
+            (header->indexStride != sizeof(uint16_t) && header->indexStride != sizeof(uint32_t)) ||
+            header->positionFormat > VERTEX_POSITION_FORMAT_UNORM16)
+            return false;
+
+        for (uint32_t i = 0; i < VERTEX_ATTRIBUTE_MAX_ENUM; i++) {
+            if (header->vertexFormats[i] >= VERTEX_ATTRIBUTE_FORMAT_MAX_ENUM)
+                return false;
+        }
+        VertexLayout layout = _GetVertexLayout(header);
+        if (layout.streamCount != header->vertexStreamCount)
+            return false;
+        for (uint32_t i = 0; i < layout.streamCount; i++) {
+            if (layout.strides[i] != header->vertexStrides[i] ||
+                !_IsStreamValid(header->vertexOffsets[i], header->vertexCount, header->vertexStrides[i], size))
+                return false;
+        }
+
+        if (!_IsStreamValid(header->indexOffset, header->indexCount, header->indexStride, size) ||
+            !_IsStreamValid(header->submeshOffset, header->submeshCount, sizeof(MeshCacheSubmesh), size) ||
+            !_IsStreamValid(header->materialOffset, header->materialCount, sizeof(MeshCacheMaterial), size) ||
+            !_IsStreamValid(header->stringOffset, header->stringSize, 1, size))
+            return false;
+
+        if (!_IsStringValid({ header->sourcePathOffset, header->sourcePathLength }))
+            return false;
+
+        const MeshCacheSubmesh *submeshes = reinterpret_cast<const MeshCacheSubmesh *>(m_File.GetData() + header->submeshOffset);
+        for (uint32_t i = 0; i < header->submeshCount; i++) {
+            const MeshCacheSubmesh &submesh = submeshes[i];
+            if (!_IsStringValid(submesh.name) || static_cast<uint64_t>(submesh.indexOffset) + submesh.indexCount > header->indexCount)
+                return false;
+        }
+
+        const MeshCacheMaterial *materials = reinterpret_cast<const MeshCacheMaterial *>(m_File.GetData() + header->materialOffset);
+        for (uint32_t i = 0; i < header->materialCount; i++) {
+            const MeshCacheMaterial &material = materials[i];
+            if (!_IsStringValid(material.name) || !_IsStringValid(material.diffuseMap) || !_IsStringValid(material.specularMap) ||
+                !_IsStringValid(material.normalMap) || !_IsStringValid(material.alphaMap) || !_IsStringValid(material.emissiveMap))
+                return false;
+        }
+
+        return true;
+    }
+
+private:
+    MappedFile m_File;
+    ObjModel m_Model;
+    const void *m_VertexStreams[VERTEX_STREAM_MAX_ENUM] = {};
+    Vector<uint8_t> m_PackedVertices[VERTEX_STREAM_MAX_ENUM];
+    VertexLayout m_VertexLayout;
+    VertexQuantization m_Quantization;
+    const void *m_Indices = null;
+    Vector<uint16_t> m_Indices16;
+    uint32_t m_IndexSize = sizeof(uint32_t);
+    uint32_t m_VertexCount = 0;
+    uint32_t m_IndexCount = 0;
+    Vector<ObjSubmesh> m_Submeshes;
+    Vector<ObjMaterial> m_Materials;
+    glm::vec3 m_BoundsMin = glm::vec3(0.0f);
+    glm::vec3 m_BoundsMax = glm::vec3(0.0f);
+};
+
+/**
+ * 二进制网格缓存。缓存文件名是源文件绝对路径的哈希，文件头里记录源文件的
+ * 修改时间、大小和内容哈希：修改时间和大小都对上直接命中；只有修改时间变了
+ * （重新拷贝、checkout）时再算一遍内容哈希，内容没变就更新头里的时间继续用。
+ * 未命中时用 OBJ 加载器解析，写出缓存后再映射回来。
+ */
+namespace Loader {
+
+    /* 64 位哈希，每次处理 32 字节，4 路互不依赖 */
+    static uint64_t _MeshCacheHash(const void *pData, size_t size) {
+        const uint64_t prime1 = 0x9E3779B185EBCA87ull;
+        const uint64_t prime2 = 0xC2B2AE3D27D4EB4Full;
+        const uint8_t *p = static_cast<const uint8_t *>(pData);
+        const uint8_t *end = p + size;
+        uint64_t lanes[4] = { prime1 + prime2, prime2, 0, 0 - prime1 };
+
+        for (; end - p >= 32; p += 32) {
+            for (int i = 0; i < 4; i++) {
+                uint64_t word;
+                memcpy(&word, p + i * 8, sizeof(word));
+                lanes[i] = std::rotl(lanes[i] + word * prime2, 31) * prime1;
+            }
+        }
+
+        uint64_t hash = std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7) + std::rotl(lanes[2], 12) + std::rotl(lanes[3], 18);
+        hash += size;
+        for (; p < end; p += 8) {
+            uint64_t word = 0;
+            memcpy(&word, p, std::min<size_t>(8, end - p));
+            hash = std::rotl(hash ^ (std::rotl(word * prime2, 31) * prime1), 27) * prime1 + prime2;
+        }
+
+        hash ^= hash >> 33;
+        hash *= prime2;
+        hash ^= hash >> 29;
+        hash *= prime1;
+        hash ^= hash >> 32;
+        return hash;
+    }
+
+    static uint64_t _MeshCacheHashFile(const String &path) {
+        MappedFile file(path);
+        return _MeshCacheHash(file.GetData(), file.GetSize());
+    }
+
+    static String GetMeshCachePath(const String &path) {
+        String absolute = std::filesystem::absolute(path).lexically_normal().generic_string();
+        uint64_t hash = _MeshCacheHash(std::data(absolute), std::size(absolute));
+        return (std::filesystem::path(ENGINE_CONFIG_MESH_CACHE_FOLDER) / strfmt("{:016x}{}", hash, MESH_CACHE_EXTENSION)).generic_string();
+    }
+
+    static void WriteMeshCache(const String &cachePath, const String &sourcePath, uint64_t sourceMtime, uint64_t sourceSize,
+                               uint64_t sourceHash, const ObjModel &model, VertexPositionFormat positionFormat) {
+        String strings;
+        auto add_string = [&strings](const String &value) {
+            MeshCacheString string = { static_cast<uint32_t>(std::size(strings)), static_cast<uint32_t>(std::size(value)) };
+            strings += value;
+            return string;
+        };
+
+        MeshCacheHeader header = {};
+        header.magic = MESH_CACHE_MAGIC;
+        header.version = MESH_CACHE_VERSION;
+        header.sourceMtime = sourceMtime;
+        header.sourceSize = sourceSize;
+        header.sourceHash = sourceHash;
+        VertexLayout layout = VertexLayout::CreateQuantized(positionFormat, !model.normals.empty(), true);
+        VertexQuantization quantization = VertexCodec::GetQuantization(positionFormat, model.boundsMin, model.boundsMax);
+        header.vertexStreamCount = layout.streamCount;
+        header.splitPosition = layout.splitPosition;
+        for (uint32_t i = 0; i < layout.streamCount; i++)
+            header.vertexStrides[i] = layout.strides[i];
+        header.vertexCount = static_cast<uint32_t>(std::size(model.vertices));
+        header.positionFormat = positionFormat;
+        for (uint32_t i = 0; i < VERTEX_ATTRIBUTE_MAX_ENUM; i++)
+            header.vertexFormats[i] = layout.attributes[i].format;
+        memcpy(header.quantizationOffset, &quantization.offset, sizeof(header.quantizationOffset));
+        memcpy(header.quantizationScale, &quantization.scale, sizeof(header.quantizationScale));
+        header.indexCount = static_cast<uint32_t>(std::size(model.indices));
+        header.indexStride = sizeof(uint32_t);
+        header.submeshCount = static_cast<uint32_t>(std::size(model.submeshes));
+        header.materialCount = static_cast<uint32_t>(std::size(model.materials));
+        memcpy(header.boundsMin, &model.boundsMin, sizeof(header.boundsMin));
+        memcpy(header.boundsMax, &model.boundsMax, sizeof(header.boundsMax));
+
+        MeshCacheString path = add_string(std::filesystem::absolute(sourcePath).lexically_normal().generic_string());
+        header.sourcePathOffset = path.offset;
+        header.sourcePathLength = path.length;
+
+        Vector<MeshCacheSubmesh> submeshes;
+        for (const auto &submesh : model.submeshes)
+            submeshes.push_back({ add_string(submesh.name), submesh.material, submesh.indexOffset, submesh.indexCount });
+
+        Vector<MeshCacheMaterial> materials;
+        for (const auto &material : model.materials) {
+            MeshCacheMaterial &dst = materials.emplace_back();
+            dst.name = add_string(material.name);
+            memcpy(dst.ambient, &material.ambient, sizeof(dst.ambient));
+            memcpy(dst.diffuse, &material.diffuse, sizeof(dst.diffuse));
+            memcpy(dst.specular, &material.specular, sizeof(dst.specular));
+            memcpy(dst.emissive, &material.emissive, sizeof(dst.emissive));
+            dst.shininess = material.shininess;
+            dst.opacity = material.opacity;
+            dst.ior = material.ior;
+            dst.illum = material.illum;
+            dst.diffuseMap = add_string(material.diffuseMap);
+            dst.specularMap = add_string(material.specularMap);
+            dst.normalMap = add_string(material.normalMap);
+            dst.alphaMap = add_string(material.alphaMap);
+            dst.emissiveMap = add_string(material.emissiveMap);
+        }
+
+        Vector<uint8_t> vertices[VERTEX_STREAM_MAX_ENUM];
+        void *vertexStreams[VERTEX_STREAM_MAX_ENUM] = {};
+        for (uint32_t i = 0; i < layout.streamCount; i++) {
+            vertices[i].resize(std::size(model.vertices) * layout.strides[i]);
+            vertexStreams[i] = std::data(vertices[i]);
+        }
+        VertexCodec::Encode(layout, quantization, std::data(model.vertices), !model.normals.empty() ? std::data(model.normals) : null,
+                            std::size(model.vertices), vertexStreams);
+
+        Vector<uint16_t> indices16;
+        if (MeshOptimizer::CanUse16BitIndices(std::size(model.vertices))) {
+            indices16.assign(std::begin(model.indices), std::end(model.indices));
+            header.indexStride = sizeof(uint16_t);
+        }
+
+        struct Stream {
+            uint64_t *pOffset;
+            const void *pData;
+            uint64_t size;
+        };
+
+        Stream streams[] = {
+            { &header.vertexOffsets[VERTEX_STREAM_POSITION], std::data(vertices[VERTEX_STREAM_POSITION]), std::size(vertices[VERTEX_STREAM_POSITION]) },
+            { &header.vertexOffsets[VERTEX_STREAM_ATTRIBUTES], std::data(vertices[VERTEX_STREAM_ATTRIBUTES]), std::size(vertices[VERTEX_STREAM_ATTRIBUTES]) },
+            { &header.indexOffset, header.indexStride == sizeof(uint16_t) ? static_cast<const void *>(std::data(indices16)) : std::data(model.indices),
+              std::size(model.indices) * header.indexStride },
+            { &header.submeshOffset, std::data(submeshes), std::size(submeshes) * sizeof(MeshCacheSubmesh) },
+            { &header.materialOffset, std::data(materials), std::size(materials) * sizeof(MeshCacheMaterial) },
+            { &header.stringOffset, std::data(strings), std::size(strings) },
+        };
+
+        uint64_t offset = sizeof(header);
+        for (auto &stream : streams) {
+            offset = (offset + MESH_CACHE_STREAM_ALIGNMENT - 1) / MESH_CACHE_STREAM_ALIGNMENT * MESH_CACHE_STREAM_ALIGNMENT;
+            *stream.pOffset = offset;
+            offset += stream.size;
+        }
+        header.stringSize = std::size(strings);
+        header.fileSize = offset;
+
+        /* 先写临时文件再改名，读的一方不会看到写了一半的缓存 */
+        std::filesystem::path folder = std::filesystem::path(cachePath).parent_path();
+        if (!folder.empty())
+            std::filesystem::create_directories(folder);
+        String temporary = cachePath + ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            if (!file.is_open())
+                throw std::runtime_error("Error: open file failed!");
+
+            static const char padding[MESH_CACHE_STREAM_ALIGNMENT] = {};
+            file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            uint64_t position = sizeof(header);
+            for (const auto &stream : streams) {
+                file.write(padding, static_cast<std::streamsize>(*stream.pOffset - position));
+                if (stream.size != 0)
+                    file.write(static_cast<const char *>(stream.pData), static_cast<std::streamsize>(stream.size));
+                position = *stream.pOffset + stream.size;
+            }
+            if (!file.good()) {
+                file.close();
+                std::error_code error;
+                std::filesystem::remove(temporary, error);
+                throw std::runtime_error(strfmt("failed to write mesh cache {}", cachePath));
+            }
+        }
+        std::error_code error;
+        std::filesystem::rename(temporary, cachePath, error);
+        if (error) {
+            std::filesystem::remove(temporary, error);
+            throw std::runtime_error(strfmt("failed to replace mesh cache {}", cachePath));
+        }
+    }
+
+    /* 返回是否命中缓存，缓存写不了时 pMesh 直接持有 OBJ 的结果。位置格式不同的缓存算未命中 */
+    static bool LoadMesh(const String &path, MeshCache *pMesh, MeshCacheStats *pStats = null,
+                         VertexPositionFormat positionFormat = VERTEX_POSITION_FORMAT_UNORM16) {
+        uint64_t start = System::GetTimeNanos();
+        MeshCacheStats stats;
+
+        uint64_t sourceMtime = static_cast<uint64_t>(std::filesystem::last_write_time(path).time_since_epoch().count());
+        uint64_t sourceSize = std::filesystem::file_size(path);
+        uint64_t sourceHash = 0;
+        String cachePath = GetMeshCachePath(path);
+        String absolute = std::filesystem::absolute(path).lexically_normal().generic_string();
+
+        if (pMesh->Open(cachePath) && pMesh->GetSourcePath() == absolute && pMesh->GetHeader()->sourceSize == sourceSize &&
+            pMesh->GetVertexLayout().positionFormat == positionFormat) {
+            if (pMesh->GetHeader()->sourceMtime == sourceMtime) {
+                stats.hit = true;
+            } else {
+                stats.hashed = true;
+                sourceHash = _MeshCacheHashFile(path);
+                stats.hit = pMesh->GetHeader()->sourceHash == sourceHash;
+                if (stats.hit) {
+                    /* 内容没变，只把新的修改时间写回文件头。写不进去缓存照样能用，下次再算一次哈希 */
+                    pMesh->Close();
+                    std::fstream file(cachePath, std::ios::binary | std::ios::in | std::ios::out);
+                    if (file.is_open()) {
+                        file.seekp(offsetof(MeshCacheHeader, sourceMtime));
+                        file.write(reinterpret_cast<const char *>(&sourceMtime), sizeof(sourceMtime));
+                        file.close();
+                    }
+                    if (file.fail())
+                        System::ConsoleWrite("failed to update mesh cache timestamp {}", cachePath);
+                    stats.hit = pMesh->Open(cachePath);
+                }
+            }
+        }
+        stats.lookupMicros = (System::GetTimeNanos() - start) / 1000;
+
+        if (!stats.hit) {
+            /* 旧缓存的映射还开着的话 Windows 上替换不了文件 */
+            pMesh->Close();
+            uint64_t objStart = System::GetTimeNanos();
+            ObjModel model;
+            LoadObj(path, &model);
+            if (!stats.hashed)
+                sourceHash = _MeshCacheHashFile(path);
+            uint64_t writeStart = System::GetTimeNanos();
+            stats.objMicros = (writeStart - objStart) / 1000;
+
+            MeshOptimizer::Optimize(&model, &stats.optimize);
+            stats.optimizeMicros = stats.optimize.micros;
+            writeStart = System::GetTimeNanos();
+
+            bool written = false;
+            try {
+                WriteMeshCache(cachePath, path, sourceMtime, sourceSize, sourceHash, model, positionFormat);
+                written = pMesh->Open(cachePath);
+            } catch (const std::exception &e) {
+                System::ConsoleWrite("failed to write mesh cache for {}: {}", path, e.what());
+            }
+            if (!written)
+                pMesh->Assign(std::move(model), positionFormat);
+            stats.writeMicros = (System::GetTimeNanos() - writeStart) / 1000;
+        }
+
+        stats.totalMicros = (System::GetTimeNanos() - start) / 1000;
+        if (pStats != null)
+            *pStats = stats;
+        return stats.hit;
+    }
+
+}
+
+#endif /* _VECTRAFLUX_ENGINE_MESH_CACHE_H_ */
@@ -0,0 +1,388 @@
+/* ************************************************************************
+ *
+ * Copyright (C) 2022 Vincent Luo All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, e1ither express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ************************************************************************/
+
+/* Creates on 2026/10/17. */
+
+/*
+  ===================================
+    @author bit-fashion
+  ===================================
+*/
+#ifndef _VECTRAFLUX_ENGINE_MESH_OPTIMIZER_H_
+#define _VECTRAFLUX_ENGINE_MESH_OPTIMIZER_H_
+
+#include <Typedef.h>
+#include <Math.h>
+#include <System.h>
+#include <algorithm>
+#include <cmath>
+#include "Render/Model/Vertex.h"
+#include "Utils/Model/ObjLoader.h"
+
+/* Forsyth 算法模拟的 LRU 缓存大小 */
+#define MESH_OPTIMIZER_CACHE_SIZE 32
+/* 统计 ACMR/ATVR 时模拟的 FIFO 缓存大小，接近常见硬件 */
+#define MESH_OPTIMIZER_ANALYZE_CACHE_SIZE 16
+/* overdraw 排序后 ACMR 允许变差的比例 */
+#define MESH_OPTIMIZER_OVERDRAW_THRESHOLD 1.05f
+
+/* ACMR = 缓存未命中 / 三角形数，ATVR = 缓存未命中 / 顶点数，两者越接近下限越好 (0.5 / 1.0) */
+struct VertexCacheStats {
+    uint32_t misses = 0;
+    float acmr = 0.0f;
+    float atvr = 0.0f;
+};
+
+struct MeshOptimizeStats {
+    VertexCacheStats before;
+    VertexCacheStats after;
+    uint32_t vertexCountBefore = 0;
+    uint32_t vertexCountAfter = 0; /* unreferenced vertices are dropped */
+    bool indices16 = false;
+    uint64_t micros = 0;
+};
+
+/**
+ * 网格预处理，按顺序：
+ *  - 顶点缓存：Forsyth 的线性时间贪心算法，按顶点在 LRU 里的位置和剩余
+ *    三角形数打分，每次输出分数最高的三角形；
+ *  - overdraw：在缓存优化的结果上按“所有顶点都不在缓存里”的位置切成
+ *    若干簇，簇按朝外程度排序，ACMR 变差超过阈值时放弃；
+ *  - 顶点读取：按索引第一次引用的顺序重排顶点，去掉没被引用的顶点。
+ * 所有步骤只在 submesh 内部重排三角形，submesh 的范围不变。
+ */
+namespace MeshOptimizer {
+
+    static bool CanUse16BitIndices(size_t vertexCount) {
+        return vertexCount <= 65536;
+    }
+
+    static VertexCacheStats AnalyzeVertexCache(const uint32_t *pIndices, size_t indexCount, uint32_t vertexCount,
+                                               uint32_t cacheSize = MESH_OPTIMIZER_ANALYZE_CACHE_SIZE) {
+        VertexCacheStats stats;
+        if (indexCount == 0)
+            return stats;
+
+        /* FIFO：记录每个顶点进入缓存时的计数，差值小于缓存大小就是命中 */
+        Vector<uint32_t> timestamps(vertexCount, 0);
+        Vector<uint8_t> referenced(vertexCount, 0);
+        uint32_t time = cacheSize + 1;
+        uint32_t uniqueCount = 0;
+        for (size_t i = 0; i < indexCount; i++) {
+            uint32_t index = pIndices[i];
+            if (time - timestamps[index] > cacheSize) {
+                timestamps[index] = time++;
+                ++stats.misses;
+            }
+            uniqueCount += referenced[index] == 0;
+            referenced[index] = 1;
+        }
+
+        stats.acmr = static_cast<float>(stats.misses) / static_cast<float>(indexCount / 3);
+        stats.atvr = static_cast<float>(stats.misses) / static_cast<float>(std::max(1u, uniqueCount));
+        return stats;
+    }
+
+    /* 分数表，下标是 LRU 位置 / 剩余三角形数 */
+    struct _ForsythScores {
+        float cache[MESH_OPTIMIZER_CACHE_SIZE + 3];
+        float valence[32];
+
+        _ForsythScores() {
+            for (uint32_t i = 0; i < MESH_OPTIMIZER_CACHE_SIZE + 3; i++) {
+                if (i < 3)
+                    cache[i] = 0.75f; /* 刚用过的三角形，故意压低避免来回跳 */
+                else if (i < MESH_OPTIMIZER_CACHE_SIZE)
+                    cache[i] = std::pow(1.0f - (i - 3) / static_cast<float>(MESH_OPTIMIZER_CACHE_SIZE - 3), 1.5f);
+                else
+                    cache[i] = 0.0f;
+            }
+            valence[0] = 0.0f;
+            for (uint32_t i = 1; i < 32; i++)
+                valence[i] = 2.0f / std::sqrt(static_cast<float>(i));
+        }
+
+        float Get(int32_t position, uint32_t remaining) const {
+            if (remaining == 0)
+                return -1.0f;
+            float score = position >= 0 ? cache[position] : 0.0f;
+            return score + valence[std::min(remaining, 31u)];
+        }
+    };
+
+    static void OptimizeVertexCache(uint32_t *pIndices, size_t indexCount, uint32_t vertexCount) {
+        static const _ForsythScores scores;
+        size_t triangleCount = indexCount / 3;
+        if (triangleCount == 0)
+            return;
+
+        /* 顶点 -> 相邻三角形，活动的三角形放在每个顶点列表的前 remaining 个 */
+        Vector<uint32_t> remaining(vertexCount, 0);
+        Vector<uint32_t> offsets(vertexCount + 1, 0);
+        for (size_t i = 0; i < triangleCount * 3; i++)
+            ++remaining[pIndices[i]];
+        for (uint32_t i = 0; i < vertexCount; i++)
+            offsets[i + 1] = offsets[i] + remaining[i];
+
+        Vector<uint32_t> adjacency(triangleCount * 3);
+        {
+            Vector<uint32_t> fill(std::begin(offsets), std::end(offsets) - 1);
+            for (size_t i = 0; i < triangleCount * 3; i++)
+                adjacency[fill[pIndices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+
+        Vector<int32_t> positions(vertexCount, -1);
+        Vector<float> vertexScores(vertexCount);
+        for (uint32_t i = 0; i < vertexCount; i++)
+            vertexScores[i] = scores.Get(-1, remaining[i]);
+
+        Vector<float> triangleScores(triangleCount);
+        for (size_t i = 0; i < triangleCount; i++)
+            triangleScores[i] = vertexScores[pIndices[i * 3]] + vertexScores[pIndices[i * 3 + 1]] + vertexScores[pIndices[i * 3 + 2]];
+
+        Vector<uint8_t> emitted(triangleCount, 0);
+        Vector<uint32_t> output(triangleCount * 3);
+        uint32_t cache[MESH_OPTIMIZER_CACHE_SIZE + 3];
+        uint32_t nextCache[MESH_OPTIMIZER_CACHE_SIZE + 3];
+        uint32_t cacheCount = 0;
+        size_t cursor = 0;
+
+        uint32_t best = 0;
+        for (size_t i = 1; i < triangleCount; i++) {
+            if (triangleScores[i] > triangleScores[best])
+                best = static_cast<uint32_t>(i);
+        }
+
+        for (size_t emit = 0; emit < triangleCount; emit++) {
+            /* 缓存里没有可用的三角形时，顺序找下一个没输出的 */
+            if (best == UINT32_MAX) {
+                while (emitted[cursor])
+                    ++cursor;
+                best = static_cast<uint32_t>(cursor);
+            }
+
+            const uint32_t *triangle = pIndices + best * 3;
+            memcpy(&output[emit * 3], triangle, 3 * sizeof(uint32_t));
+            emitted[best] = 1;
+
+            /* 从三个顶点的活动列表里移除 */
+            for (uint32_t k = 0; k < 3; k++) {
+                uint32_t vertex = triangle[k];
+                uint32_t *list = &adjacency[offsets[vertex]];
+                for (uint32_t j = 0; j < remaining[vertex]; j++) {
+                    if (list[j] == best) {
+                        list[j] = list[--remaining[vertex]];
+                        break;
+                    }
+                }
+            }
+
+            /* 新三角形的顶点移到 LRU 最前面 */
+            uint32_t nextCount = 0;
+            for (uint32_t k = 0; k < 3; k++) {
+                if (std::find(nextCache, nextCache + nextCount, triangle[k]) == nextCache + nextCount)
+                    nextCache[nextCount++] = triangle[k];
+            }
+            for (uint32_t j = 0; j < cacheCount; j++) {
+                uint32_t vertex = cache[j];
+                if (std::find(nextCache, nextCache + nextCount, vertex) == nextCache + nextCount)
+                    nextCache[nextCount++] = vertex;
+            }
+
+            /* 挤出去的顶点也要重新打分 */
+            uint32_t keepCount = std::min<uint32_t>(nextCount, MESH_OPTIMIZER_CACHE_SIZE);
+            for (uint32_t j = 0; j < nextCount; j++)
+                positions[nextCache[j]] = j < keepCount ? static_cast<int32_t>(j) : -1;
+
+            best = UINT32_MAX;
+            float bestScore = -1.0f;
+            for (uint32_t j = 0; j < nextCount; j++) {
+                uint32_t vertex = nextCache[j];
+                float score = scores.Get(positions[vertex], remaining[vertex]);
+                float delta = score - vertexScores[vertex];
+                vertexScores[vertex] = score;
+
+                const uint32_t *list = &adjacency[offsets[vertex]];
+                for (uint32_t t = 0; t < remaining[vertex]; t++) {
+                    float triangleScore = triangleScores[list[t]] += delta;
+                    if (triangleScore > bestScore) {
+                        bestScore = triangleScore;
+                        best = list[t];
+                    }
+                }
+            }
+
+            memcpy(cache, nextCache, keepCount * sizeof(uint32_t));
+            cacheCount = keepCount;
+        }
+
+        memcpy(pIndices, std::data(output), triangleCount * 3 * sizeof(uint32_t));
+    }
+
+    /* pIndices 应该已经做过顶点缓存优化，threshold 是允许的 ACMR 变差比例 */
+    static void OptimizeOverdraw(uint32_t *pIndices, size_t indexCount, const Vertex *pVertices, uint32_t vertexCount,
+                                 float threshold = MESH_OPTIMIZER_OVERDRAW_THRESHOLD) {
+        size_t triangleCount = indexCount / 3;
+        if (triangleCount < 2)
+            return;
+
+        /* 三个顶点都不在缓存里的位置是天然的切分点，在这里换顺序不增加未命中 */
+        Vector<uint32_t> clusters;
+        {
+            Vector<uint32_t> timestamps(vertexCount, 0);
+            uint32_t time = MESH_OPTIMIZER_ANALYZE_CACHE_SIZE + 1;
+            for (size_t i = 0; i < triangleCount; i++) {
+                uint32_t misses = 0;
+                for (uint32_t k = 0; k < 3; k++) {
+                    uint32_t index = pIndices[i * 3 + k];
+                    if (time - timestamps[index] > MESH_OPTIMIZER_ANALYZE_CACHE_SIZE) {
+                        timestamps[index] = time++;
+                        ++misses;
+                    }
+                }
+                if (i == 0 || misses == 3)
+                    clusters.push_back(static_cast<uint32_t>(i));
+            }
+        }
+        if (std::size(clusters) < 2)
+            return;
+        clusters.push_back(static_cast<uint32_t>(triangleCount));
+
+        glm::vec3 meshCentroid(0.0f);
+        for (size_t i = 0; i < indexCount; i++)
+            meshCentroid += pVertices[pIndices[i]].position;
+        meshCentroid /= static_cast<float>(indexCount);
+
+        /* 簇的面积加权中心和法线，朝外的簇先画，更可能挡住后面的 */
+        size_t clusterCount = std::size(clusters) - 1;
+        Vector<std::pair<float, uint32_t>> order(clusterCount);
+        for (size_t c = 0; c < clusterCount; c++) {
+            glm::vec3 centroid(0.0f), normal(0.0f);
+            float area = 0.0f;
+            for (uint32_t i = clusters[c]; i < clusters[c + 1]; i++) {
+                const glm::vec3 &p0 = pVertices[pIndices[i * 3]].position;
+                const glm::vec3 &p1 = pVertices[pIndices[i * 3 + 1]].position;
+                const glm::vec3 &p2 = pVertices[pIndices[i * 3 + 2]].position;
+                glm::vec3 cross = glm::cross(p1 - p0, p2 - p0);
+                float triangleArea = glm::length(cross);
+                centroid += (p0 + p1 + p2) * (triangleArea / 3.0f);
+                normal += cross;
+                area += triangleArea;
+            }
+            if (area > 0.0f)
+                centroid /= area;
+            float length = glm::length(normal);
+            float dot = length > 0.0f ? glm::dot(centroid - meshCentroid, normal / length) : 0.0f;
+            order[c] = { -dot, static_cast<uint32_t>(c) };
+        }
+        std::stable_sort(std::begin(order), std::end(order),
+                         [](const auto &a, const auto &b) { return a.first < b.first; });
+
+        Vector<uint32_t> sorted;
+        sorted.reserve(indexCount);
+        for (const auto &entry : order)
+            sorted.insert(sorted.end(), pIndices + clusters[entry.second] * 3, pIndices + clusters[entry.second + 1] * 3);
+
+        VertexCacheStats before = AnalyzeVertexCache(pIndices, indexCount, vertexCount);
+        VertexCacheStats after = AnalyzeVertexCache(std::data(sorted), indexCount, vertexCount);
+        if (after.acmr <= before.acmr * threshold)
+            memcpy(pIndices, std::data(sorted), indexCount * sizeof(uint32_t));
+    }
+
+    /* 返回新的顶点数，pRemap[old] = new，没被引用的顶点是 UINT32_MAX */
+    static uint32_t OptimizeVertexFetchRemap(uint32_t *pIndices, size_t indexCount, uint32_t vertexCount, Vector<uint32_t> *pRemap) {
+        pRemap->assign(vertexCount, UINT32_MAX);
+        uint32_t next = 0;
+        for (size_t i = 0; i < indexCount; i++) {
+            uint32_t &remap = (*pRemap)[pIndices[i]];
+            if (remap == UINT32_MAX)
+                remap = next++;
+            pIndices[i] = remap;
+        }
+        return next;
+    }
+
+    template<typename T>
+    static void RemapVertexStream(Vector<T> *pStream, const Vector<uint32_t> &remap, uint32_t newCount) {
+        if (pStream->empty())
+            return;
+        Vector<T> result(newCount);
+        for (size_t i = 0; i < std::size(remap); i++) {
+            if (remap[i] != UINT32_MAX)
+                result[remap[i]] = (*pStream)[i];
+        }
+        pStream->swap(result);
+    }
+
+    /* 依次做顶点缓存、overdraw 和顶点读取优化，每个 submesh 单独处理 */
+    static void Optimize(ObjModel *pModel, MeshOptimizeStats *pStats = null, bool overdraw = true) {
+        uint64_t start = System::GetTimeNanos();
+        uint32_t vertexCount = static_cast<uint32_t>(std::size(pModel->vertices));
+        MeshOptimizeStats stats;
+        stats.vertexCountBefore = vertexCount;
+        stats.before = AnalyzeVertexCache(std::data(pModel->indices), std::size(pModel->indices), vertexCount);
+
+        /* submesh 内的顶点先压缩到局部编号，避免每个 submesh 都分配整个模型大小的数组 */
+        Vector<uint32_t> local(vertexCount, UINT32_MAX);
+        Vector<uint32_t> global;
+        Vector<uint32_t> indices;
+        Vector<Vertex> vertices;
+        for (const auto &submesh : pModel->submeshes) {
+            uint32_t *range = std::data(pModel->indices) + submesh.indexOffset;
+            global.clear();
+            indices.resize(submesh.indexCount);
+            for (uint32_t i = 0; i < submesh.indexCount; i++) {
+                uint32_t &index = local[range[i]];
+                if (index == UINT32_MAX) {
+                    index = static_cast<uint32_t>(std::size(global));
+                    global.push_back(range[i]);
+                }
+                indices[i] = index;
+            }
+            uint32_t localCount = static_cast<uint32_t>(std::size(global));
+
+            OptimizeVertexCache(std::data(indices), std::size(indices), localCount);
+            if (overdraw) {
+                vertices.resize(localCount);
+                for (uint32_t i = 0; i < localCount; i++)
+                    vertices[i] = pModel->vertices[global[i]];
+                OptimizeOverdraw(std::data(indices), std::size(indices), std::data(vertices), localCount);
+            }
+
+            for (uint32_t i = 0; i < submesh.indexCount; i++)
+                range[i] = global[indices[i]];
+            for (uint32_t vertex : global)
+                local[vertex] = UINT32_MAX;
+        }
+
+        Vector<uint32_t> remap;
+        uint32_t newCount = OptimizeVertexFetchRemap(std::data(pModel->indices), std::size(pModel->indices), vertexCount, &remap);
+        RemapVertexStream(&pModel->vertices, remap, newCount);
+        RemapVertexStream(&pModel->normals, remap, newCount);
+
+        stats.vertexCountAfter = newCount;
+        stats.after = AnalyzeVertexCache(std::data(pModel->indices), std::size(pModel->indices), newCount);
+        stats.indices16 = CanUse16BitIndices(newCount);
+        stats.micros = (System::GetTimeNanos() - start) / 1000;
+        if (pStats != null)
+            *pStats = stats;
+    }
+
+}
+
+#endif /* _VECTRAFLUX_ENGINE_MESH_OPTIMIZER_H_ */
@@ -25,6 +25,644 @@
 */
 #pragma once
 
+#include <Typedef.h>
+#include <Math.h>
+#include <System.h>
+#include <bit>
+#include <cfloat>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include "Render/Model/Vertex.h"
+#include "Utils/MappedFile.h"
+#include "Utils/ThreadPool.h"
+
+/* 没有 usemtl 或者材质库里找不到的面 */
+#define OBJ_NO_MATERIAL UINT32_MAX
+
+struct ObjMaterial {
+    String name;
+    glm::vec3 ambient = glm::vec3(0.0f);
+    glm::vec3 diffuse = glm::vec3(1.0f);
+    glm::vec3 specular = glm::vec3(0.0f);
+    glm::vec3 emissive = glm::vec3(0.0f);
+    float shininess = 0.0f;
+    float opacity = 1.0f;
+    float ior = 1.0f;
+    uint32_t illum = 0;
+    /* 贴图路径已经拼上 .mtl 所在的目录 */
+    String diffuseMap;
+    String specularMap;
+    String normalMap; /* map_Bump / bump / norm */
+    String alphaMap;
+    String emissiveMap;
+};
+
+/* 连续使用同一个材质、属于同一个 o/g 的三角形 */
+struct ObjSubmesh {
+    String name;
+    uint32_t material;
+    uint32_t indexOffset;
+    uint32_t indexCount;
+};
+
+/* Triangulated, indexed model. Every distinct v/vt/vn triple becomes one
+ * Vertex, texCoord.y is flipped to the top-left origin of Vulkan images and
+ * color comes from the "v x y z r g b" extension (white otherwise). */
+struct ObjModel {
+    Vector<Vertex> vertices;
+    Vector<glm::vec3> normals; /* parallel to vertices, empty when the file has none */
+    Vector<uint32_t> indices;
+    Vector<ObjSubmesh> submeshes;
+    Vector<ObjMaterial> materials;
+    glm::vec3 boundsMin;
+    glm::vec3 boundsMax;
+};
+
+struct ObjLoadStats {
+    uint64_t fileBytes = 0;
+    uint32_t chunkCount = 0;
+    uint64_t parseMicros = 0; /* count + parse, parallel */
+    uint64_t indexMicros = 0; /* vertex dedup and submeshes */
+    uint64_t totalMicros = 0;
+};
+
+/**
+ * OBJ/MTL 解析。文件被内存映射后按行切成若干块，每块先并行统计 v/vt/vn
+ * 的数量，得到每块在全局数组里的起始位置后再并行解析，属性直接写到最终位置，
+ * 负数（相对）下标也能在块内解析。最后按文件顺序去重顶点、生成 submesh。
+ * 常见的数字不经过 strtof，8 位数字一次用 SWAR 转换，只有精度不够时才回退到 strtof。
+ */
 namespace Loader {
 
-}
\ No newline at end of file
+    static const double _ObjPow10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    static const uint64_t _ObjPow10Int[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000 };
+
+    static inline bool _ObjIsDigit(char c) {
+        return (unsigned char) (c - '0') < 10;
+    }
+
+    static inline bool _ObjIsSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    static inline const char *_ObjSkipSpaces(const char *p, const char *end) {
+        while (p < end && _ObjIsSpace(*p))
+            ++p;
+        return p;
+    }
+
+    static inline const char *_ObjNextLine(const char *p, const char *end) {
+        if (p >= end)
+            return end;
+        const void *newline = memchr(p, '\n', static_cast<size_t>(end - p));
+        return newline != null ? static_cast<const char *>(newline) + 1 : end;
+    }
+
+    /* p 开始的连续数字（最多 8 个）一次转换，返回数字个数。p 之后至少 8 字节可读 */
+    static inline uint32_t _ObjParseEightDigits(const char *p, uint32_t *pValue) {
+        uint64_t bytes;
+        memcpy(&bytes, p, 8);
+
+        /* 高 4 位是 3 并且加 6 之后高 4 位仍然是 3 的字节才是数字 */
+        uint64_t nonDigit = ((bytes & 0xF0F0F0F0F0F0F0F0ull) ^ 0x3030303030303030ull) |
+                            (((bytes + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) ^ 0x3030303030303030ull);
+        uint32_t count = nonDigit == 0 ? 8 : std::countr_zero(nonDigit) >> 3;
+        if (count == 0)
+            return 0;
+
+        /* 非数字字节移出去，前面补 0，再两两、四四合并 */
+        uint64_t digits = (bytes - 0x3030303030303030ull) << (8 * (8 - count));
+        digits = digits * 10 + (digits >> 8);
+        digits = (((digits & 0x000000FF000000FFull) * (100 + (1000000ull << 32))) +
+                  (((digits >> 16) & 0x000000FF000000FFull) * (1 + (10000ull << 32)))) >> 32;
+        *pValue = static_cast<uint32_t>(digits);
+        return count;
+    }
+
+    /* 累加一串数字，超过 19 位有效数字的部分只影响指数，*pSignificant 记为 20 */
+    static inline const char *_ObjParseDigits(const char *p, const char *end, uint64_t *pMantissa, uint32_t *pSignificant,
+                                              int32_t *pExponent, bool fraction) {
+        for (;;) {
+            uint32_t count = 0, value = 0;
+            if (end - p >= 8) {
+                count = _ObjParseEightDigits(p, &value);
+            } else {
+                while (p + count < end && _ObjIsDigit(p[count]))
+                    value = value * 10 + (p[count++] - '0');
+            }
+            if (count == 0)
+                return p;
+
+            if (*pSignificant + count <= 19) {
+                *pMantissa = *pMantissa * _ObjPow10Int[count] + value;
+                *pSignificant += *pMantissa != 0 ? count : 0;
+                if (fraction)
+                    *pExponent -= count;
+            } else {
+                *pSignificant = 20;
+                if (!fraction)
+                    *pExponent += count;
+            }
+
+            p += count;
+            if (count < 8)
+                return p;
+        }
+    }
+
+    /* 返回 null 表示 p 处不是数字 */
+    static inline const char *_ObjParseFloat(const char *p, const char *end, float *pValue) {
+        const char *number = p;
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+'))
+            negative = *p++ == '-';
+
+        uint64_t mantissa = 0;
+        uint32_t significant = 0;
+        int32_t exponent = 0;
+        const char *start = p;
+        p = _ObjParseDigits(p, end, &mantissa, &significant, &exponent, false);
+        if (p < end && *p == '.')
+            p = _ObjParseDigits(p + 1, end, &mantissa, &significant, &exponent, true);
+        if (p == start || (p == start + 1 && *start == '.'))
+            return null;
+
+        if (p < end && (*p == 'e' || *p == 'E')) {
+            const char *q = p + 1;
+            bool negativeExponent = false;
+            if (q < end && (*q == '-' || *q == '+'))
+                negativeExponent = *q++ == '-';
+            int32_t value = 0;
+            for (; q < end && _ObjIsDigit(*q); ++q)
+                value = std::min(value * 10 + (*q - '0'), 9999);
+            exponent += negativeExponent ? -value : value;
+            p = q;
+        }
+
+        /* 丢了有效数字、mantissa 超过 2^53 或者 |exponent| > 22 时一次乘除不精确，交给 strtof。
+         * 映射的文件不以 '\0' 结尾，先拷出来 */
+        if (significant > 19 || mantissa > (1ull << 53) || exponent < -22 || exponent > 22) {
+            char buffer[64];
+            size_t length = static_cast<size_t>(p - number);
+            if (length < sizeof(buffer)) {
+                memcpy(buffer, number, length);
+                buffer[length] = '\0';
+                *pValue = strtof(buffer, null);
+            } else {
+                *pValue = strtof(String(number, p).c_str(), null);
+            }
+            return p;
+        }
+
+        /* mantissa <= 2^53 并且 |exponent| <= 22，两个操作数都是精确的，只有一次舍入 */
+        double value = static_cast<double>(mantissa);
+        value = exponent < 0 ? value / _ObjPow10[-exponent] : value * _ObjPow10[exponent];
+        *pValue = static_cast<float>(negative ? -value : value);
+        return p;
+    }
+
+    static inline const char *_ObjParseInt(const char *p, const char *end, int32_t *pValue) {
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+'))
+            negative = *p++ == '-';
+
+        uint64_t value = 0;
+        uint32_t significant = 0;
+        int32_t exponent = 0;
+        const char *start = p;
+        p = _ObjParseDigits(p, end, &value, &significant, &exponent, false);
+        if (p == start || exponent != 0 || value > INT32_MAX)
+            return null;
+
+        *pValue = negative ? -static_cast<int32_t>(value) : static_cast<int32_t>(value);
+        return p;
+    }
+
+    /* 行内剩余部分作为名字，去掉首尾空白 */
+    static inline String _ObjParseName(const char *p, const char *end) {
+        p = _ObjSkipSpaces(p, end);
+        const char *last = _ObjNextLine(p, end);
+        while (last > p && (_ObjIsSpace(last[-1]) || last[-1] == '\n'))
+            --last;
+        return String(p, last);
+    }
+
+    static inline bool _ObjIsKeyword(const char *p, const char *end, const char *keyword, size_t length) {
+        return (size_t) (end - p) > length && memcmp(p, keyword, length) == 0 && _ObjIsSpace(p[length]);
+    }
+
+    enum _ObjEventType {
+        _OBJ_EVENT_USEMTL,
+        _OBJ_EVENT_GROUP,
+    };
+
+    /* usemtl / o / g 在第 triangle 个三角形之前生效 */
+    struct _ObjEvent {
+        uint32_t triangle;
+        _ObjEventType type;
+        String name;
+    };
+
+    struct _ObjChunk {
+        const char *begin;
+        const char *end;
+        uint32_t positionCount = 0;
+        uint32_t texCoordCount = 0;
+        uint32_t normalCount = 0;
+        uint32_t positionBase = 0;
+        uint32_t texCoordBase = 0;
+        uint32_t normalBase = 0;
+        Vector<uint32_t> corners; /* v, vt, vn per triangle corner, UINT32_MAX when absent */
+        Vector<std::pair<uint32_t, glm::vec3>> colors;
+        Vector<_ObjEvent> events;
+        Vector<String> materialLibraries;
+        glm::vec3 boundsMin = glm::vec3(FLT_MAX);
+        glm::vec3 boundsMax = glm::vec3(-FLT_MAX);
+        String error;
+    };
+
+    static void _ObjCountChunk(_ObjChunk &chunk) {
+        for (const char *p = chunk.begin; p < chunk.end; p = _ObjNextLine(p, chunk.end)) {
+            p = _ObjSkipSpaces(p, chunk.end);
+            if (chunk.end - p < 2 || p[0] != 'v')
+                continue;
+            if (_ObjIsSpace(p[1]))
+                ++chunk.positionCount;
+            else if (p[1] == 't')
+                ++chunk.texCoordCount;
+            else if (p[1] == 'n')
+                ++chunk.normalCount;
+        }
+    }
+
+    /* 负数下标相对于当前已经出现的数量 */
+    static inline bool _ObjResolveIndex(int32_t index, uint32_t count, uint32_t *pIndex) {
+        if (index > 0)
+            *pIndex = static_cast<uint32_t>(index - 1);
+        else if (index < 0 && static_cast<uint32_t>(-index) <= count)
+            *pIndex = count + index;
+        else
+            return false;
+        return true;
+    }
+
+    static void _ObjParseChunk(_ObjChunk &chunk, glm::vec3 *pPositions, glm::vec2 *pTexCoords, glm::vec3 *pNormals) {
+        const char *end = chunk.end;
+        uint32_t position = chunk.positionBase;
+        uint32_t texCoord = chunk.texCoordBase;
+        uint32_t normal = chunk.normalBase;
+        uint32_t triangle = 0;
+        uint32_t polygon[9];
+
+        for (const char *line = chunk.begin; line < end; line = _ObjNextLine(line, end)) {
+            const char *p = _ObjSkipSpaces(line, end);
+            if (end - p < 2)
+                continue;
+
+            if (p[0] == 'v' && _ObjIsSpace(p[1])) {
+                glm::vec3 &v = pPositions[position];
+                p = _ObjParseFloat(_ObjSkipSpaces(p + 2, end), end, &v.x);
+                if (p != null) p = _ObjParseFloat(_ObjSkipSpaces(p, end), end, &v.y);
+                if (p != null) p = _ObjParseFloat(_ObjSkipSpaces(p, end), end, &v.z);
+                if (p == null) {
+                    chunk.error = "invalid vertex position";
+                    return;
+                }
+                chunk.boundsMin = glm::min(chunk.boundsMin, v);
+                chunk.boundsMax = glm::max(chunk.boundsMax, v);
+
+                /* 可选的顶点颜色 */
+                glm::vec3 color;
+                const char *q = _ObjParseFloat(_ObjSkipSpaces(p, end), end, &color.r);
+                if (q != null) q = _ObjParseFloat(_ObjSkipSpaces(q, end), end, &color.g);
+                if (q != null) q = _ObjParseFloat(_ObjSkipSpaces(q, end), end, &color.b);
+                if (q != null)
+                    chunk.colors.emplace_back(position, color);
+                ++position;
+            } else if (p[0] == 'v' && p[1] == 't') {
+                glm::vec2 uv(0.0f);
+                p = _ObjParseFloat(_ObjSkipSpaces(p + 2, end), end, &uv.x);
+                if (p == null) {
+                    chunk.error = "invalid texture coordinate";
+                    return;
+                }
+                _ObjParseFloat(_ObjSkipSpaces(p, end), end, &uv.y);
+                pTexCoords[texCoord++] = glm::vec2(uv.x, 1.0f - uv.y);
+            } else if (p[0] == 'v' && p[1] == 'n') {
+                glm::vec3 &n = pNormals[normal++];
+                p = _ObjParseFloat(_ObjSkipSpaces(p + 2, end), end, &n.x);
+                if (p != null) p = _ObjParseFloat(_ObjSkipSpaces(p, end), end, &n.y);
+                if (p != null) p = _ObjParseFloat(_ObjSkipSpaces(p, end), end, &n.z);
+                if (p == null) {
+                    chunk.error = "invalid vertex normal";
+                    return;
+                }
+            } else if (p[0] == 'f' && _ObjIsSpace(p[1])) {
+                /* 多边形按扇形拆成三角形 */
+                uint32_t count = 0;
+                for (p = _ObjSkipSpaces(p + 2, end); p < end && *p != '\n' && *p != '#'; p = _ObjSkipSpaces(p, end)) {
+                    int32_t v, vt, vn;
+                    uint32_t *corner = &polygon[std::min(count, 2u) * 3];
+                    corner[1] = corner[2] = UINT32_MAX;
+                    p = _ObjParseInt(p, end, &v);
+                    if (p == null || !_ObjResolveIndex(v, position, &corner[0])) {
+                        chunk.error = "invalid face";
+                        return;
+                    }
+                    if (p < end && *p == '/') {
+                        ++p;
+                        if (p < end && *p != '/') {
+                            p = _ObjParseInt(p, end, &vt);
+                            if (p == null || !_ObjResolveIndex(vt, texCoord, &corner[1])) {
+                                chunk.error = "invalid face";
+                                return;
+                            }
+                        }
+                        if (p < end && *p == '/') {
+                            p = _ObjParseInt(p + 1, end, &vn);
+                            if (p == null || !_ObjResolveIndex(vn, normal, &corner[2])) {
+                                chunk.error = "invalid face";
+                                return;
+                            }
+                        }
+                    }
+
+                    /* polygon[0] 是扇形的中心，polygon[1] 是上一个角 */
+                    if (++count >= 3) {
+                        chunk.corners.insert(chunk.corners.end(), polygon, polygon + 9);
+                        memcpy(&polygon[3], &polygon[6], 3 * sizeof(uint32_t));
+                        ++triangle;
+                    }
+                }
+            } else if (_ObjIsKeyword(p, end, "usemtl", 6)) {
+                chunk.events.push_back({ triangle, _OBJ_EVENT_USEMTL, _ObjParseName(p + 6, end) });
+            } else if ((p[0] == 'o' || p[0] == 'g') && _ObjIsSpace(p[1])) {
+                chunk.events.push_back({ triangle, _OBJ_EVENT_GROUP, _ObjParseName(p + 1, end) });
+            } else if (_ObjIsKeyword(p, end, "mtllib", 6)) {
+                chunk.materialLibraries.push_back(_ObjParseName(p + 6, end));
+            }
+        }
+    }
+
+    /* 贴图一行里可能带 -bm 之类的选项，文件名是最后一个词 */
+    static inline String _MtlParseMap(const char *p, const char *end, const std::filesystem::path &folder) {
+        String value = _ObjParseName(p, end);
+        size_t space = value.find_last_of(" \t");
+        if (space != String::npos)
+            value = value.substr(space + 1);
+        return (folder / value).generic_string();
+    }
+
+    static inline const char *_MtlParseColor(const char *p, const char *end, glm::vec3 *pColor) {
+        p = _ObjParseFloat(_ObjSkipSpaces(p, end), end, &pColor->r);
+        if (p == null)
+            return null;
+        /* 只有一个分量时表示灰度 */
+        pColor->g = pColor->b = pColor->r;
+        const char *q = _ObjParseFloat(_ObjSkipSpaces(p, end), end, &pColor->g);
+        if (q != null)
+            q = _ObjParseFloat(_ObjSkipSpaces(q, end), end, &pColor->b);
+        return q != null ? q : p;
+    }
+
+    static void LoadMtl(const String &path, Vector<ObjMaterial> *pMaterials) {
+        MappedFile file(path);
+        const char *end = file.GetData() + file.GetSize();
+        std::filesystem::path folder = std::filesystem::path(path).parent_path();
+        ObjMaterial *material = null;
+
+        for (const char *line = file.GetData(); line < end; line = _ObjNextLine(line, end)) {
+            const char *p = _ObjSkipSpaces(line, end);
+            if (_ObjIsKeyword(p, end, "newmtl", 6)) {
+                pMaterials->emplace_back();
+                material = &pMaterials->back();
+                material->name = _ObjParseName(p + 6, end);
+                continue;
+            }
+            if (material == null || end - p < 3)
+                continue;
+
+            float value;
+            if (_ObjIsKeyword(p, end, "Ka", 2))
+                _MtlParseColor(p + 2, end, &material->ambient);
+            else if (_ObjIsKeyword(p, end, "Kd", 2))
+                _MtlParseColor(p + 2, end, &material->diffuse);
+            else if (_ObjIsKeyword(p, end, "Ks", 2))
+                _MtlParseColor(p + 2, end, &material->specular);
+            else if (_ObjIsKeyword(p, end, "Ke", 2))
+                _MtlParseColor(p + 2, end, &material->emissive);
+            else if (_ObjIsKeyword(p, end, "Ns", 2) && _ObjParseFloat(_ObjSkipSpaces(p + 2, end), end, &value))
+                material->shininess = value;
+            else if (_ObjIsKeyword(p, end, "Ni", 2) && _ObjParseFloat(_ObjSkipSpaces(p + 2, end), end, &value))
+                material->ior = value;
+            else if (_ObjIsKeyword(p, end, "d", 1) && _ObjParseFloat(_ObjSkipSpaces(p + 1, end), end, &value))
+                material->opacity = value;
+            else if (_ObjIsKeyword(p, end, "Tr", 2) && _ObjParseFloat(_ObjSkipSpaces(p + 2, end), end, &value))
+                material->opacity = 1.0f - value;
+            else if (_ObjIsKeyword(p, end, "illum", 5) && _ObjParseFloat(_ObjSkipSpaces(p + 5, end), end, &value))
+                material->illum = static_cast<uint32_t>(value);
+            else if (_ObjIsKeyword(p, end, "map_Kd", 6))
+                material->diffuseMap = _MtlParseMap(p + 6, end, folder);
+            else if (_ObjIsKeyword(p, end, "map_Ks", 6))
+                material->specularMap = _MtlParseMap(p + 6, end, folder);
+            else if (_ObjIsKeyword(p, end, "map_Ke", 6))
+                material->emissiveMap = _MtlParseMap(p + 6, end, folder);
+            else if (_ObjIsKeyword(p, end, "map_d", 5))
+                material->alphaMap = _MtlParseMap(p + 5, end, folder);
+            else if (_ObjIsKeyword(p, end, "map_Bump", 8) || _ObjIsKeyword(p, end, "map_bump", 8))
+                material->normalMap = _MtlParseMap(p + 8, end, folder);
+            else if (_ObjIsKeyword(p, end, "bump", 4) || _ObjIsKeyword(p, end, "norm", 4))
+                material->normalMap = _MtlParseMap(p + 4, end, folder);
+        }
+    }
+
+    /* threadCount 为 0 时使用所有核心 */
+    static void LoadObj(const String &path, ObjModel *pModel, ObjLoadStats *pStats = null, uint32_t threadCount = 0) {
+        uint64_t start = System::GetTimeNanos();
+        MappedFile file(path);
+        const char *data = file.GetData();
+        size_t size = file.GetSize();
+        ThreadPool pool(threadCount);
+
+        /* 至少 256KB 一块，块数是线程数的几倍以平衡负载 */
+        size_t chunkCount = std::clamp<size_t>(size / (256 * 1024), 1, (pool.GetThreadCount() + 1) * 8);
+        Vector<_ObjChunk> chunks(chunkCount);
+        const char *end = data + size;
+        for (size_t i = 0; i < chunkCount; i++) {
+            const char *begin = i == 0 ? data : _ObjNextLine(data + size * i / chunkCount, end);
+            chunks[i].begin = i == 0 ? data : std::max(begin, chunks[i - 1].begin);
+            if (i > 0)
+                chunks[i - 1].end = chunks[i].begin;
+        }
+        chunks.back().end = end;
+
+        for (auto &chunk : chunks)
+            pool.Submit([&chunk] { _ObjCountChunk(chunk); });
+        pool.Wait();
+
+        uint32_t positionCount = 0, texCoordCount = 0, normalCount = 0;
+        for (auto &chunk : chunks) {
+            chunk.positionBase = positionCount;
+            chunk.texCoordBase = texCoordCount;
+            chunk.normalBase = normalCount;
+            positionCount += chunk.positionCount;
+            texCoordCount += chunk.texCoordCount;
+            normalCount += chunk.normalCount;
+        }
+
+        Vector<glm::vec3> positions(positionCount);
+        Vector<glm::vec2> texCoords(texCoordCount);
+        Vector<glm::vec3> normals(normalCount);
+        for (auto &chunk : chunks) {
+            pool.Submit([&chunk, &positions, &texCoords, &normals] {
+                try {
+                    _ObjParseChunk(chunk, std::data(positions), std::data(texCoords), std::data(normals));
+                } catch (const std::exception &e) {
+                    chunk.error = e.what();
+                }
+            });
+        }
+        pool.Wait();
+
+        uint64_t parsed = System::GetTimeNanos();
+        for (const auto &chunk : chunks) {
+            if (!chunk.error.empty())
+                throw std::runtime_error(strfmt("failed to parse {}: {}", path, chunk.error));
+        }
+
+        /* 材质库 */
+        pModel->materials.clear();
+        std::filesystem::path folder = std::filesystem::path(path).parent_path();
+        for (const auto &chunk : chunks) {
+            for (const auto &library : chunk.materialLibraries) {
+                try {
+                    LoadMtl((folder / library).generic_string(), &pModel->materials);
+                } catch (const std::exception &e) {
+                    System::ConsoleWrite("failed to load material library {}: {}", library, e.what());
+                }
+            }
+        }
+        HashMap<String, uint32_t> materialIndices;
+        for (uint32_t i = 0; i < std::size(pModel->materials); i++)
+            materialIndices.emplace(pModel->materials[i].name, i);
+
+        /* 顶点颜色 */
+        Vector<glm::vec3> colors;
+        for (const auto &chunk : chunks) {
+            if (chunk.colors.empty())
+                continue;
+            if (colors.empty())
+                colors.assign(positionCount, glm::vec3(1.0f));
+            for (const auto &color : chunk.colors)
+                colors[color.first] = color.second;
+        }
+
+        /* 按文件顺序去重，material 或 o/g 变化时开始新的 submesh */
+        size_t cornerCount = 0;
+        for (const auto &chunk : chunks)
+            cornerCount += std::size(chunk.corners) / 3;
+
+        /* 共享同一个 v 的顶点串成链表，文件里 v 下标基本连续，比哈希表的访问更集中 */
+        Vector<uint32_t> keys;
+        Vector<uint32_t> next;
+        Vector<uint32_t> head(positionCount, UINT32_MAX);
+        keys.reserve(std::min<size_t>(cornerCount, positionCount * 2) * 3);
+        next.reserve(std::min<size_t>(cornerCount, positionCount * 2));
+        pModel->indices.resize(cornerCount);
+        pModel->submeshes.clear();
+
+        String group;
+        uint32_t material = OBJ_NO_MATERIAL;
+        bool changed = true;
+        uint32_t *index = std::data(pModel->indices);
+        for (const auto &chunk : chunks) {
+            size_t event = 0;
+            size_t triangleCount = std::size(chunk.corners) / 9;
+            for (size_t triangle = 0; triangle <= triangleCount; triangle++) {
+                for (; event < std::size(chunk.events) && chunk.events[event].triangle == triangle; event++) {
+                    const _ObjEvent &e = chunk.events[event];
+                    if (e.type == _OBJ_EVENT_GROUP) {
+                        changed |= e.name != group;
+                        group = e.name;
+                    } else {
+                        auto it = materialIndices.find(e.name);
+                        uint32_t next = it != materialIndices.end() ? it->second : OBJ_NO_MATERIAL;
+                        changed |= next != material;
+                        material = next;
+                    }
+                }
+                if (triangle == triangleCount)
+                    break;
+
+                if (changed) {
+                    uint32_t offset = static_cast<uint32_t>(index - std::data(pModel->indices));
+                    pModel->submeshes.push_back({ group, material, offset, 0 });
+                    changed = false;
+                }
+
+                const uint32_t *corners = &chunk.corners[triangle * 9];
+                for (uint32_t i = 0; i < 3; i++) {
+                    const uint32_t *key = corners + i * 3;
+                    if (key[0] >= positionCount || (key[1] != UINT32_MAX && key[1] >= texCoordCount) ||
+                        (key[2] != UINT32_MAX && key[2] >= normalCount))
+                        throw std::runtime_error(strfmt("failed to parse {}: face index out of range", path));
+                    uint32_t vertex = head[key[0]];
+                    while (vertex != UINT32_MAX && (keys[vertex * 3 + 1] != key[1] || keys[vertex * 3 + 2] != key[2]))
+                        vertex = next[vertex];
+                    if (vertex == UINT32_MAX) {
+                        vertex = static_cast<uint32_t>(std::size(next));
+                        keys.insert(keys.end(), key, key + 3);
+                        next.push_back(head[key[0]]);
+                        head[key[0]] = vertex;
+                    }
+                    *index++ = vertex;
+                }
+                pModel->submeshes.back().indexCount += 3;
+            }
+        }
+        pModel->boundsMin = glm::vec3(FLT_MAX);
+        pModel->boundsMax = glm::vec3(-FLT_MAX);
+        for (const auto &chunk : chunks) {
+            pModel->boundsMin = glm::min(pModel->boundsMin, chunk.boundsMin);
+            pModel->boundsMax = glm::max(pModel->boundsMax, chunk.boundsMax);
+        }
+        chunks.clear();
+
+        /* 展开顶点，按块并行 */
+        size_t vertexCount = std::size(keys) / 3;
+        pModel->vertices.resize(vertexCount);
+        pModel->normals.resize(normalCount != 0 ? vertexCount : 0);
+        size_t batch = std::max<size_t>(64 * 1024, vertexCount / ((pool.GetThreadCount() + 1) * 4) + 1);
+        for (size_t first = 0; first < vertexCount; first += batch) {
+            pool.Submit([&, first] {
+                size_t last = std::min(first + batch, vertexCount);
+                for (size_t i = first; i < last; i++) {
+                    const uint32_t *key = &keys[i * 3];
+                    Vertex &vertex = pModel->vertices[i];
+                    vertex.position = positions[key[0]];
+                    vertex.color = colors.empty() ? glm::vec3(1.0f) : colors[key[0]];
+                    vertex.texCoord = key[1] != UINT32_MAX ? texCoords[key[1]] : glm::vec2(0.0f);
+                    if (normalCount != 0)
+                        pModel->normals[i] = key[2] != UINT32_MAX ? normals[key[2]] : glm::vec3(0.0f);
+                }
+            });
+        }
+        pool.Wait();
+
+        if (pStats != null) {
+            uint64_t finish = System::GetTimeNanos();
+            pStats->fileBytes = size;
+            pStats->chunkCount = static_cast<uint32_t>(chunkCount);
+            pStats->parseMicros = (parsed - start) / 1000;
+            pStats->indexMicros = (finish - parsed) / 1000;
+            pStats->totalMicros = (finish - start) / 1000;
+        }
+    }
+
+}
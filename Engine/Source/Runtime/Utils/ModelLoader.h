@@ -25,4 +25,5 @@
 */
 #pragma once
 
-#include "Model/ObjLoader.h"
\ No newline at end of file
+#include "Model/ObjLoader.h"
+#include "Model/MeshCache.h"
\ No newline at end of file
@@ -0,0 +1,312 @@
+/* ************************************************************************
+ *
+ * Copyright (C) 2022 Vincent Luo All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, e1ither express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ************************************************************************/
+/* Creates on 2026/10/17. */
+
+/*
+ ===============================
+   @author bit-fashion
+ ===============================
+*/
+#ifndef _VECTRAFLUX_ENGINE_BCN_ENCODER_H_
+#define _VECTRAFLUX_ENGINE_BCN_ENCODER_H_
+
+#include <Typedef.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+enum BCnFormat {
+    BCN_FORMAT_BC1 = 0, /* RGB, 8 bytes per block */
+    BCN_FORMAT_BC3, /* RGBA, 16 bytes per block */
+    BCN_FORMAT_BC4, /* R, 8 bytes per block */
+    BCN_FORMAT_BC5, /* RG, 16 bytes per block */
+    BCN_FORMAT_BC7, /* RGBA, 16 bytes per block, mode 6 only */
+};
+
+/**
+ * 离线用的 BCn 块压缩编码器，输入 RGBA8。端点取主成分方向上的极值，
+ * 索引选最近的调色板颜色，质量够用但不追求最优。
+ */
+namespace BCnEncoder {
+
+    static uint32_t GetBlockSize(BCnFormat format) {
+        return format == BCN_FORMAT_BC1 || format == BCN_FORMAT_BC4 ? 8 : 16;
+    }
+
+    static size_t GetEncodedSize(BCnFormat format, uint32_t width, uint32_t height) {
+        return (size_t) ((width + 3) / 4) * ((height + 3) / 4) * GetBlockSize(format);
+    }
+
+    /* 主成分方向，幂迭代几次就够了 */
+    static void _PrincipalAxis(const float (*pixels)[4], uint32_t channels, float *axis) {
+        float mean[4] = {};
+        for (int i = 0; i < 16; i++)
+            for (uint32_t c = 0; c < channels; c++)
+                mean[c] += pixels[i][c] / 16.0f;
+
+        float covariance[4][4] = {};
+        for (int i = 0; i < 16; i++)
+            for (uint32_t a = 0; a < channels; a++)
+                for (uint32_t b = 0; b < channels; b++)
+                    covariance[a][b] += (pixels[i][a] - mean[a]) * (pixels[i][b] - mean[b]);
+
+        for (uint32_t c = 0; c < channels; c++)
+            axis[c] = 1.0f;
+        for (int iteration = 0; iteration < 8; iteration++) {
+            float next[4] = {};
+            float length = 0.0f;
+            for (uint32_t a = 0; a < channels; a++) {
+                for (uint32_t b = 0; b < channels; b++)
+                    next[a] += covariance[a][b] * axis[b];
+                length = std::max(length, std::abs(next[a]));
+            }
+            if (length == 0.0f)
+                return;
+            for (uint32_t c = 0; c < channels; c++)
+                axis[c] = next[c] / length;
+        }
+    }
+
+    /* 沿主成分方向投影最小、最大的两个像素作为端点 */
+    static void _FitEndpoints(const float (*pixels)[4], uint32_t channels, float *pMin, float *pMax) {
+        float axis[4] = {};
+        _PrincipalAxis(pixels, channels, axis);
+
+        float minDot = INFINITY, maxDot = -INFINITY;
+        int minIndex = 0, maxIndex = 0;
+        for (int i = 0; i < 16; i++) {
+            float dot = 0.0f;
+            for (uint32_t c = 0; c < channels; c++)
+                dot += pixels[i][c] * axis[c];
+            if (dot < minDot) { minDot = dot; minIndex = i; }
+            if (dot > maxDot) { maxDot = dot; maxIndex = i; }
+        }
+
+        for (uint32_t c = 0; c < channels; c++) {
+            pMin[c] = pixels[minIndex][c];
+            pMax[c] = pixels[maxIndex][c];
+        }
+    }
+
+    /* 取出一个 4x4 块，越界的像素重复边缘 */
+    static void _LoadBlock(const uint8_t *pPixels, uint32_t width, uint32_t height, uint32_t bx, uint32_t by, float (*block)[4]) {
+        for (uint32_t y = 0; y < 4; y++) {
+            for (uint32_t x = 0; x < 4; x++) {
+                uint32_t px = std::min(bx * 4 + x, width - 1);
+                uint32_t py = std::min(by * 4 + y, height - 1);
+                const uint8_t *pixel = pPixels + ((size_t) py * width + px) * 4;
+                for (int c = 0; c < 4; c++)
+                    block[y * 4 + x][c] = pixel[c];
+            }
+        }
+    }
+
+    static uint16_t _Pack565(const float *color) {
+        uint32_t r = (uint32_t) std::clamp(std::lround(color[0] * 31.0f / 255.0f), 0l, 31l);
+        uint32_t g = (uint32_t) std::clamp(std::lround(color[1] * 63.0f / 255.0f), 0l, 63l);
+        uint32_t b = (uint32_t) std::clamp(std::lround(color[2] * 31.0f / 255.0f), 0l, 31l);
+        return (uint16_t) ((r << 11) | (g << 5) | b);
+    }
+
+    static void _Unpack565(uint16_t packed, float *color) {
+        uint32_t r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+        color[0] = (float) ((r << 3) | (r >> 2));
+        color[1] = (float) ((g << 2) | (g >> 4));
+        color[2] = (float) ((b << 3) | (b >> 2));
+    }
+
+    /* BC1 颜色块，总是使用 4 色模式 (c0 > c1) */
+    static void _EncodeColorBlock(const float (*block)[4], uint8_t *pOut) {
+        float minColor[4], maxColor[4];
+        _FitEndpoints(block, 3, minColor, maxColor);
+
+        uint16_t c0 = _Pack565(maxColor), c1 = _Pack565(minColor);
+        if (c0 < c1)
+            std::swap(c0, c1);
+
+        uint32_t indices = 0;
+        if (c0 != c1) {
+            float palette[4][3];
+            _Unpack565(c0, palette[0]);
+            _Unpack565(c1, palette[1]);
+            for (int c = 0; c < 3; c++) {
+                palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+                palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+            }
+
+            for (int i = 0; i < 16; i++) {
+                uint32_t best = 0;
+                float bestError = INFINITY;
+                for (uint32_t p = 0; p < 4; p++) {
+                    float error = 0.0f;
+                    for (int c = 0; c < 3; c++)
+                        error += (block[i][c] - palette[p][c]) * (block[i][c] - palette[p][c]);
+                    if (error < bestError) { bestError = error; best = p; }
+                }
+                indices |= best << (i * 2);
+            }
+        }
+
+        memcpy(pOut, &c0, 2);
+        memcpy(pOut + 2, &c1, 2);
+        memcpy(pOut + 4, &indices, 4);
+    }
+
+    /* BC4 单通道块，8 值模式 (a0 > a1) */
+    static void _EncodeChannelBlock(const float (*block)[4], uint32_t channel, uint8_t *pOut) {
+        float minValue = 255.0f, maxValue = 0.0f;
+        for (int i = 0; i < 16; i++) {
+            minValue = std::min(minValue, block[i][channel]);
+            maxValue = std::max(maxValue, block[i][channel]);
+        }
+
+        uint8_t a0 = (uint8_t) std::lround(maxValue), a1 = (uint8_t) std::lround(minValue);
+        uint64_t bits = (uint64_t) a0 | ((uint64_t) a1 << 8);
+
+        if (a0 != a1) {
+            float palette[8];
+            palette[0] = a0;
+            palette[1] = a1;
+            for (int k = 2; k < 8; k++)
+                palette[k] = ((8 - k) * a0 + (k - 1) * a1) / 7.0f;
+
+            for (int i = 0; i < 16; i++) {
+                uint64_t best = 0;
+                float bestError = INFINITY;
+                for (uint32_t p = 0; p < 8; p++) {
+                    float error = std::abs(block[i][channel] - palette[p]);
+                    if (error < bestError) { bestError = error; best = p; }
+                }
+                bits |= best << (16 + i * 3);
+            }
+        }
+
+        memcpy(pOut, &bits, 8);
+    }
+
+    /* BC7 mode 6: 单个子集，RGBA 7 位端点 + 每端点一个 p-bit，4 位索引 */
+    static void _EncodeBC7Block(const float (*block)[4], uint8_t *pOut) {
+        static const uint32_t weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+        float endpoints[2][4];
+        _FitEndpoints(block, 4, endpoints[0], endpoints[1]);
+
+        /* 每个端点选误差更小的 p-bit */
+        uint32_t quantized[2][4], pbits[2];
+        for (int e = 0; e < 2; e++) {
+            float bestError = INFINITY;
+            for (uint32_t p = 0; p < 2; p++) {
+                uint32_t values[4];
+                float error = 0.0f;
+                for (int c = 0; c < 4; c++) {
+                    values[c] = (uint32_t) std::clamp(std::lround((endpoints[e][c] - p) / 2.0f), 0l, 127l);
+                    float decoded = (float) ((values[c] << 1) | p);
+                    error += (decoded - endpoints[e][c]) * (decoded - endpoints[e][c]);
+                }
+                if (error < bestError) {
+                    bestError = error;
+                    pbits[e] = p;
+                    memcpy(quantized[e], values, sizeof(values));
+                }
+            }
+        }
+
+        float palette[16][4];
+        for (int c = 0; c < 4; c++) {
+            uint32_t e0 = (quantized[0][c] << 1) | pbits[0], e1 = (quantized[1][c] << 1) | pbits[1];
+            for (int k = 0; k < 16; k++)
+                palette[k][c] = (float) (((64 - weights[k]) * e0 + weights[k] * e1 + 32) >> 6);
+        }
+
+        uint32_t indices[16];
+        for (int i = 0; i < 16; i++) {
+            float bestError = INFINITY;
+            for (uint32_t k = 0; k < 16; k++) {
+                float error = 0.0f;
+                for (int c = 0; c < 4; c++)
+                    error += (block[i][c] - palette[k][c]) * (block[i][c] - palette[k][c]);
+                if (error < bestError) { bestError = error; indices[i] = k; }
+            }
+        }
+
+        /* 第一个像素的索引最高位隐含为 0，否则交换端点 */
+        if (indices[0] & 8) {
+            std::swap(quantized[0], quantized[1]);
+            std::swap(pbits[0], pbits[1]);
+            for (auto &index : indices)
+                index = 15 - index;
+        }
+
+        uint8_t bytes[16] = {};
+        uint32_t position = 0;
+        auto write = [&](uint32_t value, uint32_t count) {
+            for (uint32_t i = 0; i < count; i++, position++)
+                bytes[position >> 3] |= ((value >> i) & 1) << (position & 7);
+        };
+
+        write(1 << 6, 7);
+        for (int c = 0; c < 4; c++) {
+            write(quantized[0][c], 7);
+            write(quantized[1][c], 7);
+        }
+        write(pbits[0], 1);
+        write(pbits[1], 1);
+        write(indices[0], 3);
+        for (int i = 1; i < 16; i++)
+            write(indices[i], 4);
+
+        memcpy(pOut, bytes, 16);
+    }
+
+    /* 编码一个 RGBA8 level，pOut 至少 GetEncodedSize() 字节 */
+    static void Encode(BCnFormat format, const uint8_t *pPixels, uint32_t width, uint32_t height, uint8_t *pOut) {
+        uint32_t blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+        uint32_t blockSize = GetBlockSize(format);
+
+        for (uint32_t by = 0; by < blocksY; by++) {
+            for (uint32_t bx = 0; bx < blocksX; bx++) {
+                float block[16][4];
+                _LoadBlock(pPixels, width, height, bx, by, block);
+                uint8_t *out = pOut + ((size_t) by * blocksX + bx) * blockSize;
+
+                switch (format) {
+                    case BCN_FORMAT_BC1:
+                        _EncodeColorBlock(block, out);
+                        break;
+                    case BCN_FORMAT_BC3:
+                        _EncodeChannelBlock(block, 3, out);
+                        _EncodeColorBlock(block, out + 8);
+                        break;
+                    case BCN_FORMAT_BC4:
+                        _EncodeChannelBlock(block, 0, out);
+                        break;
+                    case BCN_FORMAT_BC5:
+                        _EncodeChannelBlock(block, 0, out);
+                        _EncodeChannelBlock(block, 1, out + 8);
+                        break;
+                    case BCN_FORMAT_BC7:
+                        _EncodeBC7Block(block, out);
+                        break;
+                }
+            }
+        }
+    }
+
+}
+
+#endif /* _VECTRAFLUX_ENGINE_BCN_ENCODER_H_ */
@@ -0,0 +1,166 @@
+/* ************************************************************************
+ *
+ * Copyright (C) 2022 Vincent Luo All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, e1ither express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ************************************************************************/
+/* Creates on 2026/10/17. */
+
+/*
+ ===============================
+   @author bit-fashion
+ ===============================
+*/
+#ifndef _VECTRAFLUX_ENGINE_KTX2_H_
+#define _VECTRAFLUX_ENGINE_KTX2_H_
+
+#include <Typedef.h>
+#include <bit>
+#include <fstream>
+#include <cstring>
+#include <stdexcept>
+
+/* 引擎里的纹理最多 VULKAN_MAX_MIP_LEVELS 级 */
+#define KTX2_MAX_LEVELS 16
+
+/* KTX2 文件头，字段顺序和大小与规范一致 (80 字节) */
+struct KTX2Header {
+    uint8_t identifier[12];
+    uint32_t vkFormat;
+    uint32_t typeSize;
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t pixelDepth;
+    uint32_t layerCount;
+    uint32_t faceCount;
+    uint32_t levelCount;
+    uint32_t supercompressionScheme;
+    uint32_t dfdByteOffset;
+    uint32_t dfdByteLength;
+    uint32_t kvdByteOffset;
+    uint32_t kvdByteLength;
+    uint64_t sgdByteOffset;
+    uint64_t sgdByteLength;
+};
+
+struct KTX2Level {
+    uint64_t byteOffset;
+    uint64_t byteLength;
+    uint64_t uncompressedByteLength;
+};
+
+/* 解析结果，level 数据指向调用者传入的文件内存 */
+struct KTX2Texture {
+    uint32_t vkFormat;
+    uint32_t width;
+    uint32_t height;
+    Vector<const uint8_t *> levelData; /* level 0 first */
+    Vector<uint64_t> levelSizes;
+};
+
+/**
+ * 只支持 2D、单层、无超压缩的 KTX2，贴图烘焙器写出的就是这种。Parse 只检查
+ * 文件结构，每个 level 的大小是否和格式相符由调用者检查。
+ */
+namespace KTX2 {
+
+    static const uint8_t Identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+    static bool IsKTX2(const void *pData, size_t size) {
+        return size >= sizeof(KTX2Header) && memcmp(pData, Identifier, sizeof(Identifier)) == 0;
+    }
+
+    static void Parse(const void *pData, size_t size, KTX2Texture *pTexture) {
+        if (!IsKTX2(pData, size))
+            throw std::runtime_error("not a KTX2 file!");
+
+        KTX2Header header;
+        memcpy(&header, pData, sizeof(header));
+        if (header.supercompressionScheme != 0 || header.pixelDepth != 0 || header.layerCount > 1 || header.faceCount != 1)
+            throw std::runtime_error("unsupported KTX2 file, only uncompressed single 2D images are supported!");
+
+        if (header.pixelWidth == 0 || header.pixelHeight == 0)
+            throw std::runtime_error("invalid KTX2 image size!");
+
+        /* level 数不能超过完整 mip 链的长度，先限制住再算 level index 的大小 */
+        uint32_t levelCount = std::max(1u, header.levelCount);
+        if (levelCount > KTX2_MAX_LEVELS || levelCount > static_cast<uint32_t>(std::bit_width(std::max(header.pixelWidth, header.pixelHeight))))
+            throw std::runtime_error("invalid KTX2 level count!");
+        if (sizeof(header) + levelCount * sizeof(KTX2Level) > size)
+            throw std::runtime_error("truncated KTX2 level index!");
+
+        const uint8_t *bytes = static_cast<const uint8_t *>(pData);
+        pTexture->vkFormat = header.vkFormat;
+        pTexture->width = header.pixelWidth;
+        pTexture->height = header.pixelHeight;
+        pTexture->levelData.resize(levelCount);
+        pTexture->levelSizes.resize(levelCount);
+
+        for (uint32_t i = 0; i < levelCount; i++) {
+            KTX2Level level;
+            memcpy(&level, bytes + sizeof(header) + i * sizeof(KTX2Level), sizeof(level));
+            /* 分开比较，offset + length 可能溢出 */
+            if (level.byteOffset > size || level.byteLength > size - level.byteOffset)
+                throw std::runtime_error("truncated KTX2 level data!");
+            pTexture->levelData[i] = bytes + level.byteOffset;
+            pTexture->levelSizes[i] = level.byteLength;
+        }
+    }
+
+    /* levels 从 level 0 开始，文件里按规范从最小的 level 开始存放 */
+    static void Write(const String &path, uint32_t vkFormat, uint32_t typeSize, uint32_t width, uint32_t height,
+                      uint32_t levelAlignment, const Vector<uint32_t> &dfd, const Vector<Vector<uint8_t>> &levels) {
+        uint32_t levelCount = std::size(levels);
+
+        KTX2Header header = {};
+        memcpy(header.identifier, Identifier, sizeof(Identifier));
+        header.vkFormat = vkFormat;
+        header.typeSize = typeSize;
+        header.pixelWidth = width;
+        header.pixelHeight = height;
+        header.faceCount = 1;
+        header.levelCount = levelCount;
+        header.dfdByteOffset = sizeof(header) + levelCount * sizeof(KTX2Level);
+        header.dfdByteLength = std::size(dfd) * sizeof(uint32_t);
+
+        Vector<KTX2Level> levelIndex(levelCount);
+        uint64_t offset = header.dfdByteOffset + header.dfdByteLength;
+        for (uint32_t i = levelCount; i-- > 0;) {
+            offset = (offset + levelAlignment - 1) / levelAlignment * levelAlignment;
+            levelIndex[i].byteOffset = offset;
+            levelIndex[i].byteLength = std::size(levels[i]);
+            levelIndex[i].uncompressedByteLength = std::size(levels[i]);
+            offset += std::size(levels[i]);
+        }
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            throw std::runtime_error("Error: open file failed!");
+
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(std::data(levelIndex)), levelCount * sizeof(KTX2Level));
+        file.write(reinterpret_cast<const char *>(std::data(dfd)), header.dfdByteLength);
+
+        uint64_t position = header.dfdByteOffset + header.dfdByteLength;
+        static const char padding[16] = {};
+        for (uint32_t i = levelCount; i-- > 0;) {
+            file.write(padding, levelIndex[i].byteOffset - position);
+            file.write(reinterpret_cast<const char *>(std::data(levels[i])), std::size(levels[i]));
+            position = levelIndex[i].byteOffset + levelIndex[i].byteLength;
+        }
+    }
+
+}
+
+#endif /* _VECTRAFLUX_ENGINE_KTX2_H_ */
@@ -0,0 +1,113 @@
+/* ************************************************************************
+ *
+ * Copyright (C) 2022 Vincent Luo All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, e1ither express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ************************************************************************/
+
+/* Creates on 2026/10/17. */
+
+/*
+ ===============================
+   @author bit-fashion
+ ===============================
+*/
+#ifndef _VECTRAFLUX_ENGINE_THREAD_POOL_H_
+#define _VECTRAFLUX_ENGINE_THREAD_POOL_H_
+
+#include <Typedef.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+
+/**
+ * 固定数量工作线程的任务池，任务按提交顺序执行。
+ */
+class ThreadPool {
+public:
+    explicit ThreadPool(uint32_t threadCount = 0) {
+        if (threadCount == 0)
+            threadCount = std::max(2u, std::thread::hardware_concurrency()) - 1;
+
+        for (uint32_t i = 0; i < threadCount; i++)
+            m_Workers.emplace_back([this] { WorkerMain(); });
+    }
+
+   ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Stopping = true;
+        }
+        m_TaskCondition.notify_all();
+        for (auto &worker : m_Workers)
+            worker.join();
+    }
+
+    void Submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Tasks.push_back(std::move(task));
+            ++m_PendingCount;
+        }
+        m_TaskCondition.notify_one();
+    }
+
+    /* 阻塞直到所有已提交的任务执行完毕 */
+    void Wait() {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_IdleCondition.wait(lock, [this] { return m_PendingCount == 0; });
+    }
+
+    uint32_t GetThreadCount() const { return static_cast<uint32_t>(std::size(m_Workers)); }
+
+private:
+    void WorkerMain() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(m_Mutex);
+                m_TaskCondition.wait(lock, [this] { return m_Stopping || !m_Tasks.empty(); });
+                if (m_Tasks.empty())
+                    return;
+                task = std::move(m_Tasks.front());
+                m_Tasks.pop_front();
+            }
+
+            /* 任务自己负责错误处理，这里只保证计数正确 */
+            try {
+                task();
+            } catch (...) {
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                if (--m_PendingCount == 0)
+                    m_IdleCondition.notify_all();
+            }
+        }
+    }
+
+private:
+    Vector<std::thread> m_Workers;
+    std::deque<std::function<void()>> m_Tasks;
+    std::mutex m_Mutex;
+    std::condition_variable m_TaskCondition;
+    std::condition_variable m_IdleCondition;
+    uint32_t m_PendingCount = 0;
+    bool m_Stopping = false;
+};
+
+#endif /* _VECTRAFLUX_ENGINE_THREAD_POOL_H_ */
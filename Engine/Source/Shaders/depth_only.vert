@@ -0,0 +1,16 @@
+#version 450
+
+// 深度/阴影 pass：只读位置流 (binding 0)，布局用 VertexLayout::GetPositionOnly()
+layout(location = 0) in vec3 inPosition;
+
+layout(set = 0, binding = 0) uniform UniformBufferObject {
+    mat4 m;
+    mat4 v;
+    mat4 p;
+} ubo;
+
+invariant gl_Position;
+
+void main() {
+    gl_Position = ubo.p * ubo.v * ubo.m * vec4(inPosition, 1.0f);
+}
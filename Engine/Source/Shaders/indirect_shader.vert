@@ -0,0 +1,21 @@
+#version 450
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+layout(location = 2) in vec2 inTexCoord;
+
+layout(push_constant) uniform PushConstants {
+    mat4 viewProjection;
+} pc;
+
+/* 每个物体一个矩阵，indirect 命令的 firstInstance 就是物体下标 */
+layout(std430, set = 0, binding = 0) readonly buffer Transforms {
+    mat4 models[];
+};
+
+layout(location = 0) out vec3 outColor;
+
+void main() {
+    gl_Position = pc.viewProjection * models[gl_InstanceIndex] * vec4(inPosition, 1.0f);
+    outColor = inColor;
+}
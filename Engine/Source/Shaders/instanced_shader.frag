@@ -0,0 +1,16 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(location = 0) in vec3 inColor;
+layout(location = 1) in vec2 inTexCoord;
+layout(location = 2) flat in uint inMaterialIndex;
+
+layout(set = 1, binding = 0) uniform sampler2D textures[];
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    /* VULKAN_BINDLESS_INVALID_INDEX 只用颜色 */
+    vec4 albedo = inMaterialIndex != 0xFFFFFFFFu ? texture(textures[nonuniformEXT(inMaterialIndex)], inTexCoord) : vec4(1.0f);
+    outColor = vec4(inColor, 1.0f) * albedo;
+}
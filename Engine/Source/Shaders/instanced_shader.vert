@@ -0,0 +1,35 @@
+#version 450
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+layout(location = 2) in vec2 inTexCoord;
+
+layout(push_constant) uniform PushConstants {
+    mat4 viewProjection;
+} pc;
+
+/* VkInstanceData, firstInstance 是批次在 buffer 里的偏移 */
+struct InstanceData {
+    vec4 transform[3];
+    uint color;
+    uint materialIndex;
+    uint reserved[2];
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer Instances {
+    InstanceData instances[];
+};
+
+layout(location = 0) out vec3 outColor;
+layout(location = 1) out vec2 outTexCoord;
+layout(location = 2) flat out uint outMaterialIndex;
+
+void main() {
+    InstanceData instance = instances[gl_InstanceIndex];
+    vec4 position = vec4(inPosition, 1.0f);
+    vec3 world = vec3(dot(instance.transform[0], position), dot(instance.transform[1], position), dot(instance.transform[2], position));
+    gl_Position = pc.viewProjection * vec4(world, 1.0f);
+    outColor = inColor * unpackUnorm4x8(instance.color).rgb;
+    outTexCoord = inTexCoord;
+    outMaterialIndex = instance.materialIndex;
+}
@@ -0,0 +1,15 @@
+#version 450
+
+layout(location = 0) in vec3 inColor;
+layout(location = 1) in vec2 inTexCoord;
+layout(location = 2) in vec3 inNormal;
+
+layout(location = 0) out vec4 outColor;
+
+// 固定方向光 + 环境光，只用来看量化后的法线是否正确
+const vec3 LIGHT_DIRECTION = vec3(0.3482f, 0.8704f, 0.3482f);
+
+void main() {
+    float diffuse = max(dot(normalize(inNormal), LIGHT_DIRECTION), 0.0f);
+    outColor = vec4(inColor * (0.25f + 0.75f * diffuse), 1.0f);
+}
@@ -0,0 +1,39 @@
+#version 450
+
+// VertexLayout::CreateQuantized: unorm16/float16 position, unorm8 color,
+// float16 uv and an octahedral snorm16 normal. Attribute formats are
+// converted by the input assembler, ubo.m already contains
+// VertexQuantization::GetMatrix() and ubo.normal is the inverse transpose
+// of the model matrix, computed once on the CPU.
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+layout(location = 2) in vec2 inTexCoord;
+layout(location = 3) in vec2 inNormal;
+
+layout(set = 0, binding = 0) uniform UniformBufferObject {
+    mat4 m;
+    mat4 v;
+    mat4 p;
+    mat4 normal;
+} ubo;
+
+// depth_only 的预深度之后用 EQUAL 比较，两边的位置必须逐位一致
+invariant gl_Position;
+
+layout(location = 0) out vec3 outColor;
+layout(location = 1) out vec2 outTexCoord;
+layout(location = 2) out vec3 outNormal;
+
+vec3 DecodeOctahedral(vec2 e) {
+    vec3 n = vec3(e, 1.0f - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0f);
+    n.xy += mix(vec2(t), vec2(-t), greaterThanEqual(n.xy, vec2(0.0f)));
+    return normalize(n);
+}
+
+void main() {
+    gl_Position = ubo.p * ubo.v * ubo.m * vec4(inPosition, 1.0f);
+    outColor = inColor;
+    outTexCoord = inTexCoord;
+    outNormal = normalize(mat3(ubo.normal) * DecodeOctahedral(inNormal));
+}
@@ -0,0 +1,257 @@
+/* ************************************************************************
+ *
+ * Copyright (C) 2022 Vincent Luo All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, e1ither express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * ************************************************************************/
+/* Creates on 2026/10/17. */
+
+/*
+  ===================================
+    @author bit-fashion
+  ===================================
+*/
+#include <Typedef.h>
+#include <System.h>
+#include <vulkan/vulkan.h>
+#include "Utils/IOUtils.h"
+#include "Utils/MipmapUtils.h"
+#include "Utils/Texture/BCnEncoder.h"
+#include "Utils/Texture/KTX2.h"
+#include <cmath>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb/stb_image.h>
+
+//
+// 离线贴图烘焙：PNG/JPG -> 带完整 mip 链的 BCn KTX2
+//
+//   TextureCooker [--type albedo|normal|mask] [--format bc1|bc3|bc4|bc5|bc7] [-o output.ktx2] inputs...
+//
+// 不指定 --type 时按文件名判断：*_ddn / *_normal 为法线，*_spec 为单通道遮罩，其余为颜色。
+// 默认输出为输入文件同目录同名的 .ktx2，运行时 CreateTexture2D 会优先加载它。
+//
+
+enum TextureType {
+    TEXTURE_TYPE_ALBEDO,
+    TEXTURE_TYPE_NORMAL, /* XY in RG, Z is reconstructed in the shader */
+    TEXTURE_TYPE_MASK, /* single channel, red */
+};
+
+struct CookOptions {
+    bool hasType = false;
+    TextureType type = TEXTURE_TYPE_ALBEDO;
+    bool hasFormat = false;
+    BCnFormat format = BCN_FORMAT_BC7;
+    String output;
+};
+
+static TextureType GuessTextureType(const String &path) {
+    if (path.find("_ddn") != String::npos || path.find("_normal") != String::npos)
+        return TEXTURE_TYPE_NORMAL;
+    if (path.find("_spec") != String::npos)
+        return TEXTURE_TYPE_MASK;
+    return TEXTURE_TYPE_ALBEDO;
+}
+
+static const char *GetFormatName(BCnFormat format) {
+    static const char *names[] = { "BC1", "BC3", "BC4", "BC5", "BC7" };
+    return names[format];
+}
+
+static VkFormat GetVulkanFormat(BCnFormat format) {
+    switch (format) {
+        case BCN_FORMAT_BC1: return VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+        case BCN_FORMAT_BC3: return VK_FORMAT_BC3_UNORM_BLOCK;
+        case BCN_FORMAT_BC4: return VK_FORMAT_BC4_UNORM_BLOCK;
+        case BCN_FORMAT_BC5: return VK_FORMAT_BC5_UNORM_BLOCK;
+        default: return VK_FORMAT_BC7_UNORM_BLOCK;
+    }
+}
+
+/* Khronos basic data format descriptor of a 4x4 block compressed format */
+static Vector<uint32_t> BuildDataFormatDescriptor(BCnFormat format) {
+    /* KHR_DF_MODEL_BC1A .. BC7 */
+    static const uint32_t colorModels[] = { 128, 130, 131, 132, 134 };
+    /* {channel, bit offset, bit length}，channel: 0 颜色/红, 1 绿, 15 alpha */
+    struct Sample { uint32_t channel, offset, length; };
+    Vector<Sample> samples;
+    switch (format) {
+        case BCN_FORMAT_BC1: samples = { { 0, 0, 64 } }; break;
+        case BCN_FORMAT_BC3: samples = { { 15, 0, 64 }, { 0, 64, 64 } }; break;
+        case BCN_FORMAT_BC4: samples = { { 0, 0, 64 } }; break;
+        case BCN_FORMAT_BC5: samples = { { 0, 0, 64 }, { 1, 64, 64 } }; break;
+        case BCN_FORMAT_BC7: samples = { { 0, 0, 128 } }; break;
+    }
+
+    uint32_t blockSize = 24 + 16 * std::size(samples);
+    Vector<uint32_t> dfd;
+    dfd.push_back(4 + blockSize); /* dfdTotalSize */
+    dfd.push_back(0); /* vendor Khronos, descriptor type basic */
+    dfd.push_back(2 | (blockSize << 16)); /* version 1.3 */
+    dfd.push_back(colorModels[format] | (1 << 8) | (1 << 16)); /* BT709 primaries, linear transfer, straight alpha */
+    dfd.push_back(3 | (3 << 8)); /* 4x4x1x1 texel block */
+    dfd.push_back(BCnEncoder::GetBlockSize(format));
+    dfd.push_back(0);
+    for (const Sample &sample : samples) {
+        dfd.push_back(sample.offset | ((sample.length - 1) << 16) | (sample.channel << 24));
+        dfd.push_back(0);
+        dfd.push_back(0);
+        dfd.push_back(UINT32_MAX);
+    }
+    return dfd;
+}
+
+/* 法线 box filter 之后长度变短，重新归一化 */
+static void RenormalizeNormals(uint8_t *pPixels, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        uint8_t *pixel = pPixels + i * 4;
+        float x = pixel[0] / 127.5f - 1.0f, y = pixel[1] / 127.5f - 1.0f, z = pixel[2] / 127.5f - 1.0f;
+        float length = std::sqrt(x * x + y * y + z * z);
+        if (length < 1e-6f)
+            continue;
+        pixel[0] = (uint8_t) std::lround((x / length + 1.0f) * 127.5f);
+        pixel[1] = (uint8_t) std::lround((y / length + 1.0f) * 127.5f);
+        pixel[2] = (uint8_t) std::lround((z / length + 1.0f) * 127.5f);
+    }
+}
+
+static void CookTexture(const String &input, const CookOptions &options) {
+    timestamp64_t decodeStart = System::GetTimeNanos();
+    int width, height, channels;
+    stbi_uc *pixels = stbi_load(getchr(input), &width, &height, &channels, STBI_rgb_alpha);
+    if (!pixels)
+        throw std::runtime_error(strfmt("failed to load texture image: {}", input));
+    timestamp64_t decodeNanos = System::GetTimeNanos() - decodeStart;
+
+    TextureType type = options.hasType ? options.type : GuessTextureType(input);
+    BCnFormat format = options.format;
+    if (!options.hasFormat) {
+        if (type == TEXTURE_TYPE_NORMAL) {
+            format = BCN_FORMAT_BC5;
+        } else if (type == TEXTURE_TYPE_MASK) {
+            format = BCN_FORMAT_BC4;
+        } else {
+            /* 不透明的颜色贴图用 BC1，体积是 BC7 的一半 */
+            bool opaque = true;
+            for (size_t i = 0; i < (size_t) width * height && opaque; i++)
+                opaque = pixels[i * 4 + 3] == 255;
+            format = opaque ? BCN_FORMAT_BC1 : BCN_FORMAT_BC7;
+        }
+    }
+
+    timestamp64_t encodeStart = System::GetTimeNanos();
+    uint32_t mipLevels = MipmapUtils::GetMipLevelCount(width, height);
+    Vector<Vector<uint8_t>> levels(mipLevels);
+    Vector<uint8_t> level(pixels, pixels + (size_t) width * height * 4), next;
+    stbi_image_free(pixels);
+
+    size_t uncompressedBytes = 0;
+    for (uint32_t i = 0; i < mipLevels; i++) {
+        uint32_t levelWidth = std::max(1, width >> i), levelHeight = std::max(1, height >> i);
+        uncompressedBytes += std::size(level);
+
+        levels[i].resize(BCnEncoder::GetEncodedSize(format, levelWidth, levelHeight));
+        BCnEncoder::Encode(format, std::data(level), levelWidth, levelHeight, std::data(levels[i]));
+
+        if (i + 1 < mipLevels) {
+            next.resize((size_t) std::max(1u, levelWidth >> 1) * std::max(1u, levelHeight >> 1) * 4);
+            MipmapUtils::Downsample(std::data(level), levelWidth, levelHeight, 4, std::data(next));
+            if (type == TEXTURE_TYPE_NORMAL)
+                RenormalizeNormals(std::data(next), std::size(next) / 4);
+            std::swap(level, next);
+        }
+    }
+    timestamp64_t encodeNanos = System::GetTimeNanos() - encodeStart;
+
+    String output = options.output;
+    if (output.empty())
+        output = input.substr(0, input.find_last_of('.')) + ".ktx2";
+
+    /* level 偏移按块大小对齐 (同时满足 4 字节对齐) */
+    uint32_t blockSize = BCnEncoder::GetBlockSize(format);
+    KTX2::Write(output, GetVulkanFormat(format), 1, width, height, blockSize, BuildDataFormatDescriptor(format), levels);
+
+    /* 运行时加载路径：读文件 + 解析，不再解码 */
+    timestamp64_t loadStart = System::GetTimeNanos();
+    size_t size;
+    char *buf = IOUtils::Read(output, &size);
+    KTX2Texture texture;
+    KTX2::Parse(buf, size, &texture);
+    IOUtils::Free(buf);
+    timestamp64_t loadNanos = System::GetTimeNanos() - loadStart;
+
+    size_t compressedBytes = 0;
+    for (const auto &encoded : levels)
+        compressedBytes += std::size(encoded);
+
+    System::ConsoleWrite("{} -> {} ({}x{}, {} mips, {})", input, output, width, height, mipLevels, GetFormatName(format));
+    System::ConsoleWrite("  VRAM: {:.2f} MB RGBA8 -> {:.2f} MB ({:.1f}x smaller)",
+                         uncompressedBytes / 1048576.0, compressedBytes / 1048576.0, (double) uncompressedBytes / compressedBytes);
+    System::ConsoleWrite("  load: {:.2f} ms decode -> {:.2f} ms read, encode {:.2f} ms",
+                         decodeNanos / 1e6, loadNanos / 1e6, encodeNanos / 1e6);
+}
+
+static bool ParseFormat(const String &name, BCnFormat *pFormat) {
+    static const std::pair<const char *, BCnFormat> formats[] = {
+        { "bc1", BCN_FORMAT_BC1 }, { "bc3", BCN_FORMAT_BC3 }, { "bc4", BCN_FORMAT_BC4 },
+        { "bc5", BCN_FORMAT_BC5 }, { "bc7", BCN_FORMAT_BC7 },
+    };
+    for (const auto &[formatName, format] : formats) {
+        if (name == formatName) {
+            *pFormat = format;
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, const char **argv) {
+    CookOptions options;
+    Vector<String> inputs;
+
+    for (int i = 1; i < argc; i++) {
+        String arg = argv[i];
+        if (arg == "--type" && i + 1 < argc) {
+            String type = argv[++i];
+            options.hasType = true;
+            options.type = type == "normal" ? TEXTURE_TYPE_NORMAL : type == "mask" ? TEXTURE_TYPE_MASK : TEXTURE_TYPE_ALBEDO;
+        } else if (arg == "--format" && i + 1 < argc) {
+            options.hasFormat = ParseFormat(argv[++i], &options.format);
+            if (!options.hasFormat) {
+                System::ConsoleWrite("unknown format: {}", argv[i]);
+                return 1;
+            }
+        } else if (arg == "-o" && i + 1 < argc) {
+            options.output = argv[++i];
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+
+    if (inputs.empty() || (!options.output.empty() && std::size(inputs) > 1)) {
+        System::ConsoleWrite("usage: TextureCooker [--type albedo|normal|mask] [--format bc1|bc3|bc4|bc5|bc7] [-o output.ktx2] inputs...");
+        return 1;
+    }
+
+    try {
+        for (const auto &input : inputs)
+            CookTexture(input, options);
+    } catch (const std::exception &e) {
+        System::ConsoleWrite("error: {}", e.what());
+        return 1;
+    }
+
+    return 0;
+}